@@ -331,6 +331,8 @@ bool Expression::is_constant() const { return repn->is_constant(); }
 
 double Expression::value() const { return repn->eval(); }
 
+Interval Expression::interval() const { return interval_expr(repn); }
+
 std::list<std::string> Expression::to_list() const
 {
     std::list<std::string> tmp;
@@ -1006,21 +1008,34 @@ Expression operator/(const Expression& lhs, const Expression& rhs)
 // TODO - Maybe we should have an expression term for affine expressions.  But for now, we'll
 // just create a sum of monomials.
 //
+// The terms are stored in a single PlusTerm, which avoids creating a temporary
+// PlusTerm object for each term that is added.
+//
+namespace {
+
+template <typename TermFn>
+Expression affine_sum(size_t n, double offset, const TermFn& term)
+{
+    expr_pointer_t e = CREATE_POINTER(ConstantTerm, offset);
+    if (n == 0) return e;
+
+    auto sum = CREATE_POINTER(PlusTerm, e, term(0), false);
+    sum->data->reserve(n + 1);
+    for (size_t i = 1; i < n; ++i) sum->push_back(term(i));
+    return expr_pointer_t(sum);
+}
+
+}  // namespace
+
 Expression affine_expression(const std::vector<double>& coef, const std::vector<Variable>& var,
                              double offset)
 {
-    Expression e(offset);
-    auto cit = coef.begin();
-    auto vit = var.begin();
-    for (; vit != var.end(); ++vit, ++cit) e += (*cit) * (*vit);
-    return e;
+    return affine_sum(var.size(), offset, [&](size_t i) { return (coef[i] * var[i]).repn; });
 }
 
 Expression affine_expression(const std::vector<Variable>& var, double offset)
 {
-    Expression e(offset);
-    for (auto& v : var) e += v;
-    return e;
+    return affine_sum(var.size(), offset, [&](size_t i) { return expr_pointer_t(var[i].repn); });
 }
 
 }  // namespace coek
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <coek/api/constants.hpp>
+#include <coek/util/interval.hpp>
 #include <initializer_list>
 #include <iostream>
 #include <list>
@@ -325,6 +326,13 @@ class Expression {
      * Parameter and Variable objects.
      */
     double value() const;
+    /** \returns an interval that contains the values of the expression
+     *
+     * \note The interval is computed with interval arithmetic using the
+     * bounds of the associated Variable objects.  Fixed variables and
+     * parameters have a single value.
+     */
+    Interval interval() const;
 
     /** \returns a list representation of the expression */
     std::list<std::string> to_list() const;
@@ -0,0 +1,240 @@
+#include "coek/api/linear_constraint_block.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "coek/api/constants.hpp"
+#include "coek/api/expression.hpp"
+#if __cpp_lib_variant
+#    include "coek/api/parameter_array.hpp"
+#    include "coek/api/variable_array.hpp"
+#endif
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/model/model.hpp"
+#include "coek/model/model_repn.hpp"
+
+namespace coek {
+
+class LinearConstraintBlockRepn {
+   public:
+    std::shared_ptr<LinearBlockData> data;
+    // The bound expressions of each row, which are null if a row does not have a bound
+    std::vector<expr_pointer_t> lower;
+    std::vector<expr_pointer_t> upper;
+    bool equality = false;
+    // The constraints, which are created when the block is added to a model
+    bool created = false;
+    std::vector<Constraint> rows;
+
+   public:
+    void initialize(std::vector<std::shared_ptr<VariableTerm>>&& vars,
+                    const std::vector<size_t>& row_start, const std::vector<size_t>& col_index,
+                    const std::vector<double>& values);
+
+    size_t size() const { return data->row_start.size() - 1; }
+
+    void check_bounds(size_t n) const;
+    void set_bounds(std::vector<expr_pointer_t>& bounds, const std::vector<double>& values);
+    void create_rows();
+};
+
+void LinearConstraintBlockRepn::initialize(std::vector<std::shared_ptr<VariableTerm>>&& vars,
+                                           const std::vector<size_t>& row_start,
+                                           const std::vector<size_t>& col_index,
+                                           const std::vector<double>& values)
+{
+    if ((row_start.size() == 0) or (row_start[0] != 0))
+        throw std::runtime_error("The row starts of a linear constraint block must begin with 0");
+    for (size_t i = 1; i < row_start.size(); i++)
+        if (row_start[i] < row_start[i - 1])
+            throw std::runtime_error("The row starts of a linear constraint block must be "
+                                     "nondecreasing");
+    if ((row_start.back() != col_index.size()) or (col_index.size() != values.size()))
+        throw std::runtime_error("A linear constraint block has "
+                                 + std::to_string(row_start.back()) + " nonzeros, but "
+                                 + std::to_string(col_index.size()) + " column indices and "
+                                 + std::to_string(values.size()) + " values");
+    for (auto j : col_index)
+        if (j >= vars.size())
+            throw std::runtime_error("Column index " + std::to_string(j)
+                                     + " is out of range for a linear constraint block with "
+                                     + std::to_string(vars.size()) + " variables");
+
+    data = std::make_shared<LinearBlockData>();
+    data->vars = std::move(vars);
+    data->row_start = row_start;
+    data->col_index = col_index;
+    data->values = values;
+    lower.resize(size());
+    upper.resize(size());
+}
+
+void LinearConstraintBlockRepn::check_bounds(size_t n) const
+{
+    if (created)
+        throw std::runtime_error(
+            "Cannot change the bounds of a linear constraint block after it is added to a model");
+    if (n != size())
+        throw std::runtime_error("Cannot set " + std::to_string(n)
+                                 + " bounds for a linear constraint block with "
+                                 + std::to_string(size()) + " rows");
+}
+
+void LinearConstraintBlockRepn::set_bounds(std::vector<expr_pointer_t>& bounds,
+                                           const std::vector<double>& values)
+{
+    check_bounds(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        if (std::fabs(values[i]) >= COEK_INFINITY)
+            bounds[i] = nullptr;
+        else
+            bounds[i] = CREATE_POINTER(ConstantTerm, values[i]);
+    }
+}
+
+void LinearConstraintBlockRepn::create_rows()
+{
+    std::vector<Constraint> tmp;
+    tmp.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        auto body = CREATE_POINTER(LinearRowTerm, data, i);
+        if (equality) {
+            if (not lower[i])
+                throw std::runtime_error("Row " + std::to_string(i)
+                                         + " of a linear constraint block has an infinite "
+                                           "right-hand side");
+            tmp.emplace_back(CREATE_POINTER(EqualityTerm, body, lower[i]));
+        }
+        else {
+            if (not lower[i] and not upper[i])
+                throw std::runtime_error("Row " + std::to_string(i)
+                                         + " of a linear constraint block does not have a bound");
+            tmp.emplace_back(CREATE_POINTER(InequalityTerm, lower[i], body, upper[i]));
+        }
+    }
+    rows = std::move(tmp);
+    created = true;
+}
+
+//
+// LinearConstraintBlock
+//
+
+LinearConstraintBlock::LinearConstraintBlock(const std::vector<Variable>& variables,
+                                             const std::vector<size_t>& row_start,
+                                             const std::vector<size_t>& col_index,
+                                             const std::vector<double>& values)
+    : repn(std::make_shared<LinearConstraintBlockRepn>())
+{
+    std::vector<std::shared_ptr<VariableTerm>> vars;
+    vars.reserve(variables.size());
+    for (auto& var : variables) vars.push_back(var.repn);
+    repn->initialize(std::move(vars), row_start, col_index, values);
+}
+
+#if __cpp_lib_variant
+LinearConstraintBlock::LinearConstraintBlock(VariableArray& variables,
+                                             const std::vector<size_t>& row_start,
+                                             const std::vector<size_t>& col_index,
+                                             const std::vector<double>& values)
+    : repn(std::make_shared<LinearConstraintBlockRepn>())
+{
+    std::vector<std::shared_ptr<VariableTerm>> vars;
+    vars.reserve(variables.size());
+    for (auto& var : variables) vars.push_back(var.repn);
+    repn->initialize(std::move(vars), row_start, col_index, values);
+}
+#endif
+
+size_t LinearConstraintBlock::size() const { return repn->size(); }
+
+size_t LinearConstraintBlock::num_nonzeros() const { return repn->data->values.size(); }
+
+LinearConstraintBlock& LinearConstraintBlock::lower(const std::vector<double>& values)
+{
+    repn->set_bounds(repn->lower, values);
+    repn->equality = false;
+    return *this;
+}
+
+LinearConstraintBlock& LinearConstraintBlock::upper(const std::vector<double>& values)
+{
+    repn->set_bounds(repn->upper, values);
+    repn->equality = false;
+    return *this;
+}
+
+LinearConstraintBlock& LinearConstraintBlock::equal(const std::vector<double>& values)
+{
+    repn->set_bounds(repn->lower, values);
+    repn->upper = repn->lower;
+    repn->equality = true;
+    return *this;
+}
+
+#if __cpp_lib_variant
+namespace {
+
+void set_parameter_bounds(LinearConstraintBlockRepn& repn, std::vector<expr_pointer_t>& bounds,
+                          ParameterArray& values)
+{
+    repn.check_bounds(values.size());
+    size_t i = 0;
+    for (auto& param : values) bounds[i++] = param.repn;
+}
+
+}  // namespace
+
+LinearConstraintBlock& LinearConstraintBlock::lower(ParameterArray& values)
+{
+    set_parameter_bounds(*repn, repn->lower, values);
+    repn->equality = false;
+    return *this;
+}
+
+LinearConstraintBlock& LinearConstraintBlock::upper(ParameterArray& values)
+{
+    set_parameter_bounds(*repn, repn->upper, values);
+    repn->equality = false;
+    return *this;
+}
+
+LinearConstraintBlock& LinearConstraintBlock::equal(ParameterArray& values)
+{
+    set_parameter_bounds(*repn, repn->lower, values);
+    repn->upper = repn->lower;
+    repn->equality = true;
+    return *this;
+}
+#endif
+
+Constraint LinearConstraintBlock::get_constraint(size_t i) const
+{
+    if (not repn->created)
+        throw std::runtime_error("A linear constraint block does not have constraints until it "
+                                 "is added to a model");
+    if (i >= repn->rows.size())
+        throw std::runtime_error("Row " + std::to_string(i)
+                                 + " is out of range for a linear constraint block with "
+                                 + std::to_string(repn->rows.size()) + " rows");
+    return repn->rows[i];
+}
+
+//
+// Model
+//
+
+void Model::add_constraint(LinearConstraintBlock& block)
+{
+    if (not block.repn->created) block.repn->create_rows();
+    auto& rows = block.repn->rows;
+    repn->constraints.insert(repn->constraints.end(), rows.begin(), rows.end());
+}
+
+void Model::add(LinearConstraintBlock& block) { add_constraint(block); }
+
+}  // namespace coek
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifdef __has_include
+#    if __has_include(<version>)
+#        include <version>
+#    endif
+#endif
+#include <memory>
+#include <vector>
+
+#include "coek/api/constraint.hpp"
+
+namespace coek {
+
+class Variable;
+#if __cpp_lib_variant
+class ParameterArray;
+class VariableArray;
+#endif
+class LinearConstraintBlockRepn;
+
+/**
+ * A block of linear constraints
+ *
+ *      lower <= A x <= upper
+ *
+ * where the matrix A is stored in compressed sparse row (CSR) format over a list
+ * of variables.  The nonzeros in row i are values[row_start[i]] ...
+ * values[row_start[i+1]-1], and the variable of each nonzero is
+ * variables[col_index[k]].
+ *
+ * When the block is added to a model, each row is added as a constraint whose
+ * body refers to the shared CSR arrays.  Hence, the memory used by a row does not
+ * depend on its number of nonzeros, and the rows are processed by the model
+ * writers, solver interfaces and NLP back ends without creating an expression
+ * for each term.
+ *
+ * The row bounds are specified with vectors of values, or with parameter arrays
+ * that can be changed after the constraints are created.  Values that are at
+ * least COEK_INFINITY in magnitude are not included as bounds.  The bounds must
+ * be specified before the block is added to a model.
+ */
+class LinearConstraintBlock {
+   public:
+    std::shared_ptr<LinearConstraintBlockRepn> repn;
+
+   public:
+    /** Create a block of linear constraints
+     *
+     * \param variables  the variables that are referenced by the columns
+     * \param row_start  the start of each row in col_index and values, which has one
+     *                   more element than the number of rows
+     * \param col_index  the column of each nonzero
+     * \param values  the value of each nonzero
+     */
+    LinearConstraintBlock(const std::vector<Variable>& variables,
+                          const std::vector<size_t>& row_start,
+                          const std::vector<size_t>& col_index, const std::vector<double>& values);
+#if __cpp_lib_variant
+    /** Create a block of linear constraints over the variables in a variable array */
+    LinearConstraintBlock(VariableArray& variables, const std::vector<size_t>& row_start,
+                          const std::vector<size_t>& col_index, const std::vector<double>& values);
+#endif
+
+    /** \returns the number of rows */
+    size_t size() const;
+    /** \returns the number of nonzeros */
+    size_t num_nonzeros() const;
+
+    /** Set the lower bounds of the rows */
+    LinearConstraintBlock& lower(const std::vector<double>& values);
+    /** Set the upper bounds of the rows */
+    LinearConstraintBlock& upper(const std::vector<double>& values);
+    /** Set the right-hand side of equality constraints */
+    LinearConstraintBlock& equal(const std::vector<double>& values);
+#if __cpp_lib_variant
+    /** Set the lower bounds of the rows with a parameter array */
+    LinearConstraintBlock& lower(ParameterArray& values);
+    /** Set the upper bounds of the rows with a parameter array */
+    LinearConstraintBlock& upper(ParameterArray& values);
+    /** Set the right-hand side of equality constraints with a parameter array */
+    LinearConstraintBlock& equal(ParameterArray& values);
+#endif
+
+    /** \returns the constraint for the i-th row, which is created when the block is added to
+     * a model */
+    Constraint get_constraint(size_t i) const;
+};
+
+}  // namespace coek
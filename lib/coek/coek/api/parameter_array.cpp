@@ -3,6 +3,7 @@
 #include "coek/api/parameter_assoc_array_repn.hpp"
 #include "coek/model/model.hpp"
 #include "coek/model/model_repn.hpp"
+#include "coek/util/shift.hpp"
 
 namespace coek {
 
@@ -30,6 +31,11 @@ class ParameterArrayRepn : public ParameterAssocArrayRepn {
 
     size_t size() { return _size; }
 
+    void slices(size_t dimension, std::vector<size_t>& positions, std::vector<size_t>& start)
+    {
+        array_slices(shape, dimension, positions, start);
+    }
+
     std::string get_name(std::string name, size_t index);
 
     void generate_names();
@@ -151,6 +157,12 @@ ParameterArray& ParameterArray::value(const Expression& value)
     return *this;
 }
 
+ParameterArray& ParameterArray::shift(size_t dimension, int offset)
+{
+    repn->shift(dimension, offset);
+    return *this;
+}
+
 ParameterArray& ParameterArray::name(const std::string& name)
 {
     repn->name(name);
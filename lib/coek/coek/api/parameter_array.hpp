@@ -142,6 +142,9 @@ class ParameterArray : public ParameterAssocArray {
     ParameterArray& value(double value);
     /** Set the initial parameter value. \returns the parameter object. */
     ParameterArray& value(const Expression& value);
+    /** Shift the parameter values along an index dimension, so the value at index t is
+     * replaced by the value at index t+offset.  \returns the parameter object. */
+    ParameterArray& shift(size_t dimension, int offset = 1);
 
     /** Set the name of the parameter. \returns the parameter object */
     ParameterArray& name(const std::string& name);
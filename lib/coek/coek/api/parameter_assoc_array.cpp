@@ -4,6 +4,7 @@
 #include <variant>
 
 #include "coek/ast/compact_terms.hpp"
+#include "coek/util/shift.hpp"
 
 namespace coek {
 
@@ -48,6 +49,21 @@ void ParameterAssocArrayRepn::value(const Expression& value)
     }
 }
 
+void ParameterAssocArrayRepn::shift(size_t dimension, int offset)
+{
+    if (dimension >= dim())
+        throw std::runtime_error("Cannot shift the values of " + parameter_template.name()
+                                 + " along index dimension " + std::to_string(dimension)
+                                 + " because it has " + std::to_string(dim())
+                                 + " index dimensions");
+    setup();
+
+    std::vector<size_t> positions;
+    std::vector<size_t> start;
+    slices(dimension, positions, start);
+    shift_values(values, positions, start, offset);
+}
+
 void ParameterAssocArrayRepn::name(const std::string& name)
 {
     parameter_template.name(name);
@@ -32,12 +32,19 @@ class ParameterAssocArrayRepn {
     virtual size_t dim() = 0;
     virtual size_t size() = 0;
 
+    /** Group the positions of the values into slices along an index dimension. */
+    virtual void slices(size_t dimension, std::vector<size_t>& positions,
+                        std::vector<size_t>& start)
+        = 0;
+
     void resize_index_vectors(IndexVector& tmp, std::vector<refarg_types>& reftmp);
 
     /** Set the initial variable value. */
     void value(double value);
     /** Set the initial variable value. */
     void value(const Expression& value);
+    /** Shift the parameter values along an index dimension. */
+    void shift(size_t dimension, int offset);
 
     /** Set the name of the variable. */
     void name(const std::string& name);
@@ -4,6 +4,7 @@
 #include "coek/model/model.hpp"
 #include "coek/model/model_repn.hpp"
 #include "coek/api/variable_array.hpp"
+#include "coek/util/shift.hpp"
 
 namespace coek {
 
@@ -41,6 +42,11 @@ class VariableArrayRepn : public VariableAssocArrayRepn {
 
     size_t size() const { return _size; }
 
+    void slices(size_t dimension, std::vector<size_t>& positions, std::vector<size_t>& start)
+    {
+        array_slices(shape, dimension, positions, start);
+    }
+
     std::string get_name(std::string name, size_t index);
 
     void generate_names();
@@ -181,6 +187,12 @@ VariableArray& VariableArray::value(const Expression& value)
     return *this;
 }
 
+VariableArray& VariableArray::shift(size_t dimension, int offset)
+{
+    repn->shift(dimension, offset);
+    return *this;
+}
+
 VariableArray& VariableArray::lower(double value)
 {
     repn->lower(value);
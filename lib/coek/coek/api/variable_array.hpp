@@ -156,6 +156,9 @@ class VariableArray : public VariableAssocArray {
     VariableArray& value(double value);
     /** Set the initial variable value. \returns the variable object. */
     VariableArray& value(const Expression& value);
+    /** Shift the variable values along an index dimension, so the value at index t is
+     * replaced by the value at index t+offset.  \returns the variable object. */
+    VariableArray& shift(size_t dimension, int offset = 1);
 
     /** Set the lower bound. \returns the variable object. */
     VariableArray& lower(double value);
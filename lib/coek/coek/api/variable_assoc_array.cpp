@@ -4,6 +4,7 @@
 
 #include "coek/api/variable_assoc_array.hpp"
 #include "coek/ast/compact_terms.hpp"
+#include "coek/util/shift.hpp"
 
 namespace coek {
 
@@ -58,6 +59,21 @@ void VariableAssocArrayRepn::value(const Expression& value)
     }
 }
 
+void VariableAssocArrayRepn::shift(size_t dimension, int offset)
+{
+    if (dimension >= dim())
+        throw std::runtime_error("Cannot shift the values of " + variable_template.name()
+                                 + " along index dimension " + std::to_string(dimension)
+                                 + " because it has " + std::to_string(dim())
+                                 + " index dimensions");
+    setup();
+
+    std::vector<size_t> positions;
+    std::vector<size_t> start;
+    slices(dimension, positions, start);
+    shift_values(values, positions, start, offset);
+}
+
 void VariableAssocArrayRepn::lower(double value)
 {
     variable_template.lower(value);
@@ -32,12 +32,19 @@ class VariableAssocArrayRepn {
     virtual size_t dim() const = 0;
     virtual size_t size() const = 0;
 
+    /** Group the positions of the values into slices along an index dimension. */
+    virtual void slices(size_t dimension, std::vector<size_t>& positions,
+                        std::vector<size_t>& start)
+        = 0;
+
     void resize_index_vectors(IndexVector& tmp, std::vector<refarg_types>& reftmp);
 
     /** Set the initial variable value. \returns the variable object. */
     void value(double value);
     /** Set the initial variable value. \returns the variable object. */
     void value(const Expression& value);
+    /** Shift the variable values along an index dimension. */
+    void shift(size_t dimension, int offset);
 
     /** Set the lower bound. \returns the variable object. */
     void lower(double value);
@@ -146,6 +146,19 @@ VariableTerm::VariableTerm(const expr_pointer_t& _lb, const expr_pointer_t& _ub,
     index = count++;
 }
 
+VariableTerm::VariableTerm(unsigned int _index, const expr_pointer_t& _lb,
+                           const expr_pointer_t& _ub, const expr_pointer_t& _value, bool _binary,
+                           bool _integer)
+    : index(_index),
+      value(_value),
+      lb(_lb),
+      ub(_ub),
+      binary(_binary),
+      integer(_integer),
+      fixed(false)
+{
+}
+
 expr_pointer_t VariableTerm::const_mult(double coef, const expr_pointer_t& repn)
 {
     return std::make_shared<MonomialTerm>(coef, std::dynamic_pointer_cast<VariableTerm>(repn));
@@ -182,4 +195,15 @@ expr_pointer_t MonomialTerm::negate(const expr_pointer_t&)
     return std::make_shared<MonomialTerm>(-1 * coef, var);
 }
 
+//
+// LinearRowTerm
+//
+
+double LinearRowTerm::_eval() const
+{
+    double ans = 0.0;
+    for (size_t k = begin(); k < end(); k++) ans += coef(k) * var(k)->value->_eval();
+    return ans;
+}
+
 }  // namespace coek
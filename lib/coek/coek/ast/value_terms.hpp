@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "base_terms.hpp"
 
@@ -117,6 +118,10 @@ class VariableTerm : public BaseVariableTerm {
    public:
     VariableTerm(const expr_pointer_t& lb, const expr_pointer_t& ub, const expr_pointer_t& value,
                  bool _binary, bool _integer);
+    // Create a variable with a given index.  This does not change the count of variables, so
+    // it is used for temporary variables that are not declared in a model.
+    VariableTerm(unsigned int _index, const expr_pointer_t& lb, const expr_pointer_t& ub,
+                 const expr_pointer_t& value, bool _binary, bool _integer);
 
     double _eval() const { return value->_eval(); }
 
@@ -169,4 +174,45 @@ class MonomialTerm : public BaseExpressionTerm {
     term_id id() { return MonomialTerm_id; }
 };
 
+//
+// LinearRowTerm
+//
+
+// The coefficients of a block of linear constraints, which are stored in CSR format.
+// The nonzeros in row i are values[row_start[i]] ... values[row_start[i+1]-1], and
+// the variable of each nonzero is vars[col_index[k]].
+class LinearBlockData {
+   public:
+    std::vector<std::shared_ptr<VariableTerm>> vars;
+    std::vector<size_t> row_start;
+    std::vector<size_t> col_index;
+    std::vector<double> values;
+};
+
+// A row of a linear constraint block
+class LinearRowTerm : public BaseExpressionTerm {
+   public:
+    std::shared_ptr<LinearBlockData> block;
+    size_t row;
+
+   public:
+    LinearRowTerm(const std::shared_ptr<LinearBlockData>& _block, size_t _row)
+        : block(_block), row(_row)
+    {
+    }
+
+    double _eval() const;
+
+    size_t begin() const { return block->row_start[row]; }
+    size_t end() const { return block->row_start[row + 1]; }
+    double coef(size_t k) const { return block->values[k]; }
+    const std::shared_ptr<VariableTerm>& var(size_t k) const
+    {
+        return block->vars[block->col_index[k]];
+    }
+
+    void accept(Visitor& v) { v.visit(*this); }
+    term_id id() { return LinearRowTerm_id; }
+};
+
 }  // namespace coek
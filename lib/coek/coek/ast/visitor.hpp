@@ -22,6 +22,7 @@ class ConstantTerm;
 class ParameterTerm;
 class IndexParameterTerm;
 class MonomialTerm;
+class LinearRowTerm;
 class InequalityTerm;
 class EqualityTerm;
 class EmptyConstraintTerm;
@@ -66,6 +67,7 @@ class Visitor {
     virtual void visit(VariableRefTerm& arg) = 0;
 #endif
     virtual void visit(MonomialTerm& arg) = 0;
+    virtual void visit(LinearRowTerm& arg) = 0;
     virtual void visit(InequalityTerm& arg) = 0;
     virtual void visit(EqualityTerm& arg) = 0;
     virtual void visit(EmptyConstraintTerm&) {}
@@ -110,6 +112,7 @@ enum term_id : unsigned int {
     VariableRefTerm_id = 4,
     // IndexedVariableTerm_id = 101,
     MonomialTerm_id = 5,
+    LinearRowTerm_id = 108,
     InequalityTerm_id = 6,
     EqualityTerm_id = 7,
     EmptyConstraintTerm_id = 104,
@@ -91,6 +91,15 @@ double visit_MonomialTerm(const expr_pointer_t& expr, VariableData& data)
     return tmp->coef * visit_expression(tmp->var->value, data);
 }
 
+double visit_LinearRowTerm(const expr_pointer_t& expr, VariableData& data)
+{
+    auto tmp = safe_pointer_cast<LinearRowTerm>(expr);
+    double ans = 0.0;
+    for (size_t k = tmp->begin(); k < tmp->end(); k++)
+        ans += tmp->coef(k) * visit_expression(tmp->var(k)->value, data);
+    return ans;
+}
+
 // clang-format off
 FROM_BODY(InequalityTerm)
 FROM_BODY(EqualityTerm)
@@ -194,6 +203,7 @@ double visit_expression(const expr_pointer_t& expr, VariableData& data)
         VISIT_CASE(ParameterRefTerm);
 #endif
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
@@ -2,7 +2,9 @@
 
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "base_terms.hpp"
 
 namespace coek {
@@ -10,6 +12,7 @@ namespace coek {
 class VariableTerm;
 class ParameterTerm;
 class SubExpressionTerm;
+class Interval;
 
 void expr_to_list(BaseExpressionTerm* expr, std::list<std::string>& repr);
 inline void expr_to_list(const expr_pointer_t& expr, std::list<std::string>& repr)
@@ -34,6 +37,8 @@ double evaluate_expr_debug(const expr_pointer_t& expr,
 double evaluate_expr(const expr_pointer_t& expr,
                      std::map<std::shared_ptr<SubExpressionTerm>, double>& subexpr_value);
 double evaluate_expr(const expr_pointer_t& expr);
+
+Interval interval_expr(const expr_pointer_t& expr);
 double evaluate_expr(const BaseExpressionTerm* expr,
                      std::map<std::shared_ptr<SubExpressionTerm>, double>& subexpr_value);
 
@@ -64,6 +69,12 @@ void find_vars_and_params(const expr_pointer_t& expr,
 void find_variables(const expr_pointer_t& expr,
                     std::unordered_set<std::shared_ptr<VariableTerm>>& variables);
 
+// Count the references to each subexpression in expr.  Subexpressions are appended to order
+// when they are first visited, after the subexpressions that they contain.
+void count_subexpressions(const expr_pointer_t& expr,
+                          std::unordered_map<std::shared_ptr<SubExpressionTerm>, size_t>& count,
+                          std::vector<std::shared_ptr<SubExpressionTerm>>& order);
+
 expr_pointer_t simplify_expr(
     const expr_pointer_t& expr,
     std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t>& subexpr_value);
@@ -0,0 +1,256 @@
+#include <limits>
+
+#include "base_terms.hpp"
+#include "constraint_terms.hpp"
+#include "expr_terms.hpp"
+#include "value_terms.hpp"
+#include "visitor.hpp"
+#include "visitor_fns.hpp"
+#include "../api/constants.hpp"
+#include "../util/cast_utils.hpp"
+#include "../util/interval.hpp"
+#if __cpp_lib_variant
+#    include "compact_terms.hpp"
+#endif
+
+namespace coek {
+
+namespace {
+
+class IntervalData {
+   public:
+    std::map<std::shared_ptr<SubExpressionTerm>, Interval> subexpr_interval;
+};
+
+Interval visit_expression(const expr_pointer_t& expr, IntervalData& data);
+
+#define FROM_BODY(TERM)                                                     \
+    Interval visit_##TERM(const expr_pointer_t& expr, IntervalData& data) \
+    {                                                                       \
+        auto tmp = safe_pointer_cast<TERM>(expr);                           \
+        return visit_expression(tmp->body, data);                           \
+    }
+
+#define FROM_BODY_FN(TERM, FN)                                              \
+    Interval visit_##TERM(const expr_pointer_t& expr, IntervalData& data) \
+    {                                                                       \
+        auto tmp = safe_pointer_cast<TERM>(expr);                           \
+        return FN(visit_expression(tmp->body, data));                       \
+    }
+
+// Variable bounds of +/- COEK_INFINITY are treated as infinite
+Interval variable_interval(const VariableTerm& var)
+{
+    if (var.fixed) return Interval(var.value->eval());
+    double lb = var.lb->eval();
+    double ub = var.ub->eval();
+    if (lb <= -COEK_INFINITY) lb = -std::numeric_limits<double>::infinity();
+    if (ub >= COEK_INFINITY) ub = std::numeric_limits<double>::infinity();
+    return Interval(lb, ub);
+}
+
+// -----------------------------------------------------------------------------------------
+
+Interval visit_ConstantTerm(const expr_pointer_t& expr, IntervalData& /*data*/)
+{
+    auto tmp = safe_pointer_cast<ConstantTerm>(expr);
+    return Interval(tmp->value);
+}
+
+Interval visit_ParameterTerm(const expr_pointer_t& expr, IntervalData& /*data*/)
+{
+    auto tmp = safe_pointer_cast<ParameterTerm>(expr);
+    return Interval(tmp->eval());
+}
+
+Interval visit_IndexParameterTerm(const expr_pointer_t& expr, IntervalData& /*data*/)
+{
+    auto tmp = safe_pointer_cast<IndexParameterTerm>(expr);
+    return Interval(tmp->as_double_value());
+}
+
+Interval visit_VariableTerm(const expr_pointer_t& expr, IntervalData& /*data*/)
+{
+    auto tmp = safe_pointer_cast<VariableTerm>(expr);
+    return variable_interval(*tmp);
+}
+
+#ifdef COEK_WITH_COMPACT_MODEL
+Interval visit_ParameterRefTerm(const expr_pointer_t& /*expr*/, IntervalData& /*data*/)
+{
+    throw std::runtime_error(
+        "Cannot compute the interval of an expression that contains a ParameterRefTerm. This is "
+        "an abstract expression!");
+}
+
+Interval visit_VariableRefTerm(const expr_pointer_t& /*expr*/, IntervalData& /*data*/)
+{
+    throw std::runtime_error(
+        "Cannot compute the interval of an expression that contains a VariableRefTerm. This is "
+        "an abstract expression!");
+}
+#endif
+
+Interval visit_MonomialTerm(const expr_pointer_t& expr, IntervalData& /*data*/)
+{
+    auto tmp = safe_pointer_cast<MonomialTerm>(expr);
+    return Interval(tmp->coef) * variable_interval(*tmp->var);
+}
+
+Interval visit_LinearRowTerm(const expr_pointer_t& expr, IntervalData& /*data*/)
+{
+    auto tmp = safe_pointer_cast<LinearRowTerm>(expr);
+    Interval value(0.0);
+    for (size_t k = tmp->begin(); k < tmp->end(); k++)
+        value = value + Interval(tmp->coef(k)) * variable_interval(*tmp->var(k));
+    return value;
+}
+
+// clang-format off
+FROM_BODY(InequalityTerm)
+FROM_BODY(EqualityTerm)
+FROM_BODY(ObjectiveTerm)
+// clang-format on
+
+Interval visit_NegateTerm(const expr_pointer_t& expr, IntervalData& data)
+{
+    auto tmp = safe_pointer_cast<NegateTerm>(expr);
+    return -visit_expression(tmp->body, data);
+}
+
+Interval visit_SubExpressionTerm(const expr_pointer_t& expr, IntervalData& data)
+{
+    auto tmp = safe_pointer_cast<SubExpressionTerm>(expr);
+    auto it = data.subexpr_interval.find(tmp);
+    if (it == data.subexpr_interval.end()) {
+        Interval value = visit_expression(tmp->body, data);
+        data.subexpr_interval[tmp] = value;
+        return value;
+    }
+    else
+        return it->second;
+}
+
+Interval visit_PlusTerm(const expr_pointer_t& expr, IntervalData& data)
+{
+    auto tmp = safe_pointer_cast<PlusTerm>(expr);
+    auto& vec = *(tmp->data);
+    auto n = tmp->num_expressions();
+    Interval value(0.0);
+    for (size_t i = 0; i < n; i++) value = value + visit_expression(vec[i], data);
+    return value;
+}
+
+Interval visit_TimesTerm(const expr_pointer_t& expr, IntervalData& data)
+{
+    auto tmp = safe_pointer_cast<TimesTerm>(expr);
+    auto lhs = visit_expression(tmp->lhs, data);
+    auto rhs = visit_expression(tmp->rhs, data);
+    // The same expression is multiplied by itself
+    if ((tmp->lhs == tmp->rhs) and not lhs.empty())
+        return pow(lhs, Interval(2.0));
+    return lhs * rhs;
+}
+
+Interval visit_DivideTerm(const expr_pointer_t& expr, IntervalData& data)
+{
+    auto tmp = safe_pointer_cast<DivideTerm>(expr);
+    return visit_expression(tmp->lhs, data) / visit_expression(tmp->rhs, data);
+}
+
+// clang-format off
+FROM_BODY_FN(AbsTerm, abs)
+FROM_BODY_FN(CeilTerm, ceil)
+FROM_BODY_FN(FloorTerm, floor)
+FROM_BODY_FN(ExpTerm, exp)
+FROM_BODY_FN(LogTerm, log)
+FROM_BODY_FN(Log10Term, log10)
+FROM_BODY_FN(SqrtTerm, sqrt)
+FROM_BODY_FN(SinTerm, sin)
+FROM_BODY_FN(CosTerm, cos)
+FROM_BODY_FN(TanTerm, tan)
+FROM_BODY_FN(SinhTerm, sinh)
+FROM_BODY_FN(CoshTerm, cosh)
+FROM_BODY_FN(TanhTerm, tanh)
+FROM_BODY_FN(ASinTerm, asin)
+FROM_BODY_FN(ACosTerm, acos)
+FROM_BODY_FN(ATanTerm, atan)
+FROM_BODY_FN(ASinhTerm, asinh)
+FROM_BODY_FN(ACoshTerm, acosh)
+FROM_BODY_FN(ATanhTerm, atanh)
+// clang-format on
+
+Interval visit_PowTerm(const expr_pointer_t& expr, IntervalData& data)
+{
+    auto tmp = safe_pointer_cast<PowTerm>(expr);
+    return pow(visit_expression(tmp->lhs, data), visit_expression(tmp->rhs, data));
+}
+
+#define VISIT_CASE(TERM) \
+    case TERM##_id:      \
+        return visit_##TERM(expr, data);
+
+Interval visit_expression(const expr_pointer_t& expr, IntervalData& data)
+{
+    switch (expr->id()) {
+        VISIT_CASE(ConstantTerm);
+        VISIT_CASE(ParameterTerm);
+        VISIT_CASE(IndexParameterTerm);
+        VISIT_CASE(VariableTerm);
+#ifdef COEK_WITH_COMPACT_MODEL
+        VISIT_CASE(VariableRefTerm);
+        VISIT_CASE(ParameterRefTerm);
+#endif
+        VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
+        VISIT_CASE(InequalityTerm);
+        VISIT_CASE(EqualityTerm);
+        VISIT_CASE(ObjectiveTerm);
+        VISIT_CASE(SubExpressionTerm);
+        VISIT_CASE(NegateTerm);
+        VISIT_CASE(PlusTerm);
+        VISIT_CASE(TimesTerm);
+        VISIT_CASE(DivideTerm);
+        VISIT_CASE(AbsTerm);
+        VISIT_CASE(CeilTerm);
+        VISIT_CASE(FloorTerm);
+        VISIT_CASE(ExpTerm);
+        VISIT_CASE(LogTerm);
+        VISIT_CASE(Log10Term);
+        VISIT_CASE(SqrtTerm);
+        VISIT_CASE(SinTerm);
+        VISIT_CASE(CosTerm);
+        VISIT_CASE(TanTerm);
+        VISIT_CASE(SinhTerm);
+        VISIT_CASE(CoshTerm);
+        VISIT_CASE(TanhTerm);
+        VISIT_CASE(ASinTerm);
+        VISIT_CASE(ACosTerm);
+        VISIT_CASE(ATanTerm);
+        VISIT_CASE(ASinhTerm);
+        VISIT_CASE(ACoshTerm);
+        VISIT_CASE(ATanhTerm);
+        VISIT_CASE(PowTerm);
+
+        // GCOVR_EXCL_START
+        default:
+            throw std::runtime_error(
+                "Error in interval_expr visitor!  Visiting unexpected expression term "
+                + std::to_string(expr->id()));
+            // GCOVR_EXCL_STOP
+    };
+}
+
+}  // namespace
+
+Interval interval_expr(const expr_pointer_t& expr)
+{
+    // GCOVR_EXCL_START
+    if (not expr) return Interval(0.0);
+    // GCOVR_EXCL_STOP
+
+    IntervalData data;
+    return visit_expression(expr, data);
+}
+
+}  // namespace coek
@@ -81,6 +81,13 @@ void visit_MonomialTerm(const expr_pointer_t& expr, MutableValuesData& data)
     if (tmp->var->fixed) data.fixed_vars.insert(tmp->var);
 }
 
+void visit_LinearRowTerm(const expr_pointer_t& expr, MutableValuesData& data)
+{
+    auto tmp = safe_pointer_cast<LinearRowTerm>(expr);
+    for (size_t k = tmp->begin(); k < tmp->end(); k++)
+        if (tmp->var(k)->fixed) data.fixed_vars.insert(tmp->var(k));
+}
+
 // clang-format off
 FROM_BODY(InequalityTerm)
 FROM_BODY(EqualityTerm)
@@ -149,6 +156,7 @@ void visit_expression(const expr_pointer_t& expr, MutableValuesData& data)
         VISIT_CASE(ParameterRefTerm);
 #endif
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
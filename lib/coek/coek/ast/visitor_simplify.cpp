@@ -106,6 +106,20 @@ void visit_MonomialTerm(const expr_pointer_t& expr, VisitorData& data)
     }
 }
 
+void visit_LinearRowTerm(const expr_pointer_t& expr, VisitorData& data)
+{
+    auto tmp = safe_pointer_cast<LinearRowTerm>(expr);
+    for (size_t k = tmp->begin(); k < tmp->end(); k++) {
+        if (not tmp->var(k)->fixed) {
+            data.last_expr = expr;
+            data.is_value = false;
+            return;
+        }
+    }
+    data.last_value = tmp->_eval();
+    data.is_value = true;
+}
+
 void visit_ObjectiveTerm(const expr_pointer_t& expr, VisitorData& data)
 {
     auto tmp = safe_pointer_cast<ObjectiveTerm>(expr);
@@ -368,6 +382,7 @@ void visit_expression(const expr_pointer_t& expr, VisitorData& data)
         VISIT_CASE(ParameterRefTerm);
 #endif
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
@@ -0,0 +1,199 @@
+#include <unordered_map>
+#include <vector>
+
+#include "base_terms.hpp"
+#include "constraint_terms.hpp"
+#include "expr_terms.hpp"
+#include "value_terms.hpp"
+#include "visitor.hpp"
+#include "visitor_fns.hpp"
+#include "../util/cast_utils.hpp"
+#if __cpp_lib_variant
+#    include "compact_terms.hpp"
+#endif
+
+namespace coek {
+
+namespace {
+
+class SubExpressionData {
+   public:
+    std::unordered_map<std::shared_ptr<SubExpressionTerm>, size_t>& count;
+    std::vector<std::shared_ptr<SubExpressionTerm>>& order;
+
+    SubExpressionData(std::unordered_map<std::shared_ptr<SubExpressionTerm>, size_t>& _count,
+                      std::vector<std::shared_ptr<SubExpressionTerm>>& _order)
+        : count(_count), order(_order)
+    {
+    }
+};
+
+void visit_expression(const expr_pointer_t& expr, SubExpressionData& data);
+
+#define FROM_BODY(TERM)                                                    \
+    void visit_##TERM(const expr_pointer_t& expr, SubExpressionData& data) \
+    {                                                                      \
+        auto tmp = safe_pointer_cast<TERM>(expr);                          \
+        visit_expression(tmp->body, data);                                 \
+    }
+
+#define FROM_LHS_RHS(TERM)                                                 \
+    void visit_##TERM(const expr_pointer_t& expr, SubExpressionData& data) \
+    {                                                                      \
+        auto tmp = safe_pointer_cast<TERM>(expr);                          \
+        visit_expression(tmp->lhs, data);                                  \
+        visit_expression(tmp->rhs, data);                                  \
+    }
+
+#define IGNORE(TERM)                                                                    \
+    void visit_##TERM(const expr_pointer_t& /*expr*/, SubExpressionData& /*data*/) {}
+
+// -----------------------------------------------------------------------------------------
+
+// clang-format off
+IGNORE(ConstantTerm)
+IGNORE(ParameterTerm)
+IGNORE(IndexParameterTerm)
+IGNORE(VariableTerm)
+IGNORE(MonomialTerm)
+IGNORE(LinearRowTerm)
+// clang-format on
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void visit_ParameterRefTerm(const expr_pointer_t& /*expr*/, SubExpressionData& /*data*/)
+{
+    throw std::runtime_error("Attempting to find subexpressions in an abstract expression!");
+}
+
+void visit_VariableRefTerm(const expr_pointer_t& /*expr*/, SubExpressionData& /*data*/)
+{
+    throw std::runtime_error("Attempting to find subexpressions in an abstract expression!");
+}
+#endif
+
+// clang-format off
+FROM_BODY(InequalityTerm)
+FROM_BODY(EqualityTerm)
+FROM_BODY(ObjectiveTerm)
+FROM_BODY(NegateTerm)
+// clang-format on
+
+void visit_SubExpressionTerm(const expr_pointer_t& expr, SubExpressionData& data)
+{
+    auto tmp = safe_pointer_cast<SubExpressionTerm>(expr);
+    auto it = data.count.find(tmp);
+    if (it == data.count.end()) {
+        data.count[tmp] = 1;
+        visit_expression(tmp->body, data);
+        data.order.push_back(tmp);
+    }
+    else
+        it->second++;
+}
+
+void visit_PlusTerm(const expr_pointer_t& expr, SubExpressionData& data)
+{
+    auto tmp = safe_pointer_cast<PlusTerm>(expr);
+    auto& vec = *(tmp->data);
+    auto n = tmp->num_expressions();
+    for (size_t i = 0; i < n; i++) visit_expression(vec[i], data);
+}
+
+// clang-format off
+FROM_LHS_RHS(TimesTerm)
+FROM_LHS_RHS(DivideTerm)
+
+FROM_BODY(AbsTerm)
+FROM_BODY(CeilTerm)
+FROM_BODY(FloorTerm)
+FROM_BODY(ExpTerm)
+FROM_BODY(LogTerm)
+FROM_BODY(Log10Term)
+FROM_BODY(SqrtTerm)
+FROM_BODY(SinTerm)
+FROM_BODY(CosTerm)
+FROM_BODY(TanTerm)
+FROM_BODY(SinhTerm)
+FROM_BODY(CoshTerm)
+FROM_BODY(TanhTerm)
+FROM_BODY(ASinTerm)
+FROM_BODY(ACosTerm)
+FROM_BODY(ATanTerm)
+FROM_BODY(ASinhTerm)
+FROM_BODY(ACoshTerm)
+FROM_BODY(ATanhTerm)
+
+FROM_LHS_RHS(PowTerm)
+// clang-format on
+
+#define VISIT_CASE(TERM)          \
+    case TERM##_id:               \
+        visit_##TERM(expr, data); \
+        break
+
+void visit_expression(const expr_pointer_t& expr, SubExpressionData& data)
+{
+    switch (expr->id()) {
+        VISIT_CASE(ConstantTerm);
+        VISIT_CASE(ParameterTerm);
+        VISIT_CASE(IndexParameterTerm);
+        VISIT_CASE(VariableTerm);
+#ifdef COEK_WITH_COMPACT_MODEL
+        VISIT_CASE(VariableRefTerm);
+        VISIT_CASE(ParameterRefTerm);
+#endif
+        VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
+        VISIT_CASE(InequalityTerm);
+        VISIT_CASE(EqualityTerm);
+        VISIT_CASE(ObjectiveTerm);
+        VISIT_CASE(SubExpressionTerm);
+        VISIT_CASE(NegateTerm);
+        VISIT_CASE(PlusTerm);
+        VISIT_CASE(TimesTerm);
+        VISIT_CASE(DivideTerm);
+        VISIT_CASE(AbsTerm);
+        VISIT_CASE(CeilTerm);
+        VISIT_CASE(FloorTerm);
+        VISIT_CASE(ExpTerm);
+        VISIT_CASE(LogTerm);
+        VISIT_CASE(Log10Term);
+        VISIT_CASE(SqrtTerm);
+        VISIT_CASE(SinTerm);
+        VISIT_CASE(CosTerm);
+        VISIT_CASE(TanTerm);
+        VISIT_CASE(SinhTerm);
+        VISIT_CASE(CoshTerm);
+        VISIT_CASE(TanhTerm);
+        VISIT_CASE(ASinTerm);
+        VISIT_CASE(ACosTerm);
+        VISIT_CASE(ATanTerm);
+        VISIT_CASE(ASinhTerm);
+        VISIT_CASE(ACoshTerm);
+        VISIT_CASE(ATanhTerm);
+        VISIT_CASE(PowTerm);
+
+        // GCOVR_EXCL_START
+        default:
+            throw std::runtime_error(
+                "Error in count_subexpressions visitor!  Visiting unexpected expression term "
+                + std::to_string(expr->id()));
+            // GCOVR_EXCL_STOP
+    };
+}
+
+}  // namespace
+
+void count_subexpressions(const expr_pointer_t& expr,
+                          std::unordered_map<std::shared_ptr<SubExpressionTerm>, size_t>& count,
+                          std::vector<std::shared_ptr<SubExpressionTerm>>& order)
+{
+    // GCOVR_EXCL_START
+    if (not expr) return;
+    // GCOVR_EXCL_STOP
+
+    SubExpressionData data(count, order);
+    visit_expression(expr, data);
+}
+
+}  // namespace coek
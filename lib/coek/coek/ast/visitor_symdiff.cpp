@@ -329,6 +329,31 @@ typedef std::set<std::shared_ptr<VariableTerm>, bool (*)(const std::shared_ptr<V
     ordered_variableset_t;
 typedef ordered_variableset_t::iterator ordered_variableset_iterator_t;
 
+//
+// A linear row object contains variables, but its a leaf.  Hence, we need to
+// explicitly add the partial[] values of its variables.
+//
+void add_linear_row_partials(const std::shared_ptr<LinearRowTerm>& row,
+                             const expr_pointer_t& row_partial,
+                             std::map<expr_pointer_t, expr_pointer_t>& partial)
+{
+    for (size_t k = row->begin(); k < row->end(); k++) {
+        expr_pointer_t var = row->var(k);
+        expr_pointer_t term;
+        if (row_partial->is_constant()) {
+            auto _rhs = std::dynamic_pointer_cast<ConstantTerm>(row_partial);
+            term = CREATE_POINTER(ConstantTerm, row->coef(k) * _rhs->value);
+        }
+        else
+            term = times_(CREATE_POINTER(ConstantTerm, row->coef(k)), row_partial);
+        auto it = partial.find(var);
+        if (it == partial.end())
+            partial[var] = term;
+        else
+            it->second = plus_(it->second, term);
+    }
+}
+
 }  // namespace
 
 void symbolic_diff_all(const expr_pointer_t& root,
@@ -352,6 +377,15 @@ void symbolic_diff_all(const expr_pointer_t& root,
         return;
     }
 
+    else if (root->id() == LinearRowTerm_id) {
+        auto tmp = std::dynamic_pointer_cast<LinearRowTerm>(root);
+        std::map<std::shared_ptr<VariableTerm>, double> coefs;
+        for (size_t k = tmp->begin(); k < tmp->end(); k++)
+            if (!tmp->var(k)->fixed) coefs[tmp->var(k)] += tmp->coef(k);
+        for (auto& it : coefs) diff[it.first] = CREATE_POINTER(ConstantTerm, it.second);
+        return;
+    }
+
     //
     // Use a topological sort
     //
@@ -392,6 +426,11 @@ void symbolic_diff_all(const expr_pointer_t& root,
                     auto tmp = std::dynamic_pointer_cast<MonomialTerm>(child);
                     variables.insert(tmp->var);
                 }
+                else if (child->id() == LinearRowTerm_id) {
+                    auto tmp = std::dynamic_pointer_cast<LinearRowTerm>(child);
+                    for (size_t k = tmp->begin(); k < tmp->end(); k++)
+                        variables.insert(tmp->var(k));
+                }
             }
         }
     }
@@ -501,6 +540,11 @@ void symbolic_diff_all(const expr_pointer_t& root,
                                 times_(CREATE_POINTER(ConstantTerm, tmp->coef), partial[child]));
                     }
                 }
+                else if (child->id() == LinearRowTerm_id) {
+                    auto tmp = std::dynamic_pointer_cast<LinearRowTerm>(child);
+                    // Only the partial for this parent is added to the variables
+                    add_linear_row_partials(tmp, times_(partial[curr], _partial), partial);
+                }
 
 #ifdef DEBUG_DIFF
                 std::cout << "PARTIAL" << std::endl << std::flush;
@@ -126,6 +126,22 @@ void visit(std::shared_ptr<MonomialTerm>& expr, MutableNLPExpr& repn, double mul
     }
 }
 
+void visit(std::shared_ptr<LinearRowTerm>& expr, MutableNLPExpr& repn, double multiplier)
+{
+    for (size_t k = expr->begin(); k < expr->end(); k++) {
+        auto& var = expr->var(k);
+        auto coef = CREATE_POINTER(ConstantTerm, multiplier * expr->coef(k));
+        if (var->fixed) {
+            repn.constval = plus_(repn.constval, times(coef, var));
+            repn.mutable_values = true;
+        }
+        else {
+            repn.linear_vars.push_back(var);
+            repn.linear_coefs.push_back(coef);
+        }
+    }
+}
+
 void visit(std::shared_ptr<InequalityTerm>& expr, MutableNLPExpr& repn, double multiplier)
 {
     visit_expression(expr->body, repn, multiplier);
@@ -405,6 +421,7 @@ void visit_expression(const expr_pointer_t& expr, MutableNLPExpr& repn, double m
         VISIT_CASE(VariableRefTerm);
 #endif
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
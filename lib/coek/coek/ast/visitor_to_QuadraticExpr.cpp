@@ -94,6 +94,20 @@ void visit(std::shared_ptr<MonomialTerm>& expr, QuadraticExpr& repn, double mult
     }
 }
 
+void visit(std::shared_ptr<LinearRowTerm>& expr, QuadraticExpr& repn, double multiplier)
+{
+    for (size_t k = expr->begin(); k < expr->end(); k++) {
+        auto& var = expr->var(k);
+        if (var->fixed) {
+            repn.constval += multiplier * expr->coef(k) * var->value->eval();
+        }
+        else {
+            repn.linear_vars.push_back(var);
+            repn.linear_coefs.push_back(multiplier * expr->coef(k));
+        }
+    }
+}
+
 void visit(std::shared_ptr<InequalityTerm>& expr, QuadraticExpr& repn, double multiplier)
 {
     visit_expression(expr->body, repn, multiplier);
@@ -348,6 +362,7 @@ void visit_expression(const expr_pointer_t& expr, QuadraticExpr& repn, double mu
         VISIT_CASE(VariableRefTerm);
 #endif
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
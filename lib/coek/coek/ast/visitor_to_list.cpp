@@ -30,6 +30,7 @@ class ToListVisitor : public Visitor {
     void visit(VariableRefTerm& arg);
 #endif
     void visit(MonomialTerm& arg);
+    void visit(LinearRowTerm& arg);
     void visit(InequalityTerm& arg);
     void visit(EqualityTerm& arg);
     void visit(ObjectiveTerm& arg);
@@ -129,6 +130,22 @@ void ToListVisitor::visit(MonomialTerm& arg)
     repr.push_back("]");
 }
 
+void ToListVisitor::visit(LinearRowTerm& arg)
+{
+    repr.push_back("[");
+    repr.push_back("+");
+    for (size_t k = arg.begin(); k < arg.end(); k++) {
+        repr.push_back("[");
+        repr.push_back("*");
+        std::stringstream sstr;
+        sstr << arg.coef(k);
+        repr.push_back(sstr.str());
+        arg.var(k)->accept(*this);
+        repr.push_back("]");
+    }
+    repr.push_back("]");
+}
+
 void ToListVisitor::visit(InequalityTerm& arg)
 {
     repr.push_back("[");
@@ -95,6 +95,18 @@ void visit_MonomialTerm(const expr_pointer_t& expr, VariableData& data)
         data.vars.insert(tmp->var);
 }
 
+void visit_LinearRowTerm(const expr_pointer_t& expr, VariableData& data)
+{
+    auto tmp = safe_pointer_cast<LinearRowTerm>(expr);
+    for (size_t k = tmp->begin(); k < tmp->end(); k++) {
+        auto& var = tmp->var(k);
+        if (var->fixed)
+            data.fixed_vars.insert(var);
+        else
+            data.vars.insert(var);
+    }
+}
+
 // clang-format off
 FROM_BODY(InequalityTerm)
 FROM_BODY(EqualityTerm)
@@ -163,6 +175,7 @@ void visit_expression(const expr_pointer_t& expr, VariableData& data)
         VISIT_CASE(ParameterRefTerm);
 #endif
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
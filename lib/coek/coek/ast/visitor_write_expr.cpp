@@ -28,6 +28,7 @@ class WriteExprVisitor : public Visitor {
     void visit(VariableRefTerm& arg);
 #endif
     void visit(MonomialTerm& arg);
+    void visit(LinearRowTerm& arg);
     void visit(InequalityTerm& arg);
     void visit(EqualityTerm& arg);
     void visit(ObjectiveTerm& arg);
@@ -137,6 +138,19 @@ void WriteExprVisitor::visit(MonomialTerm& arg)
     arg.var->accept(*this);
 }
 
+void WriteExprVisitor::visit(LinearRowTerm& arg)
+{
+    if (arg.begin() == arg.end()) {
+        ostr << 0;
+        return;
+    }
+    for (size_t k = arg.begin(); k < arg.end(); k++) {
+        if (k > arg.begin()) ostr << " + ";
+        if (!(arg.coef(k) == 1.0)) ostr << arg.coef(k) << "*";
+        arg.var(k)->accept(*this);
+    }
+}
+
 void WriteExprVisitor::visit(InequalityTerm& arg)
 {
     if (arg.lower) {
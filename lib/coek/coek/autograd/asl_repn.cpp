@@ -1,8 +1,13 @@
-#include <cstdio>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <unordered_map>
 
+#include "coek/util/parallel.hpp"
 #include "coek/util/sequence.hpp"
 #include "coek/autograd/asl_repn.hpp"
 #include "coek/ast/value_terms.hpp"
@@ -21,6 +26,65 @@ namespace coek {
 void write_nl_problem(Model& model, const std::string& fname, std::map<size_t, size_t>& invvarmap,
                       std::map<size_t, size_t>& invconmap);
 
+namespace {
+
+//
+// Unless the ASL is built with MULTIPLE_THREADS, its evaluation routines use the
+// global cur_ASL pointer, so separate ASL instances cannot be evaluated
+// concurrently.
+//
+#ifdef MULTIPLE_THREADS
+const bool asl_thread_safe = true;
+#else
+const bool asl_thread_safe = false;
+#endif
+
+//
+// The directories where the NL file that is used to hand the model to the ASL
+// is written.  The ASL only reads NL files by name, so a memory-backed
+// filesystem is tried first.  This avoids disk I/O and contention on shared
+// scratch filesystems.
+//
+std::vector<std::string> nl_handoff_dirs()
+{
+    std::vector<std::string> dirs{"/dev/shm"};
+    const char* tmpdir = std::getenv("TMPDIR");
+    if (tmpdir and (tmpdir[0] != 0)) dirs.push_back(tmpdir);
+    dirs.push_back("/tmp");
+    return dirs;
+}
+
+//
+// Create an empty NL file in a directory.  Returns false if the file cannot be
+// created.
+//
+bool create_nl_handoff_file(const std::string& dir, std::string& fname)
+{
+    fname = dir + "/coek_XXXXXX.nl";
+    int fd = mkstemps(&fname[0], 3);
+    if (fd < 0) return false;
+    close(fd);
+    return true;
+}
+
+void free_asl_struct(ASL_pfgh* asl)
+{
+    if (X0) {
+        delete[] X0;
+        X0 = 0;
+    }
+
+    if (havex0) {
+        delete[] havex0;
+        havex0 = 0;
+    }
+
+    ASL* asl_to_free = (ASL*)asl;
+    ASL_free(&asl_to_free);
+}
+
+}  // namespace
+
 VariableRepn ASL_Repn::get_variable(size_t i) { return used_variables[varmap[i]]; }
 
 ASL_Repn::ASL_Repn(Model& model) : NLPModelRepn(model)
@@ -30,6 +94,7 @@ ASL_Repn::ASL_Repn(Model& model) : NLPModelRepn(model)
     nc = 0;
     objval_called_with_current_x_ = false;
     conval_called_with_current_x_ = false;
+    asl_conval_current_ = false;
     asl_ = 0;
     nnz_jac_g = 0;
     nnz_lag_h = 0;
@@ -57,15 +122,16 @@ size_t ASL_Repn::num_nonzeros_Jacobian() const { return nnz_jac_g; }
 
 size_t ASL_Repn::num_nonzeros_Hessian_Lagrangian() const { return nnz_lag_h; }
 
-void ASL_Repn::set_variables(std::vector<double>& x) { set_variables(&(x[0]), x.size()); }
+void ASL_Repn::set_variables(std::vector<double>& x) { set_variables(x.data(), x.size()); }
 
 void ASL_Repn::set_variables(const double* x, size_t n)
 {
     assert(n == currx.size());
-    for (size_t i = 0; i < n; i++) currx[i] = x[i];
+    std::copy(x, x + n, currx.begin());
 
     objval_called_with_current_x_ = false;
     conval_called_with_current_x_ = false;
+    asl_conval_current_ = false;
 }
 
 void ASL_Repn::get_J_nonzeros(std::vector<size_t>& jrow, std::vector<size_t>& jcol)
@@ -138,55 +204,70 @@ double ASL_Repn::compute_f(size_t i)
     return f_cache;
 }
 
-void ASL_Repn::compute_df(double& f, std::vector<double>& df, size_t i)
+void ASL_Repn::compute_df(double& f, double* df, size_t i)
 {
-    assert(df.size() == nx);
-
     if (nf == 0) {
         f = 0.0;
-        for (double& df_x : df) df_x = 0.0;
+        std::fill(df, df + nx, 0.0);
     }
     else {
         f = compute_f(i);
 
         ASL_pfgh* asl = asl_;
-        objgrd(static_cast<int>(i), &(currx[0]), &(df[0]), (fint*)nerror_);
+        objgrd(static_cast<int>(i), currx.data(), df, (fint*)nerror_);
         nerror_ok = check_asl_status(nerror_);
     }
 }
 
-void ASL_Repn::compute_c(std::vector<double>& c)
+void ASL_Repn::compute_c(double* c)
 {
-    assert(c.size() == nc);
-
     if (not conval_called_with_current_x_) {
-        ASL_pfgh* asl = asl_;
-        conval(&(currx[0]), &(c_cache[0]), (fint*)nerror_);
-        nerror_ok = check_asl_status(nerror_);
+        nerror_ok = block_asl_.size() > 0 ? compute_c_blocks() : compute_c_serial();
         if (nerror_ok)
             conval_called_with_current_x_ = true;
         else {
             conval_called_with_current_x_ = false;
-            for (size_t i : coek::range(nc)) c[i] = nan("");
+            std::fill(c, c + nc, nan(""));
             return;
         }
     }
-    for (size_t i : coek::range(nc)) c[i] = c_cache[i];
+    if (c != c_cache.data()) std::copy(c_cache.begin(), c_cache.end(), c);
+}
+
+bool ASL_Repn::compute_c_serial()
+{
+    ASL_pfgh* asl = asl_;
+    conval(currx.data(), c_cache.data(), (fint*)nerror_);
+    asl_conval_current_ = check_asl_status(nerror_);
+    return asl_conval_current_;
 }
 
-void ASL_Repn::compute_dc(std::vector<double>& dc, size_t i)
+bool ASL_Repn::compute_c_blocks()
 {
-    assert(dc.size() == nx);
+    size_t nblocks = block_start_.size() - 1;
+    std::vector<fint> nerror(nblocks, 0);
+    parallel_for(nblocks, nblocks, [&](size_t k, size_t) {
+        ASL_pfgh* asl = block_asl(k);
+        for (size_t i = block_start_[k]; i < block_start_[k + 1]; i++) {
+            c_cache[i] = conival(static_cast<int>(i), currx.data(), &nerror[k]);
+            if (nerror[k] != 0) break;
+        }
+    });
 
+    bool ok = true;
+    for (auto& err : nerror) ok = check_asl_status(&err) and ok;
+    return ok;
+}
+
+void ASL_Repn::compute_dc(double* dc, size_t i)
+{
     ASL_pfgh* asl = asl_;
-    congrd(i, &(currx[0]), &(dc[0]), (fint*)nerror_);
+    congrd(static_cast<int>(i), currx.data(), dc, (fint*)nerror_);
     nerror_ok = check_asl_status(nerror_);
-    if (not nerror_ok) {
-        for (size_t j : coek::indices(dc)) dc[j] = nan("");
-    }
+    if (not nerror_ok) std::fill(dc, dc + nx, nan(""));
 }
 
-void ASL_Repn::compute_H(std::vector<double>& w, std::vector<double>& H)
+void ASL_Repn::compute_H(const double* fw, const double* cw, double* H)
 {
     ASL_pfgh* asl = asl_;
 
@@ -194,18 +275,84 @@ void ASL_Repn::compute_H(std::vector<double>& w, std::vector<double>& H)
         f_cache = compute_f(0);  // TODO - Extend API for multiple objectives
     }
     if (!conval_called_with_current_x_) {
-        compute_c(c_cache);
+        compute_c(c_cache.data());
     }
-    sphes(&(H[0]), -1, &(w[0]), &(w[nf]));
+    // The Hessian is computed with asl_, which needs the constraint values at
+    // the current point
+    if (!asl_conval_current_) {
+        compute_c_serial();
+    }
+    // The ASL does not modify the weight arrays
+    sphes(H, -1, const_cast<double*>(fw), const_cast<double*>(cw));
 }
 
-void ASL_Repn::compute_J(std::vector<double>& J)
+void ASL_Repn::compute_J(double* J)
 {
-    ASL_pfgh* asl = asl_;
+    if (block_asl_.size() == 0) {
+        ASL_pfgh* asl = asl_;
 
-    jacval(&(currx[0]), &(J[0]), (fint*)nerror_);
+        jacval(currx.data(), J, (fint*)nerror_);
 
-    nerror_ok = check_asl_status(nerror_);
+        nerror_ok = check_asl_status(nerror_);
+        return;
+    }
+
+    //
+    // Each block writes the gradients of its constraints into J.  With
+    // congrd_mode == 2, congrd() stores the gradient of constraint i at the
+    // Jacobian offsets (goff) of that constraint.
+    //
+    {
+        ASL_pfgh* asl = asl_;
+        congrd_mode = 2;
+    }
+    size_t nblocks = block_start_.size() - 1;
+    std::vector<fint> nerror(nblocks, 0);
+    parallel_for(nblocks, nblocks, [&](size_t k, size_t) {
+        ASL_pfgh* asl = block_asl(k);
+        for (size_t i = block_start_[k]; i < block_start_[k + 1]; i++) {
+            congrd(static_cast<int>(i), currx.data(), J, &nerror[k]);
+            if (nerror[k] != 0) break;
+        }
+    });
+    {
+        ASL_pfgh* asl = asl_;
+        congrd_mode = 0;
+    }
+
+    nerror_ok = true;
+    for (auto& err : nerror) nerror_ok = check_asl_status(&err) and nerror_ok;
+}
+
+NLPModelRepn* ASL_Repn::clone_workspace() const
+{
+    //
+    // The ASL data structures cannot be shared between threads, so the copy has
+    // its own ASL instance that is created from the model.
+    //
+    Model shared_model = model;
+    auto tmp = new ASL_Repn(shared_model);
+    try {
+        tmp->initialize();
+    }
+    catch (...) {
+        delete tmp;
+        throw;
+    }
+    return tmp;
+}
+
+bool ASL_Repn::thread_safe() const { return asl_thread_safe; }
+
+void ASL_Repn::set_num_threads(size_t n)
+{
+    size_t curr = nthreads;
+    NLPModelRepn::set_num_threads(n);
+    if (not asl_thread_safe) nthreads = 1;
+    //
+    // Re-create the ASL instances if the number of threads has changed
+    //
+    if (asl_ and (nthreads != curr)) initialize();
 }
 
 void ASL_Repn::initialize(bool /*_sparse_JH*/)
@@ -255,6 +402,22 @@ void ASL_Repn::initialize(bool /*_sparse_JH*/)
     xlb.resize(nx);
     xub.resize(nx);
     c_cache.resize(nc);
+    partition_constraints();
+
+    //
+    // The NL file is regenerated when the model is reset, so the sparsity structure is
+    // compared with the previous one to see if it has changed.
+    //
+    std::vector<size_t> jrow, jcol, hrow, hcol;
+    get_J_nonzeros(jrow, jcol);
+    get_H_nonzeros(hrow, hcol);
+    if ((jrow != jrow_) or (jcol != jcol_) or (hrow != hrow_) or (hcol != hcol_)) {
+        jrow_.swap(jrow);
+        jcol_.swap(jcol);
+        hrow_.swap(hrow);
+        hcol_.swap(hcol);
+        structure_version++;
+    }
 
     //
     // Setup initial values
@@ -289,59 +452,91 @@ void ASL_Repn::alloc_asl()
 {
     free_asl();
     //
-    // Create the ASL structure
-    //
-    ASL_pfgh* asl = reinterpret_cast<ASL_pfgh*>(ASL_alloc(ASL_read_pfgh));
-    asl_ = asl;
+    // Write the NL file.  The text NL format is used, since the binary NL writer
+    // has not been verified against the ASL reader.
     //
-    // Create a temporary filename
+    // The NL file is written in the next directory if it cannot be written in
+    // one, e.g. when /dev/shm is full.  Otherwise the ASL would read a truncated
+    // file, and it calls exit() when it finds errors.
     //
-    std::string fname = "/tmp/coek_XXXXXX";
-    std::string tmp = mktemp(&fname[0]);
-    if (tmp.size() == 0)
-        throw std::runtime_error("Failure to create temporary file for ASL interface");
-    fname += ".nl";
+    std::string fname;
+    std::map<size_t, size_t> invvarmap;  // ASL index -> Var ID
+    std::string error = "Failure to create temporary file for ASL interface";
+    for (auto& dir : nl_handoff_dirs()) {
+        if (not create_nl_handoff_file(dir, fname)) continue;
+        try {
+            std::map<size_t, size_t> invconmap;  // Ignore
+            invvarmap.clear();
+            write_nl_problem(model, fname, invvarmap, invconmap);
+            break;
+        }
+        catch (std::exception& e) {
+            remove(fname.c_str());
+            fname.clear();
+            error = e.what();
+        }
+    }
+    if (fname.empty()) throw std::runtime_error(error);
+
+    std::map<size_t, size_t> tmpvarmap;  // Var ID -> Coek index
+    for (auto& it : used_variables) tmpvarmap[it.second->index] = it.first;
+    for (auto& it : invvarmap)
+        varmap[it.first] = tmpvarmap[it.second];  // ASL index -> Coek -> index
     //
-    // Write the NL file
+    // Read the NL file with the ASL library.  When multiple threads are used, an
+    // ASL instance is created from the same NL file for each block of constraints.
     //
-    {
-        std::map<size_t, size_t> invvarmap;  // ASL index -> Var ID
-        std::map<size_t, size_t> invconmap;  // Ignore
-        write_nl_problem(model, fname, invvarmap, invconmap);
-        std::map<size_t, size_t> tmpvarmap;  // Var ID -> Coek index
-        for (auto& it : used_variables) tmpvarmap[it.second->index] = it.first;
-        for (auto& it : invvarmap)
-            varmap[it.first] = tmpvarmap[it.second];  // ASL index -> Coek -> index
+    try {
+        asl_ = read_nl_file(fname, true);
+
+        ASL_pfgh* asl = asl_;
+        size_t nblocks = std::min(nthreads, static_cast<size_t>(n_con));
+        for (size_t k = 1; k < nblocks; k++) block_asl_.push_back(read_nl_file(fname, false));
+    }
+    catch (...) {
+        remove(fname.c_str());
+        throw;
     }
+    remove(fname.c_str());
+}
+
+ASL_pfgh* ASL_Repn::read_nl_file(const std::string& fname, bool primary)
+{
     //
-    // Read the NL file with the ASL library
+    // Create the ASL structure
     //
+    ASL_pfgh* asl = reinterpret_cast<ASL_pfgh*>(ASL_alloc(ASL_read_pfgh));
+
     return_nofile = 1;  // A hack to prevent the ASL from calling exit()
-    FILE* nlfile = jac0dim(&(fname[0]), 16);
+    std::string stub = fname;
+    FILE* nlfile = jac0dim(&(stub[0]), static_cast<ftnlen>(stub.size() - 3));
     if (!nlfile) {
+        free_asl_struct(asl);
         throw std::runtime_error(
             "ASL_Repn::alloc_asl - Cannot create ASL interface for model with no variables.");
     }
     //
     // allocate space for initial values
     //
-    X0 = new real[n_var];
-    havex0 = new char[n_var];
+    if (primary) {
+        X0 = new real[n_var];
+        havex0 = new char[n_var];
+    }
     //
     // Load model expressions
     //
     int retcode = pfgh_read(nlfile, ASL_return_read_err | ASL_findgroups);
-    //
-    // Close and remove the file
-    //
-    remove(fname.c_str());
 
     //
     // No errors, so return
     //
-    if ((retcode == ASL_readerr_none) or (retcode == ASL_readerr_nonlin)) return;
+    if ((retcode == ASL_readerr_none) or (retcode == ASL_readerr_nonlin)) {
+        // Block evaluations store constraint gradients at their Jacobian offsets
+        if (not primary) congrd_mode = 2;
+        return asl;
+    }
 
-    free_asl();
+    free_asl_struct(asl);
     if (retcode == ASL_readerr_nofile)
         throw std::runtime_error("ASL_Repn::alloc_asl - Error opening file " + fname);
 
@@ -366,22 +561,36 @@ void ASL_Repn::alloc_asl()
         throw std::runtime_error("ASL_Repn::alloc_asl - Unknown error in ASL file reader");
 }
 
-void ASL_Repn::free_asl()
+void ASL_Repn::partition_constraints()
 {
+    block_start_.clear();
+    if (block_asl_.size() == 0) return;
+    //
+    // Balance the blocks by the number of Jacobian nonzeros, counting one
+    // extra unit of work for each constraint
+    //
     ASL_pfgh* asl = asl_;
-    if (asl) {
-        if (X0) {
-            delete[] X0;
-            X0 = 0;
-        }
+    size_t nblocks = block_asl_.size() + 1;
+    size_t total = nnz_jac_g + nc;
+    size_t work = 0;
+    block_start_.push_back(0);
+    for (size_t i : coek::range(nc)) {
+        work++;
+        for (cgrad* cg = Cgrad[i]; cg; cg = cg->next) work++;
+        if ((block_start_.size() < nblocks) and (work * nblocks >= total * block_start_.size()))
+            block_start_.push_back(i + 1);
+    }
+    while (block_start_.size() < nblocks + 1) block_start_.push_back(nc);
+}
 
-        if (havex0) {
-            delete[] havex0;
-            havex0 = 0;
-        }
+void ASL_Repn::free_asl()
+{
+    for (auto asl : block_asl_) free_asl_struct(asl);
+    block_asl_.clear();
+    block_start_.clear();
 
-        ASL* asl_to_free = (ASL*)asl_;
-        ASL_free(&asl_to_free);
+    if (asl_) {
+        free_asl_struct(asl_);
         asl_ = 0;
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include "autograd.hpp"
@@ -20,6 +21,11 @@ class ASL_Repn : public NLPModelRepn {
    public:
     // The main ASL structure
     ASL_pfgh* asl_;
+    // Additional ASL structures that are used to evaluate blocks of constraints
+    // concurrently.  Block 0 is evaluated with asl_, and block k>0 with block_asl_[k-1].
+    std::vector<ASL_pfgh*> block_asl_;
+    // Block k contains the constraints block_start_[k], ..., block_start_[k+1]-1
+    std::vector<size_t> block_start_;
 
     // ----------------------------------------------------------------------
     // Problem information
@@ -44,6 +50,8 @@ class ASL_Repn : public NLPModelRepn {
 
     bool objval_called_with_current_x_;
     bool conval_called_with_current_x_;
+    // True if the constraints have been evaluated with asl_ at the current point
+    bool asl_conval_current_;
     double f_cache;
     std::vector<double> c_cache;
     std::vector<double> currx;
@@ -83,21 +91,33 @@ class ASL_Repn : public NLPModelRepn {
    public:
     double compute_f(size_t i);
 
-    void compute_df(double& f, std::vector<double>& df, size_t i);
+    void compute_df(double& f, double* df, size_t i);
 
-    void compute_c(std::vector<double>& c);
+    void compute_c(double* c);
 
-    void compute_dc(std::vector<double>& dc, size_t i);
+    void compute_dc(double* dc, size_t i);
 
-    void compute_H(std::vector<double>& w, std::vector<double>& H);
+    void compute_H(const double* fw, const double* cw, double* H);
 
-    void compute_J(std::vector<double>& J);
+    void compute_J(double* J);
+
+    NLPModelRepn* clone_workspace() const;
+    bool thread_safe() const;
+
+    void set_num_threads(size_t n);
 
    protected:
     void* nerror_;
+    // The sparsity structure of the Jacobian and Hessian when the model was last initialized
+    std::vector<size_t> jrow_, jcol_, hrow_, hcol_;
 
     void free_asl();
     void alloc_asl();
+    ASL_pfgh* read_nl_file(const std::string& fname, bool primary);
+    void partition_constraints();
+    ASL_pfgh* block_asl(size_t k) { return k == 0 ? asl_ : block_asl_[k - 1]; }
+    bool compute_c_serial();
+    bool compute_c_blocks();
     bool nerror_ok;
     bool check_asl_status(void* nerror);
     void call_hesset();
@@ -1,6 +1,7 @@
 #include "autograd.hpp"
 
 #include <cmath>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "../ast/base_terms.hpp"
@@ -10,6 +11,7 @@
 #include "coek/api/constraint.hpp"
 #include "coek/api/objective.hpp"
 #include "coek/model/model_repn.hpp"
+#include "coek/util/parallel.hpp"
 
 #ifdef WITH_CPPAD
 #    include "cppad_repn.hpp"
@@ -23,6 +25,7 @@ namespace coek {
 
 void check_that_expression_variables_are_declared(
     Model& model, const std::unordered_set<std::shared_ptr<VariableTerm>>& vars);
+void model_ordering(Model& model, std::vector<size_t>& var_order, std::vector<size_t>& con_order);
 
 NLPModelRepn* create_NLPModelRepn(Model& model, const std::string& name)
 {
@@ -52,15 +55,37 @@ void NLPModelRepn::find_used_variables()
 
     check_that_expression_variables_are_declared(model, vars);
 
+    //
+    // The used variables are sorted by id, or by their position in the model ordering
+    //
+    std::vector<size_t> var_order;
+    std::vector<size_t> con_order;
+    model_ordering(model, var_order, con_order);
     std::map<size_t, std::shared_ptr<VariableTerm>> tmp;
-    for (auto& it : vars) tmp[it->index] = it;
+    if (model.repn->ordering == Model::Ordering::creation)
+        for (auto& it : vars) tmp[it->index] = it;
+    else {
+        std::unordered_map<VariableRepn, size_t> rank;
+        for (size_t k = 0; k < var_order.size(); k++)
+            rank[model.repn->variables[var_order[k]].repn] = k;
+        for (auto& it : vars) tmp[rank[it]] = it;
+    }
 
-    used_variables.clear();
+    std::map<size_t, VariableRepn> new_used_variables;
     size_t i = 0;
     for (auto& it : tmp) {
         // std::cout << "DEBUG USED VARS  " << i << " " << it.first << " " << it.second->get_name()
         // << std::endl;
-        used_variables[i++] = it.second;
+        new_used_variables[i++] = it.second;
+    }
+
+    //
+    // The structure only changes if the used variables or the constraint order change
+    //
+    if ((new_used_variables != used_variables) or (con_order != constraint_order)) {
+        used_variables.swap(new_used_variables);
+        constraint_order.swap(con_order);
+        structure_version++;
     }
 
     fixed_variables.clear();
@@ -70,6 +95,13 @@ void NLPModelRepn::find_used_variables()
     for (auto& it : params) parameters[it] = j++;
 }
 
+NLPModelRepn* NLPModelRepn::clone_workspace() const
+{
+    throw std::runtime_error("NLP model type does not support concurrent evaluation");
+}
+
+void NLPModelRepn::set_num_threads(size_t n) { nthreads = n == 0 ? default_num_threads() : n; }
+
 VariableRepn NLPModelRepn::get_variable(size_t i) { return used_variables[i]; }
 
 void NLPModelRepn::set_variable(size_t i, const VariableRepn _v)
@@ -86,7 +118,11 @@ void NLPModelRepn::set_variable(size_t i, const VariableRepn _v)
 
 Objective NLPModelRepn::get_objective(size_t i) { return model.get_objective(i); }
 
-Constraint NLPModelRepn::get_constraint(size_t i) { return model.get_constraint(i); }
+Constraint NLPModelRepn::get_constraint(size_t i)
+{
+    // The constraint order is empty until the used variables are found
+    return model.get_constraint(i < constraint_order.size() ? constraint_order[i] : i);
+}
 
 void NLPModelRepn::print_equations(std::ostream& ostr) const
 {
@@ -16,6 +16,14 @@ class NLPModelRepn {
     std::map<size_t, VariableRepn> used_variables;
     std::map<VariableRepn, size_t> fixed_variables;
     std::map<ParameterRepn, size_t> parameters;
+    // The position of the i-th NLP constraint in the model
+    std::vector<size_t> constraint_order;
+    // Incremented each time the used variables, the constraint order or the
+    // sparsity structure change.  Solvers use this to detect when cached
+    // problem structure is stale.
+    size_t structure_version = 0;
+    // The number of threads used to evaluate the model
+    size_t nthreads = 1;
 
    public:
     NLPModelRepn() {}
@@ -43,18 +51,36 @@ class NLPModelRepn {
     virtual void print_equations(std::ostream& ostr) const = 0;
     virtual void print_values(std::ostream& ostr) const = 0;
 
+    // The compute methods write into caller-owned buffers that are sized by the
+    // caller (num_variables(), num_constraints(), num_nonzeros_Jacobian(), etc).
     virtual double compute_f(size_t i) = 0;
-    virtual void compute_df(double& f, std::vector<double>& df, size_t i) = 0;
-    virtual void compute_H(std::vector<double>& w, std::vector<double>& H) = 0;
-    virtual void compute_c(std::vector<double>& c) = 0;
-    virtual void compute_dc(std::vector<double>& dc, size_t i) = 0;
-    virtual void compute_J(std::vector<double>& J) = 0;
+    virtual void compute_df(double& f, double* df, size_t i) = 0;
+    // fw - objective weights (num_objectives()), cw - constraint weights (num_constraints())
+    virtual void compute_H(const double* fw, const double* cw, double* H) = 0;
+    virtual void compute_c(double* c) = 0;
+    virtual void compute_dc(double* dc, size_t i) = 0;
+    virtual void compute_J(double* J) = 0;
 
     virtual void get_J_nonzeros(std::vector<size_t>& jrow, std::vector<size_t>& jcol) = 0;
     virtual void get_H_nonzeros(std::vector<size_t>& hrow, std::vector<size_t>& hcol) = 0;
     // Returns true if the Hessian representation is column-major order, and false otherwise
     virtual bool column_major_hessian() = 0;
 
+    // Create a copy that shares the model and the AD structure of this object, but
+    // which has its own evaluation workspace.  The copy can be evaluated
+    // concurrently with this object.
+    virtual NLPModelRepn* clone_workspace() const;
+    // Returns false if separate workspaces cannot be evaluated concurrently, e.g.
+    // because the AD library uses global state.
+    virtual bool thread_safe() const { return true; }
+    // Prepare the AD library for concurrent evaluation with nthreads threads.  This
+    // is called before threads are launched, and it is called with nthreads=1 after
+    // they have completed.
+    virtual void setup_parallel(size_t /*nthreads*/) {}
+    // Set the number of threads used within the compute methods.  Backends that do
+    // not support threaded evaluation ignore this value.
+    virtual void set_num_threads(size_t n);
+
    public:
     void find_used_variables();
 };
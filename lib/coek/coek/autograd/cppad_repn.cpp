@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <unordered_map>
 
 #include "../ast/base_terms.hpp"
@@ -9,6 +10,7 @@
 #include "coek/api/objective.hpp"
 #include "coek/model/model.hpp"
 #include "coek/model/model_repn.hpp"
+#include "coek/util/parallel.hpp"
 #include "cppad_repn.hpp"
 
 namespace coek {
@@ -35,9 +37,7 @@ size_t CppAD_Repn::num_nonzeros_Hessian_Lagrangian() const { return hes_row.size
 void CppAD_Repn::set_variables(std::vector<double>& x)
 {
     assert(x.size() == currx.size());
-    auto cit = currx.begin();
-    auto xit = x.begin();
-    for (; cit != currx.end(); ++cit, ++xit) *cit = *xit;
+    std::copy(x.begin(), x.end(), currx.begin());
 
     invalid_fc = true;
 }
@@ -45,7 +45,7 @@ void CppAD_Repn::set_variables(std::vector<double>& x)
 void CppAD_Repn::set_variables(const double* x, size_t n)
 {
     assert(n == currx.size());
-    for (size_t i = 0; i < n; i++) currx[i] = x[i];
+    std::copy(x, x + n, currx.begin());
 
     invalid_fc = true;
 }
@@ -74,6 +74,72 @@ void CppAD_Repn::get_H_nonzeros(std::vector<size_t>& hrow, std::vector<size_t>&
 
 bool CppAD_Repn::column_major_hessian() { return false; }
 
+NLPModelRepn* CppAD_Repn::clone_workspace() const
+{
+    Model shared_model = model;
+    auto tmp = new CppAD_Repn(shared_model);
+
+    tmp->used_variables = used_variables;
+    tmp->fixed_variables = fixed_variables;
+    tmp->parameters = parameters;
+    tmp->structure_version = structure_version;
+    tmp->simplify_expressions = simplify_expressions;
+
+    tmp->nf = nf;
+    tmp->nx = nx;
+    tmp->nc = nc;
+    tmp->xi = xi;
+    tmp->xlb = xlb;
+    tmp->xub = xub;
+
+    // CppAD stores the Taylor coefficients of the forward and reverse sweeps in the
+    // ADFun object, and its evaluation methods are not const, so an ADFun cannot be
+    // evaluated concurrently by different threads.  Hence, the copy has its own
+    // operation sequence.  The ADFun copy constructor is disabled in CppAD, but
+    // assignment copies the operation sequence and the dynamic parameter values.  The
+    // copied Taylor coefficients are released, since the copy recomputes them.
+    tmp->ADfc = ADfc;
+    tmp->ADfc.capacity_order(0);
+
+    // The sparsity patterns and the colorings in the work objects are copied, so they
+    // are not recomputed.
+    tmp->sparse_JH = sparse_JH;
+    tmp->jac_pattern = jac_pattern;
+    tmp->jac_row = jac_row;
+    tmp->jac_col = jac_col;
+    tmp->jac_col_order = jac_col_order;
+    tmp->jac_work = jac_work;
+    tmp->hes_pattern = hes_pattern;
+    tmp->hes_row = hes_row;
+    tmp->hes_col = hes_col;
+    tmp->hes_work = hes_work;
+
+    tmp->hes_weights.assign(nf + nc, 0.0);
+    tmp->hes_values.resize(hes_row.size());
+    tmp->jac_values.resize(jac_row.size());
+    tmp->fc_cache.resize(nf + nc);
+    tmp->fcw.assign(nf + nc, 0.0);
+    tmp->currx = currx;
+    tmp->invalid_fc = true;
+
+    return tmp;
+}
+
+void CppAD_Repn::setup_parallel(size_t nthreads)
+{
+    if (nthreads > 1) {
+        CppAD::thread_alloc::parallel_setup(nthreads, coek::in_parallel, coek::thread_index);
+        CppAD::thread_alloc::hold_memory(true);
+        CppAD::parallel_ad<double>();
+    }
+    else {
+        size_t num_threads = CppAD::thread_alloc::num_threads();
+        for (size_t t = 1; t < num_threads; t++) CppAD::thread_alloc::free_available(t);
+        CppAD::thread_alloc::hold_memory(false);
+        CppAD::thread_alloc::parallel_setup(1, nullptr, nullptr);
+    }
+}
+
 void CppAD_Repn::print_equations(std::ostream& ostr) const { NLPModelRepn::print_equations(ostr); }
 
 void CppAD_Repn::print_values(std::ostream& ostr) const { NLPModelRepn::print_values(ostr); }
@@ -88,31 +154,27 @@ double CppAD_Repn::compute_f(size_t i)
     return fc_cache[i];
 }
 
-void CppAD_Repn::compute_df(double& f, std::vector<double>& df, size_t i)
+void CppAD_Repn::compute_df(double& f, double* df, size_t i)
 {
-    assert(df.size() == nx);
-
     f = compute_f(i);
     fcw[i] = 1;
     auto dy = ADfc.Reverse(1, fcw);
     fcw[i] = 0;
-    for (size_t j = 0; j < df.size(); j++) df[j] = dy[j];
+    std::copy(dy.begin(), dy.begin() + static_cast<std::ptrdiff_t>(nx), df);
 }
 
-void CppAD_Repn::compute_c(std::vector<double>& c)
+void CppAD_Repn::compute_c(double* c)
 {
-    assert(c.size() == nc);
     if (invalid_fc) {
         fc_cache = ADfc.Forward(0, currx);
         invalid_fc = false;
     }
-    for (size_t i = 0; i < c.size(); i++) c[i] = fc_cache[nf + i];
+    std::copy(fc_cache.begin() + static_cast<std::ptrdiff_t>(nf), fc_cache.end(), c);
 }
 
-void CppAD_Repn::compute_dc(std::vector<double>& dc, size_t i)
+void CppAD_Repn::compute_dc(double* dc, size_t i)
 {
-    assert(i < fcw.size());
-    assert(dc.size() == nx);
+    assert(nf + i < fcw.size());
 
     if (invalid_fc) {
         fc_cache = ADfc.Forward(0, currx);
@@ -121,11 +183,14 @@ void CppAD_Repn::compute_dc(std::vector<double>& dc, size_t i)
     fcw[nf + i] = 1;
     auto dy = ADfc.Reverse(1, fcw);
     fcw[nf + i] = 0;
-    for (size_t j = 0; j < dc.size(); j++) dc[j] = dy[j];
+    std::copy(dy.begin(), dy.begin() + static_cast<std::ptrdiff_t>(nx), dc);
 }
 
-void CppAD_Repn::compute_H(std::vector<double>& w, std::vector<double>& H)
+void CppAD_Repn::compute_H(const double* fw, const double* cw, double* H)
 {
+    std::copy(fw, fw + nf, hes_weights.begin());
+    std::copy(cw, cw + nc, hes_weights.begin() + static_cast<std::ptrdiff_t>(nf));
+
 #if 0
 if (invalid_fc) {
     fc_cache = ADfc.Forward(0, currx);
@@ -136,13 +201,15 @@ if (invalid_fc) {
         //
         // Sparse Hessian
         //
-        ADfc.SparseHessian(currx, w, hes_pattern, hes_row, hes_col, H, hes_work);
+        ADfc.SparseHessian(currx, hes_weights, hes_pattern, hes_row, hes_col, hes_values,
+                           hes_work);
+        std::copy(hes_values.begin(), hes_values.end(), H);
     }
     else {
         //
         // Dense Hessian
         //
-        auto hes = ADfc.Hessian(currx, w);
+        auto hes = ADfc.Hessian(currx, hes_weights);
         for (size_t k = 0; k < hes_row.size(); k++) {
             size_t i = hes_row[k];
             size_t j = hes_col[k];
@@ -151,7 +218,7 @@ if (invalid_fc) {
     }
 }
 
-void CppAD_Repn::compute_J(std::vector<double>& J)
+void CppAD_Repn::compute_J(double* J)
 {
     if (sparse_JH) {
         //
@@ -159,12 +226,15 @@ void CppAD_Repn::compute_J(std::vector<double>& J)
         //
         if (nx < nc) {
             // Forward
-            ADfc.SparseJacobianForward(currx, jac_pattern, jac_row, jac_col, J, jac_work);
+            ADfc.SparseJacobianForward(currx, jac_pattern, jac_row, jac_col, jac_values,
+                                       jac_work);
         }
         else {
             // Reverse
-            ADfc.SparseJacobianReverse(currx, jac_pattern, jac_row, jac_col, J, jac_work);
+            ADfc.SparseJacobianReverse(currx, jac_pattern, jac_row, jac_col, jac_values,
+                                       jac_work);
         }
+        std::copy(jac_values.begin(), jac_values.end(), J);
     }
 
     else {
@@ -263,7 +333,8 @@ void CppAD_Repn::create_CppAD_function()
             }
 
             nb = 0;
-            for (auto& it : model.repn->constraints) {
+            for (auto i : constraint_order) {
+                auto& it = model.repn->constraints[i];
                 build_expression(simplify_expr(it.repn, cache), ADvars, ADrange[nf + nb],
                                  _used_variables);
                 nb++;
@@ -277,7 +348,8 @@ void CppAD_Repn::create_CppAD_function()
             }
 
             nb = 0;
-            for (auto& it : model.repn->constraints) {
+            for (auto i : constraint_order) {
+                auto& it = model.repn->constraints[i];
                 build_expression(it.repn, ADvars, ADrange[nf + nb], _used_variables);
                 nb++;
             }
@@ -311,6 +383,7 @@ void CppAD_Repn::initialize(bool _sparse_JH)
     fc_cache.resize(nfc);
     currx.resize(nx);
     fcw.assign(nfc, 0.0);
+    hes_weights.assign(nfc, 0.0);
 
     if (nc > 0) {
         //
@@ -559,6 +632,9 @@ void CppAD_Repn::initialize(bool _sparse_JH)
 
     if (sparse_JH) hes_work.color_method = "cppad.symmetric";
 
+    jac_values.resize(jac_row.size());
+    hes_values.resize(hes_row.size());
+
     reset();
 }
 
@@ -653,6 +729,18 @@ void visit_MonomialTerm(expr_pointer_t& expr, VisitorData& data, CppAD::AD<doubl
         ans += tmp->coef * data.ADvars[data.used_variables[tmp->var]];
 }
 
+void visit_LinearRowTerm(expr_pointer_t& expr, VisitorData& data, CppAD::AD<double>& ans)
+{
+    auto tmp = std::dynamic_pointer_cast<LinearRowTerm>(expr);
+    for (size_t k = tmp->begin(); k < tmp->end(); k++) {
+        auto& var = tmp->var(k);
+        if (var->fixed)
+            ans += tmp->coef(k) * data.dynamic_params[data.fixed_variables[var]];
+        else
+            ans += tmp->coef(k) * data.ADvars[data.used_variables[var]];
+    }
+}
+
 #define FROM_BODY(TERM)                                                                \
     void visit_##TERM(expr_pointer_t& expr, VisitorData& data, CppAD::AD<double>& ans) \
     {                                                                                  \
@@ -778,6 +866,7 @@ void visit_expression(expr_pointer_t& expr, VisitorData& data, CppAD::AD<double>
         VISIT_CASE(ParameterTerm);
         VISIT_CASE(VariableTerm);
         VISIT_CASE(MonomialTerm);
+        VISIT_CASE(LinearRowTerm);
         VISIT_CASE(InequalityTerm);
         VISIT_CASE(EqualityTerm);
         VISIT_CASE(ObjectiveTerm);
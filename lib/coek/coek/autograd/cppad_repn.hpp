@@ -74,6 +74,12 @@ class CppAD_Repn : public NLPModelRepn {
     CppAD::vector<size_t> hes_col;
     /// Work vector used by SparseJacobian, stored here to avoid recalculation.
     CppAD::sparse_hessian_work hes_work;
+    /// Weights of the Lagrangian passed to SparseHessian.
+    std::vector<double> hes_weights;
+    /// Values returned by SparseHessian, which are copied into the caller buffer.
+    std::vector<double> hes_values;
+    /// Values returned by SparseJacobian, which are copied into the caller buffer.
+    std::vector<double> jac_values;
 
     bool invalid_fc;
     std::vector<double> fc_cache;
@@ -110,21 +116,24 @@ class CppAD_Repn : public NLPModelRepn {
     void get_H_nonzeros(std::vector<size_t>& hrow, std::vector<size_t>& hcol);
     bool column_major_hessian();
 
+    NLPModelRepn* clone_workspace() const;
+    void setup_parallel(size_t nthreads);
+
     void print_equations(std::ostream& ostr) const;
     void print_values(std::ostream& ostr) const;
 
    public:
     double compute_f(size_t i);
 
-    void compute_df(double& f, std::vector<double>& df, size_t i);
+    void compute_df(double& f, double* df, size_t i);
 
-    void compute_c(std::vector<double>& c);
+    void compute_c(double* c);
 
-    void compute_dc(std::vector<double>& dc, size_t i);
+    void compute_dc(double* dc, size_t i);
 
-    void compute_H(std::vector<double>& w, std::vector<double>& H);
+    void compute_H(const double* fw, const double* cw, double* H);
 
-    void compute_J(std::vector<double>& J);
+    void compute_J(double* J);
 
    public:
     void create_CppAD_function();
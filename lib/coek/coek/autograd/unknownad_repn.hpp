@@ -77,27 +77,27 @@ class UnknownAD_Repn : public NLPModelRepn {
    public:
     double compute_f(size_t) { throw std::runtime_error("Error accessing uninitialized NLPModel"); }
 
-    void compute_df(double&, std::vector<double>&, size_t)
+    void compute_df(double&, double*, size_t)
     {
         throw std::runtime_error("Error accessing uninitialized NLPModel");
     }
 
-    void compute_c(std::vector<double>&)
+    void compute_c(double*)
     {
         throw std::runtime_error("Error accessing uninitialized NLPModel");
     }
 
-    void compute_dc(std::vector<double>&, size_t)
+    void compute_dc(double*, size_t)
     {
         throw std::runtime_error("Error accessing uninitialized NLPModel");
     }
 
-    void compute_H(std::vector<double>&, std::vector<double>&)
+    void compute_H(const double*, const double*, double*)
     {
         throw std::runtime_error("Error accessing uninitialized NLPModel");
     }
 
-    void compute_J(std::vector<double>&)
+    void compute_J(double*)
     {
         throw std::runtime_error("Error accessing uninitialized NLPModel");
     }
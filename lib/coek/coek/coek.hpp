@@ -13,6 +13,7 @@
 #include "coek/api/expression.hpp"
 #include "coek/api/expression_visitor.hpp"
 #include "coek/api/intrinsic_fn.hpp"
+#include "coek/api/linear_constraint_block.hpp"
 #include "coek/api/objective.hpp"
 #if __cpp_lib_variant >= 201606
 #    include "coek/api/parameter_array.hpp"
@@ -21,8 +22,13 @@
 #    include "coek/api/subexpression_map.hpp"
 #endif
 
+#include "coek/model/decomposition.hpp"
+#include "coek/model/fbbt.hpp"
 #include "coek/model/model.hpp"
 #include "coek/model/nlp_model.hpp"
+#include "coek/model/presolve.hpp"
+#include "coek/model/scaling.hpp"
+#include "coek/model/standard_form.hpp"
 
 #ifdef COEK_WITH_COMPACT_MODEL
 #    include "coek/compact/coek_sets.hpp"
@@ -6,6 +6,7 @@
 #include "coek/ast/compact_terms.hpp"
 #include "coek/model/model.hpp"
 #include "coek/model/model_repn.hpp"
+#include "coek/util/shift.hpp"
 
 namespace coek {
 
@@ -27,6 +28,11 @@ class ParameterMapRepn : public ParameterAssocArrayRepn {
 
     size_t size() { return concrete_set.size(); }
 
+    void slices(size_t dimension, std::vector<size_t>& positions, std::vector<size_t>& start)
+    {
+        set_slices(concrete_set, dimension, positions, start);
+    }
+
     std::string get_name(size_t index);
 
     void generate_names();
@@ -138,6 +144,12 @@ ParameterMap& ParameterMap::value(const Expression& value)
     return *this;
 }
 
+ParameterMap& ParameterMap::shift(size_t dimension, int offset)
+{
+    repn->shift(dimension, offset);
+    return *this;
+}
+
 ParameterMap& ParameterMap::name(const std::string& name)
 {
     repn->name(name);
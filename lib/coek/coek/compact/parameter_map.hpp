@@ -125,6 +125,9 @@ class ParameterMap : public ParameterAssocArray {
     ParameterMap& value(double value);
     /** Set the initial parameter value. \returns the parameter object. */
     ParameterMap& value(const Expression& value);
+    /** Shift the parameter values along an index dimension, so the value at index t is
+     * replaced by the value at index t+offset.  \returns the parameter object. */
+    ParameterMap& shift(size_t dimension, int offset = 1);
 
     /** Set the name of the parameter. \returns the parameter object */
     ParameterMap& name(const std::string& name);
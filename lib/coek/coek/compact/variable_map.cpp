@@ -7,6 +7,7 @@
 #include "coek/compact/variable_map.hpp"
 #include "coek/model/model.hpp"
 #include "coek/model/model_repn.hpp"
+#include "coek/util/shift.hpp"
 
 namespace coek {
 
@@ -37,6 +38,11 @@ class VariableMapRepn : public VariableAssocArrayRepn {
 
     size_t size() const { return const_cast<ConcreteSet&>(concrete_set).size(); }
 
+    void slices(size_t dimension, std::vector<size_t>& positions, std::vector<size_t>& start)
+    {
+        set_slices(concrete_set, dimension, positions, start);
+    }
+
     void generate_names();
 };
 
@@ -154,6 +160,12 @@ VariableMap& VariableMap::value(const Expression& value)
     return *this;
 }
 
+VariableMap& VariableMap::shift(size_t dimension, int offset)
+{
+    repn->shift(dimension, offset);
+    return *this;
+}
+
 VariableMap& VariableMap::lower(double value)
 {
     repn->lower(value);
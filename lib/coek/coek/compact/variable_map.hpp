@@ -128,6 +128,9 @@ class VariableMap : public VariableAssocArray {
     VariableMap& value(double value);
     /** Set the initial variable value. \returns the variable object. */
     VariableMap& value(const Expression& value);
+    /** Shift the variable values along an index dimension, so the value at index t is
+     * replaced by the value at index t+offset.  \returns the variable object. */
+    VariableMap& shift(size_t dimension, int offset = 1);
 
     /** Set the lower bound. \returns the variable object. */
     VariableMap& lower(double value);
@@ -137,6 +137,7 @@ expr_pointer_t visit_expression(expr_pointer_t expr)
         case ParameterTerm_id:
         case VariableTerm_id:
         case MonomialTerm_id:
+        case LinearRowTerm_id:
             return expr;
 
             VISIT_CASE(IndexParameterTerm);
@@ -4,6 +4,7 @@
 #include "../util/string_utils.hpp"
 #include "coek/api/constraint.hpp"
 #include "coek/api/objective.hpp"
+#include "coek/util/compressed_file.hpp"
 // #ifdef COEK_WITH_COMPACT_MODEL
 // #include "coek/compact/coek_exprterm.hpp"
 // #endif
@@ -16,6 +17,10 @@ void write_lp_problem(CompactModel& model, const std::string& fname,
                       std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
 void write_lp_problem_ostream(CompactModel& model, const std::string& fname,
                               std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
+void write_mps_problem(CompactModel& model, const std::string& fname,
+                       std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
+void write_nl_problem_ostream(CompactModel& model, const std::string& fname,
+                              std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
 #    ifdef WITH_FMTLIB
 void write_lp_problem_fmtlib(CompactModel& model, const std::string& fname,
                              std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
@@ -69,6 +74,7 @@ void CompactModel::add_variable(PythonVariableArray& varray)
 
 VariableMap& CompactModel::add_variable(VariableMap& vars)
 {
+    vars.get_repn()->setup();
     repn->variables.insert(repn->variables.end(), vars.begin(), vars.end());
     repn->variable_names.insert(repn->variable_names.end(), vars.size(), "");
     /*
@@ -83,6 +89,7 @@ VariableMap& CompactModel::add_variable(VariableMap& vars)
 
 VariableMap& CompactModel::add_variable(VariableMap&& vars)
 {
+    vars.get_repn()->setup();
     repn->variables.insert(repn->variables.end(), vars.begin(), vars.end());
     repn->variable_names.insert(repn->variable_names.end(), vars.size(), "");
     /*
@@ -97,6 +104,7 @@ VariableMap& CompactModel::add_variable(VariableMap&& vars)
 
 VariableArray& CompactModel::add_variable(VariableArray& vars)
 {
+    vars.get_repn()->setup();
     repn->variables.insert(repn->variables.end(), vars.begin(), vars.end());
     repn->variable_names.insert(repn->variable_names.end(), vars.size(), "");
     /*
@@ -111,6 +119,7 @@ VariableArray& CompactModel::add_variable(VariableArray& vars)
 
 VariableArray& CompactModel::add_variable(VariableArray&& vars)
 {
+    vars.get_repn()->setup();
     repn->variables.insert(repn->variables.end(), vars.begin(), vars.end());
     repn->variable_names.insert(repn->variable_names.end(), vars.size(), "");
     /*
@@ -198,6 +207,7 @@ void CompactModel::add(ConstraintSequence&& seq) { repn->constraints.push_back(s
 Model CompactModel::expand()
 {
     Model model;
+    model.num_writer_threads(repn->num_writer_threads);
 
     for (auto it = repn->variables.begin(); it != repn->variables.end(); ++it) {
         auto& val = *it;
@@ -248,6 +258,10 @@ Model CompactModel::expand()
     return model;
 }
 
+void CompactModel::num_writer_threads(size_t value) { repn->num_writer_threads = value; }
+
+size_t CompactModel::num_writer_threads() { return repn->num_writer_threads; }
+
 void CompactModel::write(const std::string& fname)
 {
     std::map<size_t, size_t> varmap;
@@ -258,6 +272,16 @@ void CompactModel::write(const std::string& fname)
 void CompactModel::write(const std::string& fname, std::map<size_t, size_t>& varmap,
                          std::map<size_t, size_t>& conmap)
 {
+#    ifdef WITH_FMTLIB
+    // Compressed LP files are written without expanding the model
+    std::string base;
+    if ((compression_from_suffix(fname, base) != Compression::none)
+        and (ends_with(base, ".lp") or ends_with(base, ".fmtlp"))) {
+        write_lp_problem_fmtlib(*this, fname, varmap, conmap);
+        return;
+    }
+#    endif
+
     if (ends_with(fname, ".lp")) {
         write_lp_problem(*this, fname, varmap, conmap);
         return;
@@ -275,6 +299,17 @@ void CompactModel::write(const std::string& fname, std::map<size_t, size_t>& var
     }
 #    endif
 
+    // MPS and NL files are written without expanding the model
+    else if (ends_with(fname, ".mps")) {
+        write_mps_problem(*this, fname, varmap, conmap);
+        return;
+    }
+
+    else if (ends_with(fname, ".nl") or ends_with(fname, ".ostrnl")) {
+        write_nl_problem_ostream(*this, fname, varmap, conmap);
+        return;
+    }
+
     Model model = expand();
     model.write(fname, varmap, conmap);
 }
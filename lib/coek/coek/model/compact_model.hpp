@@ -135,6 +135,15 @@ class CompactModel {
 
     Model expand();
 
+    /** Set the number of threads used to write model files
+     *
+     * Model files are written serially by default.  A value of 0 uses all
+     * hardware threads.
+     */
+    void num_writer_threads(size_t value);
+    /** \returns the number of threads used to write model files */
+    size_t num_writer_threads();
+
     void write(const std::string& filename);
     void write(const std::string& filename, std::map<size_t, size_t>& varmap,
                std::map<size_t, size_t>& conmap);
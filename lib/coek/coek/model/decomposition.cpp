@@ -0,0 +1,255 @@
+#include "coek/model/decomposition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/expression_visitor.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/expr_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/ast/visitor.hpp"
+#include "coek/model/model_repn.hpp"
+
+namespace coek {
+
+namespace {
+
+const size_t none = std::numeric_limits<size_t>::max();
+
+// The tolerance used to check the constraints without free variables
+const double tolerance = 1e-9;
+
+// A union-find structure for the variables
+class DisjointSets {
+   public:
+    std::vector<size_t> parent;
+
+    explicit DisjointSets(size_t n) : parent(n)
+    {
+        for (size_t i = 0; i < n; i++) parent[i] = i;
+    }
+
+    size_t find(size_t i)
+    {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void merge(size_t i, size_t j)
+    {
+        i = find(i);
+        j = find(j);
+        // The root is the smallest variable index
+        if (i < j)
+            parent[j] = i;
+        else if (j < i)
+            parent[i] = j;
+    }
+};
+
+}  // namespace
+
+class DecompositionRepn {
+   public:
+    Model model;
+
+    std::vector<Model> blocks;
+    std::vector<std::vector<size_t>> block_vars;
+    std::vector<std::vector<size_t>> block_cons;
+    std::vector<size_t> fixed_cons;
+
+    std::unordered_map<VariableTerm*, size_t> var_index;
+
+   public:
+    explicit DecompositionRepn(Model& _model) : model(_model) {}
+
+    void decompose();
+    bool infeasible();
+    size_t variable(const VariableRepn& var);
+    // Merges the variables in an expression, and returns one of them (or none)
+    size_t merge_variables(MutableNLPExpr& repn, DisjointSets& sets);
+};
+
+size_t DecompositionRepn::variable(const VariableRepn& var)
+{
+    auto it = var_index.find(var.get());
+    if (it == var_index.end())
+        throw std::runtime_error("Cannot decompose a model with variable " + var->get_name()
+                                 + " that is not declared in the model");
+    return it->second;
+}
+
+size_t DecompositionRepn::merge_variables(MutableNLPExpr& repn, DisjointSets& sets)
+{
+    size_t first = none;
+    auto merge = [&](const VariableRepn& var) {
+        size_t j = variable(var);
+        if (first == none)
+            first = j;
+        else
+            sets.merge(first, j);
+    };
+    for (auto& var : repn.linear_vars) merge(var);
+    for (auto& var : repn.quadratic_lvars) merge(var);
+    for (auto& var : repn.quadratic_rvars) merge(var);
+    for (auto& var : repn.nonlinear_vars) merge(var);
+    return first;
+}
+
+void DecompositionRepn::decompose()
+{
+    auto& mrepn = *model.repn;
+    if (mrepn.objectives.size() > 1)
+        throw std::runtime_error("Cannot decompose a model with "
+                                 + std::to_string(mrepn.objectives.size()) + " objectives");
+
+    size_t nvars = mrepn.variables.size();
+    for (size_t j = 0; j < nvars; j++) var_index.emplace(mrepn.variables[j].repn.get(), j);
+    DisjointSets sets(nvars);
+
+    //
+    // Merge the variables in each constraint and each objective term
+    //
+    std::vector<size_t> con_var(mrepn.constraints.size());
+    for (size_t i = 0; i < mrepn.constraints.size(); i++) {
+        MutableNLPExpr repn;
+        repn.collect_terms(mrepn.constraints[i]);
+        con_var[i] = merge_variables(repn, sets);
+    }
+
+    std::vector<Expression> obj_terms;
+    std::vector<size_t> obj_var;
+    if (mrepn.objectives.size() == 1) {
+        auto& body = mrepn.objectives[0].repn->body;
+        if (body->id() == PlusTerm_id) {
+            auto tmp = std::dynamic_pointer_cast<PlusTerm>(body);
+            for (size_t k = 0; k < tmp->n; k++) obj_terms.emplace_back((*tmp->data)[k]);
+        }
+        else
+            obj_terms.emplace_back(body);
+        for (auto& term : obj_terms) {
+            MutableNLPExpr repn;
+            repn.collect_terms(term);
+            obj_var.push_back(merge_variables(repn, sets));
+        }
+    }
+
+    //
+    // Number the blocks in the order of their first variable
+    //
+    std::vector<size_t> root_block(nvars, none);
+    std::vector<bool> used(nvars, false);
+    auto block_of = [&](size_t j) {
+        size_t root = sets.find(j);
+        if (root_block[root] == none) {
+            root_block[root] = block_vars.size();
+            block_vars.emplace_back();
+            block_cons.emplace_back();
+        }
+        return root_block[root];
+    };
+    for (size_t i = 0; i < con_var.size(); i++)
+        if (con_var[i] != none) used[sets.find(con_var[i])] = true;
+    for (auto j : obj_var)
+        if (j != none) used[sets.find(j)] = true;
+    for (size_t j = 0; j < nvars; j++) {
+        auto& var = mrepn.variables[j];
+        // Fixed variables and unused variables are not included in the blocks
+        if (var.fixed() or not used[sets.find(j)]) continue;
+        block_vars[block_of(j)].push_back(j);
+    }
+    for (size_t i = 0; i < con_var.size(); i++) {
+        if (con_var[i] == none)
+            fixed_cons.push_back(i);
+        else
+            block_cons[block_of(con_var[i])].push_back(i);
+    }
+
+    //
+    // Create the block models
+    //
+    blocks.resize(block_vars.size());
+    for (size_t b = 0; b < blocks.size(); b++) {
+        auto& block = blocks[b];
+        block.name_generation(model.name_generation());
+        for (auto j : block_vars[b]) block.add_variable(mrepn.variables[j]);
+        for (auto i : block_cons[b]) block.add(mrepn.constraints[i]);
+    }
+
+    if (mrepn.objectives.size() == 1) {
+        // Terms without variables are added to the first block
+        std::vector<Expression> block_obj(blocks.size());
+        for (size_t k = 0; k < obj_terms.size(); k++) {
+            size_t b = obj_var[k] == none ? 0 : block_of(obj_var[k]);
+            if (b < blocks.size()) block_obj[b] += obj_terms[k];
+        }
+        bool sense = mrepn.objectives[0].sense();
+        for (size_t b = 0; b < blocks.size(); b++)
+            blocks[b].add_objective(block_obj[b]).sense(sense);
+    }
+}
+
+bool DecompositionRepn::infeasible()
+{
+    for (auto i : fixed_cons) {
+        auto& con = model.repn->constraints[i];
+        double body = con.body().value();
+        if (con.has_lower()) {
+            double lower = con.lower().value();
+            if (lower - body > tolerance * std::max(1.0, std::fabs(lower))) return true;
+        }
+        if (con.has_upper()) {
+            double upper = con.upper().value();
+            if (body - upper > tolerance * std::max(1.0, std::fabs(upper))) return true;
+        }
+    }
+    return false;
+}
+
+//
+// Decomposition
+//
+
+Decomposition::Decomposition(Model& model)
+{
+    repn = std::make_shared<DecompositionRepn>(model);
+    repn->decompose();
+}
+
+size_t Decomposition::num_blocks() const { return repn->blocks.size(); }
+
+Model& Decomposition::block(size_t i)
+{
+    if (i >= repn->blocks.size())
+        throw std::runtime_error("Block index " + std::to_string(i)
+                                 + " is out of range for a decomposition with "
+                                 + std::to_string(repn->blocks.size()) + " blocks");
+    return repn->blocks[i];
+}
+
+const std::vector<size_t>& Decomposition::variables(size_t i) const
+{
+    return repn->block_vars.at(i);
+}
+
+const std::vector<size_t>& Decomposition::constraints(size_t i) const
+{
+    return repn->block_cons.at(i);
+}
+
+const std::vector<size_t>& Decomposition::fixed_constraints() const { return repn->fixed_cons; }
+
+bool Decomposition::infeasible() const { return repn->infeasible(); }
+
+}  // namespace coek
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <coek/model/model.hpp>
+
+namespace coek {
+
+class DecompositionRepn;
+
+/**
+ * A decomposition of a model into independent blocks.
+ *
+ * The variables in each constraint, and in each term of the objective, are
+ * collected with MutableNLPExpr objects.  Two variables are in the same block
+ * if they are connected by a path of constraints and objective terms, so the
+ * blocks are the connected components of the variable-constraint incidence
+ * graph.  The objective is split into the terms of its top-level sum, and the
+ * terms are assigned to the blocks that contain their variables.
+ *
+ * Each block is a coek::Model that shares its variables and constraints with
+ * the original model, so a solution of a block is stored in the variables of
+ * the original model.  Fixed variables do not link constraints, and they are
+ * not declared in the blocks.  Variables that do not appear in the model
+ * expressions, and constraints that do not contain free variables, are not
+ * included in any block.  The latter are checked with infeasible().
+ */
+class Decomposition {
+   public:
+    std::shared_ptr<DecompositionRepn> repn;
+
+   public:
+    /** Decompose a model
+     *
+     * \param model  the model that is decomposed
+     */
+    Decomposition(Model& model);
+
+    /** \returns the number of blocks */
+    size_t num_blocks() const;
+    /** \returns the model for the i-th block */
+    Model& block(size_t i);
+    /** \returns the indices of the model variables in the i-th block */
+    const std::vector<size_t>& variables(size_t i) const;
+    /** \returns the indices of the model constraints in the i-th block */
+    const std::vector<size_t>& constraints(size_t i) const;
+    /** \returns the indices of the model constraints that do not contain free variables */
+    const std::vector<size_t>& fixed_constraints() const;
+    /** \returns \c true if a constraint without free variables is violated by the
+     * current values of the fixed variables and parameters */
+    bool infeasible() const;
+};
+
+}  // namespace coek
@@ -0,0 +1,658 @@
+#include "coek/model/fbbt.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "coek/api/constants.hpp"
+#include "coek/api/constraint.hpp"
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/expr_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/ast/visitor.hpp"
+#include "coek/model/model_repn.hpp"
+
+namespace coek {
+
+namespace fbbt {
+
+const double inf = std::numeric_limits<double>::infinity();
+const double pi = 3.14159265358979323846;
+
+//
+// An expression node.  The arguments of a node are stored before it in the list of
+// nodes for a constraint, and nodes for shared subexpressions are reused.
+//
+class Node {
+   public:
+    term_id op;
+    // The arguments of this node in FBBTRepn::args
+    size_t first_arg = 0;
+    size_t num_args = 0;
+    // The variable for VariableTerm and MonomialTerm nodes
+    size_t var = 0;
+    // The value of a ConstantTerm node, or the coefficient of a MonomialTerm node
+    double value = 0;
+    // The term for ParameterTerm nodes, which is evaluated in each forward pass
+    BaseExpressionTerm* term = nullptr;
+};
+
+class Row {
+   public:
+    Constraint con;
+    // The nodes for the constraint body in FBBTRepn::nodes
+    size_t first_node = 0;
+    size_t num_nodes = 0;
+    bool queued = false;
+};
+
+// Returns an interval with bounds of +/- COEK_INFINITY replaced by infinite values
+Interval model_bounds(double lb, double ub)
+{
+    if (lb <= -COEK_INFINITY) lb = -inf;
+    if (ub >= COEK_INFINITY) ub = inf;
+    return Interval(lb, ub);
+}
+
+Interval variable_bounds(const Variable& var)
+{
+    if (var.fixed()) return Interval(var.value());
+    auto bounds = model_bounds(var.lower(), var.upper());
+    if (var.is_binary()) bounds = intersect(bounds, Interval(0, 1));
+    return bounds;
+}
+
+}  // namespace fbbt
+
+using namespace fbbt;
+
+class FBBTRepn {
+   public:
+    Model model;
+    FBBTOptions options;
+    FBBTStatistics stats;
+    bool infeasible = false;
+
+    std::vector<Variable> vars;
+    std::vector<bool> integer;
+    // The current variable bounds, and the bounds that were last read from the model
+    std::vector<Interval> bounds;
+    std::vector<Interval> last_bounds;
+    std::unordered_map<VariableTerm*, size_t> var_index;
+
+    std::vector<Row> rows;
+    std::vector<Node> nodes;
+    std::vector<size_t> args;
+    // The constraints that contain each variable
+    std::vector<std::vector<size_t>> incidence;
+    std::deque<size_t> queue;
+
+    // Node intervals for the constraint that is propagated
+    std::vector<Interval> interval;
+
+   public:
+    FBBTRepn(Model& _model, const FBBTOptions& _options) : model(_model), options(_options) {}
+
+    void initialize();
+    size_t variable(const std::shared_ptr<VariableTerm>& var);
+    size_t compile(const expr_pointer_t& expr, size_t first_node,
+                   std::unordered_map<BaseExpressionTerm*, size_t>& shared);
+
+    void enqueue(size_t i);
+    void enqueue_variable(size_t j, size_t skip);
+    void propagate_row(size_t i);
+    void forward(const Row& row);
+    void backward(const Row& row, size_t i);
+    void narrow(Interval& x, Interval y);
+    void tighten(size_t j, const Interval& value, size_t i);
+    double relax(double value) const
+    {
+        return options.tolerance * std::max(1.0, std::fabs(value));
+    }
+};
+
+void FBBTRepn::initialize()
+{
+    vars.resize(model.repn->variables.size());
+    integer.resize(vars.size());
+    bounds.resize(vars.size());
+    incidence.resize(vars.size());
+    for (size_t j = 0; j < vars.size(); j++) {
+        auto& var = vars[j];
+        var = model.repn->variables[j];
+        integer[j] = var.is_integer() or var.is_binary();
+        bounds[j] = variable_bounds(var);
+        var_index.emplace(var.repn.get(), j);
+    }
+    last_bounds = bounds;
+
+    size_t max_nodes = 0;
+    rows.resize(model.repn->constraints.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+        auto& row = rows[i];
+        row.con = model.repn->constraints[i];
+        row.first_node = nodes.size();
+        std::unordered_map<BaseExpressionTerm*, size_t> shared;
+        compile(row.con.repn->body, row.first_node, shared);
+        row.num_nodes = nodes.size() - row.first_node;
+        max_nodes = std::max(max_nodes, row.num_nodes);
+
+        for (size_t k = row.first_node; k < nodes.size(); k++) {
+            auto& node = nodes[k];
+            if ((node.op == VariableTerm_id) or (node.op == MonomialTerm_id)) {
+                auto& inc = incidence[node.var];
+                if (inc.empty() or (inc.back() != i)) inc.push_back(i);
+            }
+        }
+        enqueue(i);
+    }
+    interval.resize(max_nodes);
+}
+
+size_t FBBTRepn::variable(const std::shared_ptr<VariableTerm>& var)
+{
+    auto it = var_index.find(var.get());
+    if (it == var_index.end())
+        throw std::runtime_error("Cannot tighten bounds in a model with variable "
+                                 + var->get_name() + " that is not declared in the model");
+    return it->second;
+}
+
+// Adds the nodes for an expression, and returns the index of the root node relative to
+// the first node of the constraint.
+size_t FBBTRepn::compile(const expr_pointer_t& expr, size_t first_node,
+                         std::unordered_map<BaseExpressionTerm*, size_t>& shared)
+{
+    // Terms that appear more than once in the expression are represented by a single node
+    auto it = shared.find(expr.get());
+    if (it != shared.end()) return it->second;
+
+    Node node;
+    node.op = expr->id();
+    switch (node.op) {
+        case ConstantTerm_id:
+            node.value = expr->eval();
+            break;
+
+        case IndexParameterTerm_id:
+            // Index parameters are constant when the model is constructed
+            node.op = ConstantTerm_id;
+            node.value = expr->eval();
+            break;
+
+        case ParameterTerm_id:
+            node.term = expr.get();
+            break;
+
+        case VariableTerm_id:
+            node.var = variable(std::dynamic_pointer_cast<VariableTerm>(expr));
+            break;
+
+        case MonomialTerm_id: {
+            auto tmp = std::dynamic_pointer_cast<MonomialTerm>(expr);
+            node.var = variable(tmp->var);
+            node.value = tmp->coef;
+        } break;
+
+        case LinearRowTerm_id: {
+            // A linear row is represented as a sum of monomials
+            auto tmp = std::dynamic_pointer_cast<LinearRowTerm>(expr);
+            node.op = PlusTerm_id;
+            node.first_arg = args.size();
+            node.num_args = tmp->end() - tmp->begin();
+            for (size_t k = tmp->begin(); k < tmp->end(); k++) {
+                Node term;
+                term.op = MonomialTerm_id;
+                term.var = variable(tmp->var(k));
+                term.value = tmp->coef(k);
+                args.push_back(nodes.size() - first_node);
+                nodes.push_back(term);
+            }
+        } break;
+
+        case VariableRefTerm_id:
+        case ParameterRefTerm_id:
+            throw std::runtime_error(
+                "Cannot tighten bounds for a constraint that contains an abstract expression");
+
+        default: {
+            auto tmp = std::dynamic_pointer_cast<ExpressionTerm>(expr);
+            // GCOVR_EXCL_START
+            if (not tmp)
+                throw std::runtime_error("Cannot tighten bounds for expression term "
+                                         + std::to_string(node.op));
+            // GCOVR_EXCL_STOP
+            std::vector<size_t> children(tmp->num_expressions());
+            for (size_t k = 0; k < children.size(); k++)
+                children[k] = compile(tmp->expression(k), first_node, shared);
+            node.first_arg = args.size();
+            node.num_args = children.size();
+            args.insert(args.end(), children.begin(), children.end());
+        }
+    };
+
+    size_t index = nodes.size() - first_node;
+    nodes.push_back(node);
+    shared[expr.get()] = index;
+    return index;
+}
+
+void FBBTRepn::enqueue(size_t i)
+{
+    if (rows[i].queued) return;
+    rows[i].queued = true;
+    queue.push_back(i);
+}
+
+void FBBTRepn::enqueue_variable(size_t j, size_t skip)
+{
+    for (auto i : incidence[j])
+        if (i != skip) enqueue(i);
+}
+
+//
+// Propagation
+//
+
+// Intersects x with y.  An empty intersection is infeasible, unless the gap between the
+// intervals is within the tolerance.
+void FBBTRepn::narrow(Interval& x, Interval y)
+{
+    if (std::isnan(y.lb)) y.lb = -inf;
+    if (std::isnan(y.ub)) y.ub = inf;
+    auto tmp = intersect(x, y);
+    if (tmp.empty()) {
+        if (y.empty())
+            infeasible = true;
+        else if ((y.lb > x.ub) and (y.lb - x.ub <= relax(x.ub)))
+            tmp = Interval(x.ub);
+        else if ((y.ub < x.lb) and (x.lb - y.ub <= relax(x.lb)))
+            tmp = Interval(x.lb);
+        else
+            infeasible = true;
+    }
+    if (not infeasible) x = tmp;
+}
+
+// Tightens the bounds of variable j using a value derived from constraint i
+void FBBTRepn::tighten(size_t j, const Interval& value, size_t i)
+{
+    auto& b = bounds[j];
+    double lb = value.lb - relax(value.lb);
+    double ub = value.ub + relax(value.ub);
+    if (integer[j]) {
+        lb = std::ceil(lb);
+        ub = std::floor(ub);
+    }
+
+    // Small improvements are ignored to avoid a long sequence of tiny updates
+    auto improved = [this](double oldval, double newval) {
+        return std::isinf(oldval)
+               or (std::fabs(newval - oldval)
+                   > options.min_improvement * std::max(1.0, std::fabs(newval)));
+    };
+    bool changed = false;
+    if ((lb > b.lb) and improved(b.lb, lb)) {
+        b.lb = lb;
+        changed = true;
+    }
+    if ((ub < b.ub) and improved(b.ub, ub)) {
+        b.ub = ub;
+        changed = true;
+    }
+    if (b.lb > b.ub) {
+        infeasible = true;
+        return;
+    }
+    if (changed) {
+        stats.tightened_bounds++;
+        enqueue_variable(j, i);
+    }
+}
+
+void FBBTRepn::forward(const Row& row)
+{
+    const Node* node = &nodes[row.first_node];
+    for (size_t k = 0; k < row.num_nodes; k++, node++) {
+        const size_t* arg = args.data() + node->first_arg;
+        auto& value = interval[k];
+        switch (node->op) {
+            case ConstantTerm_id:
+                value = Interval(node->value);
+                break;
+            case ParameterTerm_id:
+                value = Interval(node->term->eval());
+                break;
+            case VariableTerm_id:
+                value = bounds[node->var];
+                break;
+            case MonomialTerm_id:
+                value = Interval(node->value) * bounds[node->var];
+                break;
+            case SubExpressionTerm_id:
+                value = interval[arg[0]];
+                break;
+            case NegateTerm_id:
+                value = -interval[arg[0]];
+                break;
+            case PlusTerm_id:
+                value = Interval(0.0);
+                for (size_t a = 0; a < node->num_args; a++) value = value + interval[arg[a]];
+                break;
+            case TimesTerm_id:
+                if (arg[0] == arg[1])
+                    value = pow(interval[arg[0]], Interval(2.0));
+                else
+                    value = interval[arg[0]] * interval[arg[1]];
+                break;
+            case DivideTerm_id:
+                value = interval[arg[0]] / interval[arg[1]];
+                break;
+            case PowTerm_id:
+                value = pow(interval[arg[0]], interval[arg[1]]);
+                break;
+            // clang-format off
+            case AbsTerm_id:   value = abs(interval[arg[0]]); break;
+            case CeilTerm_id:  value = ceil(interval[arg[0]]); break;
+            case FloorTerm_id: value = floor(interval[arg[0]]); break;
+            case ExpTerm_id:   value = exp(interval[arg[0]]); break;
+            case LogTerm_id:   value = log(interval[arg[0]]); break;
+            case Log10Term_id: value = log10(interval[arg[0]]); break;
+            case SqrtTerm_id:  value = sqrt(interval[arg[0]]); break;
+            case SinTerm_id:   value = sin(interval[arg[0]]); break;
+            case CosTerm_id:   value = cos(interval[arg[0]]); break;
+            case TanTerm_id:   value = tan(interval[arg[0]]); break;
+            case SinhTerm_id:  value = sinh(interval[arg[0]]); break;
+            case CoshTerm_id:  value = cosh(interval[arg[0]]); break;
+            case TanhTerm_id:  value = tanh(interval[arg[0]]); break;
+            case ASinTerm_id:  value = asin(interval[arg[0]]); break;
+            case ACosTerm_id:  value = acos(interval[arg[0]]); break;
+            case ATanTerm_id:  value = atan(interval[arg[0]]); break;
+            case ASinhTerm_id: value = asinh(interval[arg[0]]); break;
+            case ACoshTerm_id: value = acosh(interval[arg[0]]); break;
+            case ATanhTerm_id: value = atanh(interval[arg[0]]); break;
+            // clang-format on
+            // GCOVR_EXCL_START
+            default:
+                throw std::runtime_error("Cannot tighten bounds for expression term "
+                                         + std::to_string(node->op));
+                // GCOVR_EXCL_STOP
+        };
+        // The node is undefined for all values of its arguments
+        if (value.empty()) {
+            infeasible = true;
+            return;
+        }
+    }
+}
+
+namespace fbbt {
+
+// The values of x where x^n is in t, for an integer n > 0
+Interval integer_root(const Interval& x, const Interval& t, int n)
+{
+    double p = 1.0 / n;
+    auto root = [p](double v) { return v < 0 ? -std::pow(-v, p) : std::pow(v, p); };
+    if (n % 2 == 1) return Interval(root(t.lb), root(t.ub));
+
+    auto tmp = intersect(t, Interval(0, inf));
+    if (tmp.empty()) return tmp;
+    double lo = root(tmp.lb);
+    double hi = root(tmp.ub);
+    return hull(intersect(x, Interval(lo, hi)), intersect(x, Interval(-hi, -lo)));
+}
+
+// The values of x where x^n is in t
+Interval inverse_pow(const Interval& x, const Interval& t, double n)
+{
+    if (n == 0) return Interval();
+    if (n == std::floor(n) and (std::fabs(n) < std::numeric_limits<int>::max())) {
+        if (n > 0) return integer_root(x, t, static_cast<int>(n));
+        return integer_root(x, Interval(1.0) / t, static_cast<int>(-n));
+    }
+    // Non-integer exponents are only defined for x >= 0
+    auto tmp = intersect(t, Interval(0, inf));
+    if (tmp.empty()) return tmp;
+    if (n > 0) return Interval(std::pow(tmp.lb, 1 / n), std::pow(tmp.ub, 1 / n));
+    return Interval(std::pow(tmp.ub, 1 / n), std::pow(tmp.lb, 1 / n));
+}
+
+// The values of x where f(x) is in t, for an even function f that is increasing for x >= 0
+// and whose inverse on x >= 0 is finv
+template <typename FN>
+Interval inverse_even(const Interval& x, const Interval& t, double fmin, FN finv)
+{
+    auto tmp = intersect(t, Interval(fmin, inf));
+    if (tmp.empty()) return tmp;
+    double lo = finv(tmp.lb);
+    double hi = finv(tmp.ub);
+    return hull(intersect(x, Interval(lo, hi)), intersect(x, Interval(-hi, -lo)));
+}
+
+}  // namespace fbbt
+
+void FBBTRepn::backward(const Row& row, size_t i)
+{
+    for (size_t k = row.num_nodes; k-- > 0;) {
+        auto& node = nodes[row.first_node + k];
+        const size_t* arg = args.data() + node.first_arg;
+        const auto& t = interval[k];
+
+        switch (node.op) {
+            case VariableTerm_id:
+                tighten(node.var, t, i);
+                break;
+            case MonomialTerm_id:
+                if (node.value != 0) tighten(node.var, t / Interval(node.value), i);
+                break;
+            case SubExpressionTerm_id:
+                narrow(interval[arg[0]], t);
+                break;
+            case NegateTerm_id:
+                narrow(interval[arg[0]], -t);
+                break;
+            case PlusTerm_id: {
+                // The sum of the finite bounds, and the number of infinite bounds
+                double lsum = 0, usum = 0;
+                size_t ninf_lb = 0, ninf_ub = 0;
+                for (size_t a = 0; a < node.num_args; a++) {
+                    auto& x = interval[arg[a]];
+                    if (x.lb == -inf)
+                        ninf_lb++;
+                    else
+                        lsum += x.lb;
+                    if (x.ub == inf)
+                        ninf_ub++;
+                    else
+                        usum += x.ub;
+                }
+                for (size_t a = 0; (a < node.num_args) and not infeasible; a++) {
+                    auto& x = interval[arg[a]];
+                    bool lb_inf = x.lb == -inf;
+                    bool ub_inf = x.ub == inf;
+                    // The bounds on the sum of the other arguments
+                    double rest_lb = (ninf_lb > (lb_inf ? 1U : 0U)) ? -inf
+                                                                     : lsum - (lb_inf ? 0 : x.lb);
+                    double rest_ub = (ninf_ub > (ub_inf ? 1U : 0U)) ? inf
+                                                                     : usum - (ub_inf ? 0 : x.ub);
+                    narrow(x, Interval(t.lb - rest_ub, t.ub - rest_lb));
+                }
+            } break;
+            case TimesTerm_id:
+                if (arg[0] == arg[1])
+                    narrow(interval[arg[0]], integer_root(interval[arg[0]], t, 2));
+                else {
+                    narrow(interval[arg[0]], t / interval[arg[1]]);
+                    if (not infeasible) narrow(interval[arg[1]], t / interval[arg[0]]);
+                }
+                break;
+            case DivideTerm_id:
+                narrow(interval[arg[0]], t * interval[arg[1]]);
+                if (not infeasible) narrow(interval[arg[1]], interval[arg[0]] / t);
+                break;
+            case PowTerm_id: {
+                auto& base = interval[arg[0]];
+                auto& exponent = interval[arg[1]];
+                if (exponent.lb == exponent.ub)
+                    narrow(base, inverse_pow(base, t, exponent.lb));
+                else if ((base.lb == base.ub) and (base.lb > 0) and (base.lb != 1))
+                    narrow(exponent, log(t) / Interval(std::log(base.lb)));
+            } break;
+            case AbsTerm_id:
+                narrow(interval[arg[0]], inverse_even(interval[arg[0]], t, 0.0,
+                                                      [](double v) { return v; }));
+                break;
+            case CoshTerm_id:
+                narrow(interval[arg[0]], inverse_even(interval[arg[0]], t, 1.0,
+                                                      [](double v) { return std::acosh(v); }));
+                break;
+            case CeilTerm_id:
+                narrow(interval[arg[0]], Interval(std::ceil(t.lb) - 1, std::floor(t.ub)));
+                break;
+            case FloorTerm_id:
+                narrow(interval[arg[0]], Interval(std::ceil(t.lb), std::floor(t.ub) + 1));
+                break;
+            case ExpTerm_id:
+                narrow(interval[arg[0]], log(t));
+                break;
+            case LogTerm_id:
+                narrow(interval[arg[0]], exp(t));
+                break;
+            case Log10Term_id:
+                narrow(interval[arg[0]], exp(t * Interval(std::log(10.0))));
+                break;
+            case SqrtTerm_id:
+                narrow(interval[arg[0]], inverse_pow(interval[arg[0]], t, 0.5));
+                break;
+            case SinhTerm_id:
+                narrow(interval[arg[0]], asinh(t));
+                break;
+            case TanhTerm_id:
+                narrow(interval[arg[0]], atanh(t));
+                break;
+            case ASinTerm_id:
+                narrow(interval[arg[0]], sin(intersect(t, Interval(-pi / 2, pi / 2))));
+                break;
+            case ACosTerm_id:
+                narrow(interval[arg[0]], cos(intersect(t, Interval(0, pi))));
+                break;
+            case ATanTerm_id:
+                narrow(interval[arg[0]], tan(intersect(t, Interval(-pi / 2, pi / 2))));
+                break;
+            case ASinhTerm_id:
+                narrow(interval[arg[0]], sinh(t));
+                break;
+            case ACoshTerm_id:
+                narrow(interval[arg[0]], cosh(intersect(t, Interval(0, inf))));
+                break;
+            case ATanhTerm_id:
+                narrow(interval[arg[0]], tanh(t));
+                break;
+            default:
+                // Constants, parameters and the sin, cos and tan functions
+                break;
+        };
+        if (infeasible) return;
+    }
+}
+
+void FBBTRepn::propagate_row(size_t i)
+{
+    auto& row = rows[i];
+    if (row.num_nodes == 0) return;
+    stats.propagations++;
+
+    forward(row);
+    if (infeasible) return;
+
+    auto& con = *row.con.repn;
+    double lb = con.lower ? con.lower->eval() : -inf;
+    double ub = con.is_equality() ? lb : (con.upper ? con.upper->eval() : inf);
+    auto& root = interval[row.num_nodes - 1];
+    narrow(root, model_bounds(lb - relax(lb), ub + relax(ub)));
+    if (infeasible) return;
+
+    backward(row, i);
+}
+
+//
+// FBBT
+//
+
+FBBT::FBBT(Model& model, const FBBTOptions& options)
+{
+    repn = std::make_shared<FBBTRepn>(model, options);
+    repn->initialize();
+}
+
+bool FBBT::propagate()
+{
+    if (repn->infeasible) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    auto& queue = repn->queue;
+    size_t limit = repn->options.max_passes * std::max(size_t(1), repn->rows.size());
+    for (size_t count = 0; (count < limit) and not queue.empty(); count++) {
+        size_t i = queue.front();
+        queue.pop_front();
+        repn->rows[i].queued = false;
+        repn->propagate_row(i);
+        if (repn->infeasible) {
+            for (auto j : queue) repn->rows[j].queued = false;
+            queue.clear();
+            break;
+        }
+    }
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+    repn->stats.time += diff.count();
+
+    return not repn->infeasible;
+}
+
+bool FBBT::infeasible() const { return repn->infeasible; }
+
+Interval FBBT::bounds(const Variable& var) const
+{
+    return repn->bounds[repn->variable(var.repn)];
+}
+
+void FBBT::set_bounds(const Variable& var, double lb, double ub)
+{
+    auto j = repn->variable(var.repn);
+    repn->bounds[j] = model_bounds(lb, ub);
+    repn->enqueue_variable(j, repn->rows.size());
+}
+
+void FBBT::update()
+{
+    for (size_t j = 0; j < repn->vars.size(); j++) {
+        auto tmp = variable_bounds(repn->vars[j]);
+        if (tmp != repn->last_bounds[j]) {
+            repn->last_bounds[j] = tmp;
+            repn->bounds[j] = tmp;
+            repn->enqueue_variable(j, repn->rows.size());
+        }
+    }
+}
+
+void FBBT::apply()
+{
+    for (size_t j = 0; j < repn->vars.size(); j++) {
+        auto& var = repn->vars[j];
+        auto& b = repn->bounds[j];
+        if (var.fixed() or (b == repn->last_bounds[j])) continue;
+        if (b.lb != repn->last_bounds[j].lb) var.lower(b.lb == -inf ? -COEK_INFINITY : b.lb);
+        if (b.ub != repn->last_bounds[j].ub) var.upper(b.ub == inf ? COEK_INFINITY : b.ub);
+        repn->last_bounds[j] = b;
+    }
+}
+
+const FBBTStatistics& FBBT::statistics() const { return repn->stats; }
+
+}  // namespace coek
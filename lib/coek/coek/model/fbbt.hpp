@@ -0,0 +1,99 @@
+#pragma once
+
+#include <memory>
+
+#include <coek/model/model.hpp>
+#include <coek/util/interval.hpp>
+
+namespace coek {
+
+class FBBTRepn;
+
+/**
+ * Options for coek::FBBT.
+ */
+class FBBTOptions {
+   public:
+    /** The tolerance used to relax derived bounds and to detect infeasibility */
+    double tolerance = 1e-8;
+    /** The relative improvement needed to tighten a variable bound */
+    double min_improvement = 1e-4;
+    /** The maximum number of constraint propagations in a call to propagate(), as a multiple of
+     * the number of constraints */
+    size_t max_passes = 20;
+};
+
+/**
+ * Statistics for coek::FBBT.
+ */
+class FBBTStatistics {
+   public:
+    /** The number of times that a constraint has been propagated */
+    size_t propagations = 0;
+    /** The number of variable bounds that have been tightened */
+    size_t tightened_bounds = 0;
+    /** The time (in seconds) spent propagating bounds */
+    double time = 0;
+};
+
+/**
+ * Feasibility-based bound tightening for the constraints in a model.
+ *
+ * Each constraint body is compiled into a list of expression nodes.  Bounds are
+ * propagated through a constraint by computing node intervals with interval
+ * arithmetic (the forward pass), intersecting the root interval with the
+ * constraint bounds, and then computing intervals for the arguments of each
+ * node from the node interval (the backward pass).  The sin, cos and tan
+ * functions are only used in the forward pass.
+ *
+ * When a variable bound is tightened, the constraints that contain the
+ * variable are queued, and propagate() continues until the queue is empty.
+ * Later calls only propagate the constraints that are affected by bound
+ * changes, so bounds can be updated incrementally.
+ *
+ * Bounds are stored in this object, and they are copied to the model variables
+ * by apply().  Constraints that are added to the model after this object is
+ * created are ignored.
+ */
+class FBBT {
+   public:
+    std::shared_ptr<FBBTRepn> repn;
+
+   public:
+    /** Create an FBBT object for a model
+     *
+     * \param model  the model whose constraints are used to tighten bounds
+     * \param options  options that control bound tightening
+     */
+    FBBT(Model& model, const FBBTOptions& options = FBBTOptions());
+
+    /** Propagate bounds through the queued constraints until no bounds are tightened
+     *
+     * All constraints are queued when this object is created.
+     *
+     * \returns \c false if the constraints are infeasible
+     */
+    bool propagate();
+    /** \returns \c true if propagation found that the constraints are infeasible */
+    bool infeasible() const;
+
+    /** \returns the bounds of a variable */
+    Interval bounds(const Variable& var) const;
+    /** Set the bounds of a variable, and queue the constraints that contain it
+     *
+     * \param var  the variable
+     * \param lb  the lower bound
+     * \param ub  the upper bound
+     */
+    void set_bounds(const Variable& var, double lb, double ub);
+    /** Read the bounds of the model variables, and queue the constraints that contain
+     * variables whose bounds have changed */
+    void update();
+    /** Set the bounds of the model variables to the tightened bounds */
+    void apply();
+
+    /** \returns statistics for bound propagation */
+    const FBBTStatistics& statistics() const;
+};
+
+}  // namespace coek
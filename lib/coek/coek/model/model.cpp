@@ -5,13 +5,18 @@
 #include <sstream>
 #include <unordered_set>
 
+#include "../ast/constraint_terms.hpp"
 #include "../ast/value_terms.hpp"
 #include "../ast/varray.hpp"
+#include "../ast/visitor_fns.hpp"
 #include "../util/string_utils.hpp"
 #include "../util/map_utils.hpp"
 #include "coek/api/constraint.hpp"
 #include "coek/api/objective.hpp"
 #include "coek/model/model.hpp"
+#include "coek/util/compressed_file.hpp"
+#include "coek/util/id_index.hpp"
+#include "coek/util/reorder.hpp"
 #include "model_repn.hpp"
 
 namespace coek {
@@ -308,6 +313,14 @@ void Model::name_generation(Model::NameGeneration value) { repn->name_generation
 
 Model::NameGeneration Model::name_generation() { return repn->name_generation_policy; }
 
+void Model::num_writer_threads(size_t value) { repn->num_writer_threads = value; }
+
+size_t Model::num_writer_threads() { return repn->num_writer_threads; }
+
+void Model::ordering(Model::Ordering value) { repn->ordering = value; }
+
+Model::Ordering Model::ordering() { return repn->ordering; }
+
 void Model::set_suffix(const std::string& name, Variable& var, double value)
 {
     repn->vsuffix[name].emplace(var.id(), value);
@@ -358,10 +371,15 @@ void write_lp_problem(Model& model, const std::string& fname, std::map<size_t, s
 void write_nl_problem(Model& model, const std::string& fname, std::map<size_t, size_t>& varmap,
                       std::map<size_t, size_t>& conmap);
 
+void write_mps_problem(Model& model, const std::string& fname, std::map<size_t, size_t>& varmap,
+                       std::map<size_t, size_t>& conmap);
+
 void write_lp_problem_ostream(Model& model, const std::string& fname,
                               std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
 void write_nl_problem_ostream(Model& model, const std::string& fname,
                               std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
+void write_nl_problem_binary(Model& model, const std::string& fname,
+                             std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
 #ifdef WITH_FMTLIB
 void write_lp_problem_fmtlib(Model& model, const std::string& fname,
                              std::map<size_t, size_t>& varmap, std::map<size_t, size_t>& conmap);
@@ -389,6 +407,22 @@ void Model::write(const std::string& fname, std::map<size_t, size_t>& varmap,
 #endif
     }
 
+    // Compressed files are written with the fmtlib writers
+    std::string base;
+    if (compression_from_suffix(fname, base) != Compression::none) {
+#ifdef WITH_FMTLIB
+        if (ends_with(base, ".lp") or ends_with(base, ".fmtlp")) {
+            write_lp_problem_fmtlib(*this, fname, varmap, conmap);
+            return;
+        }
+        else if (ends_with(base, ".nl") or ends_with(base, ".fmtnl")) {
+            write_nl_problem_fmtlib(*this, fname, varmap, conmap);
+            return;
+        }
+#endif
+        throw std::runtime_error("Compressed output is not supported for: " + fname);
+    }
+
     if (ends_with(fname, ".lp")) {
         write_lp_problem(*this, fname, varmap, conmap);
         return;
@@ -406,6 +440,11 @@ void Model::write(const std::string& fname, std::map<size_t, size_t>& varmap,
     }
 #endif
 
+    else if (ends_with(fname, ".mps")) {
+        write_mps_problem(*this, fname, varmap, conmap);
+        return;
+    }
+
     else if (ends_with(fname, ".nl")) {
         write_nl_problem(*this, fname, varmap, conmap);
         return;
@@ -416,6 +455,11 @@ void Model::write(const std::string& fname, std::map<size_t, size_t>& varmap,
         return;
     }
 
+    else if (ends_with(fname, ".bnl")) {
+        write_nl_problem_binary(*this, fname, varmap, conmap);
+        return;
+    }
+
 #ifdef WITH_FMTLIB
     else if (ends_with(fname, ".fmtnl")) {
         write_nl_problem_fmtlib(*this, fname, varmap, conmap);
@@ -426,38 +470,81 @@ void Model::write(const std::string& fname, std::map<size_t, size_t>& varmap,
     throw std::runtime_error("Unknown problem type: " + fname);
 }
 
-void check_that_expression_variables_are_declared(Model& model,
-                                                  const std::map<size_t, Variable>& varobj)
+void index_model_variables(Model& model, IdIndex& declared)
 {
-    std::unordered_set<size_t> model_ids;
+    std::vector<size_t> ids(model.repn->variables.size());
+    size_t i = 0;
+    for (auto& it : model.repn->variables) ids[i++] = it.id();
+    declared.initialize(ids);
+}
 
-    for (auto& it : model.repn->variables) model_ids.insert(it.id());
+//
+// Order the variables and constraints of a model using its ordering policy.  The
+// var_order and con_order vectors contain the positions of the model variables and
+// constraints in the new ordering.  The objectives are included in the incidence
+// graph, so variables that only appear in objectives are ordered near their
+// neighbors.  Fixed variables and undeclared variables are ignored.
+//
+void model_ordering(Model& model, std::vector<size_t>& var_order, std::vector<size_t>& con_order)
+{
+    auto& mrepn = *model.repn;
+    size_t nvars = mrepn.variables.size();
+    size_t ncons = mrepn.constraints.size();
+    if (mrepn.ordering == Model::Ordering::creation) {
+        var_order.resize(nvars);
+        for (size_t j = 0; j < nvars; j++) var_order[j] = j;
+        con_order.resize(ncons);
+        for (size_t i = 0; i < ncons; i++) con_order[i] = i;
+        return;
+    }
 
-    // TODO - Make this faster because both sets are ordered
-    for (auto& it : varobj) {
-        auto tmp = model_ids.find(it.first);
-        if (tmp == model_ids.end()) {
-            throw std::runtime_error("Model expressions contain variable '" + it.second.name()
-                                     + "' that is not declared in the model.");
+    IdIndex declared;
+    index_model_variables(model, declared);
+    std::vector<size_t> start{0};
+    std::vector<size_t> index;
+    auto add_row = [&](const expr_pointer_t& expr) {
+        std::unordered_set<VariableRepn> vars;
+        find_variables(expr, vars);
+        for (auto& var : vars) {
+            size_t j = declared.find(var->index);
+            if (j != IdIndex::npos) index.push_back(j);
         }
+        start.push_back(index.size());
+    };
+    for (auto& con : mrepn.constraints) add_row(con.repn);
+    for (auto& obj : mrepn.objectives) add_row(obj.repn);
+
+    std::vector<size_t> row_order;
+    rcm_ordering(start.size() - 1, nvars, start, index, row_order, var_order);
+    con_order.clear();
+    con_order.reserve(ncons);
+    for (auto i : row_order)
+        if (i < ncons) con_order.push_back(i);
+}
+
+void check_that_expression_variables_are_declared(const IdIndex& declared,
+                                                  const std::vector<VariableRepn>& vars)
+{
+    // Report the undeclared variable with the smallest id
+    VariableRepn undeclared;
+    for (auto& it : vars) {
+        if ((declared.find(it->index) == IdIndex::npos)
+            and ((not undeclared) or (it->index < undeclared->index)))
+            undeclared = it;
     }
+    if (undeclared)
+        throw std::runtime_error("Model expressions contain variable '" + undeclared->name
+                                 + "' that is not declared in the model.");
 }
 
 void check_that_expression_variables_are_declared(
     Model& model, const std::unordered_set<std::shared_ptr<VariableTerm>>& vars)
 {
-    std::unordered_set<size_t> model_ids;
+    IdIndex declared;
+    index_model_variables(model, declared);
 
-    for (auto& it : model.repn->variables) model_ids.insert(it.id());
-
-    // TODO - Make this faster because both sets are ordered
-    for (auto& it : vars) {
-        auto tmp = model_ids.find(it->index);
-        if (tmp == model_ids.end()) {
-            throw std::runtime_error("Model expressions contain variable '" + it->name
-                                     + "' that is not declared in the model.");
-        }
-    }
+    check_that_expression_variables_are_declared(
+        declared, std::vector<VariableRepn>(vars.begin(), vars.end()));
 }
 
 }  // namespace coek
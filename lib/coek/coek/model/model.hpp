@@ -32,7 +32,9 @@ class ParameterArray;
 class VariableArray;
 class ConstraintMap;
 #endif
+class LinearConstraintBlock;
 class ModelRepn;
+class StandardForm;
 
 //
 // Coek Model
@@ -58,6 +60,13 @@ class Model {
 
     /** The different policies for name generation. */
     enum NameGeneration { simple, lazy, eager };
+    /** The orderings of variables and constraints used by model writers and NLP models.
+     *
+     * The \c creation ordering follows the order that variables and constraints are
+     * added to the model.  The \c rcm ordering is a reverse Cuthill-McKee ordering of
+     * the variable-constraint incidence graph, which reduces the bandwidth of the
+     * constraint Jacobian. */
+    enum Ordering { creation, rcm };
 
     std::shared_ptr<ModelRepn> repn;
 
@@ -198,6 +207,14 @@ class Model {
     void add_constraint(ConstraintMap& expr);
     void add(ConstraintMap& expr);
 #endif
+    /**
+     * Add the rows of a linear constraint block to the model.
+     *
+     * The constraints for the rows are created when the block is first added to
+     * a model, and they are added in the order of the rows.
+     */
+    void add_constraint(LinearConstraintBlock& block);
+    void add(LinearConstraintBlock& block);
 
     /** \returns the i-th constraint that was added */
     Constraint get_constraint(size_t i);
@@ -259,7 +276,14 @@ class Model {
     // I/O
     //
 
-    /** Write the model to the specified file */
+    /** Write the model to the specified file
+     *
+     * The file format is determined by the filename suffix:  \c .lp for LP files, \c .nl for
+     * NL files, and \c .bnl for binary NL files.
+     *
+     * \note The binary NL format is experimental.  It is only validated against the
+     * ASL reader in builds that include the ASL.
+     */
     void write(const std::string& filename);
     /** Write the model to the specified file
      *
@@ -278,11 +302,58 @@ class Model {
     /** Print the values in the model to the specified output stream */
     void print_values(std::ostream& ostr);
 
+    /** Save the model in a binary snapshot file
+     *
+     * A snapshot contains the expressions, variables, parameters, objectives,
+     * constraints, names and suffixes in the model.  Variable arrays and maps are
+     * saved as individual variables.
+     *
+     * \param filename  the snapshot file
+     */
+    void save_snapshot(const std::string& filename);
+    /** Load a model from a binary snapshot file
+     *
+     * The snapshot file is memory-mapped when the platform supports it.
+     *
+     * \param filename  the snapshot file
+     *
+     * \returns a model object
+     */
+    static Model load_snapshot(const std::string& filename);
+
+    /** Compute the standard form of a linear or quadratic model
+     *
+     * The constraint matrix, bounds, objective coefficients and integrality
+     * flags are stored in contiguous arrays.  The standard form is cached, and
+     * it is recomputed when the variables, constraints or objectives of the
+     * model change, or when a fixed variable changes.  The row and column bounds
+     * are updated each time this method is called, but changes to the values of
+     * parameters in the model expressions are only included when the standard
+     * form is recomputed.
+     *
+     * \param recompute  if \c true, then the cached standard form is recomputed
+     *
+     * \returns the standard form of the model
+     */
+    const StandardForm& to_standard_form(bool recompute = false);
+
     friend std::ostream& operator<<(std::ostream& ostr, const Model& arg);
 
     void generate_names();
     void name_generation(Model::NameGeneration value);
     Model::NameGeneration name_generation();
+    /** Set the number of threads used to write model files
+     *
+     * Model files are written serially by default.  A value of 0 uses all
+     * hardware threads.
+     */
+    void num_writer_threads(size_t value);
+    /** \returns the number of threads used to write model files */
+    size_t num_writer_threads();
+    /** Set the ordering of variables and constraints used by NL files and NLP models */
+    void ordering(Model::Ordering value);
+    /** \returns the ordering of variables and constraints used by NL files and NLP models */
+    Model::Ordering ordering();
 };
 
 //
@@ -321,4 +392,34 @@ Model read_problem_from_jpof_file(const std::string& filename,
 Model read_problem_from_jpof_string(const std::string& jpof,
                                     std::map<std::string, Parameter>& params);
 
+/**
+ * Read a problem from an NL file
+ *
+ * Text and binary NL files are supported, and files compressed with gzip or
+ * zstd are decompressed while they are read.  NL files do not contain names,
+ * so the variables, constraints and objectives in the model are unnamed.  The
+ * variable types are inferred from the order of the variables, using the
+ * conventions of the coek NL writer.
+ *
+ * \param filename   the NL file that is read
+ *
+ * \returns a model object
+ */
+Model read_problem_from_nl_file(const std::string& filename);
+
+/**
+ * Read a problem from an LP file
+ *
+ * The file may contain linear and quadratic objectives and constraints,
+ * variable bounds, and integer and binary variables.  Files compressed with
+ * gzip or zstd are decompressed while they are read.  Variables are created in
+ * the order that they appear in the file, and they are non-negative unless
+ * other bounds are specified.
+ *
+ * \param filename   the LP file that is read
+ *
+ * \returns a model object
+ */
+Model read_problem_from_lp_file(const std::string& filename);
+
 }  // namespace coek
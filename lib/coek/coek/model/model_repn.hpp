@@ -23,6 +23,8 @@
 
 namespace coek {
 
+class StandardFormCache;
+
 //
 // ModelRepn
 //
@@ -53,6 +55,13 @@ class ModelRepn {
     std::map<std::string, double> msuffix;
 
     Model::NameGeneration name_generation_policy = Model::NameGeneration::simple;
+    // The number of threads used by model writers (0 uses all hardware threads).  Models
+    // are written serially by default.
+    size_t num_writer_threads = 1;
+    // The ordering of variables and constraints used by NL files and NLP models
+    Model::Ordering ordering = Model::Ordering::creation;
+    // The cached standard form of the model
+    std::shared_ptr<StandardFormCache> standard_form;
 };
 
 #ifdef COEK_WITH_COMPACT_MODEL
@@ -133,6 +142,10 @@ class CompactModelRepn {
     std::vector<std::string> variable_names;
     std::map<std::string, std::variant<CompactVariableMap, ObjectiveMap, CompactConstraintMap>>
         mapped_data;
+
+    // The number of threads used by model writers (0 uses all hardware threads).  Models
+    // are written serially by default.
+    size_t num_writer_threads = 1;
 };
 
 #endif
@@ -1,5 +1,7 @@
 #include "coek/model/nlp_model.hpp"
 
+#include <cassert>
+
 #include "coek/api/constraint.hpp"
 #include "coek/api/objective.hpp"
 #include "coek/autograd/autograd.hpp"
@@ -31,6 +33,19 @@ void NLPModel::initialize(Model& model, std::string type, bool sparse_JH)
 
 void NLPModel::reset() { repn->reset(); }
 
+NLPModel NLPModel::clone_workspace() const
+{
+    NLPModel tmp;
+    tmp.repn = std::shared_ptr<NLPModelRepn>(repn->clone_workspace());
+    return tmp;
+}
+
+void NLPModel::set_num_threads(size_t nthreads) { repn->set_num_threads(nthreads); }
+
+size_t NLPModel::num_threads() const { return repn->nthreads; }
+
+bool NLPModel::thread_safe() const { return repn->thread_safe(); }
+
 size_t NLPModel::num_variables() const { return repn->num_variables(); }
 
 size_t NLPModel::num_objectives() const { return repn->num_objectives(); }
@@ -70,16 +85,47 @@ double NLPModel::compute_f(size_t i) { return repn->compute_f(i); }
 
 void NLPModel::compute_df(double& f, std::vector<double>& df, size_t i)
 {
-    repn->compute_df(f, df, i);
+    assert(df.size() == repn->num_variables());
+    repn->compute_df(f, df.data(), i);
+}
+
+void NLPModel::compute_df(double& f, double* df, size_t i) { repn->compute_df(f, df, i); }
+
+void NLPModel::compute_H(std::vector<double>& w, std::vector<double>& H)
+{
+    assert(w.size() == repn->num_objectives() + repn->num_constraints());
+    assert(H.size() == repn->num_nonzeros_Hessian_Lagrangian());
+    repn->compute_H(w.data(), w.data() + repn->num_objectives(), H.data());
 }
 
-void NLPModel::compute_H(std::vector<double>& w, std::vector<double>& H) { repn->compute_H(w, H); }
+void NLPModel::compute_H(const double* fw, const double* cw, double* H)
+{
+    repn->compute_H(fw, cw, H);
+}
+
+void NLPModel::compute_c(std::vector<double>& c)
+{
+    assert(c.size() == repn->num_constraints());
+    repn->compute_c(c.data());
+}
 
-void NLPModel::compute_c(std::vector<double>& c) { repn->compute_c(c); }
+void NLPModel::compute_c(double* c) { repn->compute_c(c); }
 
-void NLPModel::compute_dc(std::vector<double>& dc, size_t i) { repn->compute_dc(dc, i); }
+void NLPModel::compute_dc(std::vector<double>& dc, size_t i)
+{
+    assert(dc.size() == repn->num_variables());
+    repn->compute_dc(dc.data(), i);
+}
+
+void NLPModel::compute_dc(double* dc, size_t i) { repn->compute_dc(dc, i); }
+
+void NLPModel::compute_J(std::vector<double>& J)
+{
+    assert(J.size() == repn->num_nonzeros_Jacobian());
+    repn->compute_J(J.data());
+}
 
-void NLPModel::compute_J(std::vector<double>& J) { repn->compute_J(J); }
+void NLPModel::compute_J(double* J) { repn->compute_J(J); }
 
 void NLPModel::write(std::string fname)
 {
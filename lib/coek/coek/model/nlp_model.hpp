@@ -38,6 +38,35 @@ class NLPModel {
     /** TODO - maybe this should be called 'update' */
     void reset();
 
+    /**
+     * Create an NLP model view that shares the model of this view, but which
+     * has its own evaluation workspace.
+     *
+     * The views can be evaluated concurrently in different threads.  The CppAD
+     * backend shares the sparsity patterns, but each view has its own copy of
+     * the CppAD tape, since CppAD stores its sweep data with the tape.  The ASL
+     * backend creates a new ASL instance for each view.
+     *
+     * \returns the new NLP model view
+     */
+    NLPModel clone_workspace() const;
+
+    /**
+     * Set the number of threads used to evaluate the model.
+     *
+     * The ASL backend partitions the constraints into blocks that are
+     * evaluated concurrently by compute_c() and compute_J(), if the ASL library
+     * is built with MULTIPLE_THREADS, and otherwise it uses one thread.  Other
+     * backends ignore this value.
+     *
+     * \param nthreads  the number of threads (0 uses all hardware threads)
+     */
+    void set_num_threads(size_t nthreads);
+    /** \returns the number of threads used to evaluate the model */
+    size_t num_threads() const;
+    /** \returns \c true if the model can be evaluated concurrently by different threads */
+    bool thread_safe() const;
+
     /** \returns the number of variables in the model */
     size_t num_variables() const;
     /** \returns the number of objectives in the model */
@@ -153,6 +182,16 @@ class NLPModel {
      * \param i   objective index
      */
     void compute_df(double& f, std::vector<double>& df, size_t i);
+    /**
+     * Compute the value and gradient of the i-th objective function.
+     *
+     * This method uses the variable values stored in the model.
+     *
+     * \param f   reference that stores the objective value
+     * \param df   array of length num_variables() that stores the gradient
+     * \param i   objective index
+     */
+    void compute_df(double& f, double* df, size_t i);
     /**
      * Compute the value and gradient of the 0-th objective function.
      *
@@ -226,6 +265,16 @@ class NLPModel {
      * \param H   reference that stores the Hessian
      */
     void compute_H(std::vector<double>& w, std::vector<double>& H);
+    /**
+     * Compute the Hessian of Lagrangian
+     *
+     * This method uses the variable values stored in the model.
+     *
+     * \param fw   array of length num_objectives() with the objective weights
+     * \param cw   array of length num_constraints() with the constraint weights
+     * \param H   array of length num_nonzeros_Hessian_Lagrangian() that stores the Hessian
+     */
+    void compute_H(const double* fw, const double* cw, double* H);
     /**
      * Compute the Hessian of Lagrangian
      *
@@ -249,6 +298,14 @@ class NLPModel {
      * \param c   reference that stores the constraint values
      */
     void compute_c(std::vector<double>& c);
+    /**
+     * Compute constraint values
+     *
+     * This method uses the variable values stored in the model.
+     *
+     * \param c   array of length num_constraints() that stores the constraint values
+     */
+    void compute_c(double* c);
     /**
      * Compute constraint values
      *
@@ -272,6 +329,15 @@ class NLPModel {
      * \param i   constraint index
      */
     void compute_dc(std::vector<double>& dc, size_t i);
+    /**
+     * Compute the gradient of the i-th constraint function.
+     *
+     * This method uses the variable values stored in the model.
+     *
+     * \param dc   array of length num_variables() that stores the gradient
+     * \param i   constraint index
+     */
+    void compute_dc(double* dc, size_t i);
     /**
      * Compute the gradient of the i-th constraint function.
      *
@@ -295,6 +361,14 @@ class NLPModel {
      * \param J   reference that stores the Jacobian
      */
     void compute_J(std::vector<double>& J);
+    /**
+     * Compute the Jacobian
+     *
+     * This method uses the variable values stored in the model.
+     *
+     * \param J   array of length num_nonzeros_Jacobian() that stores the Jacobian
+     */
+    void compute_J(double* J);
     /**
      * Compute the Jacobian
      *
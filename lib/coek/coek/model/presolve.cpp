@@ -0,0 +1,769 @@
+#include "coek/model/presolve.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "coek/api/constants.hpp"
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/expression_visitor.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/model/model_repn.hpp"
+
+namespace coek {
+
+namespace presolve {
+
+const size_t none = std::numeric_limits<size_t>::max();
+
+// Bounds whose magnitude exceeds this value are not derived from constraint activities
+const double max_derived_bound = 1e10;
+// The relative improvement needed to tighten a bound using constraint activities
+const double min_improvement = 1e-3;
+
+enum class RowStatus { Active, Nonlinear, Empty, Free, Singleton, Duplicate };
+
+typedef std::vector<std::pair<size_t, double>> LinearTerms;
+typedef std::vector<std::tuple<size_t, size_t, double>> QuadraticTerms;
+
+class PresolveVariable {
+   public:
+    Variable var;
+    double lb;
+    double ub;
+    bool integer;
+    // Variables in nonlinear constraints and objectives are not removed
+    bool keep = false;
+    bool removed = false;
+    double value = 0;
+
+    // The original bound expressions
+    expr_pointer_t orig_lb;
+    expr_pointer_t orig_ub;
+};
+
+class PresolveRow {
+   public:
+    Constraint con;
+    RowStatus status = RowStatus::Active;
+    // True if the row differs from the original constraint
+    bool modified = false;
+
+    double lower = -COEK_INFINITY;
+    double upper = COEK_INFINITY;
+    LinearTerms linear;
+    QuadraticTerms quadratic;
+
+    // The rows that define the lower and upper bounds, and the ratio of their
+    // coefficients to the coefficients in this row
+    size_t lower_source = none;
+    size_t upper_source = none;
+    double lower_ratio = 1;
+    double upper_ratio = 1;
+
+    // The variable and coefficient in a singleton row
+    size_t var = none;
+    double coef = 0;
+
+    // The constraint in the reduced model
+    Constraint reduced;
+};
+
+class PresolveObjective {
+   public:
+    Objective obj;
+    bool nonlinear = false;
+    bool modified = false;
+    double constant = 0;
+    LinearTerms linear;
+    QuadraticTerms quadratic;
+};
+
+}  // namespace presolve
+
+using namespace presolve;
+
+class PresolveRepn {
+   public:
+    Model model;
+    Model reduced;
+    PresolveOptions options;
+    PresolveStatistics stats;
+    bool infeasible = false;
+    bool bounds_applied = false;
+
+    std::vector<PresolveVariable> vars;
+    std::unordered_map<VariableTerm*, size_t> var_index;
+    std::vector<PresolveRow> rows;
+    std::vector<PresolveObjective> objs;
+
+    PresolveRepn(Model& _model, const PresolveOptions& _options)
+        : model(_model), options(_options)
+    {
+    }
+
+    void presolve();
+
+    void collect_variables();
+    size_t variable(const VariableRepn& var);
+    void collect_terms(MutableNLPExpr& repn, double& constant, LinearTerms& linear,
+                       QuadraticTerms& quadratic);
+    void collect_rows();
+    void collect_objectives();
+
+    bool fix_variables();
+    bool substitute(double& constant, LinearTerms& linear, QuadraticTerms& quadratic);
+    bool reduce_row(size_t i);
+    bool tighten_lower(size_t j, double value, double threshold);
+    bool tighten_upper(size_t j, double value, double threshold);
+    bool check_bounds(size_t j);
+    bool remove_duplicate_rows();
+    bool tighten_bounds(PresolveRow& row);
+
+    Expression expression(double constant, const LinearTerms& linear,
+                          const QuadraticTerms& quadratic);
+    void create_reduced_model();
+
+    void apply_bounds();
+    void restore_bounds();
+    void postsolve();
+};
+
+//
+// Collect the variables, constraints and objectives
+//
+
+void PresolveRepn::collect_variables()
+{
+    vars.resize(model.repn->variables.size());
+    for (size_t j = 0; j < vars.size(); j++) {
+        auto& v = vars[j];
+        v.var = model.repn->variables[j];
+        v.orig_lb = v.var.repn->lb;
+        v.orig_ub = v.var.repn->ub;
+        v.lb = v.var.lower();
+        v.ub = v.var.upper();
+        v.integer = v.var.is_integer() or v.var.is_binary();
+        if (v.var.is_binary()) {
+            v.lb = std::max(v.lb, 0.0);
+            v.ub = std::min(v.ub, 1.0);
+        }
+        var_index.emplace(v.var.repn.get(), j);
+    }
+}
+
+size_t PresolveRepn::variable(const VariableRepn& var)
+{
+    auto it = var_index.find(var.get());
+    if (it == var_index.end())
+        throw std::runtime_error("Cannot presolve a model with variable " + var->get_name()
+                                 + " that is not declared in the model");
+    return it->second;
+}
+
+void PresolveRepn::collect_terms(MutableNLPExpr& repn, double& constant, LinearTerms& linear,
+                                 QuadraticTerms& quadratic)
+{
+    constant = repn.constval->eval();
+
+    // Merge the terms for each variable, and sort them by variable index
+    std::unordered_map<size_t, double> coefs;
+    for (size_t k = 0; k < repn.linear_vars.size(); k++)
+        coefs[variable(repn.linear_vars[k])] += repn.linear_coefs[k]->eval();
+    linear.reserve(coefs.size());
+    for (auto& [j, coef] : coefs)
+        if (coef != 0) linear.emplace_back(j, coef);
+    std::sort(linear.begin(), linear.end());
+
+    for (size_t k = 0; k < repn.quadratic_lvars.size(); k++) {
+        double coef = repn.quadratic_coefs[k]->eval();
+        if (coef != 0)
+            quadratic.emplace_back(variable(repn.quadratic_lvars[k]),
+                                   variable(repn.quadratic_rvars[k]), coef);
+    }
+}
+
+void PresolveRepn::collect_rows()
+{
+    rows.resize(model.repn->constraints.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+        auto& row = rows[i];
+        row.con = model.repn->constraints[i];
+
+        MutableNLPExpr repn;
+        repn.collect_terms(row.con);
+
+        auto ineq = std::dynamic_pointer_cast<InequalityTerm>(row.con.repn);
+        if ((repn.nonlinear != ZeroConstant) or (ineq and ineq->strict)) {
+            row.status = RowStatus::Nonlinear;
+            for (auto& v : repn.linear_vars) vars[variable(v)].keep = true;
+            for (auto& v : repn.quadratic_lvars) vars[variable(v)].keep = true;
+            for (auto& v : repn.quadratic_rvars) vars[variable(v)].keep = true;
+            for (auto& v : repn.nonlinear_vars) vars[variable(v)].keep = true;
+            continue;
+        }
+
+        double constant;
+        collect_terms(repn, constant, row.linear, row.quadratic);
+        if (row.con.has_lower()) row.lower = row.con.lower().value() - constant;
+        if (row.con.is_equality())
+            row.upper = row.lower;
+        else if (row.con.has_upper())
+            row.upper = row.con.upper().value() - constant;
+    }
+}
+
+void PresolveRepn::collect_objectives()
+{
+    objs.resize(model.repn->objectives.size());
+    for (size_t i = 0; i < objs.size(); i++) {
+        auto& obj = objs[i];
+        obj.obj = model.repn->objectives[i];
+
+        MutableNLPExpr repn;
+        repn.collect_terms(obj.obj);
+
+        if (repn.nonlinear != ZeroConstant) {
+            obj.nonlinear = true;
+            for (auto& v : repn.linear_vars) vars[variable(v)].keep = true;
+            for (auto& v : repn.quadratic_lvars) vars[variable(v)].keep = true;
+            for (auto& v : repn.quadratic_rvars) vars[variable(v)].keep = true;
+            for (auto& v : repn.nonlinear_vars) vars[variable(v)].keep = true;
+            continue;
+        }
+
+        collect_terms(repn, obj.constant, obj.linear, obj.quadratic);
+    }
+}
+
+//
+// Reductions
+//
+
+bool PresolveRepn::fix_variables()
+{
+    bool changed = false;
+    for (auto& v : vars) {
+        if (v.removed or v.keep) continue;
+        if (v.var.fixed())
+            v.value = v.var.value();
+        else if ((v.lb > -COEK_INFINITY) and (v.ub - v.lb <= options.tolerance))
+            v.value = v.lb;
+        else
+            continue;
+        v.removed = true;
+        stats.fixed_variables++;
+        changed = true;
+    }
+    return changed;
+}
+
+// Replace removed variables with their values
+bool PresolveRepn::substitute(double& constant, LinearTerms& linear, QuadraticTerms& quadratic)
+{
+    bool changed = false;
+
+    size_t n = 0;
+    for (auto& term : linear) {
+        auto& v = vars[term.first];
+        if (v.removed) {
+            constant += term.second * v.value;
+            changed = true;
+        }
+        else
+            linear[n++] = term;
+    }
+    linear.resize(n);
+
+    if (quadratic.size() > 0) {
+        LinearTerms extra;
+        n = 0;
+        for (auto& term : quadratic) {
+            auto& [i, j, coef] = term;
+            auto& vi = vars[i];
+            auto& vj = vars[j];
+            if (vi.removed and vj.removed)
+                constant += coef * vi.value * vj.value;
+            else if (vi.removed)
+                extra.emplace_back(j, coef * vi.value);
+            else if (vj.removed)
+                extra.emplace_back(i, coef * vj.value);
+            else {
+                quadratic[n++] = term;
+                continue;
+            }
+            changed = true;
+        }
+        quadratic.resize(n);
+
+        // Merge the new linear terms
+        if (extra.size() > 0) {
+            linear.insert(linear.end(), extra.begin(), extra.end());
+            std::sort(linear.begin(), linear.end());
+            n = 0;
+            for (size_t k = 0; k < linear.size(); k++) {
+                if ((n > 0) and (linear[n - 1].first == linear[k].first))
+                    linear[n - 1].second += linear[k].second;
+                else
+                    linear[n++] = linear[k];
+            }
+            linear.resize(n);
+            linear.erase(std::remove_if(linear.begin(), linear.end(),
+                                        [](const auto& term) { return term.second == 0; }),
+                         linear.end());
+        }
+    }
+
+    return changed;
+}
+
+bool PresolveRepn::check_bounds(size_t j)
+{
+    auto& v = vars[j];
+    if (v.lb > v.ub) {
+        if (v.lb - v.ub > options.tolerance * std::max(1.0, std::fabs(v.ub))) {
+            infeasible = true;
+            return false;
+        }
+        v.lb = v.ub;
+    }
+    return true;
+}
+
+bool PresolveRepn::tighten_lower(size_t j, double value, double threshold)
+{
+    auto& v = vars[j];
+    if (v.integer) value = std::ceil(value - options.tolerance);
+    if ((v.lb > -COEK_INFINITY) and (value - v.lb <= threshold * std::max(1.0, std::fabs(v.lb))))
+        return false;
+    v.lb = value;
+    return check_bounds(j);
+}
+
+bool PresolveRepn::tighten_upper(size_t j, double value, double threshold)
+{
+    auto& v = vars[j];
+    if (v.integer) value = std::floor(value + options.tolerance);
+    if ((v.ub < COEK_INFINITY) and (v.ub - value <= threshold * std::max(1.0, std::fabs(v.ub))))
+        return false;
+    v.ub = value;
+    return check_bounds(j);
+}
+
+// Remove an empty, free or singleton row
+bool PresolveRepn::reduce_row(size_t i)
+{
+    auto& row = rows[i];
+
+    double constant = 0;
+    if (substitute(constant, row.linear, row.quadratic)) {
+        row.lower -= constant;
+        row.upper -= constant;
+        row.modified = true;
+    }
+
+    if (options.empty_rows and (row.linear.size() == 0) and (row.quadratic.size() == 0)) {
+        double tol = options.tolerance;
+        if ((row.lower > tol * std::max(1.0, std::fabs(row.lower)))
+            or (row.upper < -tol * std::max(1.0, std::fabs(row.upper)))) {
+            infeasible = true;
+            return false;
+        }
+        row.status = RowStatus::Empty;
+        stats.empty_rows++;
+        return true;
+    }
+
+    if (options.empty_rows and (row.lower == -COEK_INFINITY) and (row.upper == COEK_INFINITY)) {
+        row.status = RowStatus::Free;
+        stats.free_rows++;
+        return true;
+    }
+
+    if (options.singleton_rows and (row.linear.size() == 1) and (row.quadratic.size() == 0)) {
+        auto [j, coef] = row.linear[0];
+        double lower = (coef > 0 ? row.lower : row.upper) / coef;
+        double upper = (coef > 0 ? row.upper : row.lower) / coef;
+        if (lower > -COEK_INFINITY) tighten_lower(j, lower, 0);
+        if (upper < COEK_INFINITY) tighten_upper(j, upper, 0);
+        if (infeasible) return false;
+        row.status = RowStatus::Singleton;
+        row.var = j;
+        row.coef = coef;
+        stats.singleton_rows++;
+        return true;
+    }
+
+    return false;
+}
+
+bool PresolveRepn::remove_duplicate_rows()
+{
+    bool changed = false;
+    double tol = options.tolerance;
+
+    // Rows are grouped by their variables
+    std::unordered_map<size_t, std::vector<size_t>> groups;
+    for (size_t i = 0; i < rows.size(); i++) {
+        auto& row = rows[i];
+        if ((row.status != RowStatus::Active) or (row.quadratic.size() > 0)) continue;
+
+        size_t hash = row.linear.size();
+        for (auto& term : row.linear) hash = hash * 1000003 ^ term.first;
+        auto& group = groups[hash];
+
+        bool duplicate = false;
+        for (size_t k : group) {
+            auto& other = rows[k];
+            if (other.linear.size() != row.linear.size()) continue;
+
+            // row = ratio * other
+            double ratio = row.linear[0].second / other.linear[0].second;
+            bool same = true;
+            for (size_t t = 0; same and (t < row.linear.size()); t++) {
+                double coef = row.linear[t].second;
+                same = (row.linear[t].first == other.linear[t].first)
+                       and (std::fabs(coef - ratio * other.linear[t].second)
+                            <= tol * std::max(1.0, std::fabs(coef)));
+            }
+            if (not same) continue;
+
+            // Merge the bounds of this row into the other row
+            double lower = (ratio > 0 ? row.lower : row.upper) / ratio;
+            double upper = (ratio > 0 ? row.upper : row.lower) / ratio;
+            if (lower > other.lower) {
+                other.lower = lower;
+                other.lower_source = i;
+                other.lower_ratio = ratio;
+                other.modified = true;
+            }
+            if (upper < other.upper) {
+                other.upper = upper;
+                other.upper_source = i;
+                other.upper_ratio = ratio;
+                other.modified = true;
+            }
+            if (other.lower > other.upper) {
+                if (other.lower - other.upper > tol * std::max(1.0, std::fabs(other.upper))) {
+                    infeasible = true;
+                    return false;
+                }
+                other.lower = other.upper;
+            }
+
+            row.status = RowStatus::Duplicate;
+            stats.duplicate_rows++;
+            duplicate = changed = true;
+            break;
+        }
+        if (not duplicate) group.push_back(i);
+    }
+    return changed;
+}
+
+// Tighten variable bounds using the minimum and maximum activity of a linear row
+bool PresolveRepn::tighten_bounds(PresolveRow& row)
+{
+    if (row.quadratic.size() > 0) return false;
+
+    auto activity = [&](size_t j, double coef) {
+        auto& v = vars[j];
+        return coef > 0 ? std::make_pair(coef * v.lb, coef * v.ub)
+                        : std::make_pair(coef * v.ub, coef * v.lb);
+    };
+
+    double minact = 0, maxact = 0;
+    size_t mininf = 0, maxinf = 0;
+    for (auto& [j, coef] : row.linear) {
+        auto [lo, hi] = activity(j, coef);
+        if (lo == -COEK_INFINITY)
+            mininf++;
+        else
+            minact += lo;
+        if (hi == COEK_INFINITY)
+            maxinf++;
+        else
+            maxact += hi;
+    }
+    if ((mininf > 1) and (maxinf > 1)) return false;
+
+    bool changed = false;
+    for (auto& [j, coef] : row.linear) {
+        auto [lo, hi] = activity(j, coef);
+        // The activity of the other terms is finite
+        bool minfinite = (mininf == 0) or ((mininf == 1) and (lo == -COEK_INFINITY));
+        bool maxfinite = (maxinf == 0) or ((maxinf == 1) and (hi == COEK_INFINITY));
+
+        // coef * x_j <= upper - (the minimum activity of the other terms)
+        if ((row.upper < COEK_INFINITY) and minfinite) {
+            double bound = (row.upper - (mininf == 0 ? minact - lo : minact)) / coef;
+            if (std::fabs(bound) < max_derived_bound)
+                changed |= coef > 0 ? tighten_upper(j, bound, min_improvement)
+                                    : tighten_lower(j, bound, min_improvement);
+        }
+        // coef * x_j >= lower - (the maximum activity of the other terms)
+        if ((row.lower > -COEK_INFINITY) and maxfinite) {
+            double bound = (row.lower - (maxinf == 0 ? maxact - hi : maxact)) / coef;
+            if (std::fabs(bound) < max_derived_bound)
+                changed |= coef > 0 ? tighten_lower(j, bound, min_improvement)
+                                    : tighten_upper(j, bound, min_improvement);
+        }
+        if (infeasible) return false;
+    }
+    return changed;
+}
+
+void PresolveRepn::presolve()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    collect_variables();
+    collect_rows();
+    collect_objectives();
+    stats.num_variables = vars.size();
+    stats.num_constraints = rows.size();
+
+    std::vector<double> lb(vars.size());
+    std::vector<double> ub(vars.size());
+    for (size_t j = 0; j < vars.size(); j++) {
+        lb[j] = vars[j].lb;
+        ub[j] = vars[j].ub;
+    }
+
+    for (size_t round = 1; round <= options.max_rounds; round++) {
+        stats.rounds = round;
+        bool changed = false;
+
+        if (options.fixed_variables) changed |= fix_variables();
+
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (rows[i].status != RowStatus::Active) continue;
+            changed |= reduce_row(i);
+            if (infeasible) break;
+        }
+        if (infeasible) break;
+
+        if (options.duplicate_rows) changed |= remove_duplicate_rows();
+        if (infeasible) break;
+
+        if (options.bound_tightening) {
+            for (auto& row : rows) {
+                if (row.status != RowStatus::Active) continue;
+                changed |= tighten_bounds(row);
+                if (infeasible) break;
+            }
+            if (infeasible) break;
+        }
+
+        if (not changed) break;
+    }
+
+    if (not infeasible) {
+        for (size_t j = 0; j < vars.size(); j++) {
+            auto& v = vars[j];
+            if (v.removed) continue;
+            if (v.lb != lb[j]) stats.tightened_bounds++;
+            if (v.ub != ub[j]) stats.tightened_bounds++;
+        }
+        for (auto& obj : objs)
+            if (not obj.nonlinear)
+                obj.modified = substitute(obj.constant, obj.linear, obj.quadratic);
+        create_reduced_model();
+        apply_bounds();
+    }
+
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+    stats.time = diff.count();
+}
+
+//
+// Create the reduced model
+//
+
+Expression PresolveRepn::expression(double constant, const LinearTerms& linear,
+                                    const QuadraticTerms& quadratic)
+{
+    Expression e(constant);
+    for (auto& [j, coef] : linear) e += coef * vars[j].var;
+    for (auto& [i, j, coef] : quadratic) e += coef * vars[i].var * vars[j].var;
+    return e;
+}
+
+void PresolveRepn::create_reduced_model()
+{
+    reduced.name_generation(model.name_generation());
+    reduced.num_writer_threads(model.num_writer_threads());
+
+    for (auto& v : vars)
+        if (not v.removed) reduced.add_variable(v.var);
+
+    for (auto& obj : objs) {
+        if (not obj.modified) {
+            reduced.add(obj.obj);
+            continue;
+        }
+        auto tmp = reduced.add_objective(expression(obj.constant, obj.linear, obj.quadratic));
+        tmp.sense(obj.obj.sense());
+        if (obj.obj.repn->name != "") tmp.name(obj.obj.repn->name);
+    }
+
+    for (auto& row : rows) {
+        if ((row.status != RowStatus::Active) and (row.status != RowStatus::Nonlinear)) continue;
+        if (not row.modified) {
+            row.reduced = row.con;
+            reduced.add(row.reduced);
+            continue;
+        }
+
+        auto body = expression(0, row.linear, row.quadratic);
+        if (row.lower == row.upper)
+            row.reduced = body == row.lower;
+        else if (row.upper == COEK_INFINITY)
+            row.reduced = body >= row.lower;
+        else if (row.lower == -COEK_INFINITY)
+            row.reduced = body <= row.upper;
+        else
+            row.reduced = inequality(row.lower, body, row.upper);
+        if (row.con.repn->name != "") row.reduced.name(row.con.repn->name);
+        reduced.add(row.reduced);
+    }
+
+    stats.reduced_num_variables = reduced.num_variables();
+    stats.reduced_num_constraints = reduced.num_constraints();
+}
+
+//
+// Postsolve
+//
+
+void PresolveRepn::apply_bounds()
+{
+    if (bounds_applied or infeasible) return;
+    for (auto& v : vars) {
+        if (v.removed) continue;
+        if (v.lb != v.var.lower()) v.var.lower(v.lb);
+        if (v.ub != v.var.upper()) v.var.upper(v.ub);
+    }
+    bounds_applied = true;
+}
+
+void PresolveRepn::restore_bounds()
+{
+    if (not bounds_applied) return;
+    for (auto& v : vars) {
+        v.var.repn->lb = v.orig_lb;
+        v.var.repn->ub = v.orig_ub;
+    }
+    bounds_applied = false;
+}
+
+void PresolveRepn::postsolve()
+{
+    if (infeasible) return;
+    restore_bounds();
+
+    for (auto& v : vars)
+        if (v.removed and not v.var.fixed()) v.var.value(v.value);
+
+    auto dual = reduced.repn->csuffix.find("dual");
+    if (dual == reduced.repn->csuffix.end()) return;
+    auto& rdual = dual->second;
+    auto& odual = model.repn->csuffix["dual"];
+
+    std::unordered_map<unsigned int, double>* rc = nullptr;
+    auto it = reduced.repn->vsuffix.find("rc");
+    if (it != reduced.repn->vsuffix.end()) rc = &(it->second);
+
+    double tol = std::sqrt(options.tolerance);
+    auto active = [&](double value, double bound) {
+        return std::fabs(value - bound) <= tol * std::max(1.0, std::fabs(bound));
+    };
+
+    for (auto& row : rows) odual[row.con.id()] = 0;
+
+    std::vector<bool> used(vars.size(), false);
+    for (auto& row : rows) {
+        if ((row.status == RowStatus::Active) or (row.status == RowStatus::Nonlinear)) {
+            auto curr = rdual.find(row.reduced.id());
+            if (curr == rdual.end()) continue;
+            double y = curr->second;
+
+            // The dual value is assigned to the row that defines the active bound
+            double value = row.reduced.body().value();
+            if ((row.lower_source != none) and active(value, row.lower))
+                odual[rows[row.lower_source].con.id()] += y / row.lower_ratio;
+            else if ((row.upper_source != none) and active(value, row.upper))
+                odual[rows[row.upper_source].con.id()] += y / row.upper_ratio;
+            else
+                odual[row.con.id()] += y;
+        }
+        else if ((row.status == RowStatus::Singleton) and rc and not used[row.var]) {
+            // The reduced cost of a variable is the dual value of the row that
+            // defines its active bound
+            auto& v = vars[row.var];
+            double value = v.var.value();
+            double lower = (row.coef > 0 ? row.lower : row.upper) / row.coef;
+            double upper = (row.coef > 0 ? row.upper : row.lower) / row.coef;
+            if (((v.lb == lower) and active(value, lower))
+                or ((v.ub == upper) and active(value, upper))) {
+                auto curr = rc->find(v.var.id());
+                if (curr != rc->end()) odual[row.con.id()] = curr->second / row.coef;
+                used[row.var] = true;
+            }
+        }
+    }
+}
+
+//
+// Presolve
+//
+
+Presolve::Presolve(Model& model, const PresolveOptions& options)
+    : repn(std::make_shared<PresolveRepn>(model, options))
+{
+    repn->presolve();
+}
+
+Model& Presolve::reduced_model()
+{
+    repn->apply_bounds();
+    return repn->reduced;
+}
+
+bool Presolve::infeasible() const { return repn->infeasible; }
+
+const PresolveStatistics& Presolve::statistics() const { return repn->stats; }
+
+void Presolve::postsolve() { repn->postsolve(); }
+
+void Presolve::write(const std::string& filename) { reduced_model().write(filename); }
+
+std::ostream& operator<<(std::ostream& ostr, const PresolveStatistics& stats)
+{
+    ostr << "Presolve statistics" << std::endl;
+    ostr << "  Rounds:           " << stats.rounds << std::endl;
+    ostr << "  Variables:        " << stats.num_variables << " -> " << stats.reduced_num_variables
+         << std::endl;
+    ostr << "  Constraints:      " << stats.num_constraints << " -> "
+         << stats.reduced_num_constraints << std::endl;
+    ostr << "  Fixed variables:  " << stats.fixed_variables << std::endl;
+    ostr << "  Singleton rows:   " << stats.singleton_rows << std::endl;
+    ostr << "  Empty rows:       " << stats.empty_rows << std::endl;
+    ostr << "  Free rows:        " << stats.free_rows << std::endl;
+    ostr << "  Duplicate rows:   " << stats.duplicate_rows << std::endl;
+    ostr << "  Tightened bounds: " << stats.tightened_bounds << std::endl;
+    ostr << "  Time:             " << stats.time << " s" << std::endl;
+    return ostr;
+}
+
+}  // namespace coek
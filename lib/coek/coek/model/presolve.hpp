@@ -0,0 +1,111 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <coek/model/model.hpp>
+
+namespace coek {
+
+class PresolveRepn;
+
+/**
+ * Options that select the reductions applied by coek::Presolve.
+ */
+class PresolveOptions {
+   public:
+    /** Substitute variables that are fixed or whose bounds are equal */
+    bool fixed_variables = true;
+    /** Convert constraints with a single linear term into variable bounds */
+    bool singleton_rows = true;
+    /** Remove constraints without variables */
+    bool empty_rows = true;
+    /** Remove linear constraints that are scalar multiples of another constraint */
+    bool duplicate_rows = true;
+    /** Tighten variable bounds using the activity bounds of linear constraints */
+    bool bound_tightening = true;
+    /** The maximum number of passes over the model */
+    size_t max_rounds = 10;
+    /** The tolerance used to compare values */
+    double tolerance = 1e-9;
+};
+
+/**
+ * Statistics that summarize the reductions applied by coek::Presolve.
+ */
+class PresolveStatistics {
+   public:
+    size_t rounds = 0;
+    size_t num_variables = 0;
+    size_t num_constraints = 0;
+    size_t reduced_num_variables = 0;
+    size_t reduced_num_constraints = 0;
+
+    size_t fixed_variables = 0;
+    size_t singleton_rows = 0;
+    size_t empty_rows = 0;
+    size_t free_rows = 0;
+    size_t duplicate_rows = 0;
+    size_t tightened_bounds = 0;
+
+    /** The time (in seconds) spent presolving the model */
+    double time = 0;
+};
+
+/**
+ * A reduced model that is created from a coek::Model, along with the data
+ * needed to map a solution of the reduced model back to the original model.
+ *
+ * Constraint bodies are analyzed with MutableNLPExpr objects.  Linear and
+ * quadratic constraints are rebuilt when variables are substituted, while
+ * constraints with nonlinear terms are copied into the reduced model and their
+ * variables are not substituted.  Mutable parameters are evaluated when the
+ * model is presolved.
+ *
+ * The reduced model shares variables with the original model, so the
+ * tightened bounds are applied to the variables while the reduced model is
+ * used.  The original bounds are restored by postsolve().
+ */
+class Presolve {
+   public:
+    std::shared_ptr<PresolveRepn> repn;
+
+   public:
+    /** Presolve a model
+     *
+     * \param model  the model that is presolved
+     * \param options  the reductions that are applied
+     */
+    Presolve(Model& model, const PresolveOptions& options = PresolveOptions());
+
+    /** \returns the reduced model, after applying the presolve variable bounds */
+    Model& reduced_model();
+    /** \returns \c true if presolve found that the model is infeasible
+     *
+     * The reduced model is empty when the model is infeasible. */
+    bool infeasible() const;
+    /** \returns statistics for the reductions */
+    const PresolveStatistics& statistics() const;
+
+    /** Map the solution of the reduced model to the original model
+     *
+     * This restores the original variable bounds and sets the values of the
+     * variables that were removed.  If the reduced model has a constraint suffix
+     * named \c dual, then the \c dual suffix is set for the constraints in the
+     * original model.  Removed constraints have a zero dual value, unless they
+     * were converted into a bound that is active and the reduced model has a
+     * variable suffix named \c rc.
+     */
+    void postsolve();
+
+    /** Write the reduced model to the specified file
+     *
+     * \param filename  the output file, whose format is determined by its suffix
+     */
+    void write(const std::string& filename);
+};
+
+std::ostream& operator<<(std::ostream& ostr, const PresolveStatistics& stats);
+
+}  // namespace coek
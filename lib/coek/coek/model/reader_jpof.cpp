@@ -8,10 +8,10 @@
 #include <sstream>
 #include <stack>
 #include <string>
+#include <vector>
 #ifdef WITH_RAPIDJSON
 #    include <rapidjson/document.h>
 #    include <rapidjson/error/en.h>
-#    include <rapidjson/filereadstream.h>
 #endif
 
 #include "coek/api/constraint.hpp"
@@ -19,6 +19,7 @@
 #include "coek/api/intrinsic_fn.hpp"
 #include "coek/api/objective.hpp"
 #include "coek/model/model.hpp"
+#include "coek/util/compressed_file.hpp"
 
 #define RUNTIME_ASSERT(flag, msg) \
     if (not(flag)) throw std::runtime_error(msg)
@@ -578,6 +579,75 @@ void process_jpof_v20210301(rapidjson::Document& doc, Model& model,
     }
 }
 
+//
+// A RapidJSON input stream that reads an InputFile, which may be compressed
+//
+class InputFileStream {
+   public:
+    typedef char Ch;
+
+    InputFile& file;
+    std::vector<char> buffer;
+    char* current;
+    char* last;
+    size_t count = 0;
+    size_t size = 0;
+    bool eof = false;
+
+    explicit InputFileStream(InputFile& _file) : file(_file), buffer(65536)
+    {
+        current = last = buffer.data();
+        size = file.read(buffer.data(), buffer.size());
+        if (size == 0) {
+            buffer[0] = '\0';
+            eof = true;
+        }
+        else
+            last = current + size - 1;
+    }
+
+    Ch Peek() const { return *current; }
+    Ch Take()
+    {
+        Ch c = *current;
+        read();
+        return c;
+    }
+    size_t Tell() const { return count + static_cast<size_t>(current - buffer.data()); }
+
+    // Not implemented
+    void Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void Flush() { RAPIDJSON_ASSERT(false); }
+    Ch* PutBegin()
+    {
+        RAPIDJSON_ASSERT(false);
+        return 0;
+    }
+    size_t PutEnd(Ch*)
+    {
+        RAPIDJSON_ASSERT(false);
+        return 0;
+    }
+
+   protected:
+    void read()
+    {
+        if (current < last)
+            ++current;
+        else if (not eof) {
+            count += size;
+            size = file.read(buffer.data(), buffer.size());
+            current = last = buffer.data();
+            if (size == 0) {
+                buffer[0] = '\0';
+                eof = true;
+            }
+            else
+                last = current + size - 1;
+        }
+    }
+};
+
 Model create_model_from_dom(rapidjson::Document& d, std::map<std::string, Parameter>& params,
                             std::map<size_t, size_t>& vmap)
 {
@@ -618,11 +688,9 @@ Model read_problem_from_jpof_file(const std::string& fname,
                                   std::map<std::string, Parameter>& params)
 {
 #ifdef WITH_RAPIDJSON
-    FILE* fp = fopen(fname.c_str(), "r");
-    if (!fp) throw std::runtime_error("Unknown file: " + fname);
-
-    char readBuffer[65536];
-    rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+    // JPOF files may be compressed with gzip or zstd
+    InputFile file(fname);
+    reader_jpof::InputFileStream is(file);
 
     rapidjson::Document d;
     d.ParseStream(is);
@@ -632,8 +700,6 @@ Model read_problem_from_jpof_file(const std::string& fname,
                                  + std::to_string((unsigned)d.GetErrorOffset()) + "): " + msg);
     }
 
-    fclose(fp);
-
     std::map<size_t, size_t> vmap;
     return reader_jpof::create_model_from_dom(d, params, vmap);
 #else
@@ -0,0 +1,687 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if __has_include(<charconv>)
+#    include <charconv>
+#endif
+
+#include "coek/api/constants.hpp"
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/ast/expr_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/model/model.hpp"
+#include "coek/util/mapped_file.hpp"
+
+namespace coek {
+
+namespace reader_lp {
+
+enum class Token {
+    End,
+    Number,
+    Name,
+    Colon,
+    Sense,
+    Plus,
+    Minus,
+    Times,
+    Caret,
+    Slash,
+    LBracket,
+    RBracket
+};
+
+enum class Section {
+    None,
+    Minimize,
+    Maximize,
+    Constraints,
+    Bounds,
+    General,
+    Binary,
+    SemiContinuous,
+    SOS,
+    End
+};
+
+bool name_char(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c))
+           or (std::strchr("!\"#$%&()/,.;?@_`'{}|~", c) and (c != 0));
+}
+
+bool iequals(std::string_view a, const char* b)
+{
+    size_t n = std::strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; ++i)
+        if (std::tolower(static_cast<unsigned char>(a[i])) != b[i]) return false;
+    return true;
+}
+
+//
+// A tokenizer for LP files.
+//
+// Comments begin with a backslash and continue to the end of the line, and text
+// between "\*" and "*\" is ignored.  Tokens refer to the file data, so names are
+// not copied.
+//
+class Tokenizer {
+   public:
+    const char* begin;
+    const char* p;
+    const char* end;
+    const std::string* fname;
+    size_t line = 1;
+
+    Token type = Token::End;
+    std::string_view text;
+    double number = 0;
+    char sense = 0;
+    // True if this token is the first on its line
+    bool line_start = false;
+
+    Tokenizer(const MappedFile& file, const std::string& _fname)
+        : begin(file.data), p(file.data), end(file.data + file.size), fname(&_fname)
+    {
+    }
+
+    [[noreturn]] void error(const std::string& msg) const
+    {
+        throw std::runtime_error("Error reading LP file " + *fname + " (line "
+                                 + std::to_string(line) + "): " + msg);
+    }
+
+    void skip_whitespace()
+    {
+        while (p < end) {
+            if (*p == '\n') {
+                ++line;
+                line_start = true;
+                ++p;
+            }
+            else if (std::isspace(static_cast<unsigned char>(*p)))
+                ++p;
+            else if (*p == '\\') {
+                if ((p + 1 < end) and (p[1] == '*')) {
+                    p += 2;
+                    while ((p + 1 < end) and not((p[0] == '*') and (p[1] == '\\'))) {
+                        if (*p == '\n') ++line;
+                        ++p;
+                    }
+                    if (p + 1 >= end) error("Unterminated comment");
+                    p += 2;
+                }
+                else {
+                    while ((p < end) and (*p != '\n')) ++p;
+                }
+            }
+            else
+                break;
+        }
+    }
+
+    void read_number()
+    {
+#if defined(__cpp_lib_to_chars)
+        auto res = std::from_chars(p, end, number);
+        if (res.ec != std::errc()) error("Invalid number");
+        p = res.ptr;
+#else
+        char tmp[64];
+        size_t n = 0;
+        while ((p + n < end) and (n < sizeof(tmp) - 1)
+               and (std::isdigit(static_cast<unsigned char>(p[n])) or (p[n] == '.')
+                    or (p[n] == 'e') or (p[n] == 'E')
+                    or (((p[n] == '+') or (p[n] == '-')) and (n > 0)
+                        and ((p[n - 1] == 'e') or (p[n - 1] == 'E'))))) {
+            tmp[n] = p[n];
+            ++n;
+        }
+        tmp[n] = 0;
+        char* last;
+        number = std::strtod(tmp, &last);
+        if (last == tmp) error("Invalid number");
+        p += last - tmp;
+#endif
+    }
+
+    void next()
+    {
+        line_start = (p == begin);
+        skip_whitespace();
+        if (p >= end) {
+            type = Token::End;
+            text = std::string_view();
+            return;
+        }
+
+        const char* start = p;
+        char c = *p;
+        if (std::isdigit(static_cast<unsigned char>(c))
+            or ((c == '.') and (p + 1 < end) and std::isdigit(static_cast<unsigned char>(p[1])))) {
+            type = Token::Number;
+            read_number();
+        }
+        else if ((c == '<') or (c == '>') or (c == '=')) {
+            type = Token::Sense;
+            ++p;
+            if (c == '=') {
+                sense = '=';
+                if ((p < end) and ((*p == '<') or (*p == '>'))) sense = *p++;
+            }
+            else {
+                sense = c;
+                if ((p < end) and (*p == '=')) ++p;
+            }
+        }
+        else if (c == '+') {
+            type = Token::Plus;
+            ++p;
+        }
+        else if (c == '-') {
+            type = Token::Minus;
+            ++p;
+        }
+        else if (c == '*') {
+            type = Token::Times;
+            ++p;
+        }
+        else if (c == '^') {
+            type = Token::Caret;
+            ++p;
+        }
+        else if (c == '/') {
+            type = Token::Slash;
+            ++p;
+        }
+        else if (c == '[') {
+            type = Token::LBracket;
+            ++p;
+        }
+        else if (c == ']') {
+            type = Token::RBracket;
+            ++p;
+        }
+        else if (c == ':') {
+            type = Token::Colon;
+            ++p;
+        }
+        else if (name_char(c)) {
+            type = Token::Name;
+            while ((p < end) and name_char(*p)) ++p;
+        }
+        else
+            error(std::string("Unexpected character '") + c + "'");
+        text = std::string_view(start, static_cast<size_t>(p - start));
+    }
+
+    // The section keyword for the current token
+    Section section()
+    {
+        if ((type != Token::Name) or not line_start) return Section::None;
+        if (iequals(text, "minimize") or iequals(text, "minimise") or iequals(text, "minimum")
+            or iequals(text, "min"))
+            return Section::Minimize;
+        if (iequals(text, "maximize") or iequals(text, "maximise") or iequals(text, "maximum")
+            or iequals(text, "max"))
+            return Section::Maximize;
+        if (iequals(text, "st") or iequals(text, "st.") or iequals(text, "s.t."))
+            return Section::Constraints;
+        if (iequals(text, "subject") or iequals(text, "such")) {
+            Tokenizer tmp = *this;
+            tmp.next();
+            if ((tmp.type == Token::Name)
+                and (iequals(tmp.text, "to") or iequals(tmp.text, "that")))
+                return Section::Constraints;
+            return Section::None;
+        }
+        if (iequals(text, "bounds") or iequals(text, "bound")) return Section::Bounds;
+        if (iequals(text, "general") or iequals(text, "generals") or iequals(text, "gen")
+            or iequals(text, "integer") or iequals(text, "integers"))
+            return Section::General;
+        if (iequals(text, "binary") or iequals(text, "binaries") or iequals(text, "bin"))
+            return Section::Binary;
+        if (iequals(text, "semi-continuous") or iequals(text, "semis") or iequals(text, "semi"))
+            return Section::SemiContinuous;
+        if (iequals(text, "sos")) return Section::SOS;
+        if (iequals(text, "end")) return Section::End;
+        return Section::None;
+    }
+
+    // Consume the tokens in a section keyword
+    void skip_section()
+    {
+        if (iequals(text, "subject") or iequals(text, "such")) next();
+        next();
+    }
+
+    bool at_label() const
+    {
+        if (type != Token::Name) return false;
+        const char* q = p;
+        while ((q < end) and std::isspace(static_cast<unsigned char>(*q))) ++q;
+        return (q < end) and (*q == ':');
+    }
+};
+
+//
+// Read an LP file and create a model.
+//
+// Each objective and constraint is collected as a list of linear and quadratic
+// terms, which are used to create a single sum.  The bodies of linear constraints
+// are instead stored as rows of a single linear block, so no expression is
+// created for their terms.
+//
+class LPReader {
+   public:
+    Tokenizer tok;
+    Model model;
+
+    std::vector<Variable> vars;
+    std::unordered_map<std::string_view, size_t> var_index;
+
+    double constant = 0;
+    std::vector<std::pair<size_t, double>> linear;
+    std::vector<std::tuple<size_t, size_t, double>> quadratic;
+
+    // The rows of the linear constraints.  Column j is the variable vars[j].
+    std::shared_ptr<LinearBlockData> rows;
+
+    LPReader(const MappedFile& file, const std::string& fname)
+        : tok(file, fname), rows(std::make_shared<LinearBlockData>())
+    {
+        rows->row_start.push_back(0);
+    }
+
+    size_t variable(std::string_view name)
+    {
+        auto it = var_index.find(name);
+        if (it != var_index.end()) return it->second;
+
+        // Variables are non-negative by default
+        Variable var{std::string(name)};
+        var.lower(0);
+        model.add_variable(var);
+        var_index.emplace(name, vars.size());
+        vars.push_back(var);
+        rows->vars.push_back(var.repn);
+        return vars.size() - 1;
+    }
+
+    bool is_term_start()
+    {
+        switch (tok.type) {
+            case Token::Plus:
+            case Token::Minus:
+            case Token::Number:
+            case Token::LBracket:
+                return true;
+            case Token::Name:
+                return tok.section() == Section::None;
+            default:
+                return false;
+        };
+    }
+
+    // Read an optionally signed number, including infinite values
+    bool signed_number(double& value)
+    {
+        double sign = 1;
+        Tokenizer tmp = tok;
+        while ((tmp.type == Token::Plus) or (tmp.type == Token::Minus)) {
+            if (tmp.type == Token::Minus) sign = -sign;
+            tmp.next();
+        }
+        if (tmp.type == Token::Number)
+            value = sign * tmp.number;
+        else if ((tmp.type == Token::Name)
+                 and (iequals(tmp.text, "inf") or iequals(tmp.text, "infinity")))
+            value = sign * COEK_INFINITY;
+        else
+            return false;
+        tmp.next();
+        tok = tmp;
+        return true;
+    }
+
+    void read_quadratic(double sign)
+    {
+        tok.next();
+        size_t first = quadratic.size();
+        while (tok.type != Token::RBracket) {
+            double coef = sign;
+            while ((tok.type == Token::Plus) or (tok.type == Token::Minus)) {
+                if (tok.type == Token::Minus) coef = -coef;
+                tok.next();
+            }
+            if (tok.type == Token::Number) {
+                coef *= tok.number;
+                tok.next();
+            }
+            if (tok.type != Token::Name) tok.error("Expected a variable in a quadratic term");
+            size_t i = variable(tok.text);
+            tok.next();
+            if (tok.type == Token::Caret) {
+                tok.next();
+                if ((tok.type != Token::Number) or (tok.number != 2))
+                    tok.error("Expected the exponent 2 in a quadratic term");
+                quadratic.emplace_back(i, i, coef);
+            }
+            else if (tok.type == Token::Times) {
+                tok.next();
+                if (tok.type != Token::Name) tok.error("Expected a variable in a quadratic term");
+                quadratic.emplace_back(i, variable(tok.text), coef);
+            }
+            else
+                tok.error("Expected '^' or '*' in a quadratic term");
+            tok.next();
+        }
+        tok.next();
+
+        // Quadratic objective terms may be scaled by 1/2
+        if (tok.type == Token::Slash) {
+            tok.next();
+            if ((tok.type != Token::Number) or (tok.number != 2))
+                tok.error("Expected '/ 2' after a quadratic expression");
+            tok.next();
+            for (size_t k = first; k < quadratic.size(); ++k) std::get<2>(quadratic[k]) /= 2;
+        }
+    }
+
+    void read_expression()
+    {
+        constant = 0;
+        linear.clear();
+        quadratic.clear();
+
+        // Terms after the first must begin with a sign
+        for (bool first = true; is_term_start(); first = false) {
+            if (not first and (tok.type != Token::Plus) and (tok.type != Token::Minus)) break;
+            double coef = 1;
+            while ((tok.type == Token::Plus) or (tok.type == Token::Minus)) {
+                if (tok.type == Token::Minus) coef = -coef;
+                tok.next();
+            }
+            if (tok.type == Token::LBracket) {
+                read_quadratic(coef);
+                continue;
+            }
+            bool has_coef = false;
+            if (tok.type == Token::Number) {
+                coef *= tok.number;
+                has_coef = true;
+                tok.next();
+                if (tok.type == Token::Times) tok.next();
+            }
+            if ((tok.type == Token::Name) and (tok.section() == Section::None)) {
+                // The COEK LP writer uses this variable to represent a constant term
+                if (tok.text == "ONE_VAR_CONSTANT")
+                    constant += coef;
+                else
+                    linear.emplace_back(variable(tok.text), coef);
+                tok.next();
+            }
+            else if (has_coef)
+                constant += coef;
+            else
+                tok.error("Expected a term");
+        }
+    }
+
+    // Create the sum of the terms that were read
+    Expression expression()
+    {
+        size_t n = linear.size() + quadratic.size();
+        if (n == 0) return Expression(constant);
+
+        auto term = [&](size_t k) -> expr_pointer_t {
+            if (k < linear.size())
+                return CREATE_POINTER(MonomialTerm, linear[k].second, vars[linear[k].first].repn);
+            auto& [i, j, coef] = quadratic[k - linear.size()];
+            return CREATE_POINTER(TimesTerm, CREATE_POINTER(MonomialTerm, coef, vars[i].repn),
+                                  vars[j].repn);
+        };
+        auto sum = CREATE_POINTER(PlusTerm, CREATE_POINTER(ConstantTerm, constant), term(0), false);
+        sum->data->reserve(n + 1);
+        for (size_t k = 1; k < n; ++k) sum->push_back(term(k));
+        return expr_pointer_t(sum);
+    }
+
+    // Add the linear terms that were read as a row of the linear block
+    Expression linear_row()
+    {
+        for (auto& [j, coef] : linear) {
+            rows->col_index.push_back(j);
+            rows->values.push_back(coef);
+        }
+        rows->row_start.push_back(rows->col_index.size());
+        return expr_pointer_t(CREATE_POINTER(LinearRowTerm, rows, rows->row_start.size() - 2));
+    }
+
+    std::string label()
+    {
+        if (not tok.at_label()) return "";
+        std::string name(tok.text);
+        tok.next();
+        tok.next();
+        return name;
+    }
+
+    void read_objective(bool sense)
+    {
+        tok.skip_section();
+        auto name = label();
+        read_expression();
+        auto obj = name.empty() ? model.add_objective(expression())
+                                : model.add_objective(name, expression());
+        obj.sense(sense);
+    }
+
+    void read_constraints()
+    {
+        tok.skip_section();
+        while (is_term_start()) {
+            auto name = label();
+
+            // Ranged constraints begin with a value and a sense
+            double lhs = 0;
+            char lhs_sense = 0;
+            Tokenizer start = tok;
+            if (signed_number(lhs) and (tok.type == Token::Sense)) {
+                lhs_sense = tok.sense;
+                tok.next();
+            }
+            else
+                tok = start;
+
+            read_expression();
+
+            double rhs = 0;
+            char rhs_sense = 0;
+            if (tok.type == Token::Sense) {
+                rhs_sense = tok.sense;
+                tok.next();
+                if (not signed_number(rhs)) tok.error("Expected a constraint right-hand side");
+            }
+            else if (lhs_sense == 0)
+                tok.error("Expected a constraint sense");
+
+            // The COEK LP writer uses this constraint to fix ONE_VAR_CONSTANT
+            if (name == "c_ONE_VAR_CONSTANT") continue;
+
+            Expression body;
+            if (quadratic.empty() and not linear.empty()) {
+                // The constant is moved to the bounds, since rows do not have constants
+                body = linear_row();
+                lhs -= constant;
+                rhs -= constant;
+            }
+            else
+                body = expression();
+            Constraint con;
+            if (lhs_sense == 0) {
+                if (rhs_sense == '<')
+                    con = body <= rhs;
+                else if (rhs_sense == '>')
+                    con = body >= rhs;
+                else
+                    con = body == rhs;
+            }
+            else if (rhs_sense == 0) {
+                if (lhs_sense == '<')
+                    con = body >= lhs;
+                else if (lhs_sense == '>')
+                    con = body <= lhs;
+                else
+                    con = body == lhs;
+            }
+            else if ((lhs_sense == '<') and (rhs_sense == '<'))
+                con = inequality(lhs, body, rhs);
+            else if ((lhs_sense == '>') and (rhs_sense == '>'))
+                con = inequality(rhs, body, lhs);
+            else
+                tok.error("Invalid ranged constraint");
+
+            if (name.empty())
+                model.add_constraint(con);
+            else
+                model.add_constraint(name, con);
+        }
+    }
+
+    void read_bounds()
+    {
+        tok.skip_section();
+        while ((tok.type != Token::End) and (tok.section() == Section::None)) {
+            double value;
+            if (signed_number(value)) {
+                // value <= x [<= ub]
+                if (tok.type != Token::Sense) tok.error("Expected a bound sense");
+                char sense = tok.sense;
+                tok.next();
+                if (tok.type != Token::Name) tok.error("Expected a variable in a bound");
+                auto& var = vars[variable(tok.text)];
+                tok.next();
+                if (sense == '<')
+                    var.lower(value);
+                else if (sense == '>')
+                    var.upper(value);
+                else
+                    var.bounds(value, value);
+
+                if (tok.type == Token::Sense) {
+                    sense = tok.sense;
+                    tok.next();
+                    if (not signed_number(value)) tok.error("Expected a bound value");
+                    if (sense == '<')
+                        var.upper(value);
+                    else if (sense == '>')
+                        var.lower(value);
+                    else
+                        tok.error("Invalid bound");
+                }
+            }
+            else if (tok.type == Token::Name) {
+                // x free, x <= ub, x >= lb, x = value
+                auto& var = vars[variable(tok.text)];
+                tok.next();
+                if ((tok.type == Token::Name) and iequals(tok.text, "free")) {
+                    var.bounds(-COEK_INFINITY, COEK_INFINITY);
+                    tok.next();
+                    continue;
+                }
+                if (tok.type != Token::Sense) tok.error("Expected a bound sense");
+                char sense = tok.sense;
+                tok.next();
+                if (not signed_number(value)) tok.error("Expected a bound value");
+                if (sense == '<')
+                    var.upper(value);
+                else if (sense == '>')
+                    var.lower(value);
+                else
+                    var.bounds(value, value);
+            }
+            else
+                tok.error("Expected a bound");
+        }
+    }
+
+    void read_types(Section section)
+    {
+        tok.skip_section();
+        while ((tok.type == Token::Name) and (tok.section() == Section::None)) {
+            auto& var = vars[variable(tok.text)];
+            if (section == Section::Binary) {
+                var.within(Binary);
+                var.bounds(0, 1);
+            }
+            else
+                var.within(Integers);
+            tok.next();
+        }
+    }
+
+    Model read()
+    {
+        tok.next();
+        if (tok.type == Token::End) tok.error("Empty file");
+
+        bool done = false;
+        while (not done) {
+            auto section = tok.section();
+            switch (section) {
+                case Section::Minimize:
+                    read_objective(Model::minimize);
+                    break;
+                case Section::Maximize:
+                    read_objective(Model::maximize);
+                    break;
+                case Section::Constraints:
+                    read_constraints();
+                    break;
+                case Section::Bounds:
+                    read_bounds();
+                    break;
+                case Section::General:
+                case Section::Binary:
+                    read_types(section);
+                    break;
+                case Section::SemiContinuous:
+                    tok.error("Semi-continuous variables are not supported");
+                case Section::SOS:
+                    tok.error("SOS constraints are not supported");
+                case Section::End:
+                    done = true;
+                    break;
+                case Section::None:
+                    if (tok.type == Token::End)
+                        done = true;
+                    else
+                        tok.error("Unexpected token '" + std::string(tok.text) + "'");
+            };
+        }
+        return model;
+    }
+};
+
+}  // namespace reader_lp
+
+Model read_problem_from_lp_file(const std::string& fname)
+{
+    MappedFile file(fname);
+    reader_lp::LPReader reader(file, fname);
+    return reader.read();
+}
+
+}  // namespace coek
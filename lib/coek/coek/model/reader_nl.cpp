@@ -0,0 +1,702 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if __has_include(<charconv>)
+#    include <charconv>
+#endif
+
+#include "coek/api/constants.hpp"
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/intrinsic_fn.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/model/model.hpp"
+#include "model_repn.hpp"
+#include "coek/util/mapped_file.hpp"
+
+namespace coek {
+
+namespace reader_nl {
+
+//
+// A scanner for the tokens in an NL file.
+//
+// In text files, each record is on a separate line, and trailing comments are
+// ignored.  In binary files, segment keys and bound types are single characters,
+// integers are 4-byte ints and values are 8-byte doubles, except for the
+// cumulative column counts in the "k" segment, which are size_t values.
+//
+class Scanner {
+   public:
+    const char* begin;
+    const char* p;
+    const char* end;
+    const std::string& fname;
+    bool binary = false;
+
+    Scanner(const MappedFile& file, const std::string& _fname)
+        : begin(file.data), p(file.data), end(file.data + file.size), fname(_fname)
+    {
+    }
+
+    [[noreturn]] void error(const std::string& msg) const
+    {
+        throw std::runtime_error("Error reading NL file " + fname + " (offset "
+                                 + std::to_string(p - begin) + "): " + msg);
+    }
+
+    void skip_blanks()
+    {
+        while ((p < end) and ((*p == ' ') or (*p == '\t') or (*p == '\r'))) ++p;
+    }
+
+    void need(size_t n)
+    {
+        if (static_cast<size_t>(end - p) < n) error("Unexpected end of file");
+    }
+
+    // Move to the start of the next line in a text file
+    void end_line()
+    {
+        if (binary) return;
+        auto tmp = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        p = tmp ? tmp + 1 : end;
+    }
+
+    // Get the next segment key.  Returns false at the end of the file.
+    bool next_key(char& c)
+    {
+        if (not binary)
+            while ((p < end) and ((*p == ' ') or (*p == '\t') or (*p == '\r') or (*p == '\n')))
+                ++p;
+        if (p == end) return false;
+        c = *p++;
+        return true;
+    }
+
+    char key()
+    {
+        char c;
+        if (not next_key(c)) error("Unexpected end of file");
+        return c;
+    }
+
+    long integer()
+    {
+        if (binary) {
+            need(sizeof(std::int32_t));
+            std::int32_t tmp;
+            std::memcpy(&tmp, p, sizeof(tmp));
+            p += sizeof(tmp);
+            return tmp;
+        }
+
+        skip_blanks();
+        bool negative = false;
+        if ((p < end) and ((*p == '-') or (*p == '+'))) negative = (*p++ == '-');
+        if ((p == end) or (*p < '0') or (*p > '9')) error("Expected an integer");
+        long value = 0;
+        while ((p < end) and (*p >= '0') and (*p <= '9')) value = 10 * value + (*p++ - '0');
+        return negative ? -value : value;
+    }
+
+    size_t size()
+    {
+        if (binary) {
+            need(sizeof(size_t));
+            size_t tmp;
+            std::memcpy(&tmp, p, sizeof(tmp));
+            p += sizeof(tmp);
+            return tmp;
+        }
+
+        long value = integer();
+        if (value < 0) error("Expected a non-negative integer");
+        return static_cast<size_t>(value);
+    }
+
+    size_t index(size_t n, const char* what)
+    {
+        long i = integer();
+        if ((i < 0) or (static_cast<size_t>(i) >= n))
+            error("Invalid " + std::string(what) + " index: " + std::to_string(i));
+        return static_cast<size_t>(i);
+    }
+
+    double real()
+    {
+        if (binary) {
+            need(sizeof(double));
+            double tmp;
+            std::memcpy(&tmp, p, sizeof(tmp));
+            p += sizeof(tmp);
+            return tmp;
+        }
+
+        skip_blanks();
+        if ((p < end) and (*p == '+')) ++p;
+#if defined(__cpp_lib_to_chars)
+        double value;
+        auto res = std::from_chars(p, end, value);
+        if (res.ec != std::errc()) error("Expected a number");
+        p = res.ptr;
+        return value;
+#else
+        char tmp[64];
+        size_t n = 0;
+        while ((p < end) and (n < sizeof(tmp) - 1) and (*p != ' ') and (*p != '\t')
+               and (*p != '\r') and (*p != '\n') and (*p != '#'))
+            tmp[n++] = *p++;
+        tmp[n] = 0;
+        char* last;
+        double value = std::strtod(tmp, &last);
+        if ((n == 0) or (last != tmp + n)) error("Expected a number");
+        return value;
+#endif
+    }
+
+    // Read the integers on a header line, which are followed by a comment
+    std::vector<long> header_line()
+    {
+        std::vector<long> values;
+        while (true) {
+            skip_blanks();
+            if ((p == end) or (*p == '#') or (*p == '\n')) break;
+            values.push_back(integer());
+        }
+        end_line();
+        return values;
+    }
+};
+
+//
+// NL operator codes that are supported
+//
+Expression (*unary_function(long op))(const Expression&)
+{
+    switch (op) {
+            // clang-format off
+        case 13: return floor;
+        case 14: return ceil;
+        case 15: return abs;
+        case 37: return tanh;
+        case 38: return tan;
+        case 39: return sqrt;
+        case 40: return sinh;
+        case 41: return sin;
+        case 42: return log10;
+        case 43: return log;
+        case 44: return exp;
+        case 45: return cosh;
+        case 46: return cos;
+        case 47: return atanh;
+        case 49: return atan;
+        case 50: return asinh;
+        case 51: return asin;
+        case 52: return acosh;
+        case 53: return acos;
+        default: return nullptr;
+            // clang-format on
+    }
+}
+
+class NLReader {
+   public:
+    Scanner scan;
+    Model model;
+
+    size_t n_vars = 0;
+    size_t n_cons = 0;
+    size_t n_objs = 0;
+    std::vector<Variable> vars;
+    std::vector<Expression> defined;
+    std::vector<bool> is_defined;
+
+    std::vector<Expression> c_expr;
+    std::vector<Expression> c_linear;
+    std::vector<char> r_type;
+    std::vector<double> r_val;
+    bool r_found = false;
+
+    std::vector<Expression> o_expr;
+    std::vector<Expression> o_linear;
+    std::vector<bool> o_sense;
+
+    // Operators whose arguments are being read
+    struct Frame {
+        long op;
+        size_t nargs;
+        std::vector<Expression> args;
+    };
+    std::vector<Frame> frames;
+
+    NLReader(const MappedFile& file, const std::string& fname) : scan(file, fname) {}
+
+    void read_header();
+    void read_segments();
+    Model create_model();
+
+    Expression read_expression();
+    Expression apply(Frame& frame);
+    Expression variable_expression(size_t i);
+    Expression read_linear(size_t nz);
+    void read_bounds(char& type, double* val);
+    void skip_suffix();
+};
+
+void NLReader::read_header()
+{
+    if (scan.p == scan.end) scan.error("Empty file");
+    char format = *scan.p;
+    if ((format != 'g') and (format != 'b')) scan.error("Unknown NL file format");
+    scan.end_line();
+
+    std::vector<std::vector<long>> header(9);
+    for (auto& line : header) line = scan.header_line();
+    auto value = [&](size_t line, size_t i) -> long {
+        // Header lines are numbered from 2, after the format line
+        return i < header[line - 2].size() ? header[line - 2][i] : 0;
+    };
+    if (header[0].size() < 3) scan.error("Invalid problem dimensions in the header");
+
+    n_vars = static_cast<size_t>(value(2, 0));
+    n_cons = static_cast<size_t>(value(2, 1));
+    n_objs = static_cast<size_t>(value(2, 2));
+    if (value(2, 5) > 0) scan.error("Logical constraints are not supported");
+    if (value(6, 1) > 0) scan.error("Imported functions are not supported");
+
+    if (format == 'b') {
+        const int one = 1;
+        long arith = *reinterpret_cast<const char*>(&one) == 1 ? 1 : 2;
+        if (value(6, 2) != arith)
+            scan.error("Binary NL files with a different byte order are not supported");
+        scan.binary = true;
+    }
+
+    //
+    // Create the variables.  The variable types are inferred from the order of the
+    // variables, using the conventions of the coek NL writer:  the nonlinear
+    // variables used in both constraints and objectives, then in constraints only,
+    // then in objectives only, followed by the linear variables.  In each nonlinear
+    // group the discrete variables are last, and the linear variables end with the
+    // binary and then the integer variables.  The counts of nonlinear variables in
+    // constraints and objectives are cumulative.
+    //
+    size_t nlvc = static_cast<size_t>(value(5, 0));
+    size_t nlvo = static_cast<size_t>(value(5, 1));
+    size_t nlvb = static_cast<size_t>(value(5, 2));
+    size_t nbv = static_cast<size_t>(value(7, 0));
+    size_t niv = static_cast<size_t>(value(7, 1));
+    size_t nlvbi = static_cast<size_t>(value(7, 2));
+    size_t nlvci = static_cast<size_t>(value(7, 3));
+    size_t nlvoi = static_cast<size_t>(value(7, 4));
+    size_t nlv = std::max(nlvc, nlvo);
+    if ((nlvb > nlvc) or (nlv > n_vars))
+        scan.error("Inconsistent variable counts in the header");
+    niv = std::min(niv, n_vars - nlv);
+    nbv = std::min(nbv, n_vars - nlv - niv);
+
+    std::vector<VariableTypes> vtype(n_vars, Reals);
+    auto discrete = [&](size_t last, size_t n, VariableTypes type) {
+        for (size_t i = last - std::min(n, last); i < last; ++i) vtype[i] = type;
+    };
+    discrete(nlvb, std::min(nlvbi, nlvb), Integers);
+    discrete(nlvc, std::min(nlvci, nlvc - nlvb), Integers);
+    discrete(nlv, std::min(nlvoi > nlvci ? nlvoi - nlvci : 0, nlv - nlvc), Integers);
+    discrete(n_vars - niv, nbv, Binary);
+    discrete(n_vars, niv, Integers);
+
+    vars.reserve(n_vars);
+    model.repn->variables.reserve(n_vars);
+    for (size_t i = 0; i < n_vars; ++i) {
+        auto var = model.add_variable();
+        if (vtype[i] != Reals) var.within(vtype[i]);
+        vars.push_back(var);
+    }
+
+    size_t n_defined = 0;
+    for (size_t i = 0; i < 5; ++i) n_defined += static_cast<size_t>(value(10, i));
+    defined.resize(n_defined);
+    is_defined.resize(n_defined, false);
+
+    c_expr.resize(n_cons);
+    c_linear.resize(n_cons);
+    r_type.resize(n_cons, '3');
+    r_val.resize(2 * n_cons, 0);
+    o_expr.resize(n_objs);
+    o_linear.resize(n_objs);
+    o_sense.resize(n_objs, false);
+}
+
+Expression NLReader::variable_expression(size_t i)
+{
+    if (i < n_vars) return vars[i];
+    i -= n_vars;
+    if ((i >= defined.size()) or not is_defined[i])
+        scan.error("Undefined variable: v" + std::to_string(i + n_vars));
+    return defined[i];
+}
+
+//
+// Read an expression in prefix form.  The operators whose arguments are being
+// read are kept on a stack, so deeply nested expressions do not exhaust the
+// call stack.
+//
+Expression NLReader::read_expression()
+{
+    size_t base = frames.size();
+    while (true) {
+        Expression value;
+        char c = scan.key();
+        switch (c) {
+            case 'n':
+                value = Expression(scan.real());
+                break;
+
+            case 's':
+                if (scan.binary) {
+                    scan.need(sizeof(std::int16_t));
+                    std::int16_t tmp;
+                    std::memcpy(&tmp, scan.p, sizeof(tmp));
+                    scan.p += sizeof(tmp);
+                    value = Expression(static_cast<double>(tmp));
+                }
+                else
+                    value = Expression(scan.real());
+                break;
+
+            case 'l':
+                if (scan.binary)
+                    value = Expression(static_cast<double>(scan.integer()));
+                else
+                    value = Expression(scan.real());
+                break;
+
+            case 'v':
+                value = variable_expression(
+                    scan.index(n_vars + defined.size(), "variable"));
+                break;
+
+            case 'o': {
+                long op = scan.integer();
+                size_t nargs;
+                if (op == 54) {
+                    scan.end_line();
+                    long n = scan.integer();
+                    if (n < 1) scan.error("Invalid number of terms in a sum: " + std::to_string(n));
+                    nargs = static_cast<size_t>(n);
+                }
+                else if ((op <= 3) or (op == 5) or (op == 74) or (op == 76))
+                    nargs = 2;
+                else if ((op == 16) or (op == 75) or unary_function(op))
+                    nargs = 1;
+                else
+                    scan.error("Unsupported operator: o" + std::to_string(op));
+                scan.end_line();
+                frames.push_back(Frame{op, nargs, {}});
+                frames.back().args.reserve(nargs);
+                continue;
+            }
+
+            default:
+                scan.error(std::string("Unexpected expression token '") + c + "'");
+        };
+        scan.end_line();
+
+        // Pass the value to the operators that are complete
+        while (true) {
+            if (frames.size() == base) return value;
+            auto& frame = frames.back();
+            frame.args.push_back(value);
+            if (frame.args.size() < frame.nargs) break;
+            value = apply(frame);
+            frames.pop_back();
+        }
+    }
+}
+
+Expression NLReader::apply(Frame& frame)
+{
+    auto& args = frame.args;
+    switch (frame.op) {
+        case 0:
+            return args[0] + args[1];
+        case 1:
+            return args[0] - args[1];
+        case 2:
+            return args[0] * args[1];
+        case 3:
+            return args[0] / args[1];
+        case 5:
+        case 74:
+        case 76:
+            return pow(args[0], args[1]);
+        case 16:
+            return -args[0];
+        case 54: {
+            Expression e = args[0];
+            for (size_t i = 1; i < args.size(); ++i) e += args[i];
+            return e;
+        }
+        case 75:
+            return pow(args[0], 2.0);
+        default:
+            return unary_function(frame.op)(args[0]);
+    };
+}
+
+//
+// Read nz (index, coefficient) pairs, and create an affine expression
+//
+Expression NLReader::read_linear(size_t nz)
+{
+    std::vector<double> coef;
+    std::vector<Variable> var;
+    coef.reserve(nz);
+    var.reserve(nz);
+    for (size_t j = 0; j < nz; ++j) {
+        size_t i = scan.index(n_vars, "variable");
+        double value = scan.real();
+        scan.end_line();
+        if (value != 0) {
+            coef.push_back(value);
+            var.push_back(vars[i]);
+        }
+    }
+    if (var.size() == 0) return Expression();
+    return affine_expression(coef, var, 0.0);
+}
+
+//
+// Read the bound type and values for a record in the "r" or "b" section
+//
+void NLReader::read_bounds(char& type, double* val)
+{
+    type = scan.key();
+    switch (type) {
+        case '0':
+            val[0] = scan.real();
+            val[1] = scan.real();
+            break;
+        case '1':
+        case '2':
+        case '4':
+            val[0] = scan.real();
+            break;
+        case '3':
+            break;
+        default:
+            scan.error(std::string("Unsupported bound type '") + type + "'");
+    };
+    scan.end_line();
+}
+
+//
+// Skip a suffix segment.  Suffix values are integers unless bit 2 of the
+// suffix kind is set.
+//
+void NLReader::skip_suffix()
+{
+    long kind = scan.integer();
+    long n = scan.integer();
+    if (scan.binary) {
+        long len = scan.integer();
+        if (len < 0) scan.error("Invalid suffix name");
+        scan.need(static_cast<size_t>(len));
+        scan.p += len;
+    }
+    scan.end_line();
+    for (long j = 0; j < n; ++j) {
+        scan.integer();
+        if (kind & 4)
+            scan.real();
+        else
+            scan.integer();
+        scan.end_line();
+    }
+}
+
+void NLReader::read_segments()
+{
+    char c;
+    while (scan.next_key(c)) {
+        switch (c) {
+            case 'C': {
+                size_t i = scan.index(n_cons, "constraint");
+                scan.end_line();
+                c_expr[i] = read_expression();
+            } break;
+
+            case 'O': {
+                size_t i = scan.index(n_objs, "objective");
+                o_sense[i] = scan.integer() != 0;
+                scan.end_line();
+                o_expr[i] = read_expression();
+            } break;
+
+            case 'V': {
+                long i = scan.integer() - static_cast<long>(n_vars);
+                if ((i < 0) or (static_cast<size_t>(i) >= defined.size()))
+                    scan.error("Invalid defined variable index: "
+                               + std::to_string(i + static_cast<long>(n_vars)));
+                long nz = scan.integer();
+                scan.integer();
+                scan.end_line();
+                Expression linear = read_linear(static_cast<size_t>(nz));
+                Expression e = read_expression();
+                if (nz > 0) e = linear + e;
+                defined[static_cast<size_t>(i)] = SubExpression(e);
+                is_defined[static_cast<size_t>(i)] = true;
+            } break;
+
+            case 'J': {
+                size_t i = scan.index(n_cons, "constraint");
+                long nz = scan.integer();
+                scan.end_line();
+                c_linear[i] = read_linear(static_cast<size_t>(nz));
+            } break;
+
+            case 'G': {
+                size_t i = scan.index(n_objs, "objective");
+                long nz = scan.integer();
+                scan.end_line();
+                o_linear[i] = read_linear(static_cast<size_t>(nz));
+            } break;
+
+            case 'x': {
+                long n = scan.integer();
+                scan.end_line();
+                for (long j = 0; j < n; ++j) {
+                    size_t i = scan.index(n_vars, "variable");
+                    vars[i].value(scan.real());
+                    scan.end_line();
+                }
+            } break;
+
+            case 'r':
+                scan.end_line();
+                for (size_t i = 0; i < n_cons; ++i) read_bounds(r_type[i], &r_val[2 * i]);
+                r_found = true;
+                break;
+
+            case 'b':
+                scan.end_line();
+                for (auto& var : vars) {
+                    char type;
+                    double val[2];
+                    read_bounds(type, val);
+                    switch (type) {
+                        case '0':
+                            var.bounds(val[0], val[1]);
+                            break;
+                        case '1':
+                            var.upper(val[0]);
+                            break;
+                        case '2':
+                            var.lower(val[0]);
+                            break;
+                        case '4':
+                            var.bounds(val[0], val[0]);
+                            break;
+                    };
+                }
+                break;
+
+            case 'k': {
+                // The Jacobian column counts are implied by the J segments
+                long n = scan.integer();
+                scan.end_line();
+                for (long j = 0; j < n; ++j) {
+                    scan.size();
+                    scan.end_line();
+                }
+            } break;
+
+            case 'd': {
+                // Initial values of the dual variables are ignored
+                long n = scan.integer();
+                scan.end_line();
+                for (long j = 0; j < n; ++j) {
+                    scan.integer();
+                    scan.real();
+                    scan.end_line();
+                }
+            } break;
+
+            case 'S':
+                skip_suffix();
+                break;
+
+            case 'F':
+                scan.error("Imported functions are not supported");
+
+            case 'L':
+                scan.error("Logical constraints are not supported");
+
+            default:
+                scan.error(std::string("Unknown segment '") + c + "'");
+        };
+    }
+    if ((n_cons > 0) and not r_found) scan.error("Missing constraint bounds");
+}
+
+//
+// The body of a constraint or objective is the sum of its linear and
+// nonlinear parts.  Constant nonlinear parts that are zero are omitted.
+//
+Expression combine(const Expression& linear, const Expression& nonlinear)
+{
+    bool zero = nonlinear.is_constant() and (nonlinear.value() == 0);
+    if (zero) return linear;
+    if (linear.is_constant() and (linear.value() == 0)) return nonlinear;
+    return linear + nonlinear;
+}
+
+Model NLReader::create_model()
+{
+    for (size_t i = 0; i < n_cons; ++i) {
+        Expression body = combine(c_linear[i], c_expr[i]);
+        const double* val = &r_val[2 * i];
+        switch (r_type[i]) {
+            case '0':
+                model.add_constraint(inequality(val[0], body, val[1]));
+                break;
+            case '1':
+                model.add_constraint(body <= val[0]);
+                break;
+            case '2':
+                model.add_constraint(body >= val[0]);
+                break;
+            case '3':
+                model.add_constraint(inequality(-COEK_INFINITY, body, COEK_INFINITY));
+                break;
+            case '4':
+                model.add_constraint(body == val[0]);
+                break;
+        };
+    }
+
+    for (size_t i = 0; i < n_objs; ++i) {
+        model.add_objective(combine(o_linear[i], o_expr[i]))
+            .sense(o_sense[i] ? Model::maximize : Model::minimize);
+    }
+
+    return model;
+}
+
+}  // namespace reader_nl
+
+Model read_problem_from_nl_file(const std::string& fname)
+{
+    MappedFile file(fname);
+    reader_nl::NLReader reader(file, fname);
+    reader.read_header();
+    reader.read_segments();
+    return reader.create_model();
+}
+
+}  // namespace coek
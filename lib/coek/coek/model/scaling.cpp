@@ -0,0 +1,89 @@
+#include "coek/model/scaling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/ast/visitor_fns.hpp"
+#include "coek/model/model_repn.hpp"
+
+namespace coek {
+
+size_t compute_scaling_factors(Model& model, const ScalingOptions& options)
+{
+    const std::string name = "scaling_factor";
+    auto& mrepn = *model.repn;
+    size_t count = 0;
+
+    //
+    // The largest scaled derivative with respect to each variable
+    //
+    std::unordered_map<VariableTerm*, double> column_max;
+
+    auto scale_row = [&](const expr_pointer_t& body, size_t id, auto& suffix) {
+        std::map<std::shared_ptr<VariableTerm>, expr_pointer_t> diff;
+        symbolic_diff_all(body, diff);
+
+        std::vector<std::pair<VariableTerm*, double>> derivatives;
+        double row_max = 0;
+        for (auto& it : diff) {
+            double value = std::fabs(it.second->eval());
+            // Derivatives that cannot be evaluated at the current point are ignored
+            if (not std::isfinite(value)) continue;
+            derivatives.emplace_back(it.first.get(), value);
+            row_max = std::max(row_max, value);
+        }
+
+        double factor;
+        auto& factors = suffix[name];
+        auto jt = factors.find(static_cast<unsigned int>(id));
+        if (jt != factors.end())
+            factor = jt->second;
+        else {
+            factor = 1;
+            if (row_max > options.max_gradient) {
+                factor = std::max(options.min_value, options.max_gradient / row_max);
+                factors[static_cast<unsigned int>(id)] = factor;
+                ++count;
+            }
+        }
+
+        for (auto& it : derivatives) {
+            auto& tmp = column_max[it.first];
+            tmp = std::max(tmp, factor * it.second);
+        }
+    };
+
+    for (auto& obj : mrepn.objectives) scale_row(obj.repn->body, obj.id(), mrepn.osuffix);
+    for (auto& con : mrepn.constraints) scale_row(con.repn->body, con.id(), mrepn.csuffix);
+
+    if (options.scale_variables) {
+        auto& factors = mrepn.vsuffix[name];
+        for (auto& var : mrepn.variables) {
+            auto it = column_max.find(var.repn.get());
+            if (it == column_max.end()) continue;
+            auto id = static_cast<unsigned int>(var.id());
+            if (factors.find(id) != factors.end()) continue;
+            if ((it->second > 0) and (it->second * options.max_gradient < 1)) {
+                factors[id] = std::max(options.min_value, it->second);
+                ++count;
+            }
+        }
+    }
+
+    // Suffixes without values are not stored
+    for (auto* suffix : {&mrepn.vsuffix, &mrepn.csuffix, &mrepn.osuffix}) {
+        auto it = suffix->find(name);
+        if ((it != suffix->end()) and (it->second.size() == 0)) suffix->erase(it);
+    }
+
+    return count;
+}
+
+}  // namespace coek
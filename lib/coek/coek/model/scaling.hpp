@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include <coek/model/model.hpp>
+
+namespace coek {
+
+/**
+ * Options for coek::compute_scaling_factors().
+ */
+class ScalingOptions {
+   public:
+    /** The largest derivative of a scaled objective or constraint */
+    double max_gradient = 100.0;
+    /** The smallest scaling factor */
+    double min_value = 1e-8;
+    /** If \c true, then variables whose derivatives are all small are scaled */
+    bool scale_variables = false;
+};
+
+/**
+ * Compute gradient-based scaling factors for a model.
+ *
+ * The derivatives of the objectives and constraints are evaluated at the current
+ * variable values.  As in the gradient-based scaling of Ipopt, an objective or
+ * constraint whose largest derivative d is greater than \c max_gradient is scaled
+ * by \c max_gradient/d.  If \c scale_variables is \c true, then a variable whose
+ * largest derivative d in the scaled rows is less than \c 1/max_gradient is scaled
+ * by d.  Scaling factors are never less than \c min_value.
+ *
+ * The factors are stored in the \c scaling_factor suffixes of the model, which are
+ * written to NL files and passed to the ipopt solver.  Factors that are already
+ * set, e.g. by the user, are not changed.  A component without a factor is not
+ * scaled.
+ *
+ * \param model  the model that is scaled
+ * \param options  options that control scaling
+ *
+ * \returns the number of scaling factors that were set
+ */
+size_t compute_scaling_factors(Model& model, const ScalingOptions& options = ScalingOptions());
+
+}  // namespace coek
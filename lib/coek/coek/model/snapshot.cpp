@@ -0,0 +1,729 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/expr_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/model/model.hpp"
+#include "coek/util/mapped_file.hpp"
+#include "model_repn.hpp"
+
+namespace coek {
+
+//
+// A model snapshot is a binary file that contains a flat representation of a model.
+// All references are stored as indices, so the file is position-independent and
+// it can be used directly after it is memory-mapped.
+//
+// The file contains a header followed by these sections, each of which is aligned
+// on an 8-byte boundary:
+//
+//   string offsets    uint64_t[num_strings+1]  (string 0 is the empty string)
+//   string data       char[string_bytes]
+//   nodes             Node[num_nodes]
+//   node arguments    uint64_t[num_args]
+//   variables         uint64_t[num_variables]  (node indices)
+//   objectives        uint64_t[num_objectives]  (node indices)
+//   constraints       uint64_t[num_constraints]  (node indices)
+//   suffixes          Suffix[num_suffixes], each followed by SuffixValue[num_values]
+//
+// Nodes are stored in post-order, so the arguments of a node precede it.  Shared
+// terms are stored once, so the expression DAG is preserved.  The rows of linear
+// constraint blocks are stored as sums of monomials.
+//
+namespace snapshot {
+
+const char magic[8] = {'C', 'O', 'E', 'K', 'S', 'N', 'A', 'P'};
+const uint32_t version = 1;
+const uint32_t byte_order = 0x01020304;
+const uint64_t none = UINT64_MAX;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t num_strings;
+    uint64_t string_bytes;
+    uint64_t num_nodes;
+    uint64_t num_args;
+    uint64_t num_variables;
+    uint64_t num_objectives;
+    uint64_t num_constraints;
+    uint64_t num_suffixes;
+    uint64_t num_writer_threads;
+    uint32_t name_generation;
+    uint32_t reserved;
+};
+
+// The operator of a node is a term_id value, or one of the shared terms below.
+struct Node {
+    uint32_t op;
+    uint32_t flags;
+    uint32_t name;
+    uint32_t num_args;
+    uint64_t args;
+    double value;
+};
+
+// Terms that are shared by all models.  These are identified by the node flags.
+const uint32_t SharedTerm_id = 0;
+enum SharedTerm : uint32_t {
+    Zero = 0,
+    One,
+    NegativeOne,
+    NegativeInfinity,
+    PositiveInfinity,
+    NaN,
+    EmptyConstraint,
+    NumSharedTerms
+};
+
+enum SuffixKind : uint32_t { VariableSuffix = 0, ConstraintSuffix, ObjectiveSuffix, ModelSuffix };
+
+struct Suffix {
+    uint32_t kind;
+    uint32_t name;
+    uint64_t num_values;
+};
+
+struct SuffixValue {
+    uint64_t index;
+    double value;
+};
+
+// Node flags
+const uint32_t binary_flag = 1;
+const uint32_t integer_flag = 2;
+const uint32_t fixed_flag = 4;
+const uint32_t strict_flag = 1;
+const uint32_t sense_flag = 1;
+
+std::vector<BaseExpressionTerm*> shared_terms()
+{
+    return {ZeroConstant.get(),
+            OneConstant.get(),
+            NegativeOneConstant.get(),
+            VariableTerm::negative_infinity.get(),
+            VariableTerm::positive_infinity.get(),
+            VariableTerm::nan.get(),
+            EmptyConstraintRepn.get()};
+}
+
+expr_pointer_t shared_term(uint32_t i)
+{
+    switch (i) {
+        case Zero:
+            return ZeroConstant;
+        case One:
+            return OneConstant;
+        case NegativeOne:
+            return NegativeOneConstant;
+        case NegativeInfinity:
+            return VariableTerm::negative_infinity;
+        case PositiveInfinity:
+            return VariableTerm::positive_infinity;
+        case NaN:
+            return VariableTerm::nan;
+        case EmptyConstraint:
+            return EmptyConstraintRepn;
+    };
+    return nullptr;
+}
+
+size_t padding(size_t n) { return (8 - (n % 8)) % 8; }
+
+// Returns the sum of monomials in a linear row
+expr_pointer_t expand_linear_row(const LinearRowTerm& row)
+{
+    std::vector<expr_pointer_t> terms;
+    for (size_t k = row.begin(); k < row.end(); k++)
+        terms.push_back(CREATE_POINTER(MonomialTerm, row.coef(k), row.var(k)));
+    if (terms.size() == 0) return ZeroConstant;
+    if (terms.size() == 1) return terms[0];
+    auto tmp = CREATE_POINTER(PlusTerm, terms[0], terms[1], false);
+    for (size_t k = 2; k < terms.size(); k++) tmp->push_back(terms[k]);
+    return tmp;
+}
+
+//
+// Collect the nodes in a model.
+//
+// Only terms that may be referenced more than once are indexed by their address.
+// Other expression terms are owned by a single parent, so they are simply added
+// when their parent is visited.
+//
+class SnapshotWriter {
+   public:
+    struct Item {
+        BaseExpressionTerm* term;
+        bool shared;
+        bool expanded;
+        uint32_t num_args;
+    };
+
+    std::vector<uint64_t> string_offsets = {0, 0};
+    std::string string_data;
+    std::vector<Node> nodes;
+    std::vector<uint64_t> args;
+    std::unordered_map<const BaseExpressionTerm*, uint64_t> node_index;
+    std::vector<Item> children;
+    std::vector<Item> stack;
+    std::vector<uint64_t> results;
+    // The expanded linear rows, which are kept until the snapshot is written
+    std::vector<expr_pointer_t> expanded_rows;
+
+    SnapshotWriter()
+    {
+        auto shared = shared_terms();
+        for (uint32_t i = 0; i < shared.size(); ++i) {
+            node_index[shared[i]] = nodes.size();
+            nodes.push_back({SharedTerm_id, i, 0, 0, 0, 0.0});
+        }
+    }
+
+    uint32_t add_string(const std::string& str)
+    {
+        if (str.empty()) return 0;
+        string_data += str;
+        string_offsets.push_back(string_data.size());
+        return static_cast<uint32_t>(string_offsets.size() - 2);
+    }
+
+    template <typename TYPE>
+    void add_child(const std::shared_ptr<TYPE>& child)
+    {
+        if (child and (child->id() == LinearRowTerm_id)) {
+            auto row = static_cast<LinearRowTerm*>(static_cast<BaseExpressionTerm*>(child.get()));
+            expanded_rows.push_back(expand_linear_row(*row));
+            add_child(expanded_rows.back());
+            return;
+        }
+        bool shared = false;
+        if (child) {
+            switch (child->id()) {
+                case ParameterTerm_id:
+                case VariableTerm_id:
+                case SubExpressionTerm_id:
+                    shared = true;
+                    break;
+                default:
+                    shared = child.use_count() > 1;
+            };
+        }
+        children.push_back({child.get(), shared, false, 0});
+    }
+
+    // Collect the arguments of a term, which may be null
+    void get_children(BaseExpressionTerm* term)
+    {
+        children.clear();
+        switch (term->id()) {
+            case ConstantTerm_id:
+                break;
+            case ParameterTerm_id:
+                add_child(static_cast<ParameterTerm*>(term)->value);
+                break;
+            case VariableTerm_id: {
+                auto tmp = static_cast<VariableTerm*>(term);
+                add_child(tmp->lb);
+                add_child(tmp->ub);
+                add_child(tmp->value);
+            } break;
+            case MonomialTerm_id:
+                add_child(static_cast<MonomialTerm*>(term)->var);
+                break;
+            case InequalityTerm_id:
+            case EqualityTerm_id: {
+                auto tmp = static_cast<ConstraintTerm*>(term);
+                add_child(tmp->lower);
+                add_child(tmp->body);
+                add_child(tmp->upper);
+            } break;
+            case ObjectiveTerm_id:
+                add_child(static_cast<ObjectiveTerm*>(term)->body);
+                break;
+            case PlusTerm_id: {
+                auto tmp = static_cast<PlusTerm*>(term);
+                for (size_t i = 0; i < tmp->n; ++i) add_child((*tmp->data)[i]);
+            } break;
+            case SubExpressionTerm_id:
+            case NegateTerm_id:
+            case AbsTerm_id:
+            case CeilTerm_id:
+            case FloorTerm_id:
+            case ExpTerm_id:
+            case LogTerm_id:
+            case Log10Term_id:
+            case SqrtTerm_id:
+            case SinTerm_id:
+            case CosTerm_id:
+            case TanTerm_id:
+            case SinhTerm_id:
+            case CoshTerm_id:
+            case TanhTerm_id:
+            case ASinTerm_id:
+            case ACosTerm_id:
+            case ATanTerm_id:
+            case ASinhTerm_id:
+            case ACoshTerm_id:
+            case ATanhTerm_id:
+                add_child(static_cast<UnaryTerm*>(term)->body);
+                break;
+            case TimesTerm_id:
+            case DivideTerm_id:
+            case PowTerm_id: {
+                auto tmp = static_cast<BinaryTerm*>(term);
+                add_child(tmp->lhs);
+                add_child(tmp->rhs);
+            } break;
+            default:
+                throw std::runtime_error("Cannot save a snapshot of a model with term id "
+                                         + std::to_string(term->id()));
+        };
+    }
+
+    // Add a node whose arguments are the last num_args results
+    uint64_t add_node(BaseExpressionTerm* term, uint32_t num_args)
+    {
+        Node node = {term->id(), 0, 0, num_args, args.size(), 0.0};
+        args.insert(args.end(), results.end() - num_args, results.end());
+        results.resize(results.size() - num_args);
+
+        switch (term->id()) {
+            case ConstantTerm_id:
+                node.value = static_cast<ConstantTerm*>(term)->value;
+                break;
+            case ParameterTerm_id:
+                node.name = add_string(static_cast<ParameterTerm*>(term)->name);
+                break;
+            case VariableTerm_id: {
+                auto tmp = static_cast<VariableTerm*>(term);
+                node.flags = (tmp->binary ? binary_flag : 0) | (tmp->integer ? integer_flag : 0)
+                             | (tmp->fixed ? fixed_flag : 0);
+                node.name = add_string(tmp->name);
+            } break;
+            case MonomialTerm_id:
+                node.value = static_cast<MonomialTerm*>(term)->coef;
+                break;
+            case InequalityTerm_id: {
+                auto tmp = static_cast<InequalityTerm*>(term);
+                node.flags = tmp->strict ? strict_flag : 0;
+                node.name = add_string(tmp->name);
+            } break;
+            case EqualityTerm_id:
+                node.name = add_string(static_cast<EqualityTerm*>(term)->name);
+                break;
+            case ObjectiveTerm_id: {
+                auto tmp = static_cast<ObjectiveTerm*>(term);
+                node.flags = tmp->sense ? sense_flag : 0;
+                node.name = add_string(tmp->name);
+            } break;
+            case SubExpressionTerm_id:
+                node.name = add_string(static_cast<SubExpressionTerm*>(term)->name);
+                break;
+            default:
+                break;
+        };
+
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    }
+
+    // Add the nodes for an expression in post-order
+    uint64_t add(BaseExpressionTerm* root)
+    {
+        stack.push_back({root, true, false, 0});
+        while (stack.size() > 0) {
+            auto& item = stack.back();
+            if (not item.term) {
+                results.push_back(none);
+                stack.pop_back();
+            }
+            else if (item.expanded) {
+                auto term = item.term;
+                bool shared = item.shared;
+                auto i = add_node(term, item.num_args);
+                stack.pop_back();
+                results.push_back(i);
+                if (shared) node_index[term] = i;
+            }
+            else {
+                if (item.shared) {
+                    auto it = node_index.find(item.term);
+                    if (it != node_index.end()) {
+                        results.push_back(it->second);
+                        stack.pop_back();
+                        continue;
+                    }
+                }
+                get_children(item.term);
+                item.expanded = true;
+                item.num_args = static_cast<uint32_t>(children.size());
+                stack.insert(stack.end(), children.rbegin(), children.rend());
+            }
+        }
+        auto i = results.back();
+        results.pop_back();
+        return i;
+    }
+};
+
+class SnapshotReader {
+   public:
+    const std::string& fname;
+    const MappedFile& file;
+    size_t offset = 0;
+
+    SnapshotReader(const MappedFile& _file, const std::string& _fname) : fname(_fname), file(_file)
+    {
+    }
+
+    [[noreturn]] void error(const std::string& msg) const
+    {
+        throw std::runtime_error("Error loading model snapshot " + fname + ": " + msg);
+    }
+
+    // Get a pointer to an array of n values, which is aligned on an 8-byte boundary
+    template <typename TYPE>
+    const TYPE* array(uint64_t n)
+    {
+        if ((n > (file.size - offset) / sizeof(TYPE)) or (offset % 8 != 0))
+            error("Unexpected end of file");
+        auto tmp = reinterpret_cast<const TYPE*>(file.data + offset);
+        offset += n * sizeof(TYPE);
+        offset += padding(offset);
+        if (offset > file.size) error("Unexpected end of file");
+        return tmp;
+    }
+
+    Model load();
+};
+
+Model SnapshotReader::load()
+{
+    if (reinterpret_cast<uintptr_t>(file.data) % 8 != 0) error("Misaligned file data");
+    if ((file.size < sizeof(Header)) or (std::memcmp(file.data, magic, sizeof(magic)) != 0))
+        error("Not a model snapshot");
+    Header header;
+    std::memcpy(&header, file.data, sizeof(Header));
+    offset = sizeof(Header);
+    if (header.byte_order != byte_order) error("Incompatible byte order");
+    if (header.version != version)
+        error("Unsupported snapshot version " + std::to_string(header.version));
+
+    auto string_offsets = array<uint64_t>(header.num_strings + 1);
+    auto string_data = array<char>(header.string_bytes);
+    auto nodes = array<Node>(header.num_nodes);
+    auto args = array<uint64_t>(header.num_args);
+    auto variables = array<uint64_t>(header.num_variables);
+    auto objectives = array<uint64_t>(header.num_objectives);
+    auto constraints = array<uint64_t>(header.num_constraints);
+
+    auto get_string = [&](uint32_t i) {
+        if (i == 0) return std::string();
+        if ((i >= header.num_strings) or (string_offsets[i] > string_offsets[i + 1])
+            or (string_offsets[i + 1] > header.string_bytes))
+            error("Invalid string index " + std::to_string(i));
+        return std::string(string_data + string_offsets[i],
+                           string_data + string_offsets[i + 1]);
+    };
+
+    //
+    // Create the terms.  The arguments of each node have already been created.
+    //
+    std::vector<expr_pointer_t> terms(header.num_nodes);
+    for (uint64_t i = 0; i < header.num_nodes; ++i) {
+        const Node& node = nodes[i];
+        if ((node.args > header.num_args) or (node.num_args > header.num_args - node.args))
+            error("Invalid arguments for node " + std::to_string(i));
+        auto arg = [&](uint32_t j) -> expr_pointer_t {
+            if (j >= node.num_args) error("Missing argument for node " + std::to_string(i));
+            auto k = args[node.args + j];
+            if (k == none) return nullptr;
+            if (k >= i) error("Invalid argument for node " + std::to_string(i));
+            return terms[k];
+        };
+        auto required_arg = [&](uint32_t j) {
+            auto tmp = arg(j);
+            if (not tmp) error("Missing argument for node " + std::to_string(i));
+            return tmp;
+        };
+
+        switch (node.op) {
+            case SharedTerm_id:
+                if (node.flags >= NumSharedTerms)
+                    error("Unknown shared term " + std::to_string(node.flags));
+                terms[i] = shared_term(node.flags);
+                break;
+            case ConstantTerm_id:
+                terms[i] = CREATE_POINTER(ConstantTerm, node.value);
+                break;
+            case ParameterTerm_id: {
+                auto tmp = CREATE_POINTER(ParameterTerm, required_arg(0));
+                tmp->name = get_string(node.name);
+                terms[i] = tmp;
+            } break;
+            case VariableTerm_id: {
+                auto tmp = CREATE_POINTER(VariableTerm, arg(0), arg(1), arg(2),
+                                          node.flags & binary_flag, node.flags & integer_flag);
+                tmp->fixed = node.flags & fixed_flag;
+                tmp->name = get_string(node.name);
+                terms[i] = tmp;
+            } break;
+            case MonomialTerm_id: {
+                auto var = required_arg(0);
+                if (var->id() != VariableTerm_id)
+                    error("Expected a variable argument for node " + std::to_string(i));
+                terms[i] = CREATE_POINTER(MonomialTerm, node.value,
+                                          std::static_pointer_cast<VariableTerm>(var));
+            } break;
+            case InequalityTerm_id: {
+                auto tmp = CREATE_POINTER(InequalityTerm, arg(0), required_arg(1), arg(2),
+                                          node.flags & strict_flag);
+                tmp->name = get_string(node.name);
+                terms[i] = tmp;
+            } break;
+            case EqualityTerm_id: {
+                auto tmp = CREATE_POINTER(EqualityTerm, required_arg(1), required_arg(0));
+                tmp->name = get_string(node.name);
+                terms[i] = tmp;
+            } break;
+            case ObjectiveTerm_id: {
+                auto tmp = CREATE_POINTER(ObjectiveTerm, required_arg(0), node.flags & sense_flag);
+                tmp->name = get_string(node.name);
+                terms[i] = tmp;
+            } break;
+            case SubExpressionTerm_id: {
+                auto tmp = CREATE_POINTER(SubExpressionTerm, required_arg(0));
+                tmp->name = get_string(node.name);
+                terms[i] = tmp;
+            } break;
+            case PlusTerm_id: {
+                if (node.num_args < 2) error("Invalid sum for node " + std::to_string(i));
+                auto tmp = CREATE_POINTER(PlusTerm, required_arg(0), required_arg(1), false);
+                tmp->data->reserve(node.num_args);
+                for (uint32_t j = 2; j < node.num_args; ++j) tmp->push_back(required_arg(j));
+                terms[i] = tmp;
+            } break;
+            case TimesTerm_id:
+                terms[i] = CREATE_POINTER(TimesTerm, required_arg(0), required_arg(1));
+                break;
+            case DivideTerm_id:
+                terms[i] = CREATE_POINTER(DivideTerm, required_arg(0), required_arg(1));
+                break;
+            case PowTerm_id:
+                terms[i] = CREATE_POINTER(PowTerm, required_arg(0), required_arg(1));
+                break;
+
+#define UNARY_NODE(TERM)                                 \
+    case TERM##_id:                                      \
+        terms[i] = CREATE_POINTER(TERM, required_arg(0)); \
+        break;
+
+                UNARY_NODE(NegateTerm)
+                UNARY_NODE(AbsTerm)
+                UNARY_NODE(CeilTerm)
+                UNARY_NODE(FloorTerm)
+                UNARY_NODE(ExpTerm)
+                UNARY_NODE(LogTerm)
+                UNARY_NODE(Log10Term)
+                UNARY_NODE(SqrtTerm)
+                UNARY_NODE(SinTerm)
+                UNARY_NODE(CosTerm)
+                UNARY_NODE(TanTerm)
+                UNARY_NODE(SinhTerm)
+                UNARY_NODE(CoshTerm)
+                UNARY_NODE(TanhTerm)
+                UNARY_NODE(ASinTerm)
+                UNARY_NODE(ACosTerm)
+                UNARY_NODE(ATanTerm)
+                UNARY_NODE(ASinhTerm)
+                UNARY_NODE(ACoshTerm)
+                UNARY_NODE(ATanhTerm)
+#undef UNARY_NODE
+
+            default:
+                error("Unknown operator " + std::to_string(node.op) + " for node "
+                      + std::to_string(i));
+        };
+    }
+
+    //
+    // Create the model
+    //
+    auto get_node = [&](uint64_t i, bool (*valid)(const Node&), const std::string& what) {
+        if ((i >= header.num_nodes) or (not valid(nodes[i])))
+            error("Invalid " + what + " node " + std::to_string(i));
+        return terms[i];
+    };
+
+    Model model;
+    auto& repn = *model.repn;
+    repn.variables.reserve(header.num_variables);
+    for (uint64_t i = 0; i < header.num_variables; ++i)
+        repn.variables.emplace_back(std::static_pointer_cast<VariableTerm>(get_node(
+            variables[i], [](const Node& node) { return node.op == VariableTerm_id; },
+            "variable")));
+    repn.objectives.reserve(header.num_objectives);
+    for (uint64_t i = 0; i < header.num_objectives; ++i)
+        repn.objectives.emplace_back(std::static_pointer_cast<ObjectiveTerm>(get_node(
+            objectives[i], [](const Node& node) { return node.op == ObjectiveTerm_id; },
+            "objective")));
+    repn.constraints.reserve(header.num_constraints);
+    for (uint64_t i = 0; i < header.num_constraints; ++i)
+        repn.constraints.emplace_back(std::static_pointer_cast<ConstraintTerm>(get_node(
+            constraints[i],
+            [](const Node& node) {
+                return (node.op == InequalityTerm_id) or (node.op == EqualityTerm_id)
+                       or ((node.op == SharedTerm_id) and (node.flags == EmptyConstraint));
+            },
+            "constraint")));
+
+    for (uint64_t i = 0; i < header.num_suffixes; ++i) {
+        auto suffix = array<Suffix>(1);
+        auto values = array<SuffixValue>(suffix->num_values);
+        auto name = get_string(suffix->name);
+        auto check = [&](uint64_t index, uint64_t n) {
+            if (index >= n) error("Invalid suffix index " + std::to_string(index));
+        };
+        switch (suffix->kind) {
+            case VariableSuffix: {
+                auto& data = repn.vsuffix[name];
+                for (uint64_t j = 0; j < suffix->num_values; ++j) {
+                    check(values[j].index, header.num_variables);
+                    data[repn.variables[values[j].index].id()] = values[j].value;
+                }
+            } break;
+            case ConstraintSuffix: {
+                auto& data = repn.csuffix[name];
+                for (uint64_t j = 0; j < suffix->num_values; ++j) {
+                    check(values[j].index, header.num_constraints);
+                    data[repn.constraints[values[j].index].id()] = values[j].value;
+                }
+            } break;
+            case ObjectiveSuffix: {
+                auto& data = repn.osuffix[name];
+                for (uint64_t j = 0; j < suffix->num_values; ++j) {
+                    check(values[j].index, header.num_objectives);
+                    data[repn.objectives[values[j].index].id()] = values[j].value;
+                }
+            } break;
+            case ModelSuffix:
+                if (suffix->num_values != 1) error("Invalid model suffix " + name);
+                repn.msuffix[name] = values[0].value;
+                break;
+            default:
+                error("Unknown suffix kind " + std::to_string(suffix->kind));
+        };
+    }
+
+    if (header.name_generation > Model::NameGeneration::eager)
+        error("Unknown name generation policy " + std::to_string(header.name_generation));
+    repn.name_generation_policy = static_cast<Model::NameGeneration>(header.name_generation);
+    repn.num_writer_threads = header.num_writer_threads;
+
+    return model;
+}
+
+}  // namespace snapshot
+
+void Model::save_snapshot(const std::string& filename)
+{
+    if (repn->name_generation_policy == Model::NameGeneration::lazy) generate_names();
+
+    snapshot::SnapshotWriter writer;
+    std::vector<uint64_t> variables(repn->variables.size());
+    std::vector<uint64_t> objectives(repn->objectives.size());
+    std::vector<uint64_t> constraints(repn->constraints.size());
+    for (size_t i = 0; i < variables.size(); ++i)
+        variables[i] = writer.add(repn->variables[i].repn.get());
+    for (size_t i = 0; i < objectives.size(); ++i)
+        objectives[i] = writer.add(repn->objectives[i].repn.get());
+    for (size_t i = 0; i < constraints.size(); ++i)
+        constraints[i] = writer.add(repn->constraints[i].repn.get());
+
+    //
+    // Suffixes are indexed by the position of the variable, constraint or objective in
+    // the model.  Suffix values for components that are not in the model are ignored.
+    //
+    std::vector<std::pair<snapshot::Suffix, std::vector<snapshot::SuffixValue>>> suffixes;
+    auto add_suffixes = [&](uint32_t kind, const auto& suffix_data, const auto& components) {
+        if (suffix_data.size() == 0) return;
+        std::unordered_map<unsigned int, uint64_t> position;
+        for (size_t i = 0; i < components.size(); ++i) position[components[i].id()] = i;
+        for (auto& [name, data] : suffix_data) {
+            std::vector<snapshot::SuffixValue> values;
+            for (auto& [id, value] : data) {
+                auto it = position.find(id);
+                if (it != position.end()) values.push_back({it->second, value});
+            }
+            std::sort(values.begin(), values.end(),
+                      [](const auto& a, const auto& b) { return a.index < b.index; });
+            suffixes.push_back({{kind, writer.add_string(name), values.size()}, values});
+        }
+    };
+    add_suffixes(snapshot::VariableSuffix, repn->vsuffix, repn->variables);
+    add_suffixes(snapshot::ConstraintSuffix, repn->csuffix, repn->constraints);
+    add_suffixes(snapshot::ObjectiveSuffix, repn->osuffix, repn->objectives);
+    for (auto& [name, value] : repn->msuffix)
+        suffixes.push_back({{snapshot::ModelSuffix, writer.add_string(name), 1}, {{0, value}}});
+
+    snapshot::Header header;
+    std::memcpy(header.magic, snapshot::magic, sizeof(header.magic));
+    header.version = snapshot::version;
+    header.byte_order = snapshot::byte_order;
+    header.num_strings = writer.string_offsets.size() - 1;
+    header.string_bytes = writer.string_data.size();
+    header.num_nodes = writer.nodes.size();
+    header.num_args = writer.args.size();
+    header.num_variables = variables.size();
+    header.num_objectives = objectives.size();
+    header.num_constraints = constraints.size();
+    header.num_suffixes = suffixes.size();
+    header.num_writer_threads = repn->num_writer_threads;
+    header.name_generation = static_cast<uint32_t>(repn->name_generation_policy);
+    header.reserved = 0;
+
+    std::ofstream ostr(filename, std::ios::binary);
+    if (not ostr) throw std::runtime_error("Cannot open file: " + filename);
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    auto write = [&](const void* data, size_t n) {
+        ostr.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+        ostr.write(zeros, static_cast<std::streamsize>(snapshot::padding(n)));
+    };
+    auto write_vector = [&](const auto& data) {
+        write(data.data(), data.size() * sizeof(data[0]));
+    };
+    write(&header, sizeof(header));
+    write_vector(writer.string_offsets);
+    write(writer.string_data.data(), writer.string_data.size());
+    write_vector(writer.nodes);
+    write_vector(writer.args);
+    write_vector(variables);
+    write_vector(objectives);
+    write_vector(constraints);
+    for (auto& [suffix, values] : suffixes) {
+        write(&suffix, sizeof(suffix));
+        write_vector(values);
+    }
+    ostr.close();
+    if (not ostr) throw std::runtime_error("Error writing file: " + filename);
+}
+
+Model Model::load_snapshot(const std::string& filename)
+{
+    MappedFile file(filename);
+    snapshot::SnapshotReader reader(file, filename);
+    return reader.load();
+}
+
+}  // namespace coek
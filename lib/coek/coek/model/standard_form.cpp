@@ -0,0 +1,279 @@
+#include "coek/model/standard_form.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/expression_visitor.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/model/model.hpp"
+#include "coek/util/id_index.hpp"
+#include "coek/util/parallel.hpp"
+#include "model_repn.hpp"
+
+namespace coek {
+
+void index_model_variables(Model& model, IdIndex& declared);
+
+//
+// The standard form of a model, along with the model data that it was computed from.
+// The signature contains the variables, constraints, objectives and objective
+// expressions of the model, and the fixed_values vector contains the values of the
+// fixed variables.  If either of these changes, then the standard form is recomputed.
+//
+class StandardFormCache {
+   public:
+    StandardForm data;
+
+    std::vector<const void*> signature;
+    std::vector<unsigned char> fixed;
+    std::vector<double> fixed_values;
+    // The constant term in the body of each row
+    std::vector<double> row_constants;
+};
+
+namespace {
+
+// The number of rows that are collected in each parallel work item
+const size_t block_size = 256;
+
+struct Triplet {
+    size_t row;
+    size_t col;
+    double value;
+};
+
+void model_signature(ModelRepn& mrepn, std::vector<const void*>& signature,
+                     std::vector<unsigned char>& fixed, std::vector<double>& fixed_values)
+{
+    signature.clear();
+    fixed.clear();
+    fixed_values.clear();
+    for (auto& var : mrepn.variables) {
+        signature.push_back(var.repn.get());
+        fixed.push_back(var.fixed() ? 1 : 0);
+        if (var.fixed()) fixed_values.push_back(var.value());
+    }
+    for (auto& con : mrepn.constraints) signature.push_back(con.repn.get());
+    for (auto& obj : mrepn.objectives) {
+        signature.push_back(obj.repn.get());
+        signature.push_back(obj.repn->body.get());
+    }
+}
+
+//
+// Sort the triplets by (major, minor), sum the duplicates, and store them in a
+// compressed format.
+//
+template <typename MAJOR, typename MINOR>
+void compress(std::vector<Triplet>& triplets, size_t n, MAJOR major, MINOR minor,
+              std::vector<size_t>& start, std::vector<size_t>& index, std::vector<double>& values)
+{
+    std::sort(triplets.begin(), triplets.end(), [&](const Triplet& a, const Triplet& b) {
+        return (major(a) < major(b)) or ((major(a) == major(b)) and (minor(a) < minor(b)));
+    });
+
+    start.assign(n + 1, 0);
+    index.clear();
+    values.clear();
+    for (size_t k = 0; k < triplets.size(); k++) {
+        auto& t = triplets[k];
+        if ((k > 0) and (major(t) == major(triplets[k - 1]))
+            and (minor(t) == minor(triplets[k - 1]))) {
+            values.back() += t.value;
+            continue;
+        }
+        start[major(t) + 1]++;
+        index.push_back(minor(t));
+        values.push_back(t.value);
+    }
+    for (size_t i = 0; i < n; i++) start[i + 1] += start[i];
+}
+
+void refresh_bounds(ModelRepn& mrepn, StandardFormCache& cache)
+{
+    auto& data = cache.data;
+    for (size_t i = 0; i < data.num_rows; i++) {
+        auto& con = mrepn.constraints[i];
+        auto lower = con.lower();
+        auto upper = con.upper();
+        double constval = cache.row_constants[i];
+        if (not con.is_inequality()) {
+            data.row_lower[i] = data.row_upper[i] = lower.value() - constval;
+            continue;
+        }
+        data.row_lower[i] = lower.repn ? lower.value() - constval : -COEK_INFINITY;
+        data.row_upper[i] = upper.repn ? upper.value() - constval : COEK_INFINITY;
+    }
+
+    for (size_t j = 0; j < data.num_cols; j++) {
+        auto& var = mrepn.variables[j];
+        if (var.fixed()) {
+            data.col_lower[j] = data.col_upper[j] = var.value();
+        }
+        else {
+            data.col_lower[j] = var.lower();
+            data.col_upper[j] = var.upper();
+        }
+        data.integer[j] = (var.is_binary() or var.is_integer()) ? 1 : 0;
+    }
+}
+
+void compute_standard_form(Model& model, StandardFormCache& cache, size_t nthreads)
+{
+    auto& mrepn = *model.repn;
+    if (mrepn.objectives.size() > 1)
+        throw std::runtime_error("Cannot create a standard form for a model with "
+                                 + std::to_string(mrepn.objectives.size()) + " objectives");
+
+    IdIndex declared;
+    index_model_variables(model, declared);
+    auto column = [&](const VariableRepn& var) {
+        size_t j = declared.find(var->index);
+        if (j == IdIndex::npos)
+            throw std::runtime_error("Cannot create a standard form for a model with variable "
+                                     + var->get_name() + " that is not declared in the model");
+        return j;
+    };
+
+    auto& data = cache.data;
+    data.num_rows = mrepn.constraints.size();
+    data.num_cols = mrepn.variables.size();
+
+    //
+    // Collect the terms of the constraints in blocks of rows
+    //
+    size_t nblocks = (data.num_rows + block_size - 1) / block_size;
+    std::vector<std::vector<Triplet>> block_triplets(nblocks);
+    cache.row_constants.resize(data.num_rows);
+    parallel_for(nblocks, nthreads, [&](size_t b, size_t) {
+        QuadraticExpr repn;
+        auto& triplets = block_triplets[b];
+        size_t end = std::min(data.num_rows, (b + 1) * block_size);
+        for (size_t i = b * block_size; i < end; i++) {
+            auto& con = mrepn.constraints[i];
+            repn.reset();
+            repn.collect_terms(con);
+            if (repn.is_quadratic())
+                throw std::runtime_error("Cannot create a standard form for quadratic constraint "
+                                         + con.name());
+            for (size_t k = 0; k < repn.linear_coefs.size(); k++)
+                triplets.push_back({i, column(repn.linear_vars[k]), repn.linear_coefs[k]});
+            cache.row_constants[i] = repn.constval;
+        }
+    });
+
+    std::vector<Triplet> triplets;
+    size_t nnz = 0;
+    for (auto& tmp : block_triplets) nnz += tmp.size();
+    triplets.reserve(nnz);
+    for (auto& tmp : block_triplets) {
+        triplets.insert(triplets.end(), tmp.begin(), tmp.end());
+        std::vector<Triplet>().swap(tmp);
+    }
+
+    auto row = [](const Triplet& t) { return t.row; };
+    auto col = [](const Triplet& t) { return t.col; };
+    compress(triplets, data.num_rows, row, col, data.row_start, data.col_index, data.row_values);
+
+    //
+    // The CSC format is the transpose of the CSR format
+    //
+    size_t nz = data.col_index.size();
+    data.col_start.assign(data.num_cols + 1, 0);
+    for (size_t k = 0; k < nz; k++) data.col_start[data.col_index[k] + 1]++;
+    for (size_t j = 0; j < data.num_cols; j++) data.col_start[j + 1] += data.col_start[j];
+    data.row_index.resize(nz);
+    data.col_values.resize(nz);
+    std::vector<size_t> next(data.col_start.begin(), data.col_start.end() - 1);
+    for (size_t i = 0; i < data.num_rows; i++) {
+        for (size_t k = data.row_start[i]; k < data.row_start[i + 1]; k++) {
+            size_t p = next[data.col_index[k]]++;
+            data.row_index[p] = i;
+            data.col_values[p] = data.row_values[k];
+        }
+    }
+
+    //
+    // The objective
+    //
+    data.c.assign(data.num_cols, 0.0);
+    data.c0 = 0.0;
+    data.sense = Model::minimize;
+    triplets.clear();
+    if (mrepn.objectives.size() == 1) {
+        auto& obj = mrepn.objectives[0];
+        QuadraticExpr repn;
+        repn.collect_terms(obj);
+        data.c0 = repn.constval;
+        data.sense = obj.sense();
+        for (size_t k = 0; k < repn.linear_coefs.size(); k++)
+            data.c[column(repn.linear_vars[k])] += repn.linear_coefs[k];
+        // A term a*x_i*x_j contributes a to Q_ij and Q_ji, and a term a*x_i^2
+        // contributes 2a to Q_ii.
+        for (size_t k = 0; k < repn.quadratic_coefs.size(); k++) {
+            size_t i = column(repn.quadratic_lvars[k]);
+            size_t j = column(repn.quadratic_rvars[k]);
+            double coef = repn.quadratic_coefs[k];
+            if (i == j)
+                triplets.push_back({i, i, 2 * coef});
+            else {
+                triplets.push_back({i, j, coef});
+                triplets.push_back({j, i, coef});
+            }
+        }
+    }
+    compress(triplets, data.num_cols, col, row, data.q_start, data.q_index, data.q_values);
+
+    //
+    // The bounds and the mapping to the model
+    //
+    data.row_lower.resize(data.num_rows);
+    data.row_upper.resize(data.num_rows);
+    data.col_lower.resize(data.num_cols);
+    data.col_upper.resize(data.num_cols);
+    data.integer.resize(data.num_cols);
+    refresh_bounds(mrepn, cache);
+
+    data.variable_ids.resize(data.num_cols);
+    for (size_t j = 0; j < data.num_cols; j++) data.variable_ids[j] = mrepn.variables[j].id();
+    data.constraint_ids.resize(data.num_rows);
+    for (size_t i = 0; i < data.num_rows; i++)
+        data.constraint_ids[i] = mrepn.constraints[i].id();
+}
+
+}  // namespace
+
+const StandardForm& Model::to_standard_form(bool recompute)
+{
+    std::vector<const void*> signature;
+    std::vector<unsigned char> fixed;
+    std::vector<double> fixed_values;
+    model_signature(*repn, signature, fixed, fixed_values);
+
+    auto& cache = repn->standard_form;
+    if (cache and not recompute and (cache->signature == signature) and (cache->fixed == fixed)
+        and (cache->fixed_values == fixed_values)) {
+        refresh_bounds(*repn, *cache);
+        return cache->data;
+    }
+
+    // The cache is discarded if the computation fails
+    cache.reset();
+    auto tmp = std::make_shared<StandardFormCache>();
+    compute_standard_form(*this, *tmp, repn->num_writer_threads);
+    tmp->signature = std::move(signature);
+    tmp->fixed = std::move(fixed);
+    tmp->fixed_values = std::move(fixed_values);
+    cache = tmp;
+    return cache->data;
+}
+
+}  // namespace coek
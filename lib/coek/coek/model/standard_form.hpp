@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace coek {
+
+/**
+ * The linear and quadratic data of a model in a standard form:
+ *
+ *      optimize     c'x + 0.5 x'Qx + c0
+ *      subject to   row_lower <= Ax <= row_upper
+ *                   col_lower <=  x <= col_upper
+ *
+ * The columns are the model variables in the order they were declared, and the
+ * rows are the model constraints in the order they were added.  The matrix A is
+ * stored in both compressed sparse row (CSR) and compressed sparse column (CSC)
+ * format, and the symmetric matrix Q is stored in CSC format with both triangles.
+ * The indices in each row and column are sorted, and duplicate terms are summed.
+ *
+ * Constant terms in the constraint bodies are moved into the row bounds, and
+ * infinite bounds are stored as -COEK_INFINITY and COEK_INFINITY.  Fixed
+ * variables are folded into the constants, so they do not appear in A or Q,
+ * and their column bounds are set to their value.
+ */
+class StandardForm {
+   public:
+    /** The number of rows (constraints) */
+    size_t num_rows = 0;
+    /** The number of columns (variables) */
+    size_t num_cols = 0;
+
+    /** The nonzeros in row i are row_values[row_start[i]] ... row_values[row_start[i+1]-1] */
+    std::vector<size_t> row_start;
+    /** The column of each nonzero in the CSR format */
+    std::vector<size_t> col_index;
+    /** The value of each nonzero in the CSR format */
+    std::vector<double> row_values;
+
+    /** The nonzeros in column j are col_values[col_start[j]] ... col_values[col_start[j+1]-1] */
+    std::vector<size_t> col_start;
+    /** The row of each nonzero in the CSC format */
+    std::vector<size_t> row_index;
+    /** The value of each nonzero in the CSC format */
+    std::vector<double> col_values;
+
+    /** The lower bound of each row */
+    std::vector<double> row_lower;
+    /** The upper bound of each row */
+    std::vector<double> row_upper;
+    /** The lower bound of each column */
+    std::vector<double> col_lower;
+    /** The upper bound of each column */
+    std::vector<double> col_upper;
+
+    /** The linear objective coefficients */
+    std::vector<double> c;
+    /** The objective constant */
+    double c0 = 0.0;
+    /** The objective sense (\c true for minimization) */
+    bool sense = true;
+
+    /** The nonzeros in column j of Q are q_values[q_start[j]] ... q_values[q_start[j+1]-1] */
+    std::vector<size_t> q_start;
+    /** The row of each nonzero of Q */
+    std::vector<size_t> q_index;
+    /** The value of each nonzero of Q */
+    std::vector<double> q_values;
+
+    /** Nonzero if the column is a binary or integer variable */
+    std::vector<unsigned char> integer;
+
+    /** The id of the variable for each column */
+    std::vector<unsigned int> variable_ids;
+    /** The id of the constraint for each row */
+    std::vector<unsigned int> constraint_ids;
+
+   public:
+    /** \returns the number of nonzeros in A */
+    size_t num_nonzeros() const { return col_index.size(); }
+};
+
+}  // namespace coek
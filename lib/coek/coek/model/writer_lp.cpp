@@ -1,7 +1,10 @@
 #include <cmath>
+#include <cstring>
 #include <exception>
 #include <fstream>
+#include <functional>
 #include <map>
+#include <sstream>
 #include <string>
 
 #ifdef WITH_CALIPER
@@ -14,7 +17,6 @@
 #ifdef WITH_FMTLIB
 #    include <fmt/compile.h>
 #    include <fmt/core.h>
-#    include <fmt/os.h>
 #endif
 
 #include "../ast/value_terms.hpp"
@@ -24,6 +26,8 @@
 #include "coek/api/expression_visitor.hpp"
 #include "coek/api/objective.hpp"
 #include "coek/model/model.hpp"
+#include "coek/util/compressed_file.hpp"
+#include "coek/util/parallel.hpp"
 #ifdef COEK_WITH_COMPACT_MODEL
 #    include "coek/compact/constraint_sequence.hpp"
 #    include "coek/compact/objective_sequence.hpp"
@@ -122,7 +126,19 @@ void print_repn(std::ostream& ostr, const QuadraticExpr& repn,
 }
 
 #ifdef WITH_FMTLIB
-void print_repn(fmt::ostream& ostr, const QuadraticExpr& repn,
+//
+// A buffer that LP text is rendered into before it is written to a file
+//
+class LPBuffer {
+   public:
+    fmt::memory_buffer buf;
+
+    void print(const std::string& str) { buf.append(str.data(), str.data() + str.size()); }
+    void print(const char* str) { buf.append(str, str + std::strlen(str)); }
+    void write(OutputFile& ostr) const { ostr.write(buf.data(), buf.size()); }
+};
+
+void print_repn(LPBuffer& ostr, const QuadraticExpr& repn,
                 const std::unordered_map<size_t, size_t>& vid)
 {
     CALI_CXX_MARK_FUNCTION;
@@ -200,6 +216,8 @@ void print_repn(fmt::ostream& ostr, const QuadraticExpr& repn,
 class LPWriter {
    public:
     bool one_var_constant;
+    // The number of threads used to render constraints
+    size_t nthreads = 1;
     std::unordered_map<size_t, size_t> vid;
     std::vector<Variable> variables;
     std::map<size_t, Variable> bvars;
@@ -223,6 +241,12 @@ class LPWriter {
     void print_constraints(StreamType& ostr, Model& model);
     void collect_variables(Model& model);
 
+    void print_constraints(std::ostream& ostr, const std::vector<Constraint>& cons,
+                           size_t offset);
+#ifdef WITH_FMTLIB
+    void print_constraints(OutputFile& ostr, const std::vector<Constraint>& cons, size_t offset);
+#endif
+
 #ifdef COEK_WITH_COMPACT_MODEL
     template <class StreamType>
     void print_objectives(StreamType& ostr, CompactModel& model);
@@ -234,15 +258,16 @@ class LPWriter {
     void print_header(std::ostream& ostr);
     void print_objective(std::ostream& ostr, const Objective& obj);
     void print_st(std::ostream& ostr);
-    void print_constraint(std::ostream& ostr, const Constraint& c, size_t ctr);
+    void print_constraint(std::ostream& ostr, const Constraint& c, size_t ctr,
+                          QuadraticExpr& repn);
     void print_bounds(std::ostream& ostr);
 
 #ifdef WITH_FMTLIB
-    void print_header(fmt::ostream& ostr);
-    void print_objective(fmt::ostream& ostr, const Objective& obj);
-    void print_st(fmt::ostream& ostr);
-    void print_constraint(fmt::ostream& ostr, const Constraint& c, size_t ctr);
-    void print_bounds(fmt::ostream& ostr);
+    void print_header(OutputFile& ostr);
+    void print_objective(OutputFile& ostr, const Objective& obj);
+    void print_st(OutputFile& ostr);
+    void print_constraint(LPBuffer& ostr, const Constraint& c, size_t ctr, QuadraticExpr& repn);
+    void print_bounds(OutputFile& ostr);
 #endif
 };
 
@@ -292,32 +317,74 @@ void LPWriter::print_constraints(StreamType& ostr, Model& model)
     size_t ctr = 0;
     for (auto& it : model.repn->constraints) {
         invconmap[it.id()] = ctr;
-        print_constraint(ostr, it, ctr);
         ++ctr;
     }
+    print_constraints(ostr, model.repn->constraints, 0);
 }
 
 #ifdef COEK_WITH_COMPACT_MODEL
 template <class StreamType>
 void LPWriter::print_constraints(StreamType& ostr, CompactModel& model)
 {
+    //
+    // Constraints are generated serially, and they are printed in batches that
+    // are rendered in parallel.
+    //
+    size_t batch_size = chunk_buffers(nthreads) * chunk_size;
+    std::vector<Constraint> batch;
     size_t ctr = 0;
+    auto add = [&](const Constraint& c) {
+        invconmap[c.id()] = ctr++;
+        batch.push_back(c);
+        if (batch.size() == batch_size) {
+            print_constraints(ostr, batch, ctr - batch.size());
+            batch.clear();
+        }
+    };
+
     for (auto& val : model.repn->constraints) {
         if (auto cval = std::get_if<Constraint>(&val)) {
-            Constraint c = cval->expand();
-            invconmap[c.id()] = ctr;
-            print_constraint(ostr, c, ctr);
-            ++ctr;
+            add(cval->expand());
         }
         else {
             auto& seq = std::get<ConstraintSequence>(val);
-            for (auto& jt : seq) {
-                invconmap[jt.id()] = ctr;
-                print_constraint(ostr, jt, ctr);
-                ++ctr;
-            }
+            for (auto& jt : seq) add(jt);
         }
     }
+    print_constraints(ostr, batch, ctr - batch.size());
+}
+#endif
+
+//
+// Print the constraints in cons, which are numbered starting with offset
+//
+void LPWriter::print_constraints(std::ostream& ostr, const std::vector<Constraint>& cons,
+                                 size_t offset)
+{
+    CALI_CXX_MARK_FUNCTION;
+
+    std::vector<QuadraticExpr> exprs(nthreads);
+    write_chunks<std::ostringstream>(
+        cons.size(), nthreads,
+        [&](std::ostringstream& buf, size_t i, size_t t) {
+            print_constraint(buf, cons[i], offset + i, exprs[t]);
+        },
+        [&](std::ostringstream& buf) { ostr << buf.str(); });
+}
+
+#ifdef WITH_FMTLIB
+void LPWriter::print_constraints(OutputFile& ostr, const std::vector<Constraint>& cons,
+                                 size_t offset)
+{
+    CALI_CXX_MARK_FUNCTION;
+
+    std::vector<QuadraticExpr> exprs(nthreads);
+    write_chunks<LPBuffer>(
+        cons.size(), nthreads,
+        [&](LPBuffer& buf, size_t i, size_t t) {
+            print_constraint(buf, cons[i], offset + i, exprs[t]);
+        },
+        [&](LPBuffer& buf) { buf.write(ostr); });
 }
 #endif
 
@@ -346,37 +413,31 @@ void LPWriter::collect_variables(Model& model)
 void LPWriter::collect_variables(CompactModel& model)
 {
     size_t ctr = 0;
+    auto add = [&](const Variable& var) {
+        vid[var.id()] = ctr;
+        invvarmap[ctr] = var.id();
+        ++ctr;
+
+        if (var.fixed())  // Don't report fixed binary or integer variables
+            return;
+        variables.push_back(var);
+        if (var.is_binary()) bvars[vid[var.id()]] = var;
+        if (var.is_integer()) ivars[vid[var.id()]] = var;
+    };
+
     for (auto& val : model.repn->variables) {
         if (auto eval = std::get_if<Variable>(&val)) {
-            if (eval->fixed()) continue;
             Expression lb = eval->lower_expression().expand();
+            eval->lower(lb.value());
             Expression ub = eval->upper_expression().expand();
+            eval->upper(ub.value());
             Expression value = eval->value_expression().expand();
-            auto tmp = variable(eval->name())
-                           .lower(lb.value())
-                           .upper(ub.value())
-                           .value(value.value())
-                           .within(eval->within());
-            variables.push_back(tmp);
-            if (tmp.is_binary()) bvars[vid[tmp.id()]] = tmp.repn;
-            if (tmp.is_integer()) ivars[vid[tmp.id()]] = tmp.repn;
-
-            vid[eval->id()] = ctr;
-            invvarmap[ctr] = variables.size();
-            ++ctr;
+            eval->value(value.value());
+            add(*eval);
         }
         else {
             auto& seq = std::get<VariableSequence>(val);
-            for (auto& jt : seq) {
-                if (jt.fixed()) continue;
-                variables.push_back(jt);
-                if (jt.is_binary()) bvars[vid[jt.id()]] = jt.repn;
-                if (jt.is_integer()) ivars[vid[jt.id()]] = jt.repn;
-
-                vid[jt.id()] = ctr;
-                invvarmap[ctr] = variables.size();
-                ++ctr;
-            }
+            for (auto& jt : seq) add(jt);
         }
     }
 }
@@ -398,6 +459,9 @@ void LPWriter::write(StreamType& ostr, ModelType& model)
         throw std::runtime_error("Error writing LP file: More than one objective defined!");
     }
 
+    nthreads = model.repn->num_writer_threads;
+    if (nthreads == 0) nthreads = default_num_threads();
+
     // Create variable ID map
     collect_variables(model);
 
@@ -446,14 +510,15 @@ void LPWriter::print_objective(std::ostream& ostr, const Objective& obj)
 
 void LPWriter::print_st(std::ostream& ostr) { ostr << "\nsubject to\n\n"; }
 
-void LPWriter::print_constraint(std::ostream& ostr, const Constraint& c, size_t ctr)
+void LPWriter::print_constraint(std::ostream& ostr, const Constraint& c, size_t ctr,
+                                QuadraticExpr& repn)
 {
     CALI_CXX_MARK_FUNCTION;
 
     CALI_MARK_BEGIN("collect_terms");
-    expr.reset();
-    expr.collect_terms(c);
-    double tmp = expr.constval;
+    repn.reset();
+    repn.collect_terms(c);
+    double tmp = repn.constval;
 
     auto lower = c.lower();
     auto upper = c.upper();
@@ -472,7 +537,7 @@ void LPWriter::print_constraint(std::ostream& ostr, const Constraint& c, size_t
             ostr << lower.value() - tmp;
             ostr << " <= ";
         }
-        print_repn(ostr, expr, vid);
+        print_repn(ostr, repn, vid);
         if (upper.repn) {
             ostr << " <= ";
             ostr << upper.value() - tmp;
@@ -481,7 +546,7 @@ void LPWriter::print_constraint(std::ostream& ostr, const Constraint& c, size_t
         // CALI_MARK_END("IF");
     }
     else {
-        print_repn(ostr, expr, vid);
+        print_repn(ostr, repn, vid);
         CALI_MARK_BEGIN("ELSE");
         ostr << "= ";
         ostr << lower.value() - tmp;
@@ -532,15 +597,15 @@ void LPWriter::print_bounds(std::ostream& ostr)
 #ifdef WITH_FMTLIB
 //
 //
-// fmt::ostream print methods
+// fmtlib print methods
 //
 //
-void LPWriter::print_header(fmt::ostream& ostr)
+void LPWriter::print_header(OutputFile& ostr)
 {
     ostr.print("\\* LP File Generated by COEK *\\\n\n");
 }
 
-void LPWriter::print_objective(fmt::ostream& ostr, const Objective& obj)
+void LPWriter::print_objective(OutputFile& ostr, const Objective& obj)
 {
     if (obj.sense())
         ostr.print("\nminimize\n\n");
@@ -550,7 +615,9 @@ void LPWriter::print_objective(fmt::ostream& ostr, const Objective& obj)
 
     expr.reset();
     expr.collect_terms(obj);
-    print_repn(ostr, expr, vid);
+    LPBuffer buf;
+    print_repn(buf, expr, vid);
+    buf.write(ostr);
     double tmp = expr.constval;
     if (tmp != 0) {
         one_var_constant = true;
@@ -558,16 +625,17 @@ void LPWriter::print_objective(fmt::ostream& ostr, const Objective& obj)
     }
 }
 
-void LPWriter::print_st(fmt::ostream& ostr) { ostr.print("\nsubject to\n\n"); }
+void LPWriter::print_st(OutputFile& ostr) { ostr.print("\nsubject to\n\n"); }
 
-void LPWriter::print_constraint(fmt::ostream& ostr, const Constraint& c, size_t ctr)
+void LPWriter::print_constraint(LPBuffer& ostr, const Constraint& c, size_t ctr,
+                                QuadraticExpr& repn)
 {
     CALI_CXX_MARK_FUNCTION;
 
     CALI_MARK_BEGIN("collect_terms");
-    expr.reset();
-    expr.collect_terms(c);
-    double tmp = expr.constval;
+    repn.reset();
+    repn.collect_terms(c);
+    double tmp = repn.constval;
 
     auto lower = c.lower();
     auto upper = c.upper();
@@ -587,7 +655,7 @@ void LPWriter::print_constraint(fmt::ostream& ostr, const Constraint& c, size_t
             constexpr auto _fmt = FMT_COMPILE("{} <= ");
             ostr.print(fmt::format(_fmt, lower.value() - tmp));
         }
-        print_repn(ostr, expr, vid);
+        print_repn(ostr, repn, vid);
         if (upper.repn) {
             constexpr auto _fmt = FMT_COMPILE(" <= {}");
             ostr.print(fmt::format(_fmt, upper.value() - tmp));
@@ -596,7 +664,7 @@ void LPWriter::print_constraint(fmt::ostream& ostr, const Constraint& c, size_t
         // CALI_MARK_END("IF");
     }
     else {
-        print_repn(ostr, expr, vid);
+        print_repn(ostr, repn, vid);
         CALI_MARK_BEGIN("ELSE");
         constexpr auto _fmt = FMT_COMPILE("= {}\n\n");
         ostr.print(fmt::format(_fmt, lower.value() - tmp));
@@ -604,7 +672,7 @@ void LPWriter::print_constraint(fmt::ostream& ostr, const Constraint& c, size_t
     }
 }
 
-void LPWriter::print_bounds(fmt::ostream& ostr)
+void LPWriter::print_bounds(OutputFile& ostr)
 {
     if (one_var_constant) {
         ostr.print("c_ONE_VAR_CONSTANT:\n");
@@ -690,7 +758,7 @@ void write_lp_problem_fmtlib(Model& model, const std::string& fname,
                              std::map<size_t, size_t>& invvarmap,
                              std::map<size_t, size_t>& invconmap)
 {
-    auto ostr = fmt::output_file(fname, fmt::file::WRONLY | fmt::file::CREATE | FMT_POSIX(O_TRUNC));
+    OutputFile ostr(fname);
     LPWriter writer(invvarmap, invconmap);
     try {
         writer.write(ostr, model);
@@ -713,7 +781,7 @@ void write_lp_problem_fmtlib(CompactModel& model, const std::string& fname,
                              std::map<size_t, size_t>& invvarmap,
                              std::map<size_t, size_t>& invconmap)
 {
-    auto ostr = fmt::output_file(fname, fmt::file::WRONLY | fmt::file::CREATE | FMT_POSIX(O_TRUNC));
+    OutputFile ostr(fname);
     LPWriter writer(invvarmap, invconmap);
     try {
         writer.write(ostr, model);
@@ -0,0 +1,755 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+
+#ifdef WITH_CALIPER
+#    include <caliper/cali.h>
+#else
+#    define CALI_CXX_MARK_FUNCTION
+#    define CALI_MARK_BEGIN(X)
+#    define CALI_MARK_END(X)
+#endif
+#ifdef WITH_FMTLIB
+#    include <fmt/compile.h>
+#    include <fmt/core.h>
+#endif
+
+#include "../ast/value_terms.hpp"
+#include "coek/api/constraint.hpp"
+#include "coek/api/expression.hpp"
+#include "coek/api/expression_visitor.hpp"
+#include "coek/api/objective.hpp"
+#include "coek/model/model.hpp"
+#include "coek/util/parallel.hpp"
+#ifdef COEK_WITH_COMPACT_MODEL
+#    include "coek/compact/constraint_sequence.hpp"
+#    include "coek/compact/objective_sequence.hpp"
+#    include "coek/model/compact_model.hpp"
+#endif
+#include "model_repn.hpp"
+
+#define EPSILON 1e-12
+
+//
+// The MPS writer generates a free-format MPS file.  MPS files are organized by
+// column, so the linear terms of the objective and constraints are collected as
+// (row, column, value) triplets, which are then sorted by column.  Only the numeric
+// data of each row is kept, so the memory used by the writer is proportional to the
+// number of nonzeros in the model.  Quadratic terms are written in the QUADOBJ and
+// QCMATRIX sections.
+//
+// Row 0 is the objective, and row k+1 is constraint k.
+//
+
+namespace coek {
+
+namespace {
+
+inline size_t get_vid_value(const std::unordered_map<size_t, size_t>& vid, size_t id)
+{
+    auto it = vid.find(id);
+    if (it != vid.end()) return it->second;
+    throw std::runtime_error(
+        "Model expressions contain variable that is not declared in the model.");
+}
+
+struct QuadraticTerm {
+    size_t row;
+    size_t i;
+    size_t j;
+    double val;
+};
+
+//
+// The data collected for a contiguous set of constraint rows
+//
+class MPSRows {
+   public:
+    // Row type ('N', 'L', 'G' or 'E'), right-hand-side and range of each row
+    std::vector<char> type;
+    std::vector<double> rhs;
+    std::vector<double> range;
+
+    // Linear terms, sorted by row
+    std::vector<size_t> row;
+    std::vector<size_t> col;
+    std::vector<double> val;
+
+    // Quadratic terms, sorted by row
+    std::vector<QuadraticTerm> quad;
+
+    void clear()
+    {
+        type.clear();
+        rhs.clear();
+        range.clear();
+        row.clear();
+        col.clear();
+        val.clear();
+        quad.clear();
+    }
+
+    void append(const MPSRows& other)
+    {
+        type.insert(type.end(), other.type.begin(), other.type.end());
+        rhs.insert(rhs.end(), other.rhs.begin(), other.rhs.end());
+        range.insert(range.end(), other.range.begin(), other.range.end());
+        row.insert(row.end(), other.row.begin(), other.row.end());
+        col.insert(col.end(), other.col.begin(), other.col.end());
+        val.insert(val.end(), other.val.begin(), other.val.end());
+        quad.insert(quad.end(), other.quad.begin(), other.quad.end());
+    }
+};
+
+//
+// The work space used by a thread to collect rows.  slot[j] is the index of the
+// last linear term added for column j, which is used to merge repeated terms.
+//
+class RowWorkspace {
+   public:
+    QuadraticExpr repn;
+    std::vector<size_t> slot;
+};
+
+//
+// A buffer that is flushed to the output stream when it grows past a fixed size
+//
+class MPSBuffer {
+   public:
+    std::ostream& ostr;
+    std::string buf;
+
+    static constexpr size_t flush_size = 1 << 16;
+
+    explicit MPSBuffer(std::ostream& _ostr) : ostr(_ostr) { buf.reserve(2 * flush_size); }
+
+    void print(const char* str)
+    {
+        buf.append(str);
+        if (buf.size() > flush_size) flush();
+    }
+
+    void print(size_t val)
+    {
+#ifdef WITH_FMTLIB
+        fmt::format_to(std::back_inserter(buf), FMT_COMPILE("{}"), val);
+#else
+        buf.append(std::to_string(val));
+#endif
+    }
+
+    void print(double val)
+    {
+#ifdef WITH_FMTLIB
+        fmt::format_to(std::back_inserter(buf), FMT_COMPILE("{}"), val);
+#else
+        char tmp[32];
+        std::snprintf(tmp, sizeof(tmp), "%.17g", val);
+        buf.append(tmp);
+#endif
+    }
+
+    void flush()
+    {
+        ostr.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        buf.clear();
+    }
+};
+
+class MPSWriter {
+   public:
+    // The number of threads used to collect constraints
+    size_t nthreads = 1;
+    std::unordered_map<size_t, size_t> vid;
+    std::vector<Variable> variables;
+    std::map<size_t, size_t>& invvarmap;
+    std::map<size_t, size_t>& invconmap;
+
+    bool minimize = true;
+    double obj_constant = 0.0;
+    MPSRows rows;
+
+    // The linear terms, sorted by column
+    std::vector<size_t> colptr;
+    std::vector<size_t> rowind;
+    std::vector<double> colval;
+
+    std::vector<RowWorkspace> workspace;
+
+    MPSWriter(std::map<size_t, size_t>& _invvarmap, std::map<size_t, size_t>& _invconmap)
+        : invvarmap(_invvarmap), invconmap(_invconmap)
+    {
+    }
+
+    template <class ModelType>
+    void write(std::ostream& ostr, ModelType& model);
+
+    void collect_variables(Model& model);
+    void collect_objectives(Model& model);
+    void collect_constraints(Model& model);
+#ifdef COEK_WITH_COMPACT_MODEL
+    void collect_variables(CompactModel& model);
+    void collect_objectives(CompactModel& model);
+    void collect_constraints(CompactModel& model);
+#endif
+
+    void collect_objective(const Objective& obj);
+    void collect_constraints(const std::vector<Constraint>& cons, size_t offset);
+    void collect_constraint(MPSRows& data, const Constraint& c, RowWorkspace& work);
+    void collect_terms(MPSRows& data, size_t row, RowWorkspace& work);
+    void create_columns();
+
+    void print_row(MPSBuffer& buf, size_t row);
+    void print_rows(MPSBuffer& buf);
+    void print_columns(MPSBuffer& buf);
+    void print_rhs(MPSBuffer& buf);
+    void print_ranges(MPSBuffer& buf);
+    void print_bounds(MPSBuffer& buf);
+    void print_quadratic(MPSBuffer& buf);
+};
+
+//
+// Collect variables
+//
+
+void MPSWriter::collect_variables(Model& model)
+{
+    size_t ctr = 0;
+    for (auto& it : model.repn->variables) {
+        vid[it.id()] = ctr;
+        invvarmap[ctr] = it.id();
+        ++ctr;
+        variables.push_back(it);
+    }
+}
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void MPSWriter::collect_variables(CompactModel& model)
+{
+    size_t ctr = 0;
+    auto add = [&](const Variable& var) {
+        vid[var.id()] = ctr;
+        invvarmap[ctr] = var.id();
+        ++ctr;
+        variables.push_back(var);
+    };
+
+    for (auto& val : model.repn->variables) {
+        if (auto eval = std::get_if<Variable>(&val)) {
+            Expression lb = eval->lower_expression().expand();
+            eval->lower(lb.value());
+            Expression ub = eval->upper_expression().expand();
+            eval->upper(ub.value());
+            Expression value = eval->value_expression().expand();
+            eval->value(value.value());
+            add(*eval);
+        }
+        else {
+            auto& seq = std::get<VariableSequence>(val);
+            for (auto& jt : seq) add(jt);
+        }
+    }
+}
+#endif
+
+//
+// Collect objectives
+//
+
+void MPSWriter::collect_objectives(Model& model) { collect_objective(model.get_objective(0)); }
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void MPSWriter::collect_objectives(CompactModel& model)
+{
+    int nobj = 0;
+    for (auto& val : model.repn->objectives) {
+        if (auto eval = std::get_if<Objective>(&val)) {
+            auto obj = objective().expr(eval->expr().expand()).sense(eval->sense());
+            collect_objective(obj);
+            ++nobj;
+        }
+        else {
+            auto& seq = std::get<ObjectiveSequence>(val);
+            for (auto& jt : seq) {
+                collect_objective(jt);
+                ++nobj;
+            }
+        }
+    }
+    if (nobj > 1) {
+        throw std::runtime_error("More than one objective defined!");
+    }
+}
+#endif
+
+void MPSWriter::collect_objective(const Objective& obj)
+{
+    minimize = obj.sense();
+    auto& work = workspace[0];
+    work.repn.reset();
+    work.repn.collect_terms(obj);
+    obj_constant = work.repn.constval;
+    collect_terms(rows, 0, work);
+}
+
+//
+// Collect constraints
+//
+
+void MPSWriter::collect_constraints(Model& model)
+{
+    size_t ctr = 0;
+    for (auto& it : model.repn->constraints) {
+        invconmap[it.id()] = ctr;
+        ++ctr;
+    }
+    collect_constraints(model.repn->constraints, 0);
+}
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void MPSWriter::collect_constraints(CompactModel& model)
+{
+    //
+    // Constraints are generated serially, and they are collected in batches that
+    // are processed in parallel.
+    //
+    size_t batch_size = chunk_buffers(nthreads) * chunk_size;
+    std::vector<Constraint> batch;
+    size_t ctr = 0;
+    auto add = [&](const Constraint& c) {
+        invconmap[c.id()] = ctr++;
+        batch.push_back(c);
+        if (batch.size() == batch_size) {
+            collect_constraints(batch, ctr - batch.size());
+            batch.clear();
+        }
+    };
+
+    for (auto& val : model.repn->constraints) {
+        if (auto cval = std::get_if<Constraint>(&val)) {
+            add(cval->expand());
+        }
+        else {
+            auto& seq = std::get<ConstraintSequence>(val);
+            for (auto& jt : seq) add(jt);
+        }
+    }
+    collect_constraints(batch, ctr - batch.size());
+}
+#endif
+
+//
+// Collect the constraints in cons, which are numbered starting with offset
+//
+void MPSWriter::collect_constraints(const std::vector<Constraint>& cons, size_t offset)
+{
+    CALI_CXX_MARK_FUNCTION;
+
+    write_chunks<MPSRows>(
+        cons.size(), nthreads,
+        [&](MPSRows& buf, size_t i, size_t t) {
+            collect_constraint(buf, cons[i], workspace[t]);
+            // Rows are numbered from 1
+            size_t row = offset + i + 1;
+            collect_terms(buf, row, workspace[t]);
+        },
+        [&](MPSRows& buf) { rows.append(buf); });
+}
+
+void MPSWriter::collect_constraint(MPSRows& data, const Constraint& c, RowWorkspace& work)
+{
+    work.repn.reset();
+    work.repn.collect_terms(c);
+    double tmp = work.repn.constval;
+
+    auto lower = c.lower();
+    auto upper = c.upper();
+    bool has_lower = lower.repn and (lower.value() > -COEK_INFINITY);
+    bool has_upper = upper.repn and (upper.value() < COEK_INFINITY);
+
+    bool is_equality = not c.is_inequality()
+                       or (has_lower and has_upper
+                           and (::fabs(lower.value() - upper.value()) < EPSILON));
+
+    if (is_equality) {
+        data.type.push_back('E');
+        data.rhs.push_back(lower.value() - tmp);
+        data.range.push_back(0);
+    }
+    else if (has_lower and has_upper) {
+        data.type.push_back('G');
+        data.rhs.push_back(lower.value() - tmp);
+        data.range.push_back(upper.value() - lower.value());
+    }
+    else if (has_lower) {
+        data.type.push_back('G');
+        data.rhs.push_back(lower.value() - tmp);
+        data.range.push_back(0);
+    }
+    else if (has_upper) {
+        data.type.push_back('L');
+        data.rhs.push_back(upper.value() - tmp);
+        data.range.push_back(0);
+    }
+    else {
+        data.type.push_back('N');
+        data.rhs.push_back(0);
+        data.range.push_back(0);
+    }
+}
+
+//
+// Add the terms in work.repn to the given row
+//
+void MPSWriter::collect_terms(MPSRows& data, size_t row, RowWorkspace& work)
+{
+    auto& repn = work.repn;
+    auto& slot = work.slot;
+
+    size_t start = data.col.size();
+    for (size_t i = 0; i < repn.linear_coefs.size(); i++) {
+        size_t j = get_vid_value(vid, repn.linear_vars[i]->index);
+        size_t k = slot[j];
+        if ((k >= start) and (k < data.col.size()) and (data.col[k] == j))
+            data.val[k] += repn.linear_coefs[i];
+        else {
+            slot[j] = data.col.size();
+            data.row.push_back(row);
+            data.col.push_back(j);
+            data.val.push_back(repn.linear_coefs[i]);
+        }
+    }
+
+    if (repn.quadratic_coefs.size() > 0) {
+        std::map<std::pair<size_t, size_t>, double> qval;
+        for (size_t ii = 0; ii < repn.quadratic_coefs.size(); ++ii) {
+            size_t lindex = get_vid_value(vid, repn.quadratic_lvars[ii]->index);
+            size_t rindex = get_vid_value(vid, repn.quadratic_rvars[ii]->index);
+            if (lindex > rindex) std::swap(lindex, rindex);
+            qval[{lindex, rindex}] += repn.quadratic_coefs[ii];
+        }
+        for (auto& it : qval) {
+            if (it.second != 0)
+                data.quad.push_back({row, it.first.first, it.first.second, it.second});
+        }
+    }
+}
+
+//
+// Sort the linear terms by column
+//
+void MPSWriter::create_columns()
+{
+    CALI_CXX_MARK_FUNCTION;
+
+    size_t nnz = rows.col.size();
+    colptr.assign(variables.size() + 1, 0);
+    for (auto j : rows.col) ++colptr[j + 1];
+    for (size_t j = 0; j < variables.size(); j++) colptr[j + 1] += colptr[j];
+
+    rowind.resize(nnz);
+    colval.resize(nnz);
+    std::vector<size_t> next(colptr.begin(), colptr.end() - 1);
+    for (size_t k = 0; k < nnz; k++) {
+        size_t p = next[rows.col[k]]++;
+        rowind[p] = rows.row[k];
+        colval[p] = rows.val[k];
+    }
+
+    // The triplets are no longer needed
+    std::vector<size_t>().swap(rows.row);
+    std::vector<size_t>().swap(rows.col);
+    std::vector<double>().swap(rows.val);
+}
+
+//
+// Main writer
+//
+
+template <class ModelType>
+void MPSWriter::write(std::ostream& ostr, ModelType& model)
+{
+    CALI_CXX_MARK_FUNCTION;
+
+    if (model.repn->objectives.size() == 0) {
+        throw std::runtime_error("Error writing MPS file: No objectives specified!");
+    }
+    if (model.repn->objectives.size() > 1) {
+        throw std::runtime_error("Error writing MPS file: More than one objective defined!");
+    }
+
+    nthreads = model.repn->num_writer_threads;
+    if (nthreads == 0) nthreads = default_num_threads();
+
+    // Create variable ID map
+    collect_variables(model);
+
+    workspace.resize(nthreads);
+    for (auto& work : workspace) work.slot.resize(variables.size(), 0);
+
+    try {
+        collect_objectives(model);
+
+        collect_constraints(model);
+
+        create_columns();
+
+        MPSBuffer buf(ostr);
+        buf.print("NAME coek\n");
+        if (not minimize) buf.print("OBJSENSE\n    MAX\n");
+        print_rows(buf);
+        print_columns(buf);
+        print_rhs(buf);
+        print_ranges(buf);
+        print_bounds(buf);
+        print_quadratic(buf);
+        buf.print("ENDATA\n");
+        buf.flush();
+    }
+    catch (std::exception& e) {
+        throw std::runtime_error(std::string("Error writing MPS file: ") + e.what());
+    }
+}
+
+void MPSWriter::print_row(MPSBuffer& buf, size_t row)
+{
+    if (row == 0)
+        buf.print("obj");
+    else {
+        buf.print("c");
+        buf.print(row - 1);
+    }
+}
+
+void MPSWriter::print_rows(MPSBuffer& buf)
+{
+    buf.print("ROWS\n N obj\n");
+    for (size_t i = 0; i < rows.type.size(); i++) {
+        char tmp[4] = {' ', rows.type[i], ' ', 0};
+        buf.print(tmp);
+        print_row(buf, i + 1);
+        buf.print("\n");
+    }
+}
+
+void MPSWriter::print_columns(MPSBuffer& buf)
+{
+    buf.print("COLUMNS\n");
+    bool integer = false;
+    for (size_t j = 0; j < variables.size(); j++) {
+        auto& v = variables[j];
+        if (v.fixed()) continue;
+
+        // Integer columns are enclosed in markers
+        bool is_integer = v.is_integer() or v.is_binary();
+        if (is_integer != integer) {
+            integer = not integer;
+            if (integer)
+                buf.print("    MARKER 'MARKER' 'INTORG'\n");
+            else
+                buf.print("    MARKER 'MARKER' 'INTEND'\n");
+        }
+
+        bool empty = true;
+        for (size_t k = colptr[j]; k < colptr[j + 1]; k++) {
+            if (colval[k] == 0) continue;
+            buf.print("    x");
+            buf.print(j);
+            buf.print(" ");
+            print_row(buf, rowind[k]);
+            buf.print(" ");
+            buf.print(colval[k]);
+            buf.print("\n");
+            empty = false;
+        }
+        // Declare columns that only appear in quadratic terms, or not at all
+        if (empty) {
+            buf.print("    x");
+            buf.print(j);
+            buf.print(" obj 0\n");
+        }
+    }
+    if (integer) buf.print("    MARKER 'MARKER' 'INTEND'\n");
+}
+
+void MPSWriter::print_rhs(MPSBuffer& buf)
+{
+    buf.print("RHS\n");
+    if (obj_constant != 0) {
+        buf.print("    RHS obj ");
+        buf.print(-obj_constant);
+        buf.print("\n");
+    }
+    for (size_t i = 0; i < rows.rhs.size(); i++) {
+        if (rows.rhs[i] == 0) continue;
+        buf.print("    RHS ");
+        print_row(buf, i + 1);
+        buf.print(" ");
+        buf.print(rows.rhs[i]);
+        buf.print("\n");
+    }
+}
+
+void MPSWriter::print_ranges(MPSBuffer& buf)
+{
+    bool header = false;
+    for (size_t i = 0; i < rows.range.size(); i++) {
+        if (rows.range[i] == 0) continue;
+        if (not header) {
+            buf.print("RANGES\n");
+            header = true;
+        }
+        buf.print("    RNG ");
+        print_row(buf, i + 1);
+        buf.print(" ");
+        buf.print(rows.range[i]);
+        buf.print("\n");
+    }
+}
+
+void MPSWriter::print_bounds(MPSBuffer& buf)
+{
+    auto bound = [&](const char* type, size_t j) {
+        buf.print(" ");
+        buf.print(type);
+        buf.print(" BND x");
+        buf.print(j);
+    };
+    auto value = [&](double val) {
+        buf.print(" ");
+        buf.print(val);
+        buf.print("\n");
+    };
+
+    buf.print("BOUNDS\n");
+    for (size_t j = 0; j < variables.size(); j++) {
+        auto& v = variables[j];
+        if (v.fixed()) continue;
+
+        if (v.is_binary()) {
+            bound("BV", j);
+            buf.print("\n");
+            continue;
+        }
+
+        double lb = v.lower();
+        double ub = v.upper();
+        bool has_lb = lb > -COEK_INFINITY;
+        bool has_ub = ub < COEK_INFINITY;
+
+        if (has_lb and has_ub and (lb == ub)) {
+            bound("FX", j);
+            value(lb);
+        }
+        else if (not has_lb and not has_ub) {
+            bound("FR", j);
+            buf.print("\n");
+        }
+        else {
+            // The default bounds are [0, inf).  A zero lower bound is written when
+            // the upper bound is negative, since readers may otherwise relax it.
+            if (not has_lb) {
+                bound("MI", j);
+                buf.print("\n");
+            }
+            else if ((lb != 0) or (has_ub and (ub < 0))) {
+                bound("LO", j);
+                value(lb);
+            }
+            if (has_ub) {
+                bound("UP", j);
+                value(ub);
+            }
+            else if (v.is_integer()) {
+                // Some readers give integer variables a default upper bound of 1
+                bound("PL", j);
+                buf.print("\n");
+            }
+        }
+    }
+}
+
+//
+// The QUADOBJ section contains the upper triangle of Q, where the objective is
+// c'x + 0.5 x'Qx.  The QCMATRIX section for a constraint contains all entries of
+// the symmetric matrix Q, where the constraint is a'x + x'Qx.
+//
+void MPSWriter::print_quadratic(MPSBuffer& buf)
+{
+    auto entry = [&](size_t i, size_t j, double val) {
+        buf.print("    x");
+        buf.print(i);
+        buf.print(" x");
+        buf.print(j);
+        buf.print(" ");
+        buf.print(val);
+        buf.print("\n");
+    };
+
+    size_t k = 0;
+    auto& quad = rows.quad;
+    if ((quad.size() > 0) and (quad[0].row == 0)) {
+        buf.print("QUADOBJ\n");
+        for (; (k < quad.size()) and (quad[k].row == 0); k++) {
+            auto& q = quad[k];
+            entry(q.i, q.j, q.i == q.j ? 2 * q.val : q.val);
+        }
+    }
+
+    while (k < quad.size()) {
+        size_t row = quad[k].row;
+        buf.print("QCMATRIX ");
+        print_row(buf, row);
+        buf.print("\n");
+        for (; (k < quad.size()) and (quad[k].row == row); k++) {
+            auto& q = quad[k];
+            if (q.i == q.j)
+                entry(q.i, q.j, q.val);
+            else {
+                entry(q.i, q.j, q.val / 2);
+                entry(q.j, q.i, q.val / 2);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void write_mps_problem(Model& model, const std::string& fname, std::map<size_t, size_t>& invvarmap,
+                       std::map<size_t, size_t>& invconmap)
+{
+    std::ofstream ostr(fname);
+    MPSWriter writer(invvarmap, invconmap);
+    try {
+        writer.write(ostr, model);
+        ostr.close();
+    }
+    catch (std::exception& e) {
+        ostr.close();
+        throw;
+    }
+}
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void write_mps_problem(CompactModel& model, const std::string& fname,
+                       std::map<size_t, size_t>& invvarmap, std::map<size_t, size_t>& invconmap)
+{
+    std::ofstream ostr(fname);
+    MPSWriter writer(invvarmap, invconmap);
+    try {
+        writer.write(ostr, model);
+        ostr.close();
+    }
+    catch (std::exception& e) {
+        ostr.close();
+        throw;
+    }
+}
+#endif
+
+}  // namespace coek
@@ -1,6 +1,12 @@
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <initializer_list>
 #include <iomanip>
+#include <limits>
 #include <map>
+#include <sstream>
 #ifdef WITH_CALIPER
 #    include <caliper/cali.h>
 #else
@@ -11,7 +17,6 @@
 #ifdef WITH_FMTLIB
 #    include <fmt/compile.h>
 #    include <fmt/core.h>
-#    include <fmt/os.h>
 #endif
 
 #include "../ast/base_terms.hpp"
@@ -20,11 +25,21 @@
 #include "../ast/value_terms.hpp"
 #include "../ast/visitor.hpp"
 #include "../ast/visitor_fns.hpp"
+#include "../ast/ast_operators.hpp"
 #include "coek/api/constraint.hpp"
 #include "coek/api/expression.hpp"
 #include "coek/api/expression_visitor.hpp"
 #include "coek/api/objective.hpp"
 #include "coek/model/model.hpp"
+#ifdef COEK_WITH_COMPACT_MODEL
+#    include "coek/compact/constraint_sequence.hpp"
+#    include "coek/compact/objective_sequence.hpp"
+#    include "coek/compact/variable_sequence.hpp"
+#    include "coek/model/compact_model.hpp"
+#endif
+#include "coek/util/compressed_file.hpp"
+#include "coek/util/id_index.hpp"
+#include "coek/util/parallel.hpp"
 #include "coek/util/sequence.hpp"
 #include "model_repn.hpp"
 
@@ -35,8 +50,10 @@ namespace coek {
 
 void to_MutableNLPExpr(const expr_pointer_t& expr, MutableNLPExpr& repn);
 
-void check_that_expression_variables_are_declared(Model& model,
-                                                  const std::map<size_t, Variable>& varobj);
+void index_model_variables(Model& model, IdIndex& declared);
+void model_ordering(Model& model, std::vector<size_t>& var_order, std::vector<size_t>& con_order);
+void check_that_expression_variables_are_declared(const IdIndex& declared,
+                                                  const std::vector<VariableRepn>& vars);
 
 namespace {
 
@@ -54,7 +71,56 @@ struct UnknownVariable : public std::exception
 //
 //
 
-void format(std::ostream& ostr, double value) { ostr << std::setprecision(16) << value; }
+// The precision used to format values.  Note that this is sticky, so values that
+// are printed after a call to format() also use this precision.
+constexpr std::streamsize format_precision = 16;
+
+void format(std::ostream& ostr, double value) { ostr << std::setprecision(format_precision) << value; }
+
+//
+// Segments of the NL file (e.g. constraint expressions) are rendered into
+// separate buffers in parallel and then written in order.  A batch of
+// buffers is rendered at a time, to limit the memory used for large models.
+//
+
+//
+// Write segments [0, n) with fn(ostr, i).  This uses the same chunks and batches as
+// write_chunks().
+//
+// The precision of std::ostream is sticky, so the text for a segment can depend on
+// earlier calls to format().  A chunk of segments is rendered assuming the precision
+// that the output stream has at the start of the chunk.  Chunks after the first in a
+// batch are rendered assuming that format() has already been called, and they are
+// re-rendered in the rare cases where that assumption is wrong.
+//
+void write_segments(std::ostream& ostr, size_t n, size_t nthreads,
+                    const std::function<void(std::ostream&, size_t)>& fn)
+{
+    std::vector<std::ostringstream> bufs(chunk_buffers(nthreads));
+    std::vector<std::streamsize> assumed(bufs.size());
+
+    auto render = [&](size_t k, size_t start, std::streamsize precision) {
+        auto& buf = bufs[k];
+        buf.str("");
+        buf.precision(precision);
+        assumed[k] = precision;
+        size_t stop = std::min(n, start + (k + 1) * chunk_size);
+        for (size_t i = start + k * chunk_size; i < stop; i++) fn(buf, i);
+    };
+
+    for (size_t start = 0; start < n; start += bufs.size() * chunk_size) {
+        size_t nchunks = std::min(bufs.size(), (n - start + chunk_size - 1) / chunk_size);
+        std::streamsize initial = ostr.precision();
+        parallel_for(nchunks, nthreads, [&](size_t k, size_t) {
+            render(k, start, k == 0 ? initial : format_precision);
+        });
+        for (size_t k = 0; k < nchunks; k++) {
+            if (assumed[k] != ostr.precision()) render(k, start, ostr.precision());
+            ostr << bufs[k].str();
+            ostr.precision(bufs[k].precision());
+        }
+    }
+}
 
 class PrintExpr : public Visitor {
    public:
@@ -76,6 +142,7 @@ class PrintExpr : public Visitor {
     void visit(VariableRefTerm& arg);
 #endif
     void visit(MonomialTerm& arg);
+    void visit(LinearRowTerm& arg);
     void visit(InequalityTerm& arg);
     void visit(EqualityTerm& arg);
     void visit(ObjectiveTerm& arg);
@@ -161,6 +228,30 @@ void PrintExpr::visit(MonomialTerm& arg)
         ostr << "v" << varmap.at(arg.var->index) << '\n';
 }
 
+void PrintExpr::visit(LinearRowTerm& arg)
+{
+    size_t n = arg.end() - arg.begin();
+    if (n == 0) {
+        ostr << "n0\n";
+        return;
+    }
+    if (n == 2)
+        ostr << "o0\n";
+    else if (n > 2)
+        ostr << "o54\n" << n << '\n';
+    for (size_t k = arg.begin(); k < arg.end(); k++) {
+        ostr << "o2" << '\n';
+        ostr << "n";
+        format(ostr, arg.coef(k));
+        ostr << '\n';
+        auto& var = arg.var(k);
+        if (var->fixed)
+            ostr << "n" << var->value->eval() << '\n';
+        else
+            ostr << "v" << varmap.at(var->index) << '\n';
+    }
+}
+
 // GCOVR_EXCL_START
 void PrintExpr::visit(InequalityTerm&)
 {
@@ -267,13 +358,36 @@ PrintExpr_FN(o47, ATanhTerm)
 
 #ifdef WITH_FMTLIB
 
+//
+// A buffer that NL text is rendered into before it is written to a file
+//
+class NLBuffer {
+   public:
+    fmt::memory_buffer buf;
+
+    void print(const std::string& str) { buf.append(str.data(), str.data() + str.size()); }
+    void print(const char* str) { buf.append(str, str + std::strlen(str)); }
+    void clear() { buf.clear(); }
+};
+
+//
+// Write segments [0, n) with fn(buf, i).
+//
+void write_segments(OutputFile& ostr, size_t n, size_t nthreads,
+                    const std::function<void(NLBuffer&, size_t)>& fn)
+{
+    write_chunks<NLBuffer>(
+        n, nthreads, [&](NLBuffer& buf, size_t i, size_t) { fn(buf, i); },
+        [&](NLBuffer& buf) { ostr.print("{}", fmt::string_view(buf.buf.data(), buf.buf.size())); });
+}
+
 class PrintExprFmtlib : public Visitor {
    public:
-    fmt::ostream& ostr;
+    NLBuffer& ostr;
     const std::unordered_map<ITYPE, ITYPE>& varmap;
 
    public:
-    PrintExprFmtlib(fmt::ostream& _ostr, const std::unordered_map<ITYPE, ITYPE>& _varmap)
+    PrintExprFmtlib(NLBuffer& _ostr, const std::unordered_map<ITYPE, ITYPE>& _varmap)
         : ostr(_ostr), varmap(_varmap)
     {
     }
@@ -287,6 +401,7 @@ class PrintExprFmtlib : public Visitor {
     void visit(VariableRefTerm& arg);
 #    endif
     void visit(MonomialTerm& arg);
+    void visit(LinearRowTerm& arg);
     void visit(InequalityTerm& arg);
     void visit(EqualityTerm& arg);
     void visit(ObjectiveTerm& arg);
@@ -367,6 +482,27 @@ void PrintExprFmtlib::visit(MonomialTerm& arg)
         ostr.print(fmt::format(_fmtstr_v, varmap.at(arg.var->index)));
 }
 
+void PrintExprFmtlib::visit(LinearRowTerm& arg)
+{
+    size_t n = arg.end() - arg.begin();
+    if (n == 0) {
+        ostr.print(fmt::format(_fmtstr_n, 0.0));
+        return;
+    }
+    if (n == 2)
+        ostr.print("o0\n");
+    else if (n > 2)
+        ostr.print(fmt::format(_fmtstr_o54, n));
+    for (size_t k = arg.begin(); k < arg.end(); k++) {
+        ostr.print(fmt::format(_fmtstr_o2, arg.coef(k)));
+        auto& var = arg.var(k);
+        if (var->fixed)
+            ostr.print(fmt::format(_fmtstr_n, var->value->eval()));
+        else
+            ostr.print(fmt::format(_fmtstr_v, varmap.at(var->index)));
+    }
+}
+
 // GCOVR_EXCL_START
 void PrintExprFmtlib::visit(InequalityTerm&)
 {
@@ -531,7 +667,7 @@ void print_expr(std::ostream& ostr, const MutableNLPExpr& repn,
 }
 
 #ifdef WITH_FMTLIB
-void print_expr(fmt::ostream& ostr, const MutableNLPExpr& repn,
+void print_expr(NLBuffer& ostr, const MutableNLPExpr& repn,
                 const std::unordered_map<ITYPE, ITYPE>& varmap, bool objective = false)
 {
     bool nonlinear = not repn.nonlinear->is_constant();
@@ -590,466 +726,1418 @@ void print_expr(fmt::ostream& ostr, const MutableNLPExpr& repn,
     }
 }
 #endif
-}  // namespace
 
-class NLWriter {
+//
+//
+// Print expressions in the binary NL format
+//
+// The binary format has the same text header as the text format, and the
+// segments contain the same data.  Each segment key and bound type is written
+// as a single character, integers are written as binary ints, and values are
+// written as binary doubles.  The cumulative column counts in the "k" segment
+// are written as binary size_t values, which is how ASL reads them.
+// Whitespace is omitted.
+//
+//
+
+class BinaryNLBuffer {
    public:
-    //
-    // Process Model to Create NL Header
-    //
-    std::map<size_t, Variable> varobj;
-    std::set<size_t> vars;
-    std::set<size_t> nonlinear_vars_obj;
-    std::set<size_t> nonlinear_vars_con;
-    std::set<size_t> linear_vars;
+    std::vector<char> buf;
 
-    size_t num_inequalities = 0;
-    size_t num_ranges = 0;
-    size_t num_equalities = 0;
-    size_t nonl_objectives = 0;
-    size_t nonl_constraints = 0;
+    void key(char c) { buf.push_back(c); }
 
-    size_t num_nonlinear_vars_con = 0;
-    size_t num_nonlinear_vars_obj = 0;
-    size_t num_nonlinear_vars_both = 0;
+    void put(int value)
+    {
+        const char* tmp = reinterpret_cast<const char*>(&value);
+        buf.insert(buf.end(), tmp, tmp + sizeof(int));
+    }
 
-    size_t num_linear_binary_vars = 0;
-    size_t num_linear_integer_vars = 0;
-    size_t num_nonlinear_obj_int_vars = 0;
-    size_t num_nonlinear_con_int_vars = 0;
-    size_t num_nonlinear_both_int_vars = 0;
+    void put(size_t value)
+    {
+        if (value > static_cast<size_t>(std::numeric_limits<int>::max()))
+            throw std::runtime_error("The value " + std::to_string(value)
+                                     + " is too large to write in a binary NL file");
+        put(static_cast<int>(value));
+    }
 
-    size_t nnz_Jacobian = 0;
-    size_t nnz_gradient = 0;
+    void put_size(size_t value)
+    {
+        const char* tmp = reinterpret_cast<const char*>(&value);
+        buf.insert(buf.end(), tmp, tmp + sizeof(size_t));
+    }
 
-    std::vector<MutableNLPExpr> o_expr;
-    std::vector<MutableNLPExpr> c_expr;
-    std::vector<int> r;
-    std::vector<double> rval;
+    void put(double value)
+    {
+        const char* tmp = reinterpret_cast<const char*>(&value);
+        buf.insert(buf.end(), tmp, tmp + sizeof(double));
+    }
 
-    std::unordered_map<ITYPE, ITYPE> varmap;
-    std::vector<std::set<size_t>> k_count;
-    std::vector<std::map<size_t, double>> G;
-    std::vector<std::map<size_t, double>> J;
+    void op(int value)
+    {
+        key('o');
+        put(value);
+    }
 
-    NLWriter() {}
+    void num(double value)
+    {
+        key('n');
+        put(value);
+    }
 
-    void collect_nl_data(Model& model, std::map<size_t, size_t>& invvarmap,
-                         std::map<size_t, size_t>& invconmap);
+    void var(size_t value)
+    {
+        key('v');
+        put(value);
+    }
 
-    void write_ostream(Model& model, const std::string& fname);
-    void write_fmtlib(Model& model, const std::string& fname);
+    void clear() { buf.clear(); }
 };
 
-// TODO - Reorder constraints to have nonlinear before linear
-void NLWriter::collect_nl_data(Model& model, std::map<size_t, size_t>& invvarmap,
-                               std::map<size_t, size_t>& invconmap)
+//
+// Write segments [0, n) with fn(buf, i).
+//
+void write_binary_segments(std::ostream& ostr, size_t n, size_t nthreads,
+                           const std::function<void(BinaryNLBuffer&, size_t)>& fn)
 {
-    o_expr.resize(model.repn->objectives.size());
-    c_expr.resize(model.repn->constraints.size());
-    r.resize(model.repn->constraints.size());
-    rval.resize(2 * model.repn->constraints.size());
+    write_chunks<BinaryNLBuffer>(
+        n, nthreads, [&](BinaryNLBuffer& buf, size_t i, size_t) { fn(buf, i); },
+        [&](BinaryNLBuffer& buf) {
+            ostr.write(buf.buf.data(), static_cast<std::streamsize>(buf.buf.size()));
+        });
+}
 
-    std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t> simplified_subexpressions;
+class PrintExprBinary : public Visitor {
+   public:
+    BinaryNLBuffer& ostr;
+    const std::unordered_map<ITYPE, ITYPE>& varmap;
 
-    CALI_CXX_MARK_FUNCTION;
+   public:
+    PrintExprBinary(BinaryNLBuffer& _ostr, const std::unordered_map<ITYPE, ITYPE>& _varmap)
+        : ostr(_ostr), varmap(_varmap)
+    {
+    }
+
+    void visit(ConstantTerm& arg);
+    void visit(ParameterTerm& arg);
+    void visit(IndexParameterTerm& arg);
+    void visit(VariableTerm& arg);
+#if __cpp_lib_variant
+    void visit(ParameterRefTerm& arg);
+    void visit(VariableRefTerm& arg);
+#endif
+    void visit(MonomialTerm& arg);
+    void visit(LinearRowTerm& arg);
+    void visit(InequalityTerm& arg);
+    void visit(EqualityTerm& arg);
+    void visit(ObjectiveTerm& arg);
+    void visit(SubExpressionTerm& arg);
+    void visit(NegateTerm& arg);
+    void visit(PlusTerm& arg);
+    void visit(TimesTerm& arg);
+    void visit(DivideTerm& arg);
+    void visit(AbsTerm& arg);
+    void visit(CeilTerm& arg);
+    void visit(FloorTerm& arg);
+    void visit(ExpTerm& arg);
+    void visit(LogTerm& arg);
+    void visit(Log10Term& arg);
+    void visit(SqrtTerm& arg);
+    void visit(SinTerm& arg);
+    void visit(CosTerm& arg);
+    void visit(TanTerm& arg);
+    void visit(SinhTerm& arg);
+    void visit(CoshTerm& arg);
+    void visit(TanhTerm& arg);
+    void visit(ASinTerm& arg);
+    void visit(ACosTerm& arg);
+    void visit(ATanTerm& arg);
+    void visit(ASinhTerm& arg);
+    void visit(ACoshTerm& arg);
+    void visit(ATanhTerm& arg);
+    void visit(PowTerm& arg);
+};
 
-    CALI_MARK_BEGIN("Prepare Objective Expressions");
+void PrintExprBinary::visit(ConstantTerm& arg) { ostr.num(arg.value); }
 
-    // Objectives
-    try {
-        {
-            nnz_gradient = 0;
-            size_t ctr = 0;
-            for (auto& obj : model.repn->objectives) {
-                to_MutableNLPExpr(simplify_expr(obj.repn, simplified_subexpressions), o_expr[ctr]);
-                if ((o_expr[ctr].quadratic_coefs.size() > 0)
-                    or (not o_expr[ctr].nonlinear->is_constant()))
-                    ++nonl_objectives;
+void PrintExprBinary::visit(ParameterTerm& arg) { ostr.num(arg.eval()); }
 
-                std::set<ITYPE> curr_vars;
-                for (auto& var : o_expr[ctr].linear_vars) {
-                    auto index = var->index;
-                    linear_vars.insert(index);
-                    vars.insert(index);
-                    curr_vars.insert(index);
-                    varobj[index] = var;
-                }
-                for (auto& var : o_expr[ctr].quadratic_lvars) {
-                    auto index = var->index;
-                    nonlinear_vars_obj.insert(index);
-                    vars.insert(index);
-                    curr_vars.insert(index);
-                    varobj[index] = var;
-                }
-                for (auto& var : o_expr[ctr].quadratic_rvars) {
-                    auto index = var->index;
-                    nonlinear_vars_obj.insert(index);
-                    vars.insert(index);
-                    curr_vars.insert(index);
-                    varobj[index] = var;
-                }
-                for (auto& var : o_expr[ctr].nonlinear_vars) {
-                    auto index = var->index;
-                    nonlinear_vars_obj.insert(index);
-                    vars.insert(index);
-                    curr_vars.insert(index);
-                    varobj[index] = var;
-                }
-                nnz_gradient += curr_vars.size();
+// GCOVR_EXCL_START
+void PrintExprBinary::visit(IndexParameterTerm&)
+{
+    throw std::runtime_error(
+        "Encountered an index parameter when printing an expression.  This error should have been "
+        "caught earlier!");
+}
+// GCOVR_EXCL_STOP
 
-                ctr++;
-                break;  // TODO - Fix this for multiobjective
-            }
-        }
-        CALI_MARK_END("Prepare Objective Expressions");
+void PrintExprBinary::visit(VariableTerm& arg)
+{
+    if (arg.fixed)
+        ostr.num(arg.eval());
+    else
+        ostr.var(varmap.at(arg.index));
+}
 
-        CALI_MARK_BEGIN("Prepare Constraint Expressions");
-        // Constraints
-        {
-            size_t ctr = 0;
-            for (auto jt = model.repn->constraints.begin(); jt != model.repn->constraints.end();
-                 ++jt, ++ctr) {
-                auto& Expr = c_expr[ctr];
-                auto& Con = *jt;
+#if __cpp_lib_variant
+void PrintExprBinary::visit(ParameterRefTerm&)
+{
+    throw std::runtime_error("Cannot write an NL file using an abstract expression!");
+}
 
-                invconmap[ctr] = Con.id();
+void PrintExprBinary::visit(VariableRefTerm&)
+{
+    throw std::runtime_error("Cannot write an NL file using an abstract expression!");
+}
+#endif
 
-                // std::cout << "OLD " << Con.body().to_list() << std::endl;
-                to_MutableNLPExpr(simplify_expr(Con.repn, simplified_subexpressions), Expr);
-                // std::cout << "NEW " << Expr.nonlinear->to_list() << std::endl;
+void PrintExprBinary::visit(MonomialTerm& arg)
+{
+    ostr.op(2);
+    ostr.num(arg.coef);
+    if (arg.var->fixed)
+        ostr.num(arg.var->value->eval());
+    else
+        ostr.var(varmap.at(arg.var->index));
+}
 
-                double bodyconst = Expr.constval->eval();
-                if (Con.is_inequality()) {
-                    if (Con.repn->lower and Con.repn->upper) {
-                        double lower = Con.repn->lower->eval() - bodyconst;
-                        double upper = Con.repn->upper->eval() - bodyconst;
-                        if (fabs(upper - lower) < EPSILON) {
-                            ++num_equalities;
-                            r[ctr] = 4;
-                            rval[2 * ctr] = lower;
-                        }
-                        else {
-                            ++num_inequalities;
-                            ++num_ranges;
-                            r[ctr] = 0;
-                            rval[2 * ctr] = lower;
-                            rval[2 * ctr + 1] = upper;
-                        }
-                    }
-                    else if (Con.repn->lower) {
-                        ++num_inequalities;
-                        r[ctr] = 2;
-                        rval[2 * ctr] = Con.repn->lower->eval() - bodyconst;
-                    }
-                    else if (Con.repn->upper) {
-                        ++num_inequalities;
-                        r[ctr] = 1;
-                        rval[2 * ctr] = Con.repn->upper->eval() - bodyconst;
-                    }
-                    else {
-                        // TODO - test unbounded expressions like this
-                        ++num_inequalities;
-                        r[ctr] = 3;
-                    }
-                }
-                else {
-                    ++num_equalities;
-                    r[ctr] = 4;
-                    rval[2 * ctr] = Con.repn->lower->eval() - bodyconst;
-                }
-                if ((Expr.quadratic_coefs.size() > 0) or (not Expr.nonlinear->is_constant()))
-                    ++nonl_constraints;
+void PrintExprBinary::visit(LinearRowTerm& arg)
+{
+    size_t n = arg.end() - arg.begin();
+    if (n == 0) {
+        ostr.num(0.0);
+        return;
+    }
+    if (n == 2)
+        ostr.op(0);
+    else if (n > 2) {
+        ostr.op(54);
+        ostr.put(n);
+    }
+    for (size_t k = arg.begin(); k < arg.end(); k++) {
+        ostr.op(2);
+        ostr.num(arg.coef(k));
+        auto& var = arg.var(k);
+        if (var->fixed)
+            ostr.num(var->value->eval());
+        else
+            ostr.var(varmap.at(var->index));
+    }
+}
 
-                std::set<ITYPE> curr_vars;
+// GCOVR_EXCL_START
+void PrintExprBinary::visit(InequalityTerm&)
+{
+    throw std::runtime_error(
+        "Encountered an inequality constraint when printing an expression.  This error should have "
+        "been caught earlier!");
+}
 
-                for (auto& var : Expr.linear_vars) {
-                    auto index = var->index;
-                    linear_vars.insert(index);
-                    vars.insert(index);
-                    varobj[index] = var;
-                    curr_vars.insert(index);
-                }
-                for (auto& var : Expr.quadratic_lvars) {
-                    auto index = var->index;
-                    nonlinear_vars_con.insert(index);
-                    vars.insert(index);
-                    varobj[index] = var;
-                    curr_vars.insert(index);
-                }
-                for (auto& var : Expr.quadratic_rvars) {
-                    auto index = var->index;
-                    nonlinear_vars_con.insert(index);
-                    vars.insert(index);
-                    varobj[index] = var;
-                    curr_vars.insert(index);
-                }
-                for (auto& var : Expr.nonlinear_vars) {
-                    auto index = var->index;
-                    nonlinear_vars_con.insert(index);
-                    vars.insert(index);
-                    varobj[index] = var;
-                    curr_vars.insert(index);
-                }
+void PrintExprBinary::visit(EqualityTerm&)
+{
+    throw std::runtime_error(
+        "Encountered an equality constraint when printing an expression.  This error should have "
+        "been caught earlier!");
+}
 
-                // Add Jacobian terms for each constraint
-                nnz_Jacobian += curr_vars.size();
-            }
-        }
-        CALI_MARK_END("Prepare Constraint Expressions");
+void PrintExprBinary::visit(ObjectiveTerm&)
+{
+    throw std::runtime_error(
+        "Encountered an objective when printing an expression.  This error should have been caught "
+        "earlier!");
+}
+// GCOVR_EXCL_STOP
 
-        check_that_expression_variables_are_declared(model, varobj);
-    }
-    catch (std::exception& e) {
-        throw std::runtime_error(std::string("Error writing NL file: ") + e.what());
-    }
+void PrintExprBinary::visit(SubExpressionTerm& arg) { arg.body->accept(*this); }
 
-    CALI_MARK_BEGIN("Misc NL");
-    std::set<size_t> nonlinear_vars_both_c;
-    std::set<size_t> nonlinear_vars_both_i;
-    std::set<size_t> nonlinear_vars_con_c;
-    std::set<size_t> nonlinear_vars_con_i;
-    std::set<size_t> nonlinear_vars_obj_c;
-    std::set<size_t> nonlinear_vars_obj_i;
-    std::set<size_t> linear_vars_c;
-    std::set<size_t> linear_vars_b;
-    std::set<size_t> linear_vars_i;
-    //
-    // Collect the variables that are in both objectives and constraints
-    //
-    for (auto& vid : nonlinear_vars_con) {
-        if (nonlinear_vars_obj.find(vid) == nonlinear_vars_obj.end()) {
-            auto& var = varobj[vid];
-            // CON
-            if (var.is_binary() or var.is_integer())
-                nonlinear_vars_con_i.insert(vid);
-            else
-                nonlinear_vars_con_c.insert(vid);
-        }
-        else {
-            auto& var = varobj[vid];
-            // BOTH
-            if (var.is_binary() or var.is_integer())
-                nonlinear_vars_both_i.insert(vid);
-            else
-                nonlinear_vars_both_c.insert(vid);
-        }
+void PrintExprBinary::visit(NegateTerm& arg)
+{
+    if (arg.body->is_constant()) {
+        ostr.num(-arg.body->eval());
     }
-    for (auto& vid : nonlinear_vars_obj) {
-        if (nonlinear_vars_con.find(vid) == nonlinear_vars_con.end()) {
-            auto& var = varobj[vid];
-            // OBJ
-            if (var.is_binary() or var.is_integer())
-                nonlinear_vars_obj_i.insert(vid);
-            else
-                nonlinear_vars_obj_c.insert(vid);
-        }
+    else {
+        ostr.op(16);
+        arg.body->accept(*this);
     }
-    num_nonlinear_both_int_vars = nonlinear_vars_both_i.size();
-    num_nonlinear_con_int_vars = num_nonlinear_con_int_vars + nonlinear_vars_con_i.size();
-    num_nonlinear_obj_int_vars = num_nonlinear_con_int_vars + nonlinear_vars_obj_i.size();
-
-    num_nonlinear_vars_both = nonlinear_vars_both_i.size() + nonlinear_vars_both_c.size();
-    num_nonlinear_vars_con
-        = num_nonlinear_vars_both + nonlinear_vars_con_i.size() + nonlinear_vars_con_c.size();
-    num_nonlinear_vars_obj
-        = num_nonlinear_vars_con + nonlinear_vars_obj_i.size() + nonlinear_vars_obj_c.size();
-
-    num_linear_binary_vars = 0;
-    num_linear_integer_vars = 0;
-    for (auto& vid : linear_vars) {
-        auto& var = varobj[vid];
-        if (var.is_binary())
-            num_linear_binary_vars++;
-        else if (var.is_integer())
-            num_linear_integer_vars++;
-
-        if (nonlinear_vars_obj.find(vid) != nonlinear_vars_obj.end()) continue;
-        if (nonlinear_vars_con.find(vid) != nonlinear_vars_con.end()) continue;
+}
 
-        if (var.is_binary())
-            linear_vars_b.insert(vid);
+void PrintExprBinary::visit(PlusTerm& arg)
+{
+    if (arg.n == 2)
+        ostr.op(0);
+    else {
+        ostr.op(54);
+        ostr.put(static_cast<size_t>(arg.n));
+    }
+    std::vector<expr_pointer_t>& vec = *(arg.data);
+    for (size_t i = 0; i < arg.num_expressions(); ++i) vec[i]->accept(*this);
+}
+
+void PrintExprBinary::visit(TimesTerm& arg)
+{
+    ostr.op(2);
+    arg.lhs->accept(*this);
+    arg.rhs->accept(*this);
+}
+
+void PrintExprBinary::visit(DivideTerm& arg)
+{
+    ostr.op(3);
+    arg.lhs->accept(*this);
+    arg.rhs->accept(*this);
+}
+
+#define PrintExprBinary_FN(FN, TERM)       \
+    void PrintExprBinary::visit(TERM& arg) \
+    {                                      \
+        ostr.op(FN);                       \
+        arg.body->accept(*this);           \
+    }
+
+// clang-format off
+PrintExprBinary_FN(15, AbsTerm)
+PrintExprBinary_FN(14, CeilTerm)
+PrintExprBinary_FN(13, FloorTerm)
+PrintExprBinary_FN(44, ExpTerm)
+PrintExprBinary_FN(43, LogTerm)
+PrintExprBinary_FN(42, Log10Term)
+PrintExprBinary_FN(39, SqrtTerm)
+PrintExprBinary_FN(41, SinTerm)
+PrintExprBinary_FN(46, CosTerm)
+PrintExprBinary_FN(38, TanTerm)
+PrintExprBinary_FN(40, SinhTerm)
+PrintExprBinary_FN(45, CoshTerm)
+PrintExprBinary_FN(37, TanhTerm)
+PrintExprBinary_FN(51, ASinTerm)
+PrintExprBinary_FN(53, ACosTerm)
+PrintExprBinary_FN(49, ATanTerm)
+PrintExprBinary_FN(50, ASinhTerm)
+PrintExprBinary_FN(52, ACoshTerm)
+PrintExprBinary_FN(47, ATanhTerm)
+    // clang-format on
+
+    void PrintExprBinary::visit(PowTerm& arg)
+{
+    ostr.op(5);
+    arg.lhs->accept(*this);
+    arg.rhs->accept(*this);
+}
+
+void print_expr(BinaryNLBuffer& ostr, const MutableNLPExpr& repn,
+                const std::unordered_map<ITYPE, ITYPE>& varmap, bool objective = false)
+{
+    bool nonlinear = not repn.nonlinear->is_constant();
+    bool quadratic = repn.quadratic_coefs.size() > 0;
+
+    double cval = repn.constval->eval();
+    if (not nonlinear) cval += repn.nonlinear->eval();
+
+    std::map<std::pair<ITYPE, ITYPE>, double> term;
+    if (quadratic) {
+        for (size_t i = 0; i < repn.quadratic_coefs.size(); ++i) {
+            ITYPE lhs = varmap.at(repn.quadratic_lvars[i]->index);
+            ITYPE rhs = varmap.at(repn.quadratic_rvars[i]->index);
+            if (rhs < lhs) std::swap(lhs, rhs);
+            auto key = std::pair<ITYPE, ITYPE>(lhs, rhs);
+
+            auto it = term.find(key);
+            if (it != term.end())
+                it->second += repn.quadratic_coefs[i]->eval();
+            else
+                term[key] = repn.quadratic_coefs[i]->eval();
+        }
+    }
+
+    // Compute the number of terms in the sum
+    size_t ctr = 0;
+    if (objective and (fabs(cval) > EPSILON)) ++ctr;
+    if (nonlinear) ++ctr;
+    if (quadratic) ctr += term.size();
+
+    // Write the sum header
+    if (ctr == 0)
+        return;
+    else if (ctr == 2)
+        ostr.op(0);
+    else if (ctr > 2) {
+        ostr.op(54);
+        ostr.put(ctr);
+    }
+
+    // Write terms in the sum
+    if (quadratic) {
+        for (auto it = term.begin(); it != term.end(); ++it) {
+            double coef = it->second;
+            if (coef != 1) {
+                ostr.op(2);
+                ostr.num(coef);
+            }
+            ostr.op(2);
+            ostr.var(it->first.first);
+            ostr.var(it->first.second);
+        }
+    }
+    if (nonlinear) {
+        PrintExprBinary visitor(ostr, varmap);
+        repn.nonlinear->accept(visitor);
+    }
+    if (objective and (fabs(cval) > EPSILON)) {
+        ostr.num(cval);
+    }
+}
+
+//
+// Rows of sparse (index, value) pairs that are stored contiguously.  The
+// entries in each row are sorted by index.
+//
+class SparseRows {
+   public:
+    typedef std::pair<size_t, double> entry_t;
+
+    std::vector<size_t> start;
+    std::vector<entry_t> entries;
+
+    SparseRows() : start(1, 0) {}
+
+    /** \returns the number of rows */
+    size_t size() const { return start.size() - 1; }
+
+    /** \returns the number of entries in row i */
+    size_t size(size_t i) const { return start[i + 1] - start[i]; }
+
+    const entry_t* begin(size_t i) const { return entries.data() + start[i]; }
+    const entry_t* end(size_t i) const { return entries.data() + start[i + 1]; }
+};
+
+}  // namespace
+
+class NLWriter {
+   public:
+    //
+    // Process Model to Create NL Header
+    //
+    // The variables used in the model expressions, sorted by id
+    std::vector<Variable> vars;
+
+    size_t num_inequalities = 0;
+    size_t num_ranges = 0;
+    size_t num_equalities = 0;
+    size_t nonl_objectives = 0;
+    size_t nonl_constraints = 0;
+
+    size_t num_nonlinear_vars_con = 0;
+    size_t num_nonlinear_vars_obj = 0;
+    size_t num_nonlinear_vars_both = 0;
+
+    size_t num_linear_binary_vars = 0;
+    size_t num_linear_integer_vars = 0;
+    size_t num_nonlinear_obj_int_vars = 0;
+    size_t num_nonlinear_con_int_vars = 0;
+    size_t num_nonlinear_both_int_vars = 0;
+
+    size_t nnz_Jacobian = 0;
+    size_t nnz_gradient = 0;
+
+    std::vector<MutableNLPExpr> o_expr;
+    std::vector<bool> o_sense;
+    std::vector<MutableNLPExpr> c_expr;
+    std::vector<int> r;
+    std::vector<double> rval;
+
+    std::unordered_map<ITYPE, ITYPE> varmap;
+    std::vector<size_t> k_count;
+    SparseRows G;
+    SparseRows J;
+
+    //
+    // Subexpressions that are shared by more than one expression are written as NL
+    // defined variables.  When expressions are simplified, each of these subexpressions
+    // is replaced by a proxy variable, which is mapped to the index of the defined
+    // variable in varmap.  The defined variables are stored in the order that they
+    // are discovered, so each follows the defined variables that it depends on.
+    //
+    std::vector<VariableRepn> d_proxy;
+    std::vector<MutableNLPExpr> d_expr;
+    std::vector<std::vector<VariableRepn>> d_vars;  // model variables in the expression
+    std::vector<std::vector<size_t>> d_refs;        // defined variables in the expression
+    std::vector<unsigned char> d_used;              // 1 - constraints, 2 - objectives
+    std::unordered_map<ITYPE, size_t> d_index;      // proxy index -> defined variable
+
+    // The defined variables in the order they are written:  variables used in both
+    // constraints and objectives, then variables used only in constraints, and then
+    // variables used only in objectives.
+    std::vector<size_t> v_order;
+    SparseRows V;
+    size_t num_defined_vars_both = 0;
+    size_t num_defined_vars_con = 0;
+    size_t num_defined_vars_obj = 0;
+
+    //
+    // Suffixes are written as "S" segments.  The kind of a suffix is 0 for variables,
+    // 1 for constraints, 2 for objectives and 3 for the problem, plus 4 since the
+    // suffix values are real numbers.  The values are stored with the NL index of
+    // each component.
+    //
+    struct NLSuffix {
+        int kind;
+        std::string name;
+        std::vector<std::pair<size_t, double>> values;
+    };
+    std::vector<NLSuffix> suffixes;
+
+    // The number of threads used to write segments of the NL file
+    size_t nthreads = 1;
+
+    NLWriter() {}
+
+    void count_constraint(int type)
+    {
+        if (type == 4)
+            ++num_equalities;
+        else {
+            ++num_inequalities;
+            if (type == 0) ++num_ranges;
+        }
+    }
+    void order_variables(const std::vector<Variable>& model_vars,
+                         const std::vector<unsigned char>& flags, const std::vector<size_t>& rank,
+                         std::vector<size_t>& nl_index, std::map<size_t, size_t>& invvarmap);
+
+    void collect_nl_data(Model& model, std::map<size_t, size_t>& invvarmap,
+                         std::map<size_t, size_t>& invconmap);
+    void collect_defined_variables(
+        Model& model,
+        std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t>& simplified_subexpressions);
+    void substitute_defined_variables(MutableNLPExpr& repn, std::vector<size_t>& refs);
+    void collect_suffixes(Model& model, const std::map<size_t, size_t>& invconmap);
+
+    void write_header(std::ostream& ostr, bool binary);
+    void write_objective_segments(std::ostream& ostr);
+    void write_primal_values(std::ostream& ostr);
+    void write_variable_bounds(std::ostream& ostr);
+    void write_column_counts(std::ostream& ostr);
+    void write_gradient(std::ostream& ostr);
+    void write_suffixes(std::ostream& ostr);
+    void write_ostream(Model& model, const std::string& fname);
+    void write_fmtlib(Model& model, const std::string& fname);
+    void write_binary(Model& model, const std::string& fname);
+
+#ifdef COEK_WITH_COMPACT_MODEL
+    //
+    // The constraints of a compact model are generated once to collect the NL data,
+    // and then they are generated again as the NL file is written.  The variables of
+    // the model are indexed by declared, and nl_index maps their positions to NL
+    // variable IDs.
+    //
+    IdIndex declared;
+    std::vector<size_t> nl_index;
+    size_t num_constraints = 0;
+
+    void collect_nl_data(CompactModel& model, std::map<size_t, size_t>& invvarmap);
+    void write_ostream(CompactModel& model, const std::string& fname,
+                       std::map<size_t, size_t>& invconmap);
+#endif
+};
+
+namespace {
+
+// Flags that describe how a variable is used in the model expressions
+const unsigned char VAR_USED = 1;
+const unsigned char VAR_LINEAR = 2;
+const unsigned char VAR_NONLINEAR_OBJ = 4;
+const unsigned char VAR_NONLINEAR_CON = 8;
+
+//
+// Classify the bounds of a constraint with the types used in the NL "r" section, after
+// the constant term in the body is moved to the bounds:
+//   0 - range (val[0] <= body <= val[1])
+//   1 - upper bound (body <= val[0])
+//   2 - lower bound (val[0] <= body)
+//   3 - no bounds
+//   4 - equality (body == val[0])
+//
+int constraint_type(Constraint& con, double bodyconst, double* val)
+{
+    if (con.is_inequality()) {
+        if (con.repn->lower and con.repn->upper) {
+            double lower = con.repn->lower->eval() - bodyconst;
+            double upper = con.repn->upper->eval() - bodyconst;
+            val[0] = lower;
+            if (fabs(upper - lower) < EPSILON) return 4;
+            val[1] = upper;
+            return 0;
+        }
+        else if (con.repn->lower) {
+            val[0] = con.repn->lower->eval() - bodyconst;
+            return 2;
+        }
+        else if (con.repn->upper) {
+            val[0] = con.repn->upper->eval() - bodyconst;
+            return 1;
+        }
+        // TODO - test unbounded expressions like this
+        return 3;
+    }
+    val[0] = con.repn->lower->eval() - bodyconst;
+    return 4;
+}
+
+//
+// Append a row with the linear terms of an expression.  Variables in the
+// nonlinear terms are added with a zero coefficient, and then the linear
+// coefficients are summed in the order that they appear.  If count is
+// not null, then count[i] is incremented if the row contains NL variable i.
+//
+// The slot array records the position in rows.entries of each NL variable
+// in the row.  It is reset before returning, so it can be reused for the
+// next row.
+//
+void add_linear_row(const MutableNLPExpr& expr, const IdIndex& declared,
+                    const std::vector<size_t>& nl_index, std::vector<size_t>& slot,
+                    SparseRows& rows, std::vector<size_t>* count)
+{
+    size_t row_start = rows.entries.size();
+
+    auto add = [&](const VariableRepn& var, double value) {
+        size_t index = nl_index[declared.find(var->index)];
+        size_t k = slot[index];
+        if (k != IdIndex::npos) {
+            rows.entries[k].second += value;
+        }
+        else {
+            slot[index] = rows.entries.size();
+            rows.entries.emplace_back(index, value);
+            if (count) ++(*count)[index];
+        }
+    };
+
+    for (auto& var : expr.quadratic_lvars) add(var, 0);
+    for (auto& var : expr.quadratic_rvars) add(var, 0);
+    for (auto& var : expr.nonlinear_vars) add(var, 0);
+    for (size_t j : coek::indices(expr.linear_coefs))
+        add(expr.linear_vars[j], expr.linear_coefs[j]->eval());
+
+    auto row_begin = rows.entries.begin() + static_cast<std::ptrdiff_t>(row_start);
+    for (auto it = row_begin; it != rows.entries.end(); ++it) slot[it->first] = IdIndex::npos;
+    std::sort(row_begin, rows.entries.end(),
+              [](const SparseRows::entry_t& a, const SparseRows::entry_t& b) {
+                  return a.first < b.first;
+              });
+    rows.start.push_back(rows.entries.size());
+}
+
+//
+// Print a record of the "r" section, using the types from constraint_type().
+//
+void print_constraint_bounds(std::ostream& ostr, int type, const double* val)
+{
+    switch (type) {
+        case 0:
+            ostr << "0 ";
+            format(ostr, val[0]);
+            ostr << " ";
+            format(ostr, val[1]);
+            break;
+        case 1:
+            ostr << "1 ";
+            format(ostr, val[0]);
+            break;
+        case 2:
+            ostr << "2 ";
+            format(ostr, val[0]);
+            break;
+        // GCOVR_EXCL_START
+        case 3:
+            ostr << "3";
+            break;
+        // GCOVR_EXCL_STOP
+        case 4:
+            ostr << "4 ";
+            format(ostr, val[0]);
+            break;
+    };
+    ostr << '\n';
+}
+
+//
+// Print row i of the "J" or "G" sections.  Empty rows are skipped.
+//
+void print_linear_row(std::ostream& ostr, char key, size_t i, const SparseRows::entry_t* begin,
+                      const SparseRows::entry_t* end)
+{
+    if (begin == end) return;
+    ostr << key << i << " " << (end - begin) << '\n';
+    for (auto it = begin; it != end; ++it) ostr << it->first << " " << it->second << '\n';
+}
+
+//
+// Append a row of linear terms for each expression.
+//
+void collect_linear_rows(const std::vector<MutableNLPExpr>& exprs, const IdIndex& declared,
+                         const std::vector<size_t>& nl_index, size_t nvars, SparseRows& rows,
+                         std::vector<size_t>* count)
+{
+    std::vector<size_t> slot(nvars, IdIndex::npos);
+    for (auto& expr : exprs) add_linear_row(expr, declared, nl_index, slot, rows, count);
+}
+
+//
+// Check that an NL file was opened, and that it was written and closed without errors.
+// Otherwise a truncated file (e.g. on a full disk) would be left for the solver to read.
+//
+void check_open(const std::ofstream& ostr, const std::string& fname)
+{
+    if (not ostr) throw std::runtime_error("Cannot open file: " + fname);
+}
+
+void check_close(std::ofstream& ostr, const std::string& fname)
+{
+    ostr.close();
+    if (not ostr) throw std::runtime_error("Error writing NL file: " + fname);
+}
+
+}  // namespace
+
+void NLWriter::collect_defined_variables(
+    Model& model,
+    std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t>& simplified_subexpressions)
+{
+    // No subexpressions have been created
+    if (SubExpressionTerm::count == 0) return;
+
+    std::unordered_map<std::shared_ptr<SubExpressionTerm>, size_t> count;
+    std::vector<std::shared_ptr<SubExpressionTerm>> order;
+    for (auto& obj : model.repn->objectives) count_subexpressions(obj.repn, count, order);
+    for (auto& con : model.repn->constraints) count_subexpressions(con.repn, count, order);
+
+    for (auto& subexpr : order) {
+        if (count[subexpr] < 2) continue;
+
+        // Constants and variables are simply inlined
+        auto body = simplify_expr(subexpr->body, simplified_subexpressions);
+        if (body->is_constant() or body->is_variable()) {
+            simplified_subexpressions[subexpr] = body;
+            continue;
+        }
+
+        // The proxy variables are indexed from the top of the index range, so creating
+        // them does not change the indices of variables that are created later.
+        auto index = std::numeric_limits<unsigned int>::max()
+                     - static_cast<unsigned int>(d_proxy.size());
+        auto proxy = std::make_shared<VariableTerm>(index, VariableTerm::negative_infinity,
+                                                    VariableTerm::positive_infinity,
+                                                    VariableTerm::nan, false, false);
+        proxy->name = subexpr->get_name();
+        simplified_subexpressions[subexpr] = proxy;
+
+        size_t k = d_proxy.size();
+        d_index[proxy->index] = k;
+        d_proxy.push_back(proxy);
+        d_expr.emplace_back();
+        d_refs.emplace_back();
+        d_used.push_back(0);
+
+        auto& repn = d_expr[k];
+        to_MutableNLPExpr(body, repn);
+        substitute_defined_variables(repn, d_refs[k]);
+
+        std::set<VariableRepn, MutableNLPExpr::varterm_compare> tmp(repn.nonlinear_vars);
+        tmp.insert(repn.linear_vars.begin(), repn.linear_vars.end());
+        tmp.insert(repn.quadratic_lvars.begin(), repn.quadratic_lvars.end());
+        tmp.insert(repn.quadratic_rvars.begin(), repn.quadratic_rvars.end());
+        d_vars.emplace_back(tmp.begin(), tmp.end());
+    }
+}
+
+//
+// Replace the proxy variables in repn with references to defined variables in the
+// nonlinear expression.  The model variables that the defined variables depend on are
+// nonlinear variables in repn.
+//
+void NLWriter::substitute_defined_variables(MutableNLPExpr& repn, std::vector<size_t>& refs)
+{
+    refs.clear();
+    if (d_proxy.size() == 0) return;
+
+    auto defined = [&](const VariableRepn& var) {
+        auto it = d_index.find(var->index);
+        return it == d_index.end() ? IdIndex::npos : it->second;
+    };
+    auto scale = [](const expr_pointer_t& coef, const expr_pointer_t& expr) -> expr_pointer_t {
+        if (coef->is_constant() and (coef->eval() == 1)) return expr;
+        return std::make_shared<TimesTerm>(coef, expr);
+    };
+    std::set<size_t> used;
+
+    size_t n = 0;
+    for (size_t j : coek::indices(repn.linear_vars)) {
+        size_t k = defined(repn.linear_vars[j]);
+        if (k == IdIndex::npos) {
+            repn.linear_vars[n] = repn.linear_vars[j];
+            repn.linear_coefs[n] = repn.linear_coefs[j];
+            ++n;
+        }
+        else {
+            repn.nonlinear
+                = plus_(repn.nonlinear, scale(repn.linear_coefs[j], repn.linear_vars[j]));
+            used.insert(k);
+        }
+    }
+    repn.linear_vars.resize(n);
+    repn.linear_coefs.resize(n);
+
+    n = 0;
+    for (size_t j : coek::indices(repn.quadratic_coefs)) {
+        auto& lvar = repn.quadratic_lvars[j];
+        auto& rvar = repn.quadratic_rvars[j];
+        size_t lk = defined(lvar);
+        size_t rk = defined(rvar);
+        if ((lk == IdIndex::npos) and (rk == IdIndex::npos)) {
+            repn.quadratic_lvars[n] = lvar;
+            repn.quadratic_rvars[n] = rvar;
+            repn.quadratic_coefs[n] = repn.quadratic_coefs[j];
+            ++n;
+            continue;
+        }
+        repn.nonlinear = plus_(repn.nonlinear, scale(repn.quadratic_coefs[j],
+                                                     std::make_shared<TimesTerm>(lvar, rvar)));
+        if (lk == IdIndex::npos)
+            repn.nonlinear_vars.insert(lvar);
+        else
+            used.insert(lk);
+        if (rk == IdIndex::npos)
+            repn.nonlinear_vars.insert(rvar);
+        else
+            used.insert(rk);
+    }
+    repn.quadratic_lvars.resize(n);
+    repn.quadratic_rvars.resize(n);
+    repn.quadratic_coefs.resize(n);
+
+    for (auto it = repn.nonlinear_vars.begin(); it != repn.nonlinear_vars.end();) {
+        size_t k = defined(*it);
+        if (k == IdIndex::npos)
+            ++it;
+        else {
+            used.insert(k);
+            it = repn.nonlinear_vars.erase(it);
+        }
+    }
+
+    for (auto k : used) repn.nonlinear_vars.insert(d_vars[k].begin(), d_vars[k].end());
+    refs.assign(used.begin(), used.end());
+}
+
+//
+// Order the variables that are used in the model expressions, and map them to NL
+// variable IDs.  The flags describe how each variable in model_vars is used, and
+// nl_index is set to the NL variable ID of each variable (or IdIndex::npos).  If
+// rank is not empty, then it is the position of each variable in the model ordering.
+//
+void NLWriter::order_variables(const std::vector<Variable>& model_vars,
+                               const std::vector<unsigned char>& flags,
+                               const std::vector<size_t>& rank, std::vector<size_t>& nl_index,
+                               std::map<size_t, size_t>& invvarmap)
+{
+    //
+    // Collect the positions of the variables that are used, sorted by id or by rank
+    //
+    std::vector<size_t> used;
+    for (size_t i : coek::indices(flags))
+        if (flags[i] & VAR_USED) used.push_back(i);
+    if (rank.size() > 0) {
+        auto rank_less = [&](size_t a, size_t b) { return rank[a] < rank[b]; };
+        std::sort(used.begin(), used.end(), rank_less);
+    }
+    else {
+        auto id_less = [&](size_t a, size_t b) { return model_vars[a].id() < model_vars[b].id(); };
+        if (not std::is_sorted(used.begin(), used.end(), id_less))
+            std::sort(used.begin(), used.end(), id_less);
+    }
+
+    //
+    // Categorize the variables.  The NL variables are ordered by category, and then in
+    // the order of the used vector:
+    //   0,1 - nonlinear in both objectives and constraints (continuous, discrete)
+    //   2,3 - nonlinear in constraints (continuous, discrete)
+    //   4,5 - nonlinear in objectives (continuous, discrete)
+    //   6,7,8 - linear (continuous, binary, integer)
+    //
+    std::vector<unsigned char> category(used.size());
+    size_t category_size[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    for (size_t k : coek::indices(used)) {
+        auto& var = model_vars[used[k]];
+        auto flag = flags[used[k]];
+        bool discrete = var.is_binary() or var.is_integer();
+        unsigned char c;
+        if ((flag & VAR_NONLINEAR_CON) and (flag & VAR_NONLINEAR_OBJ))
+            c = discrete ? 1 : 0;
+        else if (flag & VAR_NONLINEAR_CON)
+            c = discrete ? 3 : 2;
+        else if (flag & VAR_NONLINEAR_OBJ)
+            c = discrete ? 5 : 4;
+        else if (var.is_binary())
+            c = 7;
         else if (var.is_integer())
-            linear_vars_i.insert(vid);
+            c = 8;
         else
-            linear_vars_c.insert(vid);
+            c = 6;
+        category[k] = c;
+        ++category_size[c];
+    }
+    // The discrete variables in the header are the linear variables at the end of the
+    // variable ordering, so discrete variables in nonlinear terms are not counted here.
+    num_linear_binary_vars = category_size[7];
+    num_linear_integer_vars = category_size[8];
+    num_nonlinear_both_int_vars = category_size[1];
+    num_nonlinear_con_int_vars = category_size[3];
+    num_nonlinear_obj_int_vars = num_nonlinear_con_int_vars + category_size[5];
+
+    num_nonlinear_vars_both = category_size[0] + category_size[1];
+    num_nonlinear_vars_con = num_nonlinear_vars_both + category_size[2] + category_size[3];
+    num_nonlinear_vars_obj = num_nonlinear_vars_con + category_size[4] + category_size[5];
+
+    // Map Variable index to NL variable ID (0 ... n_vars-1)
+    nl_index.assign(model_vars.size(), IdIndex::npos);
+    {
+        size_t offset[9];
+        size_t ctr = 0;
+        for (size_t c = 0; c < 9; ++c) {
+            offset[c] = ctr;
+            ctr += category_size[c];
+        }
+
+        std::vector<size_t> nl_ids(used.size());
+        vars.reserve(used.size());
+        varmap.reserve(used.size());
+        for (size_t k : coek::indices(used)) {
+            auto& var = model_vars[used[k]];
+            size_t index = offset[category[k]]++;
+            vars.push_back(var);
+            nl_index[used[k]] = index;
+            nl_ids[index] = var.id();
+            varmap[var.id()] = index;
+        }
+        for (size_t index : coek::indices(nl_ids))
+            invvarmap.insert_or_assign(invvarmap.end(), index, nl_ids[index]);
+    }
+}
+
+// TODO - Reorder constraints to have nonlinear before linear
+void NLWriter::collect_nl_data(Model& model, std::map<size_t, size_t>& invvarmap,
+                               std::map<size_t, size_t>& invconmap)
+{
+    nthreads = model.repn->num_writer_threads;
+    if (nthreads == 0) nthreads = default_num_threads();
+
+    o_expr.resize(model.repn->objectives.size());
+    for (auto& obj : model.repn->objectives) o_sense.push_back(obj.sense());
+    c_expr.resize(model.repn->constraints.size());
+    r.resize(model.repn->constraints.size());
+    rval.resize(2 * model.repn->constraints.size());
+
+    std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t> simplified_subexpressions;
+
+    CALI_CXX_MARK_FUNCTION;
+
+    //
+    // Variables are tracked by their position in the model.  The last_row array
+    // records the last objective or constraint that a variable appeared in, which
+    // is used to count the nonzeros in each row.
+    //
+    auto& model_vars = model.repn->variables;
+    IdIndex declared;
+    index_model_variables(model, declared);
+    std::vector<unsigned char> flags(model_vars.size(), 0);
+    std::vector<size_t> last_row(model_vars.size(), IdIndex::npos);
+    std::vector<VariableRepn> undeclared;
+    size_t row = 0;
+
+    auto mark_vars = [&](const auto& var_list, unsigned char flag) {
+        size_t nnz = 0;
+        for (auto& var : var_list) {
+            size_t i = declared.find(var->index);
+            if (i == IdIndex::npos) {
+                undeclared.push_back(var);
+                continue;
+            }
+            flags[i] |= VAR_USED | flag;
+            if (last_row[i] != row) {
+                last_row[i] = row;
+                ++nnz;
+            }
+        }
+        return nnz;
+    };
+
+    std::vector<size_t> refs;
+
+    //
+    // The model ordering is applied to the constraints, and to the variables within
+    // each NL variable category
+    //
+    std::vector<size_t> var_order;
+    std::vector<size_t> con_order;
+    std::vector<size_t> rank;
+    model_ordering(model, var_order, con_order);
+    if (model.repn->ordering != Model::Ordering::creation) {
+        rank.resize(model_vars.size());
+        for (size_t k : coek::indices(var_order)) rank[var_order[k]] = k;
+    }
+
+    try {
+        collect_defined_variables(model, simplified_subexpressions);
+
+        CALI_MARK_BEGIN("Prepare Objective Expressions");
+
+        // Objectives
+        {
+            nnz_gradient = 0;
+            size_t ctr = 0;
+            for (auto& obj : model.repn->objectives) {
+                to_MutableNLPExpr(simplify_expr(obj.repn, simplified_subexpressions), o_expr[ctr]);
+                substitute_defined_variables(o_expr[ctr], refs);
+                for (auto k : refs) d_used[k] |= 2;
+                if ((o_expr[ctr].quadratic_coefs.size() > 0)
+                    or (not o_expr[ctr].nonlinear->is_constant()))
+                    ++nonl_objectives;
+
+                nnz_gradient += mark_vars(o_expr[ctr].linear_vars, VAR_LINEAR);
+                nnz_gradient += mark_vars(o_expr[ctr].quadratic_lvars, VAR_NONLINEAR_OBJ);
+                nnz_gradient += mark_vars(o_expr[ctr].quadratic_rvars, VAR_NONLINEAR_OBJ);
+                nnz_gradient += mark_vars(o_expr[ctr].nonlinear_vars, VAR_NONLINEAR_OBJ);
+                ++row;
+
+                ctr++;
+            }
+        }
+        CALI_MARK_END("Prepare Objective Expressions");
+
+        CALI_MARK_BEGIN("Prepare Constraint Expressions");
+        // Constraints
+        {
+            for (size_t ctr : coek::indices(con_order)) {
+                auto& Expr = c_expr[ctr];
+                auto& Con = model.repn->constraints[con_order[ctr]];
+
+                invconmap[ctr] = Con.id();
+
+                // std::cout << "OLD " << Con.body().to_list() << std::endl;
+                to_MutableNLPExpr(simplify_expr(Con.repn, simplified_subexpressions), Expr);
+                // std::cout << "NEW " << Expr.nonlinear->to_list() << std::endl;
+                substitute_defined_variables(Expr, refs);
+                for (auto k : refs) d_used[k] |= 1;
+
+                r[ctr] = constraint_type(Con, Expr.constval->eval(), &rval[2 * ctr]);
+                count_constraint(r[ctr]);
+                if ((Expr.quadratic_coefs.size() > 0) or (not Expr.nonlinear->is_constant()))
+                    ++nonl_constraints;
+
+                // Add Jacobian terms for each constraint
+                nnz_Jacobian += mark_vars(Expr.linear_vars, VAR_LINEAR);
+                nnz_Jacobian += mark_vars(Expr.quadratic_lvars, VAR_NONLINEAR_CON);
+                nnz_Jacobian += mark_vars(Expr.quadratic_rvars, VAR_NONLINEAR_CON);
+                nnz_Jacobian += mark_vars(Expr.nonlinear_vars, VAR_NONLINEAR_CON);
+                ++row;
+            }
+        }
+        CALI_MARK_END("Prepare Constraint Expressions");
+
+        check_that_expression_variables_are_declared(declared, undeclared);
+    }
+    catch (std::exception& e) {
+        throw std::runtime_error(std::string("Error writing NL file: ") + e.what());
+    }
+
+    CALI_MARK_BEGIN("Misc NL");
+    std::vector<size_t> nl_index;
+    order_variables(model_vars, flags, rank, nl_index, invvarmap);
+
+    //
+    // Order the defined variables, and map them to the NL variable IDs that follow the
+    // model variables.  A defined variable is used wherever the defined variables that
+    // depend on it are used.
+    //
+    if (d_proxy.size() > 0) {
+        for (size_t k = d_proxy.size(); k-- > 0;)
+            for (auto j : d_refs[k]) d_used[j] |= d_used[k];
+
+        for (unsigned char u : std::initializer_list<unsigned char>{3, 1, 2})
+            for (size_t k : coek::indices(d_used))
+                if (d_used[k] == u) v_order.push_back(k);
+        num_defined_vars_both = static_cast<size_t>(std::count(d_used.begin(), d_used.end(), 3));
+        num_defined_vars_con = static_cast<size_t>(std::count(d_used.begin(), d_used.end(), 1));
+        num_defined_vars_obj = static_cast<size_t>(std::count(d_used.begin(), d_used.end(), 2));
+
+        for (size_t i : coek::indices(v_order)) {
+            auto& repn = d_expr[v_order[i]];
+            varmap[d_proxy[v_order[i]]->index] = vars.size() + i;
+
+            std::map<size_t, double> linear;
+            for (size_t j : coek::indices(repn.linear_vars)) {
+                size_t index = nl_index[declared.find(repn.linear_vars[j]->index)];
+                auto it = linear.find(index);
+                if (it != linear.end())
+                    it->second += repn.linear_coefs[j]->eval();
+                else
+                    linear[index] = repn.linear_coefs[j]->eval();
+            }
+            V.entries.insert(V.entries.end(), linear.begin(), linear.end());
+            V.start.push_back(V.entries.size());
+        }
+    }
+    CALI_MARK_END("Misc NL");
+
+    // Compute linear Jacobian and Gradient values
+    CALI_MARK_BEGIN("Compute Jacobian/Gradient");
+    k_count.assign(vars.size(), 0);
+    collect_linear_rows(o_expr, declared, nl_index, vars.size(), G, nullptr);
+    collect_linear_rows(c_expr, declared, nl_index, vars.size(), J, &k_count);
+    CALI_MARK_END("Compute Jacobian/Gradient");
+
+    collect_suffixes(model, invconmap);
+}
+
+//
+// Collect the suffix values of the variables, constraints and objectives that are
+// written to the NL file.  Only the first objective is written.
+//
+void NLWriter::collect_suffixes(Model& model, const std::map<size_t, size_t>& invconmap)
+{
+    auto& mrepn = *model.repn;
+
+    auto add_suffix = [&](int kind, const std::string& name, const auto& values,
+                          const auto& nl_index) {
+        NLSuffix suffix{kind + 4, name, {}};
+        for (auto& it : values) {
+            auto jt = nl_index.find(it.first);
+            if (jt != nl_index.end()) suffix.values.emplace_back(jt->second, it.second);
+        }
+        if (suffix.values.size() == 0) return;
+        std::sort(suffix.values.begin(), suffix.values.end());
+        suffixes.push_back(std::move(suffix));
+    };
+
+    if (mrepn.vsuffix.size() > 0) {
+        for (auto& it : mrepn.vsuffix) add_suffix(0, it.first, it.second, varmap);
+    }
+    if (mrepn.csuffix.size() > 0) {
+        std::unordered_map<size_t, size_t> con_index;
+        for (auto& it : invconmap) con_index[it.second] = it.first;
+        for (auto& it : mrepn.csuffix) add_suffix(1, it.first, it.second, con_index);
+    }
+    if ((mrepn.osuffix.size() > 0) and (mrepn.objectives.size() > 0)) {
+        std::unordered_map<size_t, size_t> obj_index;
+        obj_index[mrepn.objectives[0].id()] = 0;
+        for (auto& it : mrepn.osuffix) add_suffix(2, it.first, it.second, obj_index);
+    }
+    for (auto& it : mrepn.msuffix) suffixes.push_back(NLSuffix{3 + 4, it.first, {{0, it.second}}});
+}
+
+void NLWriter::write_header(std::ostream& ostr, bool binary)
+{
+    //
+    // Write NL Header
+    //
+    // This API seems poorly documented.  Is the 2005 paper the defining reference?  Pyomo
+    // writes a header that doesn't conform to it...
+    //
+    // The arith field of a binary NL file describes the byte order of the binary
+    // values: 1 for little-endian and 2 for big-endian IEEE arithmetic.
+    //
+    int arith = 0;
+    if (binary) {
+        const int one = 1;
+        arith = *reinterpret_cast<const char*>(&one) == 1 ? 1 : 2;
+    }
+
+    ostr << (binary ? "b" : "g") << "3 1 1 0 # unnamed problem generated by COEK\n";
+    ostr << " " << vars.size() << " " << (num_inequalities + num_equalities) << " "
+         << std::max((size_t)1, o_expr.size()) << " " << num_ranges << " " << num_equalities
+         << " 0 # vars, constraints, objectives, ranges, eqns, lcons\n";
+    ostr << " " << nonl_constraints << " " << nonl_objectives
+         << " # nonlinear constraints, objectives\n";
+    ostr << " 0 0 # network constraints: nonlinear, linear\n";
+    ostr << " " << num_nonlinear_vars_con << " " << num_nonlinear_vars_obj << " "
+         << num_nonlinear_vars_both << " # nonlinear vars in constraints, objectives, both\n";
+    ostr << " 0 0 " << arith << " 1 # linear network variables; functions; arith, flags\n";
+    ostr << " " << num_linear_binary_vars << " " << num_linear_integer_vars << " "
+         << num_nonlinear_both_int_vars << " " << num_nonlinear_con_int_vars << " "
+         << num_nonlinear_obj_int_vars << " # discrete variables: binary, integer, nonlinear (b,c,o)\n";
+    ostr << " " << nnz_Jacobian << " " << nnz_gradient << " # nonzeros in Jacobian, gradients\n";
+    ostr << " 0 0 # max name lengths: constraints, variables\n";
+    ostr << " " << num_defined_vars_both << " " << num_defined_vars_con << " "
+         << num_defined_vars_obj << " 0 0 # common exprs: b,c,o,c1,o1\n";
+}
+
+//
+// "O" section - nonlinear objective segments
+//
+void NLWriter::write_objective_segments(std::ostream& ostr)
+{
+    if (o_expr.size() > 0) {
+        size_t ctr = 0;
+        for (auto it = o_expr.begin(); it != o_expr.end(); ++it, ++ctr) {
+            if (o_sense[ctr] == Model::minimize)
+                ostr << "O" << ctr << " 0\n";
+            else
+                ostr << "O" << ctr << " 1\n";
+            if ((not it->nonlinear->is_constant()) or (it->quadratic_coefs.size() > 0)) {
+                print_expr(ostr, *it, varmap, true);
+            }
+            else {
+                ostr << "n" << it->constval->eval() << '\n';
+            }
+        }
+    }
+    else {
+        ostr << "O0 0\nn0\n";
+    }
+}
+
+//
+// "x" section - primal initial values
+//
+void NLWriter::write_primal_values(std::ostream& ostr)
+{
+    std::map<size_t, double> values;
+    size_t ctr = 0;
+    for (auto it = vars.begin(); it != vars.end(); ++it, ++ctr) {
+        auto tmp = it->value();
+        if (not std::isnan(tmp)) values[ctr] = tmp;
+    }
+    ostr << "x" << values.size() << '\n';
+    for (auto it = values.begin(); it != values.end(); ++it)
+        ostr << it->first << " " << it->second << '\n';
+}
+
+//
+// "b" section - bounds on variables
+//
+void NLWriter::write_variable_bounds(std::ostream& ostr)
+{
+    ostr << "b\n";
+    for (auto& var : vars) {
+        double lb = var.lower();
+        double ub = var.upper();
+        if (lb == -COEK_INFINITY) {
+            if (ub == COEK_INFINITY) {
+                ostr << "3\n";
+            }
+            else {
+                ostr << "1 ";
+                format(ostr, ub);
+                ostr << '\n';
+            }
+        }
+        else {
+            if (ub == COEK_INFINITY) {
+                ostr << "2 ";
+                format(ostr, lb);
+                ostr << '\n';
+            }
+            else {
+                if (fabs(ub - lb) < EPSILON) {
+                    ostr << "4 ";
+                    format(ostr, lb);
+                }
+                else {
+                    ostr << "0 ";
+                    format(ostr, lb);
+                    ostr << " ";
+                    format(ostr, ub);
+                }
+                ostr << '\n';
+            }
+        }
     }
+}
 
-    // Map Variable index to NL variable ID (0 ... n_vars-1)
-    {
+//
+// "k" section - Jacobian column counts
+//
+void NLWriter::write_column_counts(std::ostream& ostr)
+{
+    if ((num_inequalities + num_equalities) == 0) return;
+
+    if (k_count.size() > 1) {
+        ostr << "k" << (k_count.size() - 1) << '\n';
         size_t ctr = 0;
-        for (auto& vid : nonlinear_vars_both_c) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : nonlinear_vars_both_i) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : nonlinear_vars_con_c) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : nonlinear_vars_con_i) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
+        for (size_t i = 0; i < (k_count.size() - 1); ++i) {
+            ctr += k_count[i];
+            ostr << ctr << '\n';
         }
-        for (auto& vid : nonlinear_vars_obj_c) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : nonlinear_vars_obj_i) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : linear_vars_c) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : linear_vars_b) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
-        }
-        for (auto& vid : linear_vars_i) {
-            invvarmap[ctr] = vid;
-            varmap[vid] = ctr++;
+    }
+    else
+        ostr << "k0\n";
+}
+
+//
+// "G" section - Gradient sparsity, linear terms
+//
+void NLWriter::write_gradient(std::ostream& ostr)
+{
+    for (size_t i = 0; i < G.size(); ++i) print_linear_row(ostr, 'G', i, G.begin(i), G.end(i));
+}
+
+//
+// "S" section - suffixes
+//
+void NLWriter::write_suffixes(std::ostream& ostr)
+{
+    for (auto& suffix : suffixes) {
+        ostr << "S" << suffix.kind << " " << suffix.values.size() << " " << suffix.name << '\n';
+        for (auto& it : suffix.values) {
+            ostr << it.first << " ";
+            format(ostr, it.second);
+            ostr << '\n';
         }
     }
+}
 
-    // GCOVR_EXCL_START
-    if (vars.size() != varmap.size())
-        throw std::runtime_error(
-            "Error writing NL file: Variables with duplicate index values detected!");
-    // GCOVR_EXCL_STOP
+void NLWriter::write_ostream(Model& model, const std::string& fname)
+{
+    std::ofstream ostr(fname);
+    check_open(ostr, fname);
 
-    // Compute linear Jacobian and Gradient values
-    CALI_MARK_BEGIN("Compute Jacobian/Gradient");
-    k_count.resize(vars.size());
-    G.resize(o_expr.size());
-    J.resize(c_expr.size());
+    try {
+        write_header(ostr, false);
 
-    {
-        size_t ctr = 0;
-        for (auto it = o_expr.begin(); it != o_expr.end(); ++it, ++ctr) {
-            for (auto& var : it->quadratic_lvars) {
-                G[ctr][varmap[var->index]] = 0;
-            }
-            for (auto& var : it->quadratic_rvars) {
-                G[ctr][varmap[var->index]] = 0;
+        //
+        // "V" section - defined variables
+        //
+        for (size_t i : coek::indices(v_order)) {
+            auto& expr = d_expr[v_order[i]];
+            ostr << "V" << (vars.size() + i) << " " << V.size(i) << " 0\n";
+            for (auto it = V.begin(i); it != V.end(i); ++it) {
+                ostr << it->first << " ";
+                format(ostr, it->second);
+                ostr << '\n';
             }
-            for (auto& var : it->nonlinear_vars) {
-                G[ctr][varmap[var->index]] = 0;
+            if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0)) {
+                print_expr(ostr, expr, varmap, true);
             }
-            for (size_t j : coek::indices(it->linear_coefs)) {
-                auto index = varmap[it->linear_vars[j]->index];
-                auto jt = G[ctr].find(index);
-                if (jt != G[ctr].end())
-                    jt->second += it->linear_coefs[j]->eval();
-                else
-                    G[ctr][index] = it->linear_coefs[j]->eval();
+            else {
+                ostr << "n";
+                format(ostr, expr.constval->eval());
+                ostr << '\n';
             }
         }
-    }
-    {
-        size_t ctr = 0;
-        for (auto it = c_expr.begin(); it != c_expr.end(); ++it, ++ctr) {
-            for (auto& var : it->quadratic_lvars) {
-                size_t index = varmap[var->index];
-                k_count[index].insert(ctr);
-                J[ctr][index] = 0;
-            }
-            for (auto& var : it->quadratic_rvars) {
-                size_t index = varmap[var->index];
-                k_count[index].insert(ctr);
-                J[ctr][index] = 0;
-            }
-            for (auto& var : it->nonlinear_vars) {
-                size_t index = varmap[var->index];
-                k_count[index].insert(ctr);
-                J[ctr][index] = 0;
+
+        //
+        // "C" section - nonlinear constraint segments
+        //
+        write_segments(ostr, c_expr.size(), nthreads, [&](std::ostream& buf, size_t i) {
+            auto& expr = c_expr[i];
+            if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0)) {
+                buf << "C" << i << '\n';
+                print_expr(buf, expr, varmap);
             }
-            for (size_t j : coek::indices(it->linear_coefs)) {
-                size_t index = varmap[it->linear_vars[j]->index];
-                auto jt = J[ctr].find(index);
-                if (jt != J[ctr].end())
-                    jt->second += it->linear_coefs[j]->eval();
-                else {
-                    k_count[index].insert(ctr);
-                    J[ctr][index] = it->linear_coefs[j]->eval();
-                }
+            else {
+                buf << "C" << i << '\n';
+                buf << "n0\n";
             }
+        });
+
+        write_objective_segments(ostr);
+        write_primal_values(ostr);
+
+        //
+        // "r" section - bounds on constraints
+        //
+        if (model.repn->constraints.size() > 0) {
+            ostr << "r\n";
+            for (size_t i : coek::indices(r)) print_constraint_bounds(ostr, r[i], &rval[2 * i]);
         }
+
+        write_variable_bounds(ostr);
+        write_column_counts(ostr);
+
+        //
+        // "J" section - Jacobian sparsity, linear terms
+        //
+        write_segments(ostr, J.size(), nthreads, [&](std::ostream& buf, size_t i) {
+            print_linear_row(buf, 'J', i, J.begin(i), J.end(i));
+        });
+
+        write_gradient(ostr);
+        write_suffixes(ostr);
     }
-    CALI_MARK_END("Compute Jacobian/Gradient");
+    // GCOVR_EXCL_START
+    catch (std::exception& e) {
+        throw std::runtime_error(std::string("Error writing NL file: ") + e.what());
+    }
+    // GCOVR_EXCL_STOP
+
+    check_close(ostr, fname);
 }
 
-void NLWriter::write_ostream(Model& model, const std::string& fname)
+void NLWriter::write_binary(Model& model, const std::string& fname)
 {
-    std::ofstream ostr(fname);
+    std::ofstream ostr(fname, std::ios::out | std::ios::binary);
+    check_open(ostr, fname);
 
-    size_t ctr = 0;
     try {
+        write_header(ostr, true);
+
         //
-        // Write NL Header
-        //
-        // This API seems poorly documented.  Is the 2005 paper the defining reference?  Pyomo
-        // writes a header that doesn't conform to it...
+        // "V" section - defined variables
         //
-        ostr << "g3 1 1 0 # unnamed problem generated by COEK\n";
-        ostr << " " << vars.size() << " " << (num_inequalities + num_equalities) << " "
-             << std::max((size_t)1, o_expr.size()) << " " << num_ranges << " " << num_equalities
-             << " 0 # vars, constraints, objectives, ranges, eqns, lcons\n";
-        ostr << " " << nonl_constraints << " " << nonl_objectives
-             << " # nonlinear constraints, objectives\n";
-        ostr << " 0 0 # network constraints: nonlinear, linear\n";
-        ostr << " " << num_nonlinear_vars_con << " " << num_nonlinear_vars_obj << " "
-             << num_nonlinear_vars_both << " # nonlinear vars in constraints, objectives, both\n";
-        ostr << " 0 0 0 1 # linear network variables; functions; arith, flags\n";
-        ostr << " " << num_linear_binary_vars << " " << num_linear_integer_vars << " "
-             << num_nonlinear_both_int_vars << " " << num_nonlinear_con_int_vars << " "
-             << num_nonlinear_obj_int_vars
-             << " # discrete variables: binary, integer, nonlinear (b,c,o)\n";
-        ostr << " " << nnz_Jacobian << " " << nnz_gradient
-             << " # nonzeros in Jacobian, gradients\n";
-        ostr << " 0 0 # max name lengths: constraints, variables\n";
-        ostr << " 0 0 0 0 0 # common exprs: b,c,o,c1,o1\n";
+        {
+            BinaryNLBuffer vbuf;
+            for (size_t i : coek::indices(v_order)) {
+                auto& expr = d_expr[v_order[i]];
+                vbuf.key('V');
+                vbuf.put(vars.size() + i);
+                vbuf.put(V.size(i));
+                vbuf.put(0);
+                for (auto it = V.begin(i); it != V.end(i); ++it) {
+                    vbuf.put(it->first);
+                    vbuf.put(it->second);
+                }
+                if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0))
+                    print_expr(vbuf, expr, varmap, true);
+                else
+                    vbuf.num(expr.constval->eval());
+            }
+            ostr.write(vbuf.buf.data(), static_cast<std::streamsize>(vbuf.buf.size()));
+        }
 
         //
         // "C" section - nonlinear constraint segments
         //
-        ctr = 0;
-        for (auto it = c_expr.begin(); it != c_expr.end(); ++it, ++ctr) {
-            if ((not it->nonlinear->is_constant()) or (it->quadratic_coefs.size() > 0)) {
-                ostr << "C" << ctr << '\n';
-                print_expr(ostr, *it, varmap);
-            }
-            else {
-                ostr << "C" << ctr << '\n';
-                ostr << "n0\n";
-            }
-        }
+        write_binary_segments(ostr, c_expr.size(), nthreads, [&](BinaryNLBuffer& buf, size_t i) {
+            auto& expr = c_expr[i];
+            buf.key('C');
+            buf.put(i);
+            if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0))
+                print_expr(buf, expr, varmap);
+            else
+                buf.num(0.0);
+        });
+
+        BinaryNLBuffer buf;
 
         //
         // "O" section - nonlinear objective segments
         //
         if (o_expr.size() > 0) {
-            ctr = 0;
+            size_t ctr = 0;
             for (auto it = o_expr.begin(); it != o_expr.end(); ++it, ++ctr) {
                 bool sense = model.repn->objectives[ctr].sense();
-                if (sense == Model::minimize)
-                    ostr << "O" << ctr << " 0\n";
+                buf.key('O');
+                buf.put(ctr);
+                buf.put(sense == Model::minimize ? 0 : 1);
+                if ((not it->nonlinear->is_constant()) or (it->quadratic_coefs.size() > 0))
+                    print_expr(buf, *it, varmap, true);
                 else
-                    ostr << "O" << ctr << " 1\n";
-                if ((not it->nonlinear->is_constant()) or (it->quadratic_coefs.size() > 0)) {
-                    print_expr(ostr, *it, varmap, true);
-                }
-                else {
-                    ostr << "n" << it->constval->eval() << '\n';
-                }
+                    buf.num(it->constval->eval());
             }
         }
         else {
-            ostr << "O0 0\nn0\n";
+            buf.key('O');
+            buf.put(0);
+            buf.put(0);
+            buf.num(0.0);
         }
 
         //
@@ -1057,92 +2145,81 @@ void NLWriter::write_ostream(Model& model, const std::string& fname)
         //
         {
             std::map<size_t, double> values;
-            ctr = 0;
+            size_t ctr = 0;
             for (auto it = vars.begin(); it != vars.end(); ++it, ++ctr) {
-                auto tmp = varobj[*it].value();
+                auto tmp = it->value();
                 if (not std::isnan(tmp)) values[ctr] = tmp;
             }
-            ostr << "x" << values.size() << '\n';
-            if (values.size() > 0) {
-                for (auto it = values.begin(); it != values.end(); ++it)
-                    ostr << it->first << " " << it->second << '\n';
+            buf.key('x');
+            buf.put(values.size());
+            for (auto& it : values) {
+                buf.put(it.first);
+                buf.put(it.second);
             }
         }
 
         //
         // "r" section - bounds on constraints
         //
-
         if (model.repn->constraints.size() > 0) {
-            ostr << "r\n";
-            ctr = 0;
-            for (auto it = model.repn->constraints.begin(); it != model.repn->constraints.end();
-                 ++it, ++ctr) {
+            buf.key('r');
+            for (size_t ctr : coek::indices(r)) {
                 switch (r[ctr]) {
                     case 0:
-                        ostr << "0 ";
-                        format(ostr, rval[2 * ctr]);
-                        ostr << " ";
-                        format(ostr, rval[2 * ctr + 1]);
+                        buf.key('0');
+                        buf.put(rval[2 * ctr]);
+                        buf.put(rval[2 * ctr + 1]);
                         break;
                     case 1:
-                        ostr << "1 ";
-                        format(ostr, rval[2 * ctr]);
+                        buf.key('1');
+                        buf.put(rval[2 * ctr]);
                         break;
                     case 2:
-                        ostr << "2 ";
-                        format(ostr, rval[2 * ctr]);
+                        buf.key('2');
+                        buf.put(rval[2 * ctr]);
                         break;
                     // GCOVR_EXCL_START
                     case 3:
-                        ostr << "3";
+                        buf.key('3');
                         break;
                     // GCOVR_EXCL_STOP
                     case 4:
-                        ostr << "4 ";
-                        format(ostr, rval[2 * ctr]);
+                        buf.key('4');
+                        buf.put(rval[2 * ctr]);
                         break;
                 };
-                ostr << '\n';
             }
         }
 
         //
         // "b" section - bounds on variables
         //
-        ostr << "b\n";
-        for (auto it = vars.begin(); it != vars.end(); ++it) {
-            auto var = varobj[*it];
+        buf.key('b');
+        for (auto& var : vars) {
             double lb = var.lower();
             double ub = var.upper();
             if (lb == -COEK_INFINITY) {
                 if (ub == COEK_INFINITY) {
-                    ostr << "3\n";
+                    buf.key('3');
                 }
                 else {
-                    ostr << "1 ";
-                    format(ostr, ub);
-                    ostr << '\n';
+                    buf.key('1');
+                    buf.put(ub);
                 }
             }
             else {
                 if (ub == COEK_INFINITY) {
-                    ostr << "2 ";
-                    format(ostr, lb);
-                    ostr << '\n';
+                    buf.key('2');
+                    buf.put(lb);
+                }
+                else if (fabs(ub - lb) < EPSILON) {
+                    buf.key('4');
+                    buf.put(lb);
                 }
                 else {
-                    if (fabs(ub - lb) < EPSILON) {
-                        ostr << "4 ";
-                        format(ostr, lb);
-                    }
-                    else {
-                        ostr << "0 ";
-                        format(ostr, lb);
-                        ostr << " ";
-                        format(ostr, ub);
-                    }
-                    ostr << '\n';
+                    buf.key('0');
+                    buf.put(lb);
+                    buf.put(ub);
                 }
             }
         }
@@ -1151,39 +2228,65 @@ void NLWriter::write_ostream(Model& model, const std::string& fname)
         // "k" section - Jacobian column counts
         //
         if (J.size() > 0) {
+            buf.key('k');
             if (k_count.size() > 1) {
-                ostr << "k" << (k_count.size() - 1) << '\n';
-                ctr = 0;
+                buf.put(k_count.size() - 1);
+                size_t ctr = 0;
                 for (size_t i = 0; i < (k_count.size() - 1); ++i) {
-                    ctr += k_count[i].size();
-                    ostr << ctr << '\n';
+                    ctr += k_count[i];
+                    buf.put_size(ctr);
                 }
             }
             else
-                ostr << "k0\n";
+                buf.put(0);
         }
+        ostr.write(buf.buf.data(), static_cast<std::streamsize>(buf.buf.size()));
+        buf.clear();
 
         //
         // "J" section - Jacobian sparsity, linear terms
         //
-        for (size_t i = 0; i < J.size(); ++i) {
-            if (J[i].size() == 0) continue;
-            ostr << "J" << i << " " << J[i].size() << '\n';
-            for (auto it = J[i].begin(); it != J[i].end(); ++it) {
-                ostr << it->first << " " << it->second << '\n';
+        write_binary_segments(ostr, J.size(), nthreads, [&](BinaryNLBuffer& jbuf, size_t i) {
+            if (J.size(i) == 0) return;
+            jbuf.key('J');
+            jbuf.put(i);
+            jbuf.put(J.size(i));
+            for (auto it = J.begin(i); it != J.end(i); ++it) {
+                jbuf.put(it->first);
+                jbuf.put(it->second);
             }
-        }
+        });
 
         //
         // "G" section - Gradient sparsity, linear terms
         //
         for (size_t i = 0; i < G.size(); ++i) {
-            if (G[i].size() == 0) continue;
-            ostr << "G" << i << " " << G[i].size() << '\n';
-            for (auto it = G[i].begin(); it != G[i].end(); ++it) {
-                ostr << it->first << " " << it->second << '\n';
+            if (G.size(i) == 0) continue;
+            buf.key('G');
+            buf.put(i);
+            buf.put(G.size(i));
+            for (auto it = G.begin(i); it != G.end(i); ++it) {
+                buf.put(it->first);
+                buf.put(it->second);
+            }
+        }
+
+        //
+        // "S" section - suffixes.  The suffix name is written as its length and its
+        // characters.
+        //
+        for (auto& suffix : suffixes) {
+            buf.key('S');
+            buf.put(suffix.kind);
+            buf.put(suffix.values.size());
+            buf.put(suffix.name.size());
+            buf.buf.insert(buf.buf.end(), suffix.name.begin(), suffix.name.end());
+            for (auto& it : suffix.values) {
+                buf.put(it.first);
+                buf.put(it.second);
             }
         }
+        ostr.write(buf.buf.data(), static_cast<std::streamsize>(buf.buf.size()));
     }
     // GCOVR_EXCL_START
     catch (std::exception& e) {
@@ -1191,13 +2294,13 @@ void NLWriter::write_ostream(Model& model, const std::string& fname)
     }
     // GCOVR_EXCL_STOP
 
-    ostr.close();
+    check_close(ostr, fname);
 }
 
 #ifdef WITH_FMTLIB
 void NLWriter::write_fmtlib(Model& model, const std::string& fname)
 {
-    auto ostr = fmt::output_file(fname, fmt::file::WRONLY | fmt::file::CREATE | FMT_POSIX(O_TRUNC));
+    OutputFile ostr(fname);
 
     //
     // Write NL Header
@@ -1219,7 +2322,27 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
                num_nonlinear_con_int_vars, num_nonlinear_obj_int_vars);
     ostr.print(" {} {} # nonzeros in Jacobian, gradients\n", nnz_Jacobian, nnz_gradient);
     ostr.print(" 0 0 # max name lengths: constraints, variables\n");
-    ostr.print(" 0 0 0 0 0 # common exprs: b,c,o,c1,o1\n");
+    ostr.print(" {} {} {} 0 0 # common exprs: b,c,o,c1,o1\n", num_defined_vars_both,
+               num_defined_vars_con, num_defined_vars_obj);
+
+    //
+    // "V" section - defined variables
+    //
+    if (v_order.size() > 0) {
+        constexpr auto _fmtstr_V = FMT_COMPILE("V{} {} 0\n");
+        NLBuffer buf;
+        for (size_t i : coek::indices(v_order)) {
+            auto& expr = d_expr[v_order[i]];
+            buf.print(fmt::format(_fmtstr_V, vars.size() + i, V.size(i)));
+            for (auto it = V.begin(i); it != V.end(i); ++it)
+                buf.print(fmt::format(_fmtstr_2vals, it->first, it->second));
+            if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0))
+                print_expr(buf, expr, varmap, true);
+            else
+                buf.print(fmt::format(_fmtstr_n, expr.constval->eval()));
+        }
+        ostr.print("{}", fmt::string_view(buf.buf.data(), buf.buf.size()));
+    }
 
     //
     // "C" section - nonlinear constraint segments
@@ -1228,16 +2351,16 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
     {
         constexpr auto _fmtstr_C = FMT_COMPILE("C{}\n");
         constexpr auto _fmtstr_C_n0 = FMT_COMPILE("C{}\nn0\n");
-        int ctr = 0;
-        for (auto it = c_expr.begin(); it != c_expr.end(); ++it, ++ctr) {
-            if ((not it->nonlinear->is_constant()) or (it->quadratic_coefs.size() > 0)) {
-                ostr.print(fmt::format(_fmtstr_C, ctr));
-                print_expr(ostr, *it, varmap);
+        write_segments(ostr, c_expr.size(), nthreads, [&](NLBuffer& buf, size_t i) {
+            auto& expr = c_expr[i];
+            if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0)) {
+                buf.print(fmt::format(_fmtstr_C, i));
+                print_expr(buf, expr, varmap);
             }
             else {
-                ostr.print(fmt::format(_fmtstr_C_n0, ctr));
+                buf.print(fmt::format(_fmtstr_C_n0, i));
             }
-        }
+        });
     }
     CALI_MARK_END("C");
 
@@ -1249,20 +2372,22 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
         if (o_expr.size() > 0) {
             constexpr auto _fmtstr_O_0 = FMT_COMPILE("O{} 0\n");
             constexpr auto _fmtstr_O_1 = FMT_COMPILE("O{} 1\n");
+            NLBuffer buf;
             size_t ctr = 0;
             for (auto it = o_expr.begin(); it != o_expr.end(); ++it, ++ctr) {
                 bool sense = model.repn->objectives[ctr].sense();
                 if (sense == Model::minimize)
-                    ostr.print(fmt::format(_fmtstr_O_0, ctr));
+                    buf.print(fmt::format(_fmtstr_O_0, ctr));
                 else
-                    ostr.print(fmt::format(_fmtstr_O_1, ctr));
+                    buf.print(fmt::format(_fmtstr_O_1, ctr));
                 if ((not it->nonlinear->is_constant()) or (it->quadratic_coefs.size() > 0)) {
-                    print_expr(ostr, *it, varmap, true);
+                    print_expr(buf, *it, varmap, true);
                 }
                 else {
-                    ostr.print(fmt::format(_fmtstr_n, it->constval->eval()));
+                    buf.print(fmt::format(_fmtstr_n, it->constval->eval()));
                 }
             }
+            ostr.print("{}", fmt::string_view(buf.buf.data(), buf.buf.size()));
         }
         else {
             ostr.print("O0 0\nn0\n");
@@ -1281,8 +2406,8 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
             // fmt::memory_buffer out;
             int num = 0;
             int ctr = 0;
-            for (auto it = varobj.begin(); it != varobj.end(); ++it, ++ctr) {
-                auto tmp = it->second.value();
+            for (auto it = vars.begin(); it != vars.end(); ++it, ++ctr) {
+                auto tmp = it->value();
                 if (not std::isnan(tmp)) {
                     num++;
                     fmt::format_to(std::back_inserter(out), _fmtstr_x, ctr, tmp);
@@ -1342,8 +2467,7 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
     constexpr auto _fmtstr_b4 = FMT_COMPILE("4 {}\n");
     constexpr auto _fmtstr_b0 = FMT_COMPILE("0 {} {}\n");
     ostr.print("b\n");
-    for (auto it = vars.begin(); it != vars.end(); ++it) {
-        auto& var = varobj[*it];
+    for (auto& var : vars) {
         double lb = var.lower();
         double ub = var.upper();
         if (lb == -COEK_INFINITY) {
@@ -1380,7 +2504,7 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
             {
                 size_t ctr = 0;
                 for (size_t i = 0; i < (k_count.size() - 1); ++i) {
-                    ctr += k_count[i].size();
+                    ctr += k_count[i];
                     ostr.print(fmt::format(_fmtstr_value, ctr));  // << ctr << '\n';
                 }
             }
@@ -1396,16 +2520,15 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
     //
     {
         constexpr auto _fmtstr_J = FMT_COMPILE("J{} {}\n");
-        int ctr = 0;
-        for (auto jt = J.begin(); jt != J.end(); ++ctr, ++jt) {
-            if (jt->size() == 0) continue;
-            ostr.print(fmt::format(_fmtstr_J, ctr,
-                                   jt->size()));  // << "J" << i << " " << J[i].size() << '\n';
-            for (auto it = jt->begin(); it != jt->end(); ++it) {
-                ostr.print(fmt::format(_fmtstr_2vals, it->first,
-                                       it->second));  // << it->first << " " << it->second << '\n';
+        write_segments(ostr, J.size(), nthreads, [&](NLBuffer& buf, size_t i) {
+            if (J.size(i) == 0) return;
+            buf.print(fmt::format(_fmtstr_J, i,
+                                  J.size(i)));  // << "J" << i << " " << J.size(i) << '\n';
+            for (auto it = J.begin(i); it != J.end(i); ++it) {
+                buf.print(fmt::format(_fmtstr_2vals, it->first,
+                                      it->second));  // << it->first << " " << it->second << '\n';
             }
-        }
+        });
     }
     CALI_MARK_END("J");
 
@@ -1415,20 +2538,310 @@ void NLWriter::write_fmtlib(Model& model, const std::string& fname)
     constexpr auto _fmtstr_G = FMT_COMPILE("G{} {}\n");
     CALI_MARK_BEGIN("G");
     for (size_t i = 0; i < G.size(); ++i) {
-        if (G[i].size() == 0) continue;
+        if (G.size(i) == 0) continue;
         ostr.print(
-            fmt::format(_fmtstr_G, i, G[i].size()));  // << "G" << i << " " << G[i].size() << '\n';
-        for (auto it = G[i].begin(); it != G[i].end(); ++it) {
+            fmt::format(_fmtstr_G, i, G.size(i)));  // << "G" << i << " " << G.size(i) << '\n';
+        for (auto it = G.begin(i); it != G.end(i); ++it) {
             ostr.print(fmt::format(_fmtstr_2vals, it->first,
                                    it->second));  // << it->first << " " << it->second << '\n';
         }
     }
     CALI_MARK_END("G");
 
+    //
+    // "S" section - suffixes
+    //
+    constexpr auto _fmtstr_S = FMT_COMPILE("S{} {} {}\n");
+    for (auto& suffix : suffixes) {
+        ostr.print(fmt::format(_fmtstr_S, suffix.kind, suffix.values.size(), suffix.name));
+        for (auto& it : suffix.values) ostr.print(fmt::format(_fmtstr_2vals, it.first, it.second));
+    }
+
     ostr.close();
 }
 #endif
 
+#ifdef COEK_WITH_COMPACT_MODEL
+namespace {
+
+//
+// Call fn() for each constraint in a compact model.  The constraints in a
+// constraint sequence are generated one at a time.
+//
+void for_each_constraint(CompactModel& model, const std::function<void(Constraint&)>& fn)
+{
+    for (auto& val : model.repn->constraints) {
+        if (auto cval = std::get_if<Constraint>(&val)) {
+            Constraint c = cval->expand();
+            fn(c);
+        }
+        else {
+            auto& seq = std::get<ConstraintSequence>(val);
+            for (auto& jt : seq) fn(jt);
+        }
+    }
+}
+
+//
+// A temporary binary file, which is deleted when it is closed.
+//
+class SpoolFile {
+   public:
+    std::FILE* fp;
+
+    SpoolFile() : fp(std::tmpfile())
+    {
+        if (fp == nullptr) throw std::runtime_error("Cannot create a temporary file");
+    }
+    SpoolFile(const SpoolFile&) = delete;
+    SpoolFile& operator=(const SpoolFile&) = delete;
+    ~SpoolFile() { std::fclose(fp); }
+
+    template <typename T>
+    void write(const T* data, size_t n)
+    {
+        if (std::fwrite(data, sizeof(T), n, fp) != n)
+            throw std::runtime_error("Error writing a temporary file");
+    }
+
+    template <typename T>
+    void read(T* data, size_t n)
+    {
+        if (std::fread(data, sizeof(T), n, fp) != n)
+            throw std::runtime_error("Error reading a temporary file");
+    }
+
+    void rewind() { std::rewind(fp); }
+};
+
+}  // namespace
+
+//
+// Collect the data for the NL header without expanding the model.  Each constraint
+// is generated and discarded in turn, so only the data that is used to order the
+// variables is kept in memory.  Shared subexpressions are not written as defined
+// variables.
+//
+void NLWriter::collect_nl_data(CompactModel& model, std::map<size_t, size_t>& invvarmap)
+{
+    CALI_CXX_MARK_FUNCTION;
+
+    std::vector<Variable> model_vars;
+    for (auto& val : model.repn->variables) {
+        if (auto eval = std::get_if<Variable>(&val)) {
+            Expression lb = eval->lower_expression().expand();
+            eval->lower(lb.value());
+            Expression ub = eval->upper_expression().expand();
+            eval->upper(ub.value());
+            Expression value = eval->value_expression().expand();
+            eval->value(value.value());
+            model_vars.push_back(*eval);
+        }
+        else {
+            auto& seq = std::get<VariableSequence>(val);
+            for (auto& jt : seq) model_vars.push_back(jt);
+        }
+    }
+    {
+        std::vector<size_t> ids(model_vars.size());
+        for (size_t i : coek::indices(model_vars)) ids[i] = model_vars[i].id();
+        declared.initialize(ids);
+    }
+
+    //
+    // The col_count array records the number of constraints that each variable
+    // appears in, which are the Jacobian column counts.
+    //
+    std::vector<unsigned char> flags(model_vars.size(), 0);
+    std::vector<size_t> last_row(model_vars.size(), IdIndex::npos);
+    std::vector<size_t> col_count(model_vars.size(), 0);
+    std::vector<VariableRepn> undeclared;
+    size_t row = 0;
+
+    auto mark_vars = [&](const auto& var_list, unsigned char flag, bool constraint) {
+        size_t nnz = 0;
+        for (auto& var : var_list) {
+            size_t i = declared.find(var->index);
+            if (i == IdIndex::npos) {
+                undeclared.push_back(var);
+                continue;
+            }
+            flags[i] |= VAR_USED | flag;
+            if (last_row[i] != row) {
+                last_row[i] = row;
+                ++nnz;
+                if (constraint) ++col_count[i];
+            }
+        }
+        return nnz;
+    };
+
+    try {
+        CALI_MARK_BEGIN("Prepare Objective Expressions");
+        std::vector<Objective> objectives;
+        for (auto& val : model.repn->objectives) {
+            if (auto eval = std::get_if<Objective>(&val)) {
+                objectives.push_back(
+                    objective().expr(eval->expr().expand()).sense(eval->sense()));
+            }
+            else {
+                auto& seq = std::get<ObjectiveSequence>(val);
+                for (auto& jt : seq) objectives.push_back(jt);
+            }
+        }
+        o_expr.resize(objectives.size());
+        for (auto& obj : objectives) o_sense.push_back(obj.sense());
+        for (size_t i : coek::indices(objectives)) {
+            std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t> simplified_subexpressions;
+            auto& expr = o_expr[i];
+            to_MutableNLPExpr(simplify_expr(objectives[i].repn, simplified_subexpressions),
+                              expr);
+            if ((expr.quadratic_coefs.size() > 0) or (not expr.nonlinear->is_constant()))
+                ++nonl_objectives;
+
+            nnz_gradient += mark_vars(expr.linear_vars, VAR_LINEAR, false);
+            nnz_gradient += mark_vars(expr.quadratic_lvars, VAR_NONLINEAR_OBJ, false);
+            nnz_gradient += mark_vars(expr.quadratic_rvars, VAR_NONLINEAR_OBJ, false);
+            nnz_gradient += mark_vars(expr.nonlinear_vars, VAR_NONLINEAR_OBJ, false);
+            ++row;
+        }
+        CALI_MARK_END("Prepare Objective Expressions");
+
+        CALI_MARK_BEGIN("Prepare Constraint Expressions");
+        for_each_constraint(model, [&](Constraint& con) {
+            std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t> simplified_subexpressions;
+            MutableNLPExpr expr;
+            to_MutableNLPExpr(simplify_expr(con.repn, simplified_subexpressions), expr);
+
+            double val[2];
+            count_constraint(constraint_type(con, expr.constval->eval(), val));
+            if ((expr.quadratic_coefs.size() > 0) or (not expr.nonlinear->is_constant()))
+                ++nonl_constraints;
+
+            nnz_Jacobian += mark_vars(expr.linear_vars, VAR_LINEAR, true);
+            nnz_Jacobian += mark_vars(expr.quadratic_lvars, VAR_NONLINEAR_CON, true);
+            nnz_Jacobian += mark_vars(expr.quadratic_rvars, VAR_NONLINEAR_CON, true);
+            nnz_Jacobian += mark_vars(expr.nonlinear_vars, VAR_NONLINEAR_CON, true);
+            ++row;
+            ++num_constraints;
+        });
+        CALI_MARK_END("Prepare Constraint Expressions");
+
+        check_that_expression_variables_are_declared(declared, undeclared);
+    }
+    catch (std::exception& e) {
+        throw std::runtime_error(std::string("Error writing NL file: ") + e.what());
+    }
+
+    order_variables(model_vars, flags, {}, nl_index, invvarmap);
+
+    k_count.assign(vars.size(), 0);
+    for (size_t i : coek::indices(nl_index))
+        if (nl_index[i] != IdIndex::npos) k_count[nl_index[i]] = col_count[i];
+    collect_linear_rows(o_expr, declared, nl_index, vars.size(), G, nullptr);
+}
+
+//
+// Write the NL file while the constraints are generated.  The constraint segments are
+// written directly, and the constraint bounds and Jacobian rows are spooled to
+// temporary files until their sections are written.
+//
+void NLWriter::write_ostream(CompactModel& model, const std::string& fname,
+                             std::map<size_t, size_t>& invconmap)
+{
+    std::ofstream ostr(fname);
+    check_open(ostr, fname);
+    SpoolFile rfile;
+    SpoolFile jfile;
+
+    try {
+        write_header(ostr, false);
+
+        //
+        // "C" section - nonlinear constraint segments
+        //
+        std::vector<size_t> slot(vars.size(), IdIndex::npos);
+        SparseRows row;
+        size_t ctr = 0;
+        for_each_constraint(model, [&](Constraint& con) {
+            if (ctr == num_constraints)
+                throw std::runtime_error("The constraints changed while the model was written");
+            std::map<std::shared_ptr<SubExpressionTerm>, expr_pointer_t> simplified_subexpressions;
+            MutableNLPExpr expr;
+            to_MutableNLPExpr(simplify_expr(con.repn, simplified_subexpressions), expr);
+            invconmap[ctr] = con.id();
+
+            ostr << "C" << ctr << '\n';
+            if ((not expr.nonlinear->is_constant()) or (expr.quadratic_coefs.size() > 0))
+                print_expr(ostr, expr, varmap);
+            else
+                ostr << "n0\n";
+
+            double val[2] = {0, 0};
+            int type = constraint_type(con, expr.constval->eval(), val);
+            rfile.write(&type, 1);
+            rfile.write(val, 2);
+
+            add_linear_row(expr, declared, nl_index, slot, row, nullptr);
+            size_t n = row.size(0);
+            jfile.write(&n, 1);
+            for (auto it = row.begin(0); it != row.end(0); ++it) {
+                jfile.write(&it->first, 1);
+                jfile.write(&it->second, 1);
+            }
+            row.entries.clear();
+            row.start.resize(1);
+            ++ctr;
+        });
+        if (ctr != num_constraints)
+            throw std::runtime_error("The constraints changed while the model was written");
+
+        write_objective_segments(ostr);
+        write_primal_values(ostr);
+
+        //
+        // "r" section - bounds on constraints
+        //
+        if (num_constraints > 0) {
+            ostr << "r\n";
+            rfile.rewind();
+            for (size_t i = 0; i < num_constraints; ++i) {
+                int type;
+                double val[2];
+                rfile.read(&type, 1);
+                rfile.read(val, 2);
+                print_constraint_bounds(ostr, type, val);
+            }
+        }
+
+        write_variable_bounds(ostr);
+        write_column_counts(ostr);
+
+        //
+        // "J" section - Jacobian sparsity, linear terms
+        //
+        jfile.rewind();
+        for (size_t i = 0; i < num_constraints; ++i) {
+            size_t n;
+            jfile.read(&n, 1);
+            row.entries.resize(n);
+            for (auto& entry : row.entries) {
+                jfile.read(&entry.first, 1);
+                jfile.read(&entry.second, 1);
+            }
+            print_linear_row(ostr, 'J', i, row.entries.data(), row.entries.data() + n);
+        }
+
+        write_gradient(ostr);
+    }
+    catch (std::exception& e) {
+        throw std::runtime_error(std::string("Error writing NL file: ") + e.what());
+    }
+
+    check_close(ostr, fname);
+}
+#endif
+
 void write_nl_problem_ostream(Model& model, const std::string& fname,
                               std::map<size_t, size_t>& invvarmap,
                               std::map<size_t, size_t>& invconmap)
@@ -1438,6 +2851,26 @@ void write_nl_problem_ostream(Model& model, const std::string& fname,
     writer.write_ostream(model, fname);
 }
 
+void write_nl_problem_binary(Model& model, const std::string& fname,
+                             std::map<size_t, size_t>& invvarmap,
+                             std::map<size_t, size_t>& invconmap)
+{
+    NLWriter writer;
+    writer.collect_nl_data(model, invvarmap, invconmap);
+    writer.write_binary(model, fname);
+}
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void write_nl_problem_ostream(CompactModel& model, const std::string& fname,
+                              std::map<size_t, size_t>& invvarmap,
+                              std::map<size_t, size_t>& invconmap)
+{
+    NLWriter writer;
+    writer.collect_nl_data(model, invvarmap);
+    writer.write_ostream(model, fname, invconmap);
+}
+#endif
+
 #ifdef WITH_FMTLIB
 void write_nl_problem_fmtlib(Model& model, const std::string& fname,
                              std::map<size_t, size_t>& invvarmap,
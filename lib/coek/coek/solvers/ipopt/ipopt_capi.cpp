@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <memory>
+#include <string>
 
 #include "IpStdCInterfaceTypes.h"
 #include "coek/api/constraint.hpp"
@@ -8,6 +11,7 @@
 #include "coek/autograd/autograd.hpp"
 #include "coek/model/model_repn.hpp"
 #include "coek/solvers/loadlib.h"
+#include "coek/util/parallel.hpp"
 #include "coek/util/sequence.hpp"
 #include "ipopt_solver.hpp"
 
@@ -20,7 +24,7 @@ static AddIpoptStrOption_func_t AddIpoptStrOption_func_ptr = 0;
 static AddIpoptNumOption_func_t AddIpoptNumOption_func_ptr = 0;
 static AddIpoptIntOption_func_t AddIpoptIntOption_func_ptr = 0;
 /* OpenIpoptOutputFile_func_t OpenIpoptOutputFile_func_ptr=0; */
-/* SetIpoptProblemScaling_func_t SetIpoptProblemScaling_func_ptr=0; */
+static SetIpoptProblemScaling_func_t SetIpoptProblemScaling_func_ptr = 0;
 static SetIntermediateCallback_func_t SetIntermediateCallback_func_ptr = 0;
 static IpoptSolve_func_t IpoptSolve_func_ptr = 0;
 }
@@ -47,8 +51,9 @@ int load_ipopt_library(const char* libname, std::string& error_message)
     AddIpoptIntOption_func_ptr
         = (AddIpoptIntOption_func_t)getsym(ipopt_handle, "AddIpoptIntOption", buf, 256);
     // OpenIpoptOutputFile_func_ptr = (OpenIpoptOutputFile_func_t)getsym(ipopt_handle,
-    // "OpenIpoptOutputFile", buf, 256); SetIpoptProblemScaling_func_ptr =
-    // (SetIpoptProblemScaling_func_t)getsym(ipopt_handle, "SetIpoptProblemScaling", buf, 256);
+    // "OpenIpoptOutputFile", buf, 256);
+    SetIpoptProblemScaling_func_ptr
+        = (SetIpoptProblemScaling_func_t)getsym(ipopt_handle, "SetIpoptProblemScaling", buf, 256);
     SetIntermediateCallback_func_ptr
         = (SetIntermediateCallback_func_t)getsym(ipopt_handle, "SetIntermediateCallback", buf, 256);
     IpoptSolve_func_ptr = (IpoptSolve_func_t)getsym(ipopt_handle, "IpoptSolve", buf, 256);
@@ -71,11 +76,32 @@ class IpoptModel {
     std::vector<Number> last_zU;
     std::vector<Number> last_lambda;
 
-    std::vector<double> tmp_grad;
-    std::vector<double> tmp_g;
-    std::vector<double> tmp_j;
-    std::vector<double> tmp_h;
-    std::vector<double> tmp_hw;
+    // Objective weights in the Hessian of the Lagrangian
+    std::vector<double> obj_weights;
+
+    // Problem data that is cached across resolves.  The IpoptProblem is only
+    // recreated when the bounds change, and the structure is only recomputed when
+    // the NLP model structure changes.
+    Index nx;
+    Index nc;
+    Index nnz_jac;
+    Index nnz_hes;
+    size_t structure_version;
+    std::vector<Index> jac_irow;
+    std::vector<Index> jac_jcol;
+    std::vector<Index> hes_irow;
+    std::vector<Index> hes_jcol;
+    std::vector<Number> x_L;
+    std::vector<Number> x_U;
+    std::vector<Number> g_L;
+    std::vector<Number> g_U;
+
+    // Scaling factors from the scaling_factor suffixes of the COEK model.  Ipopt
+    // uses these if the model has any scaling factors.
+    bool user_scaling;
+    Number obj_scaling;
+    std::vector<Number> x_scaling;
+    std::vector<Number> g_scaling;
 
     // default constructor
     IpoptModel(NLPModel& _nlpmodel)
@@ -83,6 +109,10 @@ class IpoptModel {
         app = 0;
         nlpmodel = _nlpmodel;
         objsign = 1.0;
+        nx = nc = nnz_jac = nnz_hes = 0;
+        structure_version = 0;
+        user_scaling = false;
+        obj_scaling = 1.0;
     }
 
     // default destructor
@@ -94,12 +124,24 @@ class IpoptModel {
     // initialize using the COEK model
     void build();
 
+    // refresh the bounds after the COEK model is reset, and rebuild the problem
+    // if its structure has changed
+    void update();
+
+    // create the IpoptProblem object using the cached problem data
+    void create_problem();
+
     // Method to return some info about the nlp
     bool get_nlp_info(Index& n, Index& m, Index& nnz_jac_g, Index& nnz_h_lag, int& index_style);
 
     // Method to return the bounds for my problem
     bool get_bounds_info(Index n, Number* x_l, Number* x_u, Index m, Number* g_l, Number* g_u);
 
+    // Method to return the scaling factors for my problem.  Returns true if the
+    // problem has scaling factors.
+    bool get_scaling_info(Number& obj_scale, std::vector<Number>& x_scale,
+                          std::vector<Number>& g_scale);
+
     /*
         // Method to return the starting point for the algorithm
         bool get_starting_point(Index n, bool init_x, Number* x,
@@ -132,6 +174,9 @@ class IpoptModel {
 
     int perform_solve();
 
+    // Solve from the starting point x0 without updating the COEK model variables
+    int solve_from(const std::vector<Number>& x0);
+
    private:
     // This method should not be used.
     IpoptModel(const IpoptModel&) {}
@@ -187,8 +232,8 @@ bool IpoptModel::get_bounds_info(Index /*n*/, Number* x_l, Number* x_u, Index /*
     }
 
     // std::cout << "  num constraints: " << nlpmodel.num_constraints() << std::endl;
-    for (size_t j = 0; j < nlpmodel.repn->model.repn->constraints.size(); j++) {
-        auto& con = nlpmodel.repn->model.repn->constraints[j];
+    for (size_t j = 0; j < nlpmodel.num_constraints(); j++) {
+        auto con = nlpmodel.get_constraint(j);
         if (con.is_inequality()) {
             if (con.has_lower())
                 g_l[j] = con.lower().value();
@@ -209,6 +254,42 @@ bool IpoptModel::get_bounds_info(Index /*n*/, Number* x_l, Number* x_u, Index /*
     return true;
 }
 
+bool IpoptModel::get_scaling_info(Number& obj_scale, std::vector<Number>& x_scale,
+                                  std::vector<Number>& g_scale)
+{
+    auto& mrepn = *nlpmodel.repn->model.repn;
+    const std::string name = "scaling_factor";
+
+    obj_scale = 1.0;
+    x_scale.assign(nlpmodel.num_variables(), 1.0);
+    g_scale.assign(nlpmodel.num_constraints(), 1.0);
+
+    auto scale = [&](const auto& suffix, size_t id, Number& value) {
+        auto it = suffix.find(static_cast<unsigned int>(id));
+        if (it != suffix.end()) value = it->second;
+    };
+
+    bool found = false;
+    auto oit = mrepn.osuffix.find(name);
+    if ((oit != mrepn.osuffix.end()) and (nlpmodel.num_objectives() > 0)) {
+        scale(oit->second, nlpmodel.get_objective(0).id(), obj_scale);
+        found = true;
+    }
+    auto vit = mrepn.vsuffix.find(name);
+    if (vit != mrepn.vsuffix.end()) {
+        for (size_t i = 0; i < x_scale.size(); i++)
+            scale(vit->second, nlpmodel.get_variable(i).id(), x_scale[i]);
+        found = true;
+    }
+    auto cit = mrepn.csuffix.find(name);
+    if (cit != mrepn.csuffix.end()) {
+        for (size_t j = 0; j < g_scale.size(); j++)
+            scale(cit->second, nlpmodel.get_constraint(j).id(), g_scale[j]);
+        found = true;
+    }
+    return found;
+}
+
 bool IpoptModel::eval_f(Index n, const Number* x, bool new_x, Number& obj_value)
 {
     // std::cout << "EVAL F " << std::endl << std::flush;
@@ -247,11 +328,9 @@ bool IpoptModel::eval_grad_f(Index n, const Number* x, bool new_x, Number* grad_
     // std::cout << "Compute DF - START" << std::endl << std::flush;
     //  return the gradient of the objective function grad_{x} f(x)
     double f;
-    nlpmodel.compute_df(f, tmp_grad, 0);
-    size_t i = 0;
-    for (double val : tmp_grad) {
-        // std::cout << "DF " << i << " " << objsign << " " << val << std::endl;
-        grad_f[i++] = objsign * val;
+    nlpmodel.compute_df(f, grad_f, 0);
+    if (objsign != 1.0) {
+        for (Index i = 0; i < n; i++) grad_f[i] *= objsign;
     }
 
     // std::cout << "EVAL DF - END" << std::endl << std::flush;
@@ -268,42 +347,30 @@ bool IpoptModel::eval_g(Index n, const Number* x, bool new_x, Index /*m*/, Numbe
 
     // std::cout << "Compute G - START" << std::endl << std::flush;
     //  return the value of the constraints: g(x)
-    nlpmodel.compute_c(tmp_g);
-    size_t i = 0;
-    for (double val : tmp_g) g[i++] = val;
+    nlpmodel.compute_c(g);
 
     // std::cout << "EVAL G - END" << std::endl << std::flush;
     return true;
 }
 
-bool IpoptModel::eval_jac_g(Index n, const Number* x, bool new_x, Index /*m*/, Index nele_jac,
-                            Index* jRow, Index* jCol, Number* values)
+bool IpoptModel::eval_jac_g(Index n, const Number* x, bool new_x, Index /*m*/,
+                            Index /*nele_jac*/, Index* jRow, Index* jCol, Number* values)
 {
     // std::cout << "EVAL J " << std::endl << std::flush;
     if (values == NULL) {
         // Return the structure of the Jacobian of the constraints
-        std::vector<size_t> jrow;
-        std::vector<size_t> jcol;
-        nlpmodel.get_J_nonzeros(jrow, jcol);
-        for (size_t i = 0; i < jrow.size(); i++) {
-            jRow[i] = static_cast<Index>(jrow[i]) + 1;
-            jCol[i] = static_cast<Index>(jcol[i]) + 1;
-        }
-        // std::cout << "Get Structure " << std::endl << std::flush;
-        // std::cout << jrow << std::endl;
-        // std::cout << jcol << std::endl;
+        std::copy(jac_irow.begin(), jac_irow.end(), jRow);
+        std::copy(jac_jcol.begin(), jac_jcol.end(), jCol);
     }
 
     else {
-        assert(static_cast<size_t>(nele_jac) == tmp_j.size());
         // std::cout << "Do Eval - START" << std::endl << std::flush;
         // std::cout << "nele_jac " << nele_jac << std::endl << std::flush;
         //  Return the values of the Jacobian of the constraints
         if (new_x) {
             nlpmodel.set_variable_view(x, static_cast<size_t>(n));
         }
-        nlpmodel.compute_J(tmp_j);
-        for (size_t i = 0; i < tmp_j.size(); i++) values[i] = tmp_j[i];
+        nlpmodel.compute_J(values);
         // std::cout << "Do Eval - END" << std::endl << std::flush;
     }
 
@@ -318,14 +385,8 @@ bool IpoptModel::eval_h(Index n, const Number* x, bool new_x, Number obj_factor,
     if (values == NULL) {
         // Return the structure. This is a symmetric matrix, fill the lower left
         // triangle only.
-        std::vector<size_t> hrow;
-        std::vector<size_t> hcol;
-        nlpmodel.get_H_nonzeros(hrow, hcol);
-        for (size_t i = 0; i < hrow.size(); i++) {
-            hRow[i] = static_cast<Index>(hrow[i]) + 1;
-            hCol[i] = static_cast<Index>(hcol[i]) + 1;
-            // std::cout << "H " << hRow[i] << " " << hCol[i] << std::endl;
-        }
+        std::copy(hes_irow.begin(), hes_irow.end(), hRow);
+        std::copy(hes_jcol.begin(), hes_jcol.end(), hCol);
     }
 
     else {
@@ -333,18 +394,12 @@ bool IpoptModel::eval_h(Index n, const Number* x, bool new_x, Number obj_factor,
         if (new_x) {
             nlpmodel.set_variable_view(x, static_cast<size_t>(n));
         }
-        size_t nf = nlpmodel.num_objectives();
-        size_t nc = nlpmodel.num_constraints();
         // TODO - handle multiple objectives
-        for (size_t i = 0; i < nf; i++) tmp_hw[i] = obj_factor;
-        for (size_t i = 0; i < nc; i++) tmp_hw[i + nf] = lambda[i];
-        nlpmodel.compute_H(tmp_hw, tmp_h);
-        for (size_t i = 0; i < tmp_h.size(); i++) values[i] = tmp_h[i];
+        //
+        // Ipopt minimizes objsign*f(x), so the objective weight includes objsign
+        std::fill(obj_weights.begin(), obj_weights.end(), objsign * obj_factor);
+        nlpmodel.compute_H(obj_weights.data(), lambda, values);
 
-#if 0
-        for (size_t i = 0; i < tmp_h.size(); i++)
-            std::cout << "H " << i << " " << values[i] << std::endl;
-#endif
     }
 
     return true;
@@ -370,8 +425,10 @@ int IpoptModel::perform_solve()
             const auto& v = nlpmodel.get_variable(i);
             last_x[i] = v.value();
         }
-        status = (*IpoptSolve_func_ptr)(app, array_ptr(last_x), array_ptr(last_g), &last_objval, 0,
-                                        0, 0, this);
+        // The final multipliers are stored, so they can be used to warm start a resolve
+        status = (*IpoptSolve_func_ptr)(app, array_ptr(last_x), array_ptr(last_g), &last_objval,
+                                        array_ptr(last_lambda), array_ptr(last_zL),
+                                        array_ptr(last_zU), this);
     }
 
     if ((status == Solve_Succeeded) || (status == Solved_To_Acceptable_Level)) {
@@ -400,6 +457,15 @@ int IpoptModel::perform_solve()
     return (int)status;
 }
 
+int IpoptModel::solve_from(const std::vector<Number>& x0)
+{
+    last_x = x0;
+    last_iter_count = 0;
+    enum ApplicationReturnStatus status = (*IpoptSolve_func_ptr)(
+        app, array_ptr(last_x), array_ptr(last_g), &last_objval, 0, 0, 0, this);
+    return (int)status;
+}
+
 }  // namespace coek
 
 extern "C" {
@@ -459,39 +525,116 @@ namespace coek {
 
 void IpoptModel::build()
 {
-    Index n;
-    Index m;
-    Index nnz_jac_g;
-    Index nnz_h_lag;
     int index_style;
-    get_nlp_info(n, m, nnz_jac_g, nnz_h_lag, index_style);
-    size_t n_ = static_cast<size_t>(n);
-    size_t m_ = static_cast<size_t>(m);
+    get_nlp_info(nx, nc, nnz_jac, nnz_hes, index_style);
+    size_t n_ = static_cast<size_t>(nx);
+    size_t m_ = static_cast<size_t>(nc);
+    structure_version = nlpmodel.repn->structure_version;
 
     start_from_last_x = false;
 
     last_x.resize(n_);
+    for (size_t i = 0; i < n_; i++) last_x[i] = nlpmodel.get_variable(i).value();
     last_g.resize(m_);
-    last_zL.resize(n_);
-    last_zU.resize(n_);
-    last_lambda.resize(m_);
-    tmp_grad.resize(n_);
-    tmp_g.resize(m_);
-    tmp_j.resize(static_cast<size_t>(nnz_jac_g));
-    tmp_h.resize(static_cast<size_t>(nnz_h_lag));
-    tmp_hw.resize(nlpmodel.num_objectives() + m_);
-
-    std::vector<Number> x_L(n_);
-    std::vector<Number> x_U(n_);
-    std::vector<Number> g_L(m_);
-    std::vector<Number> g_U(m_);
-    get_bounds_info(n, array_ptr(x_L), array_ptr(x_U), m, array_ptr(g_L), array_ptr(g_U));
+    last_zL.assign(n_, 0.0);
+    last_zU.assign(n_, 0.0);
+    last_lambda.assign(m_, 0.0);
+    obj_weights.resize(nlpmodel.num_objectives());
+
+    //
+    // Cache the Jacobian and Hessian structure, using FORTRAN-style indexing
+    //
+    std::vector<size_t> row;
+    std::vector<size_t> col;
+    nlpmodel.get_J_nonzeros(row, col);
+    jac_irow.resize(row.size());
+    jac_jcol.resize(col.size());
+    for (size_t i = 0; i < row.size(); i++) {
+        jac_irow[i] = static_cast<Index>(row[i]) + 1;
+        jac_jcol[i] = static_cast<Index>(col[i]) + 1;
+    }
+    nlpmodel.get_H_nonzeros(row, col);
+    hes_irow.resize(row.size());
+    hes_jcol.resize(col.size());
+    for (size_t i = 0; i < row.size(); i++) {
+        hes_irow[i] = static_cast<Index>(row[i]) + 1;
+        hes_jcol[i] = static_cast<Index>(col[i]) + 1;
+    }
+
+    x_L.resize(n_);
+    x_U.resize(n_);
+    g_L.resize(m_);
+    g_U.resize(m_);
+    get_bounds_info(nx, array_ptr(x_L), array_ptr(x_U), nc, array_ptr(g_L), array_ptr(g_U));
+    user_scaling = get_scaling_info(obj_scaling, x_scaling, g_scaling);
 
+    create_problem();
+}
+
+void IpoptModel::update()
+{
+    if (nlpmodel.repn->structure_version != structure_version) {
+        //
+        // The structure of the NLP model has changed, so the cached problem data
+        // and the warm-start values cannot be reused.
+        //
+        build();
+        return;
+    }
+
+    //
+    // Only the bounds and scaling factors need to be refreshed.  The Ipopt C interface
+    // copies these when the problem is created, so the problem is recreated if they
+    // have changed.
+    //
+    size_t n_ = static_cast<size_t>(nx);
+    size_t m_ = static_cast<size_t>(nc);
+    std::vector<Number> new_x_L(n_);
+    std::vector<Number> new_x_U(n_);
+    std::vector<Number> new_g_L(m_);
+    std::vector<Number> new_g_U(m_);
+    get_bounds_info(nx, array_ptr(new_x_L), array_ptr(new_x_U), nc, array_ptr(new_g_L),
+                    array_ptr(new_g_U));
+    objsign = nlpmodel.get_objective(0).sense() ? 1.0 : -1.0;
+    Number new_obj_scaling;
+    std::vector<Number> new_x_scaling;
+    std::vector<Number> new_g_scaling;
+    bool new_user_scaling = get_scaling_info(new_obj_scaling, new_x_scaling, new_g_scaling);
+
+    if ((new_x_L != x_L) or (new_x_U != x_U) or (new_g_L != g_L) or (new_g_U != g_U)
+        or (new_user_scaling != user_scaling) or (new_obj_scaling != obj_scaling)
+        or (new_x_scaling != x_scaling) or (new_g_scaling != g_scaling)) {
+        x_L.swap(new_x_L);
+        x_U.swap(new_x_U);
+        g_L.swap(new_g_L);
+        g_U.swap(new_g_U);
+        user_scaling = new_user_scaling;
+        obj_scaling = new_obj_scaling;
+        x_scaling.swap(new_x_scaling);
+        g_scaling.swap(new_g_scaling);
+        create_problem();
+    }
+}
+
+void IpoptModel::create_problem()
+{
+    if (app) (*FreeIpoptProblem_func_ptr)(app);
+
+    // The cached structure uses FORTRAN-style indexing
     app = (*CreateIpoptProblem_func_ptr)(
-        n, array_ptr(x_L), array_ptr(x_U), m, array_ptr(g_L), array_ptr(g_U), nnz_jac_g, nnz_h_lag,
-        index_style, &ipopt_capi_eval_f, &ipopt_capi_eval_g, &ipopt_capi_eval_grad_f,
-        &ipopt_capi_eval_jac_g, &ipopt_capi_eval_h);
+        nx, array_ptr(x_L), array_ptr(x_U), nc, array_ptr(g_L), array_ptr(g_U), nnz_jac, nnz_hes,
+        1, &ipopt_capi_eval_f, &ipopt_capi_eval_g, &ipopt_capi_eval_grad_f, &ipopt_capi_eval_jac_g,
+        &ipopt_capi_eval_h);
     (*SetIntermediateCallback_func_ptr)(app, &ipopt_capi_intermediate_cb);
+
+    if (user_scaling and SetIpoptProblemScaling_func_ptr) {
+        (*SetIpoptProblemScaling_func_ptr)(app, obj_scaling, array_ptr(x_scaling),
+                                           array_ptr(g_scaling));
+        // Ipopt ignores these scaling factors unless this option is set.  Options
+        // that are set by the user are added after this, so they take precedence.
+        (*AddIpoptStrOption_func_ptr)(app, const_cast<char*>("nlp_scaling_method"),
+                                      const_cast<char*>("user-scaling"));
+    }
 }
 
 class IpoptSolverRepn_CAPI : public IpoptSolverRepn {
@@ -502,32 +645,47 @@ class IpoptSolverRepn_CAPI : public IpoptSolverRepn {
 
     int perform_solve() { return nlp->perform_solve(); }
 
+    void update() { nlp->update(); }
+
     void set_start_from_last_x(bool flag) { nlp->start_from_last_x = flag; }
 
+    void get_duals(std::vector<double>& duals) { duals = nlp->last_lambda; }
+
     void set_options(std::map<std::string, std::string>& string_options,
                      std::map<std::string, int>& integer_options,
                      std::map<std::string, double>& double_options);
 };
 
-void IpoptSolverRepn_CAPI::set_options(std::map<std::string, std::string>& string_options,
-                                       std::map<std::string, int>& integer_options,
-                                       std::map<std::string, double>& double_options)
+namespace {
+
+void set_ipopt_options(IpoptProblem app, std::map<std::string, std::string>& string_options,
+                       std::map<std::string, int>& integer_options,
+                       std::map<std::string, double>& double_options)
 {
     for (auto it = string_options.begin(); it != string_options.end(); ++it) {
         char* tmp1 = const_cast<char*>(it->first.c_str());
         char* tmp2 = const_cast<char*>(it->second.c_str());
-        (*AddIpoptStrOption_func_ptr)(nlp->app, tmp1, tmp2);
+        (*AddIpoptStrOption_func_ptr)(app, tmp1, tmp2);
     }
     for (auto it = integer_options.begin(); it != integer_options.end(); ++it) {
         char* tmp1 = const_cast<char*>(it->first.c_str());
-        (*AddIpoptIntOption_func_ptr)(nlp->app, tmp1, it->second);
+        (*AddIpoptIntOption_func_ptr)(app, tmp1, it->second);
     }
     for (auto it = double_options.begin(); it != double_options.end(); ++it) {
         char* tmp1 = const_cast<char*>(it->first.c_str());
-        (*AddIpoptNumOption_func_ptr)(nlp->app, tmp1, it->second);
+        (*AddIpoptNumOption_func_ptr)(app, tmp1, it->second);
     }
 }
 
+}  // namespace
+
+void IpoptSolverRepn_CAPI::set_options(std::map<std::string, std::string>& string_options,
+                                       std::map<std::string, int>& integer_options,
+                                       std::map<std::string, double>& double_options)
+{
+    set_ipopt_options(nlp->app, string_options, integer_options, double_options);
+}
+
 void IpoptSolver::initialize()
 {
 #ifdef _MSC_VER
@@ -553,4 +711,88 @@ void IpoptSolver::load(NLPModel& _nlpmodel)
     repn = std::dynamic_pointer_cast<IpoptSolverRepn>(repn_capi);
 }
 
+NLPSolverMultistartResults IpoptSolver::multistart(NLPModel& _nlpmodel,
+                                                   const std::vector<std::vector<double>>& starts,
+                                                   size_t nthreads)
+{
+    if (not available_)
+        throw std::runtime_error("Cannot perform multi-start solves because the Ipopt library "
+                                 "is not available");
+
+    NLPSolverMultistartResults results;
+    if (starts.size() == 0) return results;
+
+    size_t n = _nlpmodel.num_variables();
+    for (auto& x0 : starts) {
+        if (x0.size() != n)
+            throw std::runtime_error("Multi-start point has " + std::to_string(x0.size())
+                                     + " values but the model has " + std::to_string(n)
+                                     + " variables");
+    }
+
+    if (nthreads == 0) nthreads = default_num_threads();
+    nthreads = std::max(static_cast<size_t>(1), std::min(nthreads, starts.size()));
+    // The starts are solved serially if the AD library cannot evaluate separate
+    // workspaces concurrently
+    if (not _nlpmodel.repn->thread_safe()) nthreads = 1;
+
+    //
+    // Each thread has its own evaluation workspace and Ipopt problem.  These are
+    // created serially, since they query the COEK model.
+    //
+    std::vector<std::shared_ptr<IpoptModel>> workers(nthreads);
+    for (size_t t : coek::range(nthreads)) {
+        NLPModel view = t == 0 ? _nlpmodel : _nlpmodel.clone_workspace();
+        workers[t] = std::make_shared<IpoptModel>(view);
+        workers[t]->build();
+        set_ipopt_options(workers[t]->app, string_options, integer_options, double_options);
+    }
+
+    results.starts.resize(starts.size());
+    _nlpmodel.repn->setup_parallel(nthreads);
+    try {
+        parallel_for(starts.size(), nthreads, [&](size_t i, size_t t) {
+            auto& worker = *workers[t];
+            auto& res = results.starts[i];
+
+            auto start = std::chrono::steady_clock::now();
+            res.x0 = starts[i];
+            res.status = worker.solve_from(starts[i]);
+            std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start;
+
+            res.time = diff.count();
+            res.converged
+                = (res.status == Solve_Succeeded) or (res.status == Solved_To_Acceptable_Level);
+            res.objective = worker.objsign * worker.last_objval;
+            res.iterations = static_cast<size_t>(worker.last_iter_count);
+            res.x = worker.last_x;
+        });
+    }
+    catch (...) {
+        _nlpmodel.repn->setup_parallel(1);
+        throw;
+    }
+    _nlpmodel.repn->setup_parallel(1);
+
+    //
+    // Select the best converged start, and store its solution in the model
+    //
+    double objsign = workers[0]->objsign;
+    for (size_t i : coek::indices(results.starts)) {
+        auto& res = results.starts[i];
+        if (not res.converged) continue;
+        if ((not results.found)
+            or (objsign * res.objective < objsign * results.starts[results.best].objective)) {
+            results.found = true;
+            results.best = i;
+        }
+    }
+    if (results.found) {
+        auto& x = results.starts[results.best].x;
+        for (size_t i : coek::range(n)) _nlpmodel.get_variable(i).value(x[i]);
+    }
+
+    return results;
+}
+
 }  // namespace coek
@@ -26,7 +26,10 @@ int IpoptSolver::resolve()
     auto start = std::chrono::high_resolution_clock::now();
 #endif
 
-    if (not initial_solve()) model->reset();
+    if (not initial_solve()) {
+        model->reset();
+        repn->update();
+    }
 
     repn->set_options(string_options, integer_options, double_options);
     auto it = string_options.find("warm_start_init_point");
@@ -45,4 +48,10 @@ int IpoptSolver::resolve()
     return status;
 }
 
+void IpoptSolver::get_duals(std::vector<double>& duals)
+{
+    if (not repn) throw std::runtime_error("Cannot get the constraint multipliers before a solve");
+    repn->get_duals(duals);
+}
+
 }  // namespace coek
@@ -3,6 +3,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "coek/model/nlp_model.hpp"
 #include "coek/solvers/solver_repn.hpp"
@@ -12,7 +13,9 @@ namespace coek {
 class IpoptSolverRepn {
    public:
     virtual int perform_solve() = 0;
+    virtual void update() = 0;
     virtual void set_start_from_last_x(bool flag) = 0;
+    virtual void get_duals(std::vector<double>& duals) = 0;
     virtual void set_options(std::map<std::string, std::string>& string_options,
                              std::map<std::string, int>& integer_options,
                              std::map<std::string, double>& double_options)
@@ -35,6 +38,12 @@ class IpoptSolver : public NLPSolverRepn {
 
     int solve(NLPModel& model);
 
+    NLPSolverMultistartResults multistart(NLPModel& model,
+                                          const std::vector<std::vector<double>>& starts,
+                                          size_t nthreads);
+
+    void get_duals(std::vector<double>& duals);
+
     bool available() { return available_; }
 };
 
@@ -1,9 +1,16 @@
 #include "coek/solvers/solver.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
 #include "coek/api/constraint.hpp"
 #include "coek/api/expression.hpp"
 #include "coek/api/objective.hpp"
+#include "coek/autograd/autograd.hpp"
 #include "coek/solvers/solver_repn.hpp"
+#include "coek/util/parallel.hpp"
 
 namespace coek {
 
@@ -14,7 +21,10 @@ namespace coek {
 void Solver::initialize(std::string name)
 {
     SolverRepn* tmp = create_solver(name);
-    if (tmp) repn = std::shared_ptr<SolverRepn>(tmp);
+    if (tmp) {
+        tmp->name = name;
+        repn = std::shared_ptr<SolverRepn>(tmp);
+    }
 }
 
 bool Solver::available() const { return repn.get(); }
@@ -23,6 +33,76 @@ int Solver::solve(Model& model) { return repn->solve(model); }
 
 void Solver::load(Model& model) { repn->load(model); }
 
+int Solver::solve(Presolve& presolve)
+{
+    if (presolve.infeasible()) {
+        repn->error_occurred = true;
+        repn->error_code = -1;
+        repn->error_message = "Presolve found that the model is infeasible";
+        return -1;
+    }
+    int status = repn->solve(presolve.reduced_model());
+    presolve.postsolve();
+    return status;
+}
+
+namespace {
+
+void copy_options(const SolverCache& from, SolverCache& to)
+{
+    to.string_options = from.string_options;
+    to.integer_options = from.integer_options;
+    to.double_options = from.double_options;
+}
+
+// Records an error if a constraint without free variables is violated
+bool decomposition_infeasible(const Decomposition& decomp, SolverCache& repn)
+{
+    if (not decomp.infeasible()) return false;
+    repn.error_occurred = true;
+    repn.error_code = -1;
+    repn.error_message = "The decomposed model has an infeasible constraint without free variables";
+    return true;
+}
+
+// Records the first block that failed, and returns its status
+int block_status(const std::vector<int>& status, const std::vector<std::string>& messages,
+                 SolverCache& repn)
+{
+    for (size_t b = 0; b < status.size(); b++) {
+        if (status[b] == 0) continue;
+        repn.error_occurred = true;
+        repn.error_code = status[b];
+        repn.error_message = "Error solving block " + std::to_string(b) + ": " + messages[b];
+        return status[b];
+    }
+    return 0;
+}
+
+}  // namespace
+
+int Solver::solve(Decomposition& decomp, size_t nthreads)
+{
+    if (decomposition_infeasible(decomp, *repn)) return -1;
+    size_t n = decomp.num_blocks();
+
+    // Loading a model queries the COEK expressions, so the block solvers are loaded serially
+    std::vector<std::shared_ptr<SolverRepn>> solvers(n);
+    for (size_t b = 0; b < n; b++) {
+        solvers[b] = std::shared_ptr<SolverRepn>(create_solver(repn->name));
+        copy_options(*repn, *solvers[b]);
+        solvers[b]->load(decomp.block(b));
+    }
+
+    std::vector<int> status(n);
+    std::vector<std::string> messages(n);
+    parallel_for(n, nthreads, [&](size_t b, size_t) {
+        status[b] = solvers[b]->resolve();
+        messages[b] = solvers[b]->error_message;
+    });
+    return block_status(status, messages, *repn);
+}
+
 #ifdef COEK_WITH_COMPACT_MODEL
 int Solver::solve(CompactModel& model) { return repn->solve(model); }
 
@@ -88,6 +168,7 @@ void Solver::set_option(int option, const std::string value) { repn->set_option(
 void NLPSolver::initialize(std::string name)
 {
     std::shared_ptr<NLPSolverRepn> tmp(create_nlpsolver(name));
+    if (tmp) tmp->name = name;
     repn = tmp;
 }
 
@@ -95,12 +176,80 @@ bool NLPSolver::available() const { return repn.get() && repn->available(); }
 
 int NLPSolver::solve(NLPModel& model) { return repn->solve(model); }
 
+int NLPSolver::solve(Decomposition& decomp, const std::string& ad_type, size_t nthreads)
+{
+    if (decomposition_infeasible(decomp, *repn)) return -1;
+    size_t n = decomp.num_blocks();
+    if (n == 0) return 0;
+    if (nthreads == 0) nthreads = default_num_threads();
+    nthreads = std::min(nthreads, n);
+
+    // The NLP models and block solvers query the COEK expressions, so they are created serially
+    std::vector<NLPModel> models(n);
+    std::vector<std::shared_ptr<NLPSolverRepn>> solvers(n);
+    for (size_t b = 0; b < n; b++) {
+        models[b].initialize(decomp.block(b), ad_type);
+        solvers[b] = std::shared_ptr<NLPSolverRepn>(create_nlpsolver(repn->name));
+        copy_options(*repn, *solvers[b]);
+        solvers[b]->load(models[b]);
+    }
+
+    std::vector<int> status(n);
+    std::vector<std::string> messages(n);
+    models[0].repn->setup_parallel(nthreads);
+    try {
+        parallel_for(n, nthreads, [&](size_t b, size_t) {
+            status[b] = solvers[b]->resolve();
+            messages[b] = solvers[b]->error_message;
+        });
+    }
+    catch (...) {
+        models[0].repn->setup_parallel(1);
+        throw;
+    }
+    models[0].repn->setup_parallel(1);
+    return block_status(status, messages, *repn);
+}
+
 void NLPSolver::load(NLPModel& model) { repn->load(model); }
 
 int NLPSolver::resolve() { return repn->resolve(); }
 
 void NLPSolver::reset() { repn->reset(); }
 
+void NLPSolver::get_duals(std::vector<double>& duals) { repn->get_duals(duals); }
+
+NLPSolverMultistartResults NLPSolver::multistart(NLPModel& model,
+                                                 const std::vector<std::vector<double>>& starts,
+                                                 size_t nthreads)
+{
+    return repn->multistart(model, starts, nthreads);
+}
+
+NLPSolverMultistartResults NLPSolver::multistart(NLPModel& model, size_t nstarts, size_t nthreads,
+                                                 unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    size_t n = model.num_variables();
+    std::vector<double> lb(n);
+    std::vector<double> ub(n);
+    for (size_t i = 0; i < n; i++) {
+        auto v = model.get_variable(i);
+        double value = v.value();
+        double width = 10 * std::max(1.0, std::fabs(value));
+        lb[i] = v.lower() > -COEK_INFINITY ? v.lower() : std::min(value, v.upper()) - width;
+        ub[i] = v.upper() < COEK_INFINITY ? v.upper() : std::max(value, lb[i]) + width;
+    }
+
+    std::vector<std::vector<double>> starts(nstarts, std::vector<double>(n));
+    for (auto& x0 : starts)
+        for (size_t i = 0; i < n; i++) x0[i] = lb[i] + uniform(rng) * (ub[i] - lb[i]);
+
+    return repn->multistart(model, starts, nthreads);
+}
+
 bool NLPSolver::error_status() const
 {
     if (not repn.get()) return true;
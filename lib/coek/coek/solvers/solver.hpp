@@ -1,8 +1,10 @@
 #pragma once
 
 #include <coek/model/compact_model.hpp>
+#include <coek/model/decomposition.hpp>
 #include <coek/model/model.hpp>
 #include <coek/model/nlp_model.hpp>
+#include <coek/model/presolve.hpp>
 
 namespace coek {
 
@@ -36,6 +38,24 @@ class Solver {
     int solve(Model& model);
     /** Load a model */
     void load(Model& model);
+    /** Optimize the reduced model created by presolve, and map the solution to
+     * the original model using Presolve::postsolve()
+     *
+     * \returns an error code that is nonzero if an error occurs or if presolve
+     * found that the model is infeasible */
+    int solve(Presolve& presolve);
+    /** Optimize the blocks of a decomposed model concurrently
+     *
+     * A solver with the same name and options is created for each block.  The
+     * blocks are loaded serially, and then they are optimized concurrently.  The
+     * solution of each block is stored in the variables of the original model.
+     *
+     * \param decomp  the decomposed model
+     * \param nthreads  the number of threads (0 uses the number of hardware threads)
+     *
+     * \returns an error code that is nonzero if an error occurs in any block, or if
+     * a constraint without free variables is infeasible */
+    int solve(Decomposition& decomp, size_t nthreads = 0);
 
 #ifdef COEK_WITH_COMPACT_MODEL
     int solve(CompactModel& model);
@@ -163,6 +183,40 @@ class Solver {
     void set_option(int option, const std::string value);
 };
 
+/**
+ * The outcome of one start in a multi-start solve.
+ */
+class NLPSolverStart {
+   public:
+    /** The solver status code */
+    int status = 0;
+    /** \c true if the solver converged */
+    bool converged = false;
+    /** The final objective value */
+    double objective = 0.0;
+    /** The number of solver iterations */
+    size_t iterations = 0;
+    /** The wall-clock solve time (seconds) */
+    double time = 0.0;
+    /** The starting point, in the variable order of the coek::NLPModel */
+    std::vector<double> x0;
+    /** The final point, in the variable order of the coek::NLPModel */
+    std::vector<double> x;
+};
+
+/**
+ * The results of a multi-start solve.
+ */
+class NLPSolverMultistartResults {
+   public:
+    /** \c true if at least one start converged */
+    bool found = false;
+    /** The index of the best converged start (valid if \c found is \c true) */
+    size_t best = 0;
+    /** The outcome of each start */
+    std::vector<NLPSolverStart> starts;
+};
+
 /**
  * An optimization solver object that is initialized using the optimizer string name.
  *
@@ -188,6 +242,20 @@ class NLPSolver {
      *
      * \returns an error code that is nonzero if an error occurs */
     int solve(NLPModel& model);
+    /** Optimize the blocks of a decomposed model concurrently
+     *
+     * A coek::NLPModel and a solver with the same name and options are created
+     * for each block.  These are created serially, and then the blocks are
+     * optimized concurrently.  The solution of each block is stored in the
+     * variables of the original model.
+     *
+     * \param decomp  the decomposed model
+     * \param ad_type  the automatic differentiation type used for the NLP models
+     * \param nthreads  the number of threads (0 uses the number of hardware threads)
+     *
+     * \returns an error code that is nonzero if an error occurs in any block, or if
+     * a constraint without free variables is infeasible */
+    int solve(Decomposition& decomp, const std::string& ad_type, size_t nthreads = 0);
 
     /** Load a model */
     void load(NLPModel& model);
@@ -197,6 +265,46 @@ class NLPSolver {
     int resolve();
     /** Resets the state of the optimizer */
     void reset();
+    /** Get the constraint multipliers from the last optimization
+     *
+     * \param duals  the multipliers, in the constraint order of the coek::NLPModel
+     */
+    void get_duals(std::vector<double>& duals);
+
+    /** Optimize the specified model from several starting points
+     *
+     * The starts are solved concurrently by a pool of worker threads.  Each
+     * thread evaluates a copy of the model's evaluation workspace, so the model's
+     * sparsity structure is computed only once.  With the CppAD backend, each copy
+     * has its own copy of the CppAD tape.  The model variables are set to the best
+     * converged solution.
+     * The starts are solved serially with the ASL backend, unless the ASL library is
+     * built with MULTIPLE_THREADS.
+     *
+     * \param model  the NLP model
+     * \param starts  the starting points, in the variable order of the model
+     * \param nthreads  the number of threads (0 uses the number of hardware threads)
+     *
+     * \returns the solution and solver statistics for each start
+     */
+    NLPSolverMultistartResults multistart(NLPModel& model,
+                                          const std::vector<std::vector<double>>& starts,
+                                          size_t nthreads = 0);
+    /** Optimize the specified model from randomly sampled starting points
+     *
+     * Starting values are sampled uniformly within the variable bounds.  If a bound
+     * is infinite, then values are sampled within 10*max(1,|v|) of the current
+     * variable value v.
+     *
+     * \param model  the NLP model
+     * \param nstarts  the number of starting points
+     * \param nthreads  the number of threads (0 uses the number of hardware threads)
+     * \param seed  the random number seed
+     *
+     * \returns the solution and solver statistics for each start
+     */
+    NLPSolverMultistartResults multistart(NLPModel& model, size_t nstarts, size_t nthreads = 0,
+                                          unsigned int seed = 0);
 
     /** Returns \c true if an error occurred */
     bool error_status() const;
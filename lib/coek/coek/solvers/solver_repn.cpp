@@ -67,6 +67,18 @@ SolverRepn* create_solver(std::string& name)
     return 0;
 }
 
+NLPSolverMultistartResults NLPSolverRepn::multistart(NLPModel& /*model*/,
+                                                     const std::vector<std::vector<double>>& /*starts*/,
+                                                     size_t /*nthreads*/)
+{
+    throw std::runtime_error("Solver does not support multi-start solves");
+}
+
+void NLPSolverRepn::get_duals(std::vector<double>& /*duals*/)
+{
+    throw std::runtime_error("Solver does not provide constraint multipliers");
+}
+
 NLPSolverRepn* create_nlpsolver(std::string& name)
 {
     if (name == "ipopt") {
@@ -11,6 +11,7 @@
 #include "coek/api/expression_visitor.hpp"
 #include "coek/model/model.hpp"
 #include "coek/model/compact_model.hpp"
+#include "coek/solvers/solver.hpp"
 
 namespace coek {
 
@@ -28,6 +29,8 @@ class SolverCache {
     std::map<std::string, int> integer_options;
     std::map<std::string, double> double_options;
 
+    // The name used to create the solver
+    std::string name;
     //
     double tolerance;
     // Error flag
@@ -126,6 +129,12 @@ class NLPSolverRepn : public SolverCache {
 
     virtual int solve(NLPModel& model) = 0;
 
+    virtual NLPSolverMultistartResults multistart(NLPModel& model,
+                                                  const std::vector<std::vector<double>>& starts,
+                                                  size_t nthreads);
+
+    virtual void get_duals(std::vector<double>& duals);
+
     virtual bool initial_solve()
     {
         if (initial) {
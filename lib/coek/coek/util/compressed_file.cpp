@@ -0,0 +1,498 @@
+#include "coek/util/compressed_file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef WITH_ZLIB
+#    include <zlib.h>
+#endif
+#ifdef WITH_ZSTD
+#    include <zstd.h>
+#endif
+
+namespace coek {
+
+namespace {
+
+bool ends_with(const std::string& str, const std::string& suffix)
+{
+    return (str.size() >= suffix.size())
+           and (str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+constexpr size_t io_buffer_size = 1 << 18;
+
+void write_data(std::FILE* fp, const char* data, size_t n)
+{
+    if (std::fwrite(data, 1, n, fp) != n) throw std::runtime_error("Error writing file");
+}
+
+//
+// Compressors write compressed data to a file
+//
+class Compressor {
+   public:
+    std::FILE* fp;
+    std::vector<char> out;
+
+    explicit Compressor(std::FILE* _fp) : fp(_fp), out(io_buffer_size) {}
+    virtual ~Compressor() {}
+
+    virtual void compress(const char* data, size_t n) = 0;
+    virtual void finish() = 0;
+};
+
+#ifdef WITH_ZLIB
+//
+// Text files compress well with the fastest gzip setting, which keeps the
+// compression thread from limiting the writers.
+//
+class GzipCompressor : public Compressor {
+   public:
+    z_stream strm;
+
+    explicit GzipCompressor(std::FILE* _fp) : Compressor(_fp)
+    {
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        // A window size of 15+16 adds a gzip header and trailer
+        if (deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::runtime_error("Error initializing gzip compression");
+    }
+
+    ~GzipCompressor() { deflateEnd(&strm); }
+
+    void deflate_data(int flush)
+    {
+        int ret;
+        do {
+            strm.next_out = reinterpret_cast<Bytef*>(out.data());
+            strm.avail_out = static_cast<uInt>(out.size());
+            ret = deflate(&strm, flush);
+            if (ret == Z_STREAM_ERROR) throw std::runtime_error("Error compressing data");
+            write_data(fp, out.data(), out.size() - strm.avail_out);
+        } while ((strm.avail_out == 0) or ((flush == Z_FINISH) and (ret != Z_STREAM_END)));
+    }
+
+    void compress(const char* data, size_t n)
+    {
+        while (n > 0) {
+            size_t len = std::min(n, io_buffer_size);
+            strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            strm.avail_in = static_cast<uInt>(len);
+            deflate_data(Z_NO_FLUSH);
+            data += len;
+            n -= len;
+        }
+    }
+
+    void finish()
+    {
+        strm.next_in = Z_NULL;
+        strm.avail_in = 0;
+        deflate_data(Z_FINISH);
+    }
+};
+#endif
+
+#ifdef WITH_ZSTD
+class ZstdCompressor : public Compressor {
+   public:
+    ZSTD_CCtx* cctx;
+
+    explicit ZstdCompressor(std::FILE* _fp) : Compressor(_fp)
+    {
+        cctx = ZSTD_createCCtx();
+        if (cctx == nullptr) throw std::runtime_error("Error initializing zstd compression");
+    }
+
+    ~ZstdCompressor() { ZSTD_freeCCtx(cctx); }
+
+    size_t compress_data(ZSTD_inBuffer& in, ZSTD_EndDirective mode)
+    {
+        ZSTD_outBuffer output = {out.data(), out.size(), 0};
+        size_t ret = ZSTD_compressStream2(cctx, &output, &in, mode);
+        if (ZSTD_isError(ret))
+            throw std::runtime_error(std::string("Error compressing data: ")
+                                     + ZSTD_getErrorName(ret));
+        write_data(fp, out.data(), output.pos);
+        return ret;
+    }
+
+    void compress(const char* data, size_t n)
+    {
+        ZSTD_inBuffer in = {data, n, 0};
+        while (in.pos < in.size) compress_data(in, ZSTD_e_continue);
+    }
+
+    void finish()
+    {
+        ZSTD_inBuffer in = {nullptr, 0, 0};
+        while (compress_data(in, ZSTD_e_end) != 0)
+            ;
+    }
+};
+#endif
+
+//
+// Decompressors read compressed data from a file
+//
+class Decompressor {
+   public:
+    std::FILE* fp;
+    std::vector<char> in;
+    bool eof = false;
+
+    explicit Decompressor(std::FILE* _fp) : fp(_fp), in(io_buffer_size) {}
+    virtual ~Decompressor() {}
+
+    size_t fill()
+    {
+        size_t n = std::fread(in.data(), 1, in.size(), fp);
+        if (n < in.size()) {
+            if (std::ferror(fp)) throw std::runtime_error("Error reading file");
+            eof = true;
+        }
+        return n;
+    }
+
+    virtual size_t read(char* data, size_t n) = 0;
+};
+
+#ifdef WITH_ZLIB
+class GzipDecompressor : public Decompressor {
+   public:
+    z_stream strm;
+    bool done = false;
+
+    explicit GzipDecompressor(std::FILE* _fp) : Decompressor(_fp)
+    {
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        strm.next_in = Z_NULL;
+        strm.avail_in = 0;
+        if (inflateInit2(&strm, 15 + 16) != Z_OK)
+            throw std::runtime_error("Error initializing gzip decompression");
+    }
+
+    ~GzipDecompressor() { inflateEnd(&strm); }
+
+    size_t read(char* data, size_t n)
+    {
+        strm.next_out = reinterpret_cast<Bytef*>(data);
+        strm.avail_out = static_cast<uInt>(std::min(n, io_buffer_size));
+        size_t len = strm.avail_out;
+
+        while ((strm.avail_out == len) and not done) {
+            if ((strm.avail_in == 0) and not eof) {
+                strm.next_in = reinterpret_cast<Bytef*>(in.data());
+                strm.avail_in = static_cast<uInt>(fill());
+            }
+            int ret = inflate(&strm, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                // Concatenated gzip files are read as a single file
+                if ((strm.avail_in > 0) or not eof)
+                    inflateReset(&strm);
+                else
+                    done = true;
+            }
+            else if (ret == Z_BUF_ERROR) {
+                if ((strm.avail_in == 0) and eof)
+                    throw std::runtime_error("Unexpected end of compressed file");
+            }
+            else if (ret != Z_OK)
+                throw std::runtime_error("Error decompressing gzip data");
+        }
+        return len - strm.avail_out;
+    }
+};
+#endif
+
+#ifdef WITH_ZSTD
+class ZstdDecompressor : public Decompressor {
+   public:
+    ZSTD_DCtx* dctx;
+    ZSTD_inBuffer input = {nullptr, 0, 0};
+    // The value returned by the last call to ZSTD_decompressStream
+    size_t last = 0;
+
+    explicit ZstdDecompressor(std::FILE* _fp) : Decompressor(_fp)
+    {
+        dctx = ZSTD_createDCtx();
+        if (dctx == nullptr) throw std::runtime_error("Error initializing zstd decompression");
+        input.src = in.data();
+    }
+
+    ~ZstdDecompressor() { ZSTD_freeDCtx(dctx); }
+
+    size_t read(char* data, size_t n)
+    {
+        ZSTD_outBuffer output = {data, n, 0};
+        while (output.pos == 0) {
+            if ((input.pos == input.size) and not eof) {
+                input.size = fill();
+                input.pos = 0;
+            }
+            bool exhausted = (input.pos == input.size) and eof;
+            if (exhausted and (last == 0)) break;
+            last = ZSTD_decompressStream(dctx, &output, &input);
+            if (ZSTD_isError(last))
+                throw std::runtime_error(std::string("Error decompressing zstd data: ")
+                                         + ZSTD_getErrorName(last));
+            if (exhausted and (output.pos == 0))
+                throw std::runtime_error("Unexpected end of compressed file");
+        }
+        return output.pos;
+    }
+};
+#endif
+
+std::string compression_name(Compression compression)
+{
+    return compression == Compression::gzip ? "gzip" : "zstd";
+}
+
+}  // namespace
+
+Compression compression_from_suffix(const std::string& fname, std::string& base)
+{
+    if (ends_with(fname, ".gz")) {
+        base = fname.substr(0, fname.size() - 3);
+        return Compression::gzip;
+    }
+    if (ends_with(fname, ".zst")) {
+        base = fname.substr(0, fname.size() - 4);
+        return Compression::zstd;
+    }
+    base = fname;
+    return Compression::none;
+}
+
+bool compression_available(Compression compression)
+{
+    switch (compression) {
+        case Compression::none:
+            return true;
+        case Compression::gzip:
+#ifdef WITH_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::zstd:
+#ifdef WITH_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+//
+// OutputFile
+//
+
+//
+// Compressed data is written by a worker thread.  Each block is compressed by a new
+// worker, which is started after the worker for the previous block has finished.
+//
+class OutputFileRepn {
+   public:
+    std::string fname;
+    std::FILE* fp = nullptr;
+    std::unique_ptr<Compressor> compressor;
+
+    // The block that is being compressed
+    std::string block;
+    std::thread worker;
+    std::exception_ptr error;
+
+    OutputFileRepn(const std::string& _fname) : fname(_fname) {}
+
+    ~OutputFileRepn()
+    {
+        if (worker.joinable()) worker.join();
+        compressor.reset();
+        if (fp) std::fclose(fp);
+    }
+
+    void wait()
+    {
+        if (worker.joinable()) worker.join();
+        if (error) std::rethrow_exception(error);
+    }
+
+    void push(std::string& data)
+    {
+        if (not compressor) {
+            write_data(fp, data.data(), data.size());
+            data.clear();
+            return;
+        }
+
+        wait();
+        std::swap(block, data);
+        data.clear();
+        worker = std::thread([this]() {
+            try {
+                compressor->compress(block.data(), block.size());
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        });
+    }
+
+    void close()
+    {
+        try {
+            if (compressor) {
+                wait();
+                compressor->finish();
+            }
+        }
+        catch (...) {
+            std::fclose(fp);
+            fp = nullptr;
+            throw;
+        }
+        int status = std::fclose(fp);
+        fp = nullptr;
+        if (status != 0) throw std::runtime_error("Error closing file: " + fname);
+    }
+};
+
+OutputFile::OutputFile(const std::string& fname)
+{
+    std::string base;
+    auto compression = compression_from_suffix(fname, base);
+    if (not compression_available(compression))
+        throw std::runtime_error("Cannot write " + fname + ": coek was built without "
+                                 + compression_name(compression) + " support");
+
+    repn = std::make_unique<OutputFileRepn>(fname);
+    repn->fp = std::fopen(fname.c_str(), "wb");
+    if (not repn->fp) throw std::runtime_error("Cannot open file: " + fname);
+
+#ifdef WITH_ZLIB
+    if (compression == Compression::gzip)
+        repn->compressor = std::make_unique<GzipCompressor>(repn->fp);
+#endif
+#ifdef WITH_ZSTD
+    if (compression == Compression::zstd)
+        repn->compressor = std::make_unique<ZstdCompressor>(repn->fp);
+#endif
+
+    buf.reserve(block_size + block_size / 4);
+}
+
+OutputFile::~OutputFile()
+{
+    try {
+        close();
+    }
+    catch (...) {
+    }
+}
+
+void OutputFile::flush()
+{
+    if (buf.size() > 0) repn->push(buf);
+}
+
+void OutputFile::write(const char* data, size_t n)
+{
+    buf.append(data, n);
+    if (buf.size() >= block_size) flush();
+}
+
+void OutputFile::close()
+{
+    if (not repn->fp) return;
+    try {
+        flush();
+    }
+    catch (...) {
+        repn->close();
+        throw;
+    }
+    repn->close();
+}
+
+//
+// InputFile
+//
+
+class InputFileRepn {
+   public:
+    std::FILE* fp = nullptr;
+    std::unique_ptr<Decompressor> decompressor;
+    // Data that was read to check for compression
+    char header[4];
+    size_t header_size = 0;
+    size_t header_pos = 0;
+
+    ~InputFileRepn()
+    {
+        decompressor.reset();
+        if (fp) std::fclose(fp);
+    }
+};
+
+InputFile::InputFile(const std::string& fname)
+{
+    repn = std::make_unique<InputFileRepn>();
+    repn->fp = std::fopen(fname.c_str(), "rb");
+    if (not repn->fp) throw std::runtime_error("Unknown file: " + fname);
+
+    // Check the magic number at the start of the file
+    auto& header = repn->header;
+    repn->header_size = std::fread(header, 1, sizeof(header), repn->fp);
+    Compression compression = Compression::none;
+    if ((repn->header_size >= 2) and (header[0] == '\x1f') and (header[1] == '\x8b'))
+        compression = Compression::gzip;
+    else if ((repn->header_size == 4) and (header[0] == '\x28') and (header[1] == '\xb5')
+             and (header[2] == '\x2f') and (header[3] == '\xfd'))
+        compression = Compression::zstd;
+    if (compression == Compression::none) return;
+
+    if (not compression_available(compression))
+        throw std::runtime_error("Cannot read " + fname + ": coek was built without "
+                                 + compression_name(compression) + " support");
+    std::rewind(repn->fp);
+    repn->header_size = 0;
+#ifdef WITH_ZLIB
+    if (compression == Compression::gzip)
+        repn->decompressor = std::make_unique<GzipDecompressor>(repn->fp);
+#endif
+#ifdef WITH_ZSTD
+    if (compression == Compression::zstd)
+        repn->decompressor = std::make_unique<ZstdDecompressor>(repn->fp);
+#endif
+}
+
+InputFile::~InputFile() {}
+
+size_t InputFile::read(char* data, size_t n)
+{
+    if (n == 0) return 0;
+    if (repn->decompressor) return repn->decompressor->read(data, n);
+
+    if (repn->header_pos < repn->header_size) {
+        size_t len = std::min(n, repn->header_size - repn->header_pos);
+        std::copy(repn->header + repn->header_pos, repn->header + repn->header_pos + len, data);
+        repn->header_pos += len;
+        return len;
+    }
+    size_t len = std::fread(data, 1, n, repn->fp);
+    if ((len == 0) and std::ferror(repn->fp)) throw std::runtime_error("Error reading file");
+    return len;
+}
+
+}  // namespace coek
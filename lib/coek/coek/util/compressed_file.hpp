@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#ifdef WITH_FMTLIB
+#    include <fmt/core.h>
+#endif
+
+namespace coek {
+
+/** The compression formats supported for model files */
+enum class Compression { none, gzip, zstd };
+
+/**
+ * Get the compression format that is indicated by the suffix of a file name.
+ *
+ * Files that end with ".gz" are compressed with gzip, and files that end with
+ * ".zst" are compressed with zstd.
+ *
+ * \param fname  the file name
+ * \param base  the file name without the compression suffix
+ *
+ * \returns the compression format
+ */
+Compression compression_from_suffix(const std::string& fname, std::string& base);
+
+/** \returns \c true if coek was built with support for the given compression format */
+bool compression_available(Compression compression);
+
+class OutputFileRepn;
+class InputFileRepn;
+
+/**
+ * A buffered output file, which is compressed if its name ends with ".gz" or ".zst".
+ *
+ * Compressed data is written in a background thread, so a block of data is
+ * compressed and written while the next block is being formatted.
+ */
+class OutputFile {
+   public:
+    /** The size of the blocks that are passed to the background thread */
+    static constexpr size_t block_size = 1 << 20;
+
+   protected:
+    std::string buf;
+    std::unique_ptr<OutputFileRepn> repn;
+
+    void flush();
+
+   public:
+    /**
+     * Open a file for writing.
+     *
+     * \param fname  the file name
+     */
+    explicit OutputFile(const std::string& fname);
+    ~OutputFile();
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    /** Write n bytes of data */
+    void write(const char* data, size_t n);
+
+#ifdef WITH_FMTLIB
+    /** Print formatted data, using the same conventions as fmt::ostream::print() */
+    template <typename... T>
+    void print(fmt::format_string<T...> fmt, T&&... args)
+    {
+        fmt::format_to(std::back_inserter(buf), fmt, std::forward<T>(args)...);
+        if (buf.size() >= block_size) flush();
+    }
+#endif
+
+    /** Write all buffered data and close the file */
+    void close();
+};
+
+/**
+ * A file reader that decompresses files that are compressed with gzip or zstd.
+ *
+ * Compressed files are recognized by their contents rather than their names.
+ */
+class InputFile {
+   protected:
+    std::unique_ptr<InputFileRepn> repn;
+
+   public:
+    /**
+     * Open a file for reading.
+     *
+     * \param fname  the file name
+     */
+    explicit InputFile(const std::string& fname);
+    ~InputFile();
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    /**
+     * Read data from the file.
+     *
+     * \param data  the buffer that is filled
+     * \param n  the size of the buffer
+     *
+     * \returns the number of bytes read, which is zero at the end of the file
+     */
+    size_t read(char* data, size_t n);
+};
+
+}  // namespace coek
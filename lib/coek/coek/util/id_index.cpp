@@ -0,0 +1,39 @@
+#include "coek/util/id_index.hpp"
+
+#include <algorithm>
+
+namespace coek {
+
+void IdIndex::initialize(const std::vector<size_t>& ids)
+{
+    min_id = 0;
+    dense.clear();
+    sorted.clear();
+    if (ids.size() == 0) return;
+
+    auto [lo, hi] = std::minmax_element(ids.begin(), ids.end());
+    size_t span = *hi - *lo + 1;
+
+    if (span <= 4 * ids.size() + 1024) {
+        min_id = *lo;
+        dense.assign(span, npos);
+        for (size_t i = ids.size(); i-- > 0;) dense[ids[i] - min_id] = i;
+    }
+    else {
+        sorted.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) sorted[i] = {ids[i], i};
+        std::sort(sorted.begin(), sorted.end());
+        auto last = std::unique(sorted.begin(), sorted.end(),
+                                [](const auto& a, const auto& b) { return a.first == b.first; });
+        sorted.erase(last, sorted.end());
+    }
+}
+
+size_t IdIndex::find_sorted(size_t id) const
+{
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(id, size_t(0)));
+    if ((it == sorted.end()) or (it->first != id)) return npos;
+    return it->second;
+}
+
+}  // namespace coek
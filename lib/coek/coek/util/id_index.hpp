@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace coek {
+
+/**
+ * A map from unique ids to their positions in a list.
+ *
+ * The ids are stored in a dense array when they span a compact range, which
+ * is the common case for the variables in a model.  Otherwise, the ids are
+ * stored in a sorted vector that is searched with a binary search.
+ */
+class IdIndex {
+   public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+   protected:
+    size_t min_id = 0;
+    std::vector<size_t> dense;
+    std::vector<std::pair<size_t, size_t>> sorted;
+
+   public:
+    IdIndex() {}
+
+    /**
+     * Index a list of ids.
+     *
+     * If an id is repeated, then its first position is used.
+     *
+     * \param ids  the list of ids
+     */
+    void initialize(const std::vector<size_t>& ids);
+
+    /** \returns the position of the given id, or \c npos if it is not in the index */
+    size_t find(size_t id) const
+    {
+        if (sorted.size() == 0) {
+            size_t i = id - min_id;
+            return (id >= min_id) and (i < dense.size()) ? dense[i] : npos;
+        }
+        return find_sorted(id);
+    }
+
+   protected:
+    size_t find_sorted(size_t id) const;
+};
+
+}  // namespace coek
@@ -0,0 +1,239 @@
+#include "interval.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace coek {
+
+namespace {
+
+const double inf = std::numeric_limits<double>::infinity();
+const double pi = 3.14159265358979323846;
+
+// Multiplication where 0 * inf is 0
+double mult(double a, double b) { return ((a == 0) or (b == 0)) ? 0 : a * b; }
+
+// The interval [f(lb), f(ub)] for a nondecreasing function f
+template <typename FN>
+Interval increasing(const Interval& a, FN fn)
+{
+    if (a.empty()) return a;
+    return Interval(fn(a.lb), fn(a.ub));
+}
+
+// The interval [f(ub), f(lb)] for a nonincreasing function f
+template <typename FN>
+Interval decreasing(const Interval& a, FN fn)
+{
+    if (a.empty()) return a;
+    return Interval(fn(a.ub), fn(a.lb));
+}
+
+// The range of a function that is nonincreasing for x<=0 and nondecreasing for x>=0
+template <typename FN>
+Interval even(const Interval& a, FN fn)
+{
+    if (a.empty()) return a;
+    if (a.lb >= 0) return Interval(fn(a.lb), fn(a.ub));
+    if (a.ub <= 0) return Interval(fn(a.ub), fn(a.lb));
+    return Interval(fn(0.0), std::max(fn(a.lb), fn(a.ub)));
+}
+
+bool is_integer(double value) { return (std::floor(value) == value) and (std::fabs(value) < 1e15); }
+
+Interval integer_pow(const Interval& a, double n)
+{
+    if (n < 0) return Interval(1.0) / integer_pow(a, -n);
+    auto fn = [n](double x) { return std::pow(x, n); };
+    if (std::fmod(n, 2.0) == 0) return even(a, fn);
+    return increasing(a, fn);
+}
+
+}  // namespace
+
+bool Interval::bounded() const { return std::isfinite(lb) and std::isfinite(ub); }
+
+Interval intersect(const Interval& a, const Interval& b)
+{
+    return Interval(std::max(a.lb, b.lb), std::min(a.ub, b.ub));
+}
+
+Interval hull(const Interval& a, const Interval& b)
+{
+    if (a.empty()) return b;
+    if (b.empty()) return a;
+    return Interval(std::min(a.lb, b.lb), std::max(a.ub, b.ub));
+}
+
+Interval operator-(const Interval& a)
+{
+    if (a.empty()) return a;
+    return Interval(-a.ub, -a.lb);
+}
+
+Interval operator+(const Interval& a, const Interval& b)
+{
+    if (a.empty() or b.empty()) return Interval::empty_interval();
+    return Interval(a.lb + b.lb, a.ub + b.ub);
+}
+
+Interval operator-(const Interval& a, const Interval& b) { return a + (-b); }
+
+Interval operator*(const Interval& a, const Interval& b)
+{
+    if (a.empty() or b.empty()) return Interval::empty_interval();
+    double v1 = mult(a.lb, b.lb);
+    double v2 = mult(a.lb, b.ub);
+    double v3 = mult(a.ub, b.lb);
+    double v4 = mult(a.ub, b.ub);
+    return Interval(std::min({v1, v2, v3, v4}), std::max({v1, v2, v3, v4}));
+}
+
+Interval operator/(const Interval& a, const Interval& b)
+{
+    if (a.empty() or b.empty()) return Interval::empty_interval();
+    if ((b.lb > 0) or (b.ub < 0)) return a * Interval(1 / b.ub, 1 / b.lb);
+    if ((b.lb == 0) and (b.ub == 0)) return Interval::empty_interval();
+    if (b.lb == 0) return a * Interval(1 / b.ub, inf);
+    if (b.ub == 0) return a * Interval(-inf, 1 / b.lb);
+    return Interval();
+}
+
+Interval abs(const Interval& a)
+{
+    return even(a, [](double x) { return std::fabs(x); });
+}
+
+Interval ceil(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::ceil(x); });
+}
+
+Interval floor(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::floor(x); });
+}
+
+Interval exp(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::exp(x); });
+}
+
+Interval log(const Interval& a)
+{
+    return increasing(intersect(a, Interval(0, inf)), [](double x) { return std::log(x); });
+}
+
+Interval log10(const Interval& a)
+{
+    return increasing(intersect(a, Interval(0, inf)), [](double x) { return std::log10(x); });
+}
+
+Interval sqrt(const Interval& a)
+{
+    return increasing(intersect(a, Interval(0, inf)), [](double x) { return std::sqrt(x); });
+}
+
+Interval sin(const Interval& a)
+{
+    if (a.empty()) return a;
+    if (not a.bounded() or (a.ub - a.lb >= 2 * pi)) return Interval(-1, 1);
+
+    double lo = std::min(std::sin(a.lb), std::sin(a.ub));
+    double hi = std::max(std::sin(a.lb), std::sin(a.ub));
+    // The maximum is at pi/2 + 2*k*pi, and the minimum is at -pi/2 + 2*k*pi
+    double k = std::ceil((a.lb - pi / 2) / (2 * pi));
+    if (pi / 2 + 2 * k * pi <= a.ub) hi = 1;
+    k = std::ceil((a.lb + pi / 2) / (2 * pi));
+    if (-pi / 2 + 2 * k * pi <= a.ub) lo = -1;
+    return Interval(lo, hi);
+}
+
+Interval cos(const Interval& a) { return sin(a + Interval(pi / 2)); }
+
+Interval tan(const Interval& a)
+{
+    if (a.empty()) return a;
+    if (not a.bounded() or (a.ub - a.lb >= pi)) return Interval();
+    // Poles are at pi/2 + k*pi
+    double k = std::ceil((a.lb - pi / 2) / pi);
+    if (pi / 2 + k * pi <= a.ub) return Interval();
+    return Interval(std::tan(a.lb), std::tan(a.ub));
+}
+
+Interval sinh(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::sinh(x); });
+}
+
+Interval cosh(const Interval& a)
+{
+    return even(a, [](double x) { return std::cosh(x); });
+}
+
+Interval tanh(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::tanh(x); });
+}
+
+Interval asin(const Interval& a)
+{
+    return increasing(intersect(a, Interval(-1, 1)), [](double x) { return std::asin(x); });
+}
+
+Interval acos(const Interval& a)
+{
+    return decreasing(intersect(a, Interval(-1, 1)), [](double x) { return std::acos(x); });
+}
+
+Interval atan(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::atan(x); });
+}
+
+Interval asinh(const Interval& a)
+{
+    return increasing(a, [](double x) { return std::asinh(x); });
+}
+
+Interval acosh(const Interval& a)
+{
+    return increasing(intersect(a, Interval(1, inf)), [](double x) { return std::acosh(x); });
+}
+
+Interval atanh(const Interval& a)
+{
+    return increasing(intersect(a, Interval(-1, 1)), [](double x) { return std::atanh(x); });
+}
+
+Interval pow(const Interval& a, const Interval& b)
+{
+    if (a.empty() or b.empty()) return Interval::empty_interval();
+
+    if (b.lb == b.ub) {
+        double n = b.lb;
+        if (n == 0) return Interval(1.0);
+        if (is_integer(n)) return integer_pow(a, n);
+
+        // Non-integer powers are defined for nonnegative values
+        auto fn = [n](double x) { return std::pow(x, n); };
+        auto tmp = intersect(a, Interval(0, inf));
+        return n > 0 ? increasing(tmp, fn) : decreasing(tmp, fn);
+    }
+
+    // a^b = exp(b * log(a)) for positive values of a
+    auto tmp = intersect(a, Interval(0, inf));
+    if (tmp.empty()) return tmp;
+    return exp(b * log(tmp));
+}
+
+std::ostream& operator<<(std::ostream& ostr, const Interval& a)
+{
+    if (a.empty())
+        ostr << "[]";
+    else
+        ostr << "[" << a.lb << ", " << a.ub << "]";
+    return ostr;
+}
+
+}  // namespace coek
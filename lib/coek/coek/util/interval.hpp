@@ -0,0 +1,88 @@
+#pragma once
+
+#include <iostream>
+#include <limits>
+
+namespace coek {
+
+/**
+ * A closed interval of real values.
+ *
+ * Unbounded intervals use infinite values, and an interval is empty if its lower
+ * bound is greater than its upper bound.  The interval functions return the
+ * range of a function over the part of an interval that is in the function
+ * domain.  Bounds are not rounded outward.
+ */
+class Interval {
+   public:
+    double lb;
+    double ub;
+
+   public:
+    /** Creates the interval (-inf, inf) */
+    Interval()
+        : lb(-std::numeric_limits<double>::infinity()),
+          ub(std::numeric_limits<double>::infinity())
+    {
+    }
+    /** Creates the interval [value, value] */
+    explicit Interval(double value) : lb(value), ub(value) {}
+    /** Creates the interval [lb, ub] */
+    Interval(double _lb, double _ub) : lb(_lb), ub(_ub) {}
+
+    /** \returns an empty interval */
+    static Interval empty_interval()
+    {
+        return Interval(std::numeric_limits<double>::infinity(),
+                        -std::numeric_limits<double>::infinity());
+    }
+
+    /** \returns \c true if the interval is empty */
+    bool empty() const { return not(lb <= ub); }
+    /** \returns \c true if the interval contains the value */
+    bool contains(double value) const { return (lb <= value) and (value <= ub); }
+    /** \returns \c true if the interval is bounded */
+    bool bounded() const;
+
+    bool operator==(const Interval& other) const
+    {
+        return (empty() and other.empty()) or ((lb == other.lb) and (ub == other.ub));
+    }
+    bool operator!=(const Interval& other) const { return not(*this == other); }
+};
+
+/** \returns the intersection of two intervals */
+Interval intersect(const Interval& a, const Interval& b);
+/** \returns the smallest interval containing two intervals */
+Interval hull(const Interval& a, const Interval& b);
+
+Interval operator-(const Interval& a);
+Interval operator+(const Interval& a, const Interval& b);
+Interval operator-(const Interval& a, const Interval& b);
+Interval operator*(const Interval& a, const Interval& b);
+Interval operator/(const Interval& a, const Interval& b);
+
+Interval abs(const Interval& a);
+Interval ceil(const Interval& a);
+Interval floor(const Interval& a);
+Interval exp(const Interval& a);
+Interval log(const Interval& a);
+Interval log10(const Interval& a);
+Interval sqrt(const Interval& a);
+Interval sin(const Interval& a);
+Interval cos(const Interval& a);
+Interval tan(const Interval& a);
+Interval sinh(const Interval& a);
+Interval cosh(const Interval& a);
+Interval tanh(const Interval& a);
+Interval asin(const Interval& a);
+Interval acos(const Interval& a);
+Interval atan(const Interval& a);
+Interval asinh(const Interval& a);
+Interval acosh(const Interval& a);
+Interval atanh(const Interval& a);
+Interval pow(const Interval& a, const Interval& b);
+
+std::ostream& operator<<(std::ostream& ostr, const Interval& a);
+
+}  // namespace coek
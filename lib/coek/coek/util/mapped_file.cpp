@@ -0,0 +1,72 @@
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define COEK_WITH_MMAP
+#endif
+
+#include "compressed_file.hpp"
+#include "mapped_file.hpp"
+
+namespace coek {
+
+MappedFile::MappedFile(const std::string& fname)
+{
+#ifdef COEK_WITH_MMAP
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Unknown file: " + fname);
+    struct stat st;
+    void* tmp = MAP_FAILED;
+    if ((fstat(fd, &st) == 0) and (st.st_size > 0)) {
+        map_size = static_cast<size_t>(st.st_size);
+        tmp = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (tmp != MAP_FAILED) {
+        data = static_cast<const char*>(tmp);
+        size = map_size;
+        // Files compressed with gzip or zstd are decompressed into a buffer
+        bool gzip = (size >= 2) and (static_cast<unsigned char>(data[0]) == 0x1f)
+                    and (static_cast<unsigned char>(data[1]) == 0x8b);
+        bool zstd = (size >= 4) and (static_cast<unsigned char>(data[0]) == 0x28)
+                    and (static_cast<unsigned char>(data[1]) == 0xb5)
+                    and (static_cast<unsigned char>(data[2]) == 0x2f)
+                    and (static_cast<unsigned char>(data[3]) == 0xfd);
+        if (not(gzip or zstd)) {
+            map = tmp;
+            madvise(map, map_size, MADV_SEQUENTIAL);
+            return;
+        }
+        munmap(tmp, map_size);
+    }
+#endif
+    read_file(fname);
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef COEK_WITH_MMAP
+    if (map) munmap(map, map_size);
+#endif
+}
+
+void MappedFile::read_file(const std::string& fname)
+{
+    InputFile file(fname);
+    const size_t chunk = 1 << 20;
+    size_t n = 0;
+    while (true) {
+        buf.resize(n + chunk);
+        size_t nread = file.read(buf.data() + n, chunk);
+        if (nread == 0) break;
+        n += nread;
+    }
+    buf.resize(n);
+    data = buf.data();
+    size = n;
+}
+
+}  // namespace coek
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace coek {
+
+/**
+ * The read-only contents of a file.
+ *
+ * Uncompressed files are memory-mapped when the platform supports it.  Files
+ * compressed with gzip or zstd, and files that cannot be mapped, are read into
+ * a buffer.
+ */
+class MappedFile {
+   public:
+    /** The file contents */
+    const char* data = nullptr;
+    /** The number of bytes in the file */
+    size_t size = 0;
+
+   protected:
+    std::vector<char> buf;
+    void* map = nullptr;
+    size_t map_size = 0;
+
+    void read_file(const std::string& fname);
+
+   public:
+    /**
+     * Open a file for reading.
+     *
+     * \param fname  the file name
+     */
+    explicit MappedFile(const std::string& fname);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** \returns \c true if the file contents are memory-mapped */
+    bool mapped() const { return map != nullptr; }
+};
+
+}  // namespace coek
@@ -0,0 +1,174 @@
+#include "coek/util/parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace coek {
+
+namespace {
+
+thread_local size_t local_thread_index = 0;
+// The number of parallel_for() calls that the calling thread is executing within
+thread_local size_t parallel_depth = 0;
+
+//
+// Set the thread index and enter a parallel region, and restore the previous
+// state when the scope is exited.
+//
+class ParallelScope {
+   public:
+    size_t index;
+
+    explicit ParallelScope(size_t t) : index(local_thread_index)
+    {
+        local_thread_index = t;
+        parallel_depth++;
+    }
+
+    ~ParallelScope()
+    {
+        local_thread_index = index;
+        parallel_depth--;
+    }
+};
+
+//
+// A pool of worker threads that are reused by parallel_for().
+//
+// The workers are created when they are first needed, and they wait for jobs
+// until the program exits.  Worker t executes job(t) for t in [1, nthreads), and
+// the calling thread executes job(0).  One job is executed at a time, so if the
+// pool is busy then the calling thread executes job(0) by itself.
+//
+class ThreadPool {
+   public:
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        start_cv.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    void run(size_t nthreads, const std::function<void(size_t)>& _job)
+    {
+        std::unique_lock<std::mutex> run_lock(run_mutex, std::try_to_lock);
+        if (not run_lock.owns_lock()) {
+            _job(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (workers.size() + 1 < nthreads)
+                workers.emplace_back(&ThreadPool::work, this, workers.size() + 1, generation);
+            job = &_job;
+            active = nthreads;
+            remaining = nthreads - 1;
+            generation++;
+        }
+        start_cv.notify_all();
+
+        _job(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [this] { return remaining == 0; });
+        job = nullptr;
+    }
+
+   protected:
+    // Held while a job is executed
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    std::vector<std::thread> workers;
+    const std::function<void(size_t)>* job = nullptr;
+    // The number of threads used by the current job, including the calling thread
+    size_t active = 0;
+    // The number of workers that have not finished the current job
+    size_t remaining = 0;
+    // Incremented when a job is submitted
+    size_t generation = 0;
+    bool stop = false;
+
+    void work(size_t t, size_t last)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            start_cv.wait(lock, [&] { return stop or (generation != last); });
+            if (stop) return;
+            last = generation;
+            if (t >= active) continue;
+
+            lock.unlock();
+            (*job)(t);
+            lock.lock();
+            if (--remaining == 0) done_cv.notify_one();
+        }
+    }
+};
+
+}  // namespace
+
+size_t default_num_threads()
+{
+    size_t n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+size_t thread_index() { return local_thread_index; }
+
+bool in_parallel() { return parallel_depth > 0; }
+
+void parallel_for(size_t n, size_t nthreads, const std::function<void(size_t, size_t)>& fn)
+{
+    if (nthreads == 0) nthreads = default_num_threads();
+    nthreads = std::min(nthreads, n);
+
+    if ((nthreads <= 1) or in_parallel()) {
+        // The calling thread is the only thread used by this call
+        ParallelScope scope(0);
+        for (size_t i = 0; i < n; i++) fn(i, 0);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    std::function<void(size_t)> worker = [&](size_t t) {
+        ParallelScope scope(t);
+        while (not failed.load()) {
+            size_t i = next++;
+            if (i >= n) break;
+            try {
+                fn(i, t);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (not error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    ThreadPool::instance().run(nthreads, worker);
+
+    if (error) std::rethrow_exception(error);
+}
+
+}  // namespace coek
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace coek {
+
+/** \returns the number of hardware threads available (at least 1) */
+size_t default_num_threads();
+
+/** \returns the index of the calling thread within parallel_for(), or 0 outside of it */
+size_t thread_index();
+
+/** \returns \c true if the calling thread is executing within parallel_for() */
+bool in_parallel();
+
+/**
+ * Execute fn(i, t) for i in [0, n) using up to nthreads threads.
+ *
+ * The calling thread participates as thread 0, and work items are assigned
+ * dynamically.  The value t is the index of the executing thread, which is
+ * also returned by thread_index().  If a call to fn throws, the remaining
+ * work items are skipped and the first exception is rethrown in the calling
+ * thread.  Nested calls are executed serially by the calling thread, which
+ * is thread 0 of the nested call.
+ *
+ * The other threads are taken from a pool of worker threads, which are created
+ * when they are first needed and reused by later calls.  The pool executes one
+ * call at a time, and a call that is made while the pool is busy is executed
+ * by the calling thread alone.
+ *
+ * \param n  the number of work items
+ * \param nthreads  the number of threads (0 uses default_num_threads())
+ * \param fn  the function that is executed for each work item
+ */
+void parallel_for(size_t n, size_t nthreads, const std::function<void(size_t, size_t)>& fn);
+
+/** The number of work items that write_chunks() renders into a buffer */
+constexpr size_t chunk_size = 1024;
+
+/** \returns the number of buffers that write_chunks() renders at a time */
+inline size_t chunk_buffers(size_t nthreads) { return 4 * nthreads; }
+
+/**
+ * Render items [0, n) with render(buf, i, t), and write each buffer with write(buf).
+ *
+ * The items are split into chunks of chunk_size items.  Each chunk is rendered
+ * into its own buffer by a worker thread, and the buffers are then written in
+ * order.  A batch of chunk_buffers(nthreads) buffers is rendered at a time, to
+ * limit the memory used for large models.  The value t is the index of the thread
+ * that renders the chunk.
+ */
+template <class BufferType>
+void write_chunks(size_t n, size_t nthreads,
+                  const std::function<void(BufferType&, size_t, size_t)>& render,
+                  const std::function<void(BufferType&)>& write)
+{
+    std::vector<BufferType> bufs(chunk_buffers(nthreads));
+
+    for (size_t start = 0; start < n; start += bufs.size() * chunk_size) {
+        size_t nchunks = std::min(bufs.size(), (n - start + chunk_size - 1) / chunk_size);
+        parallel_for(nchunks, nthreads, [&](size_t k, size_t t) {
+            auto& buf = bufs[k];
+            buf = BufferType();
+            size_t stop = std::min(n, start + (k + 1) * chunk_size);
+            for (size_t i = start + k * chunk_size; i < stop; i++) render(buf, i, t);
+        });
+        for (size_t k = 0; k < nchunks; k++) write(bufs[k]);
+    }
+}
+
+}  // namespace coek
@@ -0,0 +1,154 @@
+#include "coek/util/reorder.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace coek {
+
+namespace {
+
+const size_t npos = std::numeric_limits<size_t>::max();
+
+//
+// The bipartite graph of a sparse matrix.  Nodes 0 ... nrows-1 are the rows, and
+// nodes nrows ... nrows+ncols-1 are the columns.
+//
+class BipartiteGraph {
+   public:
+    size_t nrows;
+    size_t nnodes;
+    // The neighbors of node i are adj[adj_start[i]] ... adj[adj_start[i+1]-1]
+    std::vector<size_t> adj_start;
+    std::vector<size_t> adj;
+
+    BipartiteGraph(size_t _nrows, size_t ncols, const std::vector<size_t>& start,
+                   const std::vector<size_t>& index)
+        : nrows(_nrows), nnodes(_nrows + ncols), adj_start(nnodes + 1, 0)
+    {
+        size_t nnz = nrows == 0 ? 0 : start[nrows];
+        for (size_t i = 0; i < nrows; i++) adj_start[i + 1] = start[i + 1] - start[i];
+        for (size_t k = 0; k < nnz; k++) adj_start[nrows + index[k] + 1]++;
+        for (size_t i = 0; i < nnodes; i++) adj_start[i + 1] += adj_start[i];
+
+        adj.resize(2 * nnz);
+        std::vector<size_t> next(adj_start.begin(), adj_start.end() - 1);
+        for (size_t i = 0; i < nrows; i++) {
+            for (size_t k = start[i]; k < start[i + 1]; k++) {
+                adj[next[i]++] = nrows + index[k];
+                adj[next[nrows + index[k]]++] = i;
+            }
+        }
+    }
+
+    size_t degree(size_t i) const { return adj_start[i + 1] - adj_start[i]; }
+};
+
+//
+// Computes the level structure of the component that contains root.  The nodes are
+// appended to order in breadth-first order, and the number of levels is returned.
+// Nodes are marked with the value of stamp.
+//
+size_t level_structure(const BipartiteGraph& graph, size_t root, size_t stamp,
+                       std::vector<size_t>& mark, std::vector<size_t>& order,
+                       std::vector<size_t>& last_level)
+{
+    order.clear();
+    order.push_back(root);
+    mark[root] = stamp;
+    size_t nlevels = 0;
+    size_t begin = 0;
+    while (begin < order.size()) {
+        size_t end = order.size();
+        last_level.assign(order.begin() + static_cast<std::ptrdiff_t>(begin),
+                          order.begin() + static_cast<std::ptrdiff_t>(end));
+        for (size_t k = begin; k < end; k++) {
+            size_t i = order[k];
+            for (size_t a = graph.adj_start[i]; a < graph.adj_start[i + 1]; a++) {
+                size_t j = graph.adj[a];
+                if (mark[j] != stamp) {
+                    mark[j] = stamp;
+                    order.push_back(j);
+                }
+            }
+        }
+        begin = end;
+        nlevels++;
+    }
+    return nlevels;
+}
+
+}  // namespace
+
+void rcm_ordering(size_t nrows, size_t ncols, const std::vector<size_t>& start,
+                  const std::vector<size_t>& index, std::vector<size_t>& row_order,
+                  std::vector<size_t>& col_order)
+{
+    BipartiteGraph graph(nrows, ncols, start, index);
+    size_t n = graph.nnodes;
+
+    std::vector<size_t> mark(n, npos);
+    std::vector<bool> visited(n, false);
+    std::vector<size_t> order;
+    order.reserve(n);
+    std::vector<size_t> component;
+    std::vector<size_t> last_level;
+    std::vector<size_t> neighbors;
+    size_t stamp = 0;
+
+    auto by_degree = [&](size_t a, size_t b) {
+        size_t da = graph.degree(a);
+        size_t db = graph.degree(b);
+        return (da < db) or ((da == db) and (a < b));
+    };
+
+    for (size_t s = 0; s < n; s++) {
+        if (visited[s]) continue;
+
+        //
+        // Find a pseudo-peripheral node with the George-Liu algorithm
+        //
+        size_t root = s;
+        size_t nlevels = level_structure(graph, root, stamp++, mark, component, last_level);
+        while (true) {
+            size_t candidate
+                = *std::min_element(last_level.begin(), last_level.end(), by_degree);
+            size_t tmp = level_structure(graph, candidate, stamp++, mark, component, last_level);
+            if (tmp <= nlevels) break;
+            root = candidate;
+            nlevels = tmp;
+        }
+
+        //
+        // Cuthill-McKee ordering of the component
+        //
+        size_t begin = order.size();
+        order.push_back(root);
+        visited[root] = true;
+        for (size_t k = begin; k < order.size(); k++) {
+            size_t i = order[k];
+            neighbors.clear();
+            for (size_t a = graph.adj_start[i]; a < graph.adj_start[i + 1]; a++) {
+                size_t j = graph.adj[a];
+                if (not visited[j]) {
+                    visited[j] = true;
+                    neighbors.push_back(j);
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end(), by_degree);
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+
+    row_order.clear();
+    row_order.reserve(nrows);
+    col_order.clear();
+    col_order.reserve(ncols);
+    for (size_t k = order.size(); k-- > 0;) {
+        if (order[k] < nrows)
+            row_order.push_back(order[k]);
+        else
+            col_order.push_back(order[k] - nrows);
+    }
+}
+
+}  // namespace coek
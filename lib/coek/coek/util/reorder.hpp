@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace coek {
+
+/**
+ * Compute a reverse Cuthill-McKee ordering of the rows and columns of a sparse matrix.
+ *
+ * The rows and columns are the nodes of a bipartite graph that has an edge for
+ * each nonzero.  Each connected component is ordered with a breadth-first search
+ * that starts at a pseudo-peripheral node and visits neighbors in order of
+ * increasing degree, and the combined ordering is reversed.  Ordering the rows
+ * and columns in this way reduces the bandwidth of the matrix.
+ *
+ * \param nrows  the number of rows
+ * \param ncols  the number of columns
+ * \param start  the nonzeros in row i are index[start[i]] ... index[start[i+1]-1]
+ * \param index  the column of each nonzero
+ * \param row_order  row_order[k] is set to the k-th row in the new ordering
+ * \param col_order  col_order[k] is set to the k-th column in the new ordering
+ */
+void rcm_ordering(size_t nrows, size_t ncols, const std::vector<size_t>& start,
+                  const std::vector<size_t>& index, std::vector<size_t>& row_order,
+                  std::vector<size_t>& col_order);
+
+}  // namespace coek
@@ -0,0 +1,62 @@
+#include "coek/util/shift.hpp"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#ifdef COEK_WITH_COMPACT_MODEL
+#    include "coek/compact/coek_sets.hpp"
+#endif
+
+namespace coek {
+
+void array_slices(const std::vector<size_t>& shape, size_t dimension,
+                  std::vector<size_t>& positions, std::vector<size_t>& start)
+{
+    // The array is stored in row-major order, so the positions in a slice are
+    // separated by the product of the dimensions that follow it.
+    size_t n = shape[dimension];
+    size_t outer = 1;
+    for (size_t i = 0; i < dimension; i++) outer *= shape[i];
+    size_t stride = 1;
+    for (size_t i = dimension + 1; i < shape.size(); i++) stride *= shape[i];
+
+    positions.clear();
+    positions.reserve(outer * n * stride);
+    start.assign(1, 0);
+    for (size_t o = 0; o < outer; o++) {
+        for (size_t j = 0; j < stride; j++) {
+            for (size_t t = 0; t < n; t++) positions.push_back((o * n + t) * stride + j);
+            start.push_back(positions.size());
+        }
+    }
+}
+
+#ifdef COEK_WITH_COMPACT_MODEL
+void set_slices(ConcreteSet& set, size_t dimension, std::vector<size_t>& positions,
+                std::vector<size_t>& start)
+{
+    // Group the elements by their index values in the other dimensions
+    size_t dim = set.dim();
+    std::map<std::vector<set_types>, std::vector<std::pair<set_types, size_t>>> slices;
+    std::vector<set_types> key(dim - 1);
+    size_t i = 0;
+    for (auto& vec : set) {
+        for (size_t j = 0, k = 0; j < dim; j++)
+            if (j != dimension) key[k++] = vec[j];
+        slices[key].emplace_back(vec[dimension], i++);
+    }
+
+    positions.clear();
+    positions.reserve(i);
+    start.assign(1, 0);
+    for (auto& it : slices) {
+        auto& slice = it.second;
+        std::sort(slice.begin(), slice.end());
+        for (auto& elem : slice) positions.push_back(elem.second);
+        start.push_back(positions.size());
+    }
+}
+#endif
+
+}  // namespace coek
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace coek {
+
+class ConcreteSet;
+
+/**
+ * Group the values of an array into slices along an index dimension.
+ *
+ * A slice contains the values whose indices are equal in every other dimension,
+ * ordered by their index in the given dimension.
+ *
+ * \param shape  the shape of the array, whose values are stored in row-major order
+ * \param dimension  the index dimension
+ * \param positions  set to the positions of the values in each slice
+ * \param start  the positions in slice s are positions[start[s]] ...
+ *               positions[start[s+1]-1]
+ */
+void array_slices(const std::vector<size_t>& shape, size_t dimension,
+                  std::vector<size_t>& positions, std::vector<size_t>& start);
+
+#ifdef COEK_WITH_COMPACT_MODEL
+/**
+ * Group the values of a map into slices along an index dimension.
+ *
+ * The values are stored in the order of the elements in the index set, and each
+ * slice is ordered by the index values in the given dimension.  A slice only
+ * contains values for the elements in the set.
+ */
+void set_slices(ConcreteSet& set, size_t dimension, std::vector<size_t>& positions,
+                std::vector<size_t>& start);
+#endif
+
+/**
+ * Shift the values of parameters or variables in each slice.
+ *
+ * The value at position i of a slice with n values is replaced by the value at
+ * position (i + offset) mod n.  The value expressions are moved between the
+ * existing terms, so expressions that refer to these terms are not changed, and
+ * a term is only updated if its value expression changes.
+ */
+template <class TYPE>
+void shift_values(std::vector<TYPE>& values, const std::vector<size_t>& positions,
+                  const std::vector<size_t>& start, int offset)
+{
+    std::vector<decltype(values[0].repn->value)> tmp;
+    for (size_t s = 0; s + 1 < start.size(); s++) {
+        size_t n = start[s + 1] - start[s];
+        if (n == 0) continue;
+        auto len = static_cast<long>(n);
+        auto k = static_cast<size_t>(((offset % len) + len) % len);
+        if (k == 0) continue;
+
+        const size_t* slice = positions.data() + start[s];
+        tmp.clear();
+        for (size_t i = 0; i < n; i++) tmp.push_back(values[slice[i]].repn->value);
+        for (size_t i = 0; i < n; i++) {
+            auto& repn = values[slice[i]].repn;
+            auto& value = tmp[(i + k) % n];
+            if (repn->value != value) repn->set_value(value);
+        }
+    }
+}
+
+}  // namespace coek
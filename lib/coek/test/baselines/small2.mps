@@ -0,0 +1,15 @@
+NAME coek
+ROWS
+ N obj
+ E c0
+COLUMNS
+    x0 obj 1
+    x1 obj 0
+RHS
+    RHS c0 4
+BOUNDS
+ FR BND x0
+ FR BND x1
+QCMATRIX c0
+    x1 x1 1
+ENDATA
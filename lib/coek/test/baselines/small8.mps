@@ -0,0 +1,23 @@
+NAME coek
+ROWS
+ N obj
+ G c0
+ L c1
+ L c2
+COLUMNS
+    x0 c1 -0.5
+    x1 obj 1
+    x1 c1 1
+    x1 c2 -1
+    x2 obj 1
+    x2 c2 1
+RHS
+    RHS c0 2
+    RHS c2 2
+BOUNDS
+ LO BND x2 7
+QUADOBJ
+    x0 x0 2
+QCMATRIX c0
+    x1 x1 1
+ENDATA
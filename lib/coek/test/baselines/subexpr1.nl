@@ -0,0 +1,79 @@
+g3 1 1 0 # unnamed problem generated by COEK
+ 3 3 1 0 1 0 # vars, constraints, objectives, ranges, eqns, lcons
+ 3 1 # nonlinear constraints, objectives
+ 0 0 # network constraints: nonlinear, linear
+ 3 3 3 # nonlinear vars in constraints, objectives, both
+ 0 0 0 1 # linear network variables; functions; arith, flags
+ 0 0 0 0 0 # discrete variables: binary, integer, nonlinear (b,c,o)
+ 9 3 # nonzeros in Jacobian, gradients
+ 0 0 # max name lengths: constraints, variables
+ 2 1 0 0 0 # common exprs: b,c,o,c1,o1
+V3 1 0
+0 2
+o0
+o2
+v1
+v1
+n1
+V4 1 0
+2 3
+o41
+v3
+V5 0 0
+o2
+v0
+v2
+C0
+o2
+v4
+v0
+C1
+o0
+o2
+n3
+v4
+v5
+C2
+o0
+o2
+v1
+v2
+o0
+o44
+v5
+v3
+O0 0
+o0
+v3
+v4
+x3
+0 0.5
+1 0.5
+2 0.5
+r
+4 1
+1 2
+2 0
+b
+0 0 1
+0 0 1
+0 0 1
+k2
+3
+6
+J0 3
+0 0
+1 0
+2 0
+J1 3
+0 0
+1 0
+2 0
+J2 3
+0 0
+1 0
+2 0
+G0 3
+0 0
+1 0
+2 0
@@ -0,0 +1,49 @@
+g3 1 1 0 # unnamed problem generated by COEK
+ 3 1 2 0 0 0 # vars, constraints, objectives, ranges, eqns, lcons
+ 1 1 # nonlinear constraints, objectives
+ 0 0 # network constraints: nonlinear, linear
+ 3 3 3 # nonlinear vars in constraints, objectives, both
+ 0 0 0 1 # linear network variables; functions; arith, flags
+ 0 0 0 0 0 # discrete variables: binary, integer, nonlinear (b,c,o)
+ 3 5 # nonzeros in Jacobian, gradients
+ 0 0 # max name lengths: constraints, variables
+ 1 0 0 0 0 # common exprs: b,c,o,c1,o1
+V3 0 0
+o0
+o2
+v0
+v1
+o41
+v2
+C0
+o2
+v3
+v0
+O0 0
+n0
+O1 1
+v3
+x3
+0 0.5
+1 0.5
+2 0.5
+r
+1 1
+b
+0 0 1
+0 0 1
+0 0 1
+k2
+1
+2
+J0 3
+0 0
+1 0
+2 0
+G0 2
+0 1
+1 1
+G1 3
+0 0
+1 0
+2 2
@@ -0,0 +1,54 @@
+NAME coek
+OBJSENSE
+    MAX
+ROWS
+ N obj
+ L c0
+ E c1
+ E c2
+ L c3
+ G c4
+ E c5
+ E c6
+ E c7
+COLUMNS
+    MARKER 'MARKER' 'INTORG'
+    x0 obj 3
+    x0 c0 -1
+    x0 c7 -1
+    x1 c0 3
+    x1 c1 4
+    x1 c7 3
+    MARKER 'MARKER' 'INTEND'
+    x2 c5 1
+    x3 c5 1
+    x3 c6 3
+RHS
+    RHS obj -2
+    RHS c0 -2
+    RHS c2 -2
+    RHS c3 -2
+    RHS c4 -9
+    RHS c7 5
+RANGES
+    RNG c4 14
+BOUNDS
+ UP BND x0 1
+ BV BND x1
+ MI BND x3
+ UP BND x3 0
+QCMATRIX c2
+    x0 x1 1.5
+    x1 x0 1.5
+    x1 x1 2
+QCMATRIX c3
+    x0 x0 -1
+    x0 x1 -0.5
+    x1 x0 -0.5
+    x1 x1 3
+QCMATRIX c4
+    x0 x0 -1
+    x0 x1 -0.5
+    x1 x0 -0.5
+    x1 x1 3
+ENDATA
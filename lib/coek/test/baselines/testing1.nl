@@ -4,7 +4,7 @@ g3 1 1 0 # unnamed problem generated by COEK
  0 0 # network constraints: nonlinear, linear
  2 2 0 # nonlinear vars in constraints, objectives, both
  0 0 0 1 # linear network variables; functions; arith, flags
- 1 1 0 2 2 # discrete variables: binary, integer, nonlinear (b,c,o)
+ 0 0 0 2 2 # discrete variables: binary, integer, nonlinear (b,c,o)
  14 1 # nonzeros in Jacobian, gradients
  0 0 # max name lengths: constraints, variables
  0 0 0 0 0 # common exprs: b,c,o,c1,o1
@@ -0,0 +1,9 @@
+NAME coek
+ROWS
+ N obj
+COLUMNS
+    x0 obj 1
+RHS
+BOUNDS
+ FX BND x0 2
+ENDATA
@@ -306,6 +306,69 @@ TEST_CASE("asl_ad", "[smoke]")
         }
     }
 
+    SECTION("threads")
+    {
+        coek::Model model;
+        auto a = model.add_variable("a");
+        auto b = model.add_variable("b");
+        auto c = model.add_variable("c");
+
+        model.add_objective(a + b + c);
+        model.add_constraint(a * b <= 0);
+        model.add_constraint(b * c + a <= 0);
+        model.add_constraint(c <= 0);
+        model.add_constraint(a * a * c <= 0);
+
+        coek::NLPModel nlp(model, ADNAME);
+        if (not nlp.thread_safe()) {
+            // Constraint blocks are only evaluated concurrently if the ASL library is
+            // built with MULTIPLE_THREADS
+            WARN("Skipping the threads test: the ASL library is not thread-safe");
+            nlp.set_num_threads(3);
+            REQUIRE(nlp.num_threads() == 1);
+            return;
+        }
+        std::vector<double> x{1, 2, 3};
+        std::vector<double> c1(nlp.num_constraints());
+        std::vector<double> j1(nlp.num_nonzeros_Jacobian());
+        nlp.compute_c(x, c1);
+        nlp.compute_J(x, j1);
+
+        nlp.set_num_threads(3);
+        REQUIRE(nlp.num_threads() == 3);
+        std::vector<double> c2(nlp.num_constraints());
+        std::vector<double> j2(nlp.num_nonzeros_Jacobian());
+        nlp.compute_c(x, c2);
+        nlp.compute_J(x, j2);
+        REQUIRE(c1 == c2);
+        REQUIRE(j1 == j2);
+    }
+
+    SECTION("clone_workspace")
+    {
+        coek::Model model;
+        auto a = model.add_variable("a").lower(0).upper(1).value(0);
+        auto b = model.add_variable("b").lower(0).upper(1).value(0);
+
+        model.add_objective(a * b);
+        model.add_constraint(a + b * b <= 1);
+
+        coek::NLPModel nlp(model, ADNAME);
+        auto clone = nlp.clone_workspace();
+        REQUIRE(clone.num_variables() == 2);
+        REQUIRE(clone.num_objectives() == 1);
+        REQUIRE(clone.num_constraints() == 1);
+
+        std::vector<double> x{3, 5};
+        std::vector<double> y{3, 6};
+        std::vector<double> c(1);
+        REQUIRE(nlp.compute_f(x) == 15.0);
+        REQUIRE(clone.compute_f(y) == 18.0);
+        clone.compute_c(c);
+        REQUIRE(c[0] == 39.0);
+        REQUIRE(nlp.compute_f() == 15.0);
+    }
+
     SECTION("sparse_h")
     {
         WHEN("nx < nc")
@@ -1189,3 +1252,119 @@ TEST_CASE("asl_diff_tests", "[smoke]")
         }
     }
 }
+
+//
+// The ASL headers define many macros, so they are included after the other tests.
+//
+#include <cstdio>
+
+#include "asl.h"
+#ifdef range
+#    undef range
+#endif
+
+namespace {
+
+struct ASLEvaluation {
+    int nvars, ncons, nobjs, nnz;
+    std::vector<double> var_bounds, con_bounds, f, df, c, J;
+    std::vector<int> Jrow, Jcol;
+};
+
+ASLEvaluation asl_evaluate(const std::string& fname, std::vector<double>& x)
+{
+    ASL* asl = ASL_alloc(ASL_read_fg);
+    return_nofile = 1;
+    std::string stub = fname;
+    FILE* nlfile = jac0dim(&(stub[0]), static_cast<ftnlen>(stub.size() - 3));
+    REQUIRE(nlfile != nullptr);
+    REQUIRE(fg_read(nlfile, ASL_return_read_err) == ASL_readerr_none);
+
+    ASLEvaluation ans;
+    ans.nvars = n_var;
+    ans.ncons = n_con;
+    ans.nobjs = n_obj;
+    ans.nnz = static_cast<int>(nzc);
+    REQUIRE(x.size() == static_cast<size_t>(n_var));
+    ans.var_bounds.assign(LUv, LUv + 2 * n_var);
+    ans.con_bounds.assign(LUrhs, LUrhs + 2 * n_con);
+
+    fint nerror = 0;
+    std::vector<double> df(x.size());
+    for (int i = 0; i < n_obj; i++) {
+        ans.f.push_back(objval(i, x.data(), &nerror));
+        objgrd(i, x.data(), df.data(), &nerror);
+        ans.df.insert(ans.df.end(), df.begin(), df.end());
+    }
+    ans.c.resize(static_cast<size_t>(n_con));
+    conval(x.data(), ans.c.data(), &nerror);
+    ans.J.resize(static_cast<size_t>(nzc));
+    jacval(x.data(), ans.J.data(), &nerror);
+    REQUIRE(nerror == 0);
+
+    ans.Jrow.resize(static_cast<size_t>(nzc));
+    ans.Jcol.resize(static_cast<size_t>(nzc));
+    for (int i = 0; i < n_con; i++) {
+        for (cgrad* cg = Cgrad[i]; cg; cg = cg->next) {
+            ans.Jrow[static_cast<size_t>(cg->goff)] = i;
+            ans.Jcol[static_cast<size_t>(cg->goff)] = cg->varno;
+        }
+    }
+
+    ASL_free(&asl);
+    return ans;
+}
+
+void require_equal(const std::vector<double>& a, const std::vector<double>& b)
+{
+    REQUIRE(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); i++) REQUIRE(a[i] == Approx(b[i]));
+}
+
+}  // namespace
+
+TEST_CASE("asl_bnl_roundtrip", "[smoke]")
+{
+    // The ASL must read the binary NL file written by coek as it reads the text NL file
+    coek::Model model;
+    auto x = model.add_variable("x").lower(-1).upper(2).value(0.5);
+    auto y = model.add_variable("y").lower(0).upper(3).value(1.5);
+    auto z = model.add_variable("z").lower(-COEK_INFINITY).upper(4).value(0.25);
+    auto w = model.add_variable("w").lower(0).upper(5).value(1).within(coek::Integers);
+    auto p = coek::parameter("p").value(2);
+
+    model.add_objective(x * y + sin(z) - p * w);
+    model.add_constraint(pow(x, 2) + y <= 4);
+    model.add_constraint(x + exp(y) == 2);
+    model.add_constraint(inequality(0, x * z / (1 + y), 3));
+    model.add_constraint(x + 2 * y - 3 * w >= -1);
+    model.add_constraint(p * z + w <= 6);
+
+    model.write("asl_roundtrip.nl");
+    model.write("asl_roundtrip.bnl");
+    // The ASL only reads files with the .nl suffix, and it detects the binary format
+    // from the file header.
+    std::rename("asl_roundtrip.bnl", "asl_roundtrip_binary.nl");
+
+    std::vector<double> point{0.5, 1.5, 0.25, 1};
+    auto text = asl_evaluate("asl_roundtrip.nl", point);
+    auto binary = asl_evaluate("asl_roundtrip_binary.nl", point);
+    std::remove("asl_roundtrip.nl");
+    std::remove("asl_roundtrip_binary.nl");
+
+    REQUIRE(text.nvars == 4);
+    REQUIRE(text.ncons == 5);
+    REQUIRE(text.nobjs == 1);
+    REQUIRE(binary.nvars == text.nvars);
+    REQUIRE(binary.ncons == text.ncons);
+    REQUIRE(binary.nobjs == text.nobjs);
+    REQUIRE(binary.nnz == text.nnz);
+    REQUIRE(binary.var_bounds == text.var_bounds);
+    REQUIRE(binary.con_bounds == text.con_bounds);
+    REQUIRE(binary.Jrow == text.Jrow);
+    REQUIRE(binary.Jcol == text.Jcol);
+    require_equal(binary.f, text.f);
+    require_equal(binary.df, text.df);
+    require_equal(binary.c, text.c);
+    require_equal(binary.J, text.J);
+}
@@ -150,6 +150,26 @@ TEST_CASE("cppad_ad", "[smoke]")
         REQUIRE(nlp.compute_f(y, 1) == 18.0);
     }
 
+    SECTION("clone_workspace")
+    {
+        coek::Model model;
+        auto a = model.add_variable("a").lower(0).upper(1).value(0);
+        auto b = model.add_variable("b").lower(0).upper(1).value(0);
+
+        model.add_objective(a * b);
+
+        coek::NLPModel nlp(model, ADNAME);
+        auto clone = nlp.clone_workspace();
+        REQUIRE(clone.num_variables() == 2);
+        REQUIRE(clone.num_objectives() == 1);
+
+        std::vector<double> x{3, 5};
+        std::vector<double> y{3, 6};
+        REQUIRE(nlp.compute_f(x) == 15.0);
+        REQUIRE(clone.compute_f(y) == 18.0);
+        REQUIRE(nlp.compute_f() == 15.0);
+    }
+
     SECTION("df")
     {
         coek::Model model;
@@ -1288,3 +1308,54 @@ TEST_CASE("cppad_diff_tests", "[smoke]")
         }
     }
 }
+
+TEST_CASE("cppad_ordering", "[smoke]")
+{
+    coek::Model model;
+    std::vector<coek::Variable> x;
+    for (size_t i = 0; i < 6; i++) x.push_back(model.add_variable().bounds(0, 1));
+    model.add_objective(x[0]);
+    model.add_constraint(x[1] + 2 * x[4] <= 1);
+    model.add_constraint(x[0] + 2 * x[5] <= 1);
+    model.add_constraint(x[2] + 2 * x[3] <= 1);
+    model.add_constraint(x[5] + 2 * x[1] <= 1);
+    model.add_constraint(x[4] + 2 * x[2] <= 1);
+    model.ordering(coek::Model::Ordering::rcm);
+
+    coek::NLPModel nlp(model, ADNAME);
+    std::vector<size_t> var_order = {3, 2, 4, 1, 5, 0};
+    std::vector<size_t> con_order = {2, 4, 0, 3, 1};
+    for (size_t i = 0; i < 6; i++) REQUIRE(nlp.get_variable(i).id() == x[var_order[i]].id());
+    for (size_t i = 0; i < 5; i++)
+        REQUIRE(nlp.get_constraint(i).id() == model.get_constraint(con_order[i]).id());
+
+    // The constraint values and the AD variables follow the same ordering
+    std::vector<double> v = {1, 2, 3, 4, 5, 6};
+    std::vector<double> c(5);
+    nlp.compute_c(v, c);
+    for (size_t i = 0; i < 6; i++) x[var_order[i]].value(v[i]);
+    for (size_t i = 0; i < 5; i++) REQUIRE(c[i] == Approx(nlp.get_constraint(i).body().value()));
+}
+
+TEST_CASE("cppad_linear_block", "[smoke]")
+{
+    coek::Model model;
+    auto x = model.add_variable("x").bounds(0, 10);
+    auto y = model.add_variable("y").bounds(0, 10);
+    auto z = model.add_variable("z").bounds(0, 10).fix(2);
+    model.add_objective(x * y);
+    coek::LinearConstraintBlock block({x, y, z}, {0, 2, 4}, {0, 1, 1, 2}, {1, 2, 3, -1});
+    block.upper({4, 1});
+    model.add_constraint(block);
+
+    coek::NLPModel nlp(model, ADNAME);
+    REQUIRE(nlp.num_variables() == 2);
+    REQUIRE(nlp.num_nonzeros_Jacobian() == 3);
+
+    // The fixed variable z is a constant in the second row
+    std::vector<double> v = {1, 2};
+    std::vector<double> c(2);
+    nlp.compute_c(v, c);
+    REQUIRE(c[0] == Approx(5));
+    REQUIRE(c[1] == Approx(4));
+}
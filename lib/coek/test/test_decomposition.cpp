@@ -0,0 +1,137 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/ast/base_terms.hpp"
+#include "coek/coek.hpp"
+#include "coek/model/model_repn.hpp"
+
+TEST_CASE("decomposition", "[smoke]")
+{
+    SECTION("blocks")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10);
+        auto y = model.add_variable("y").bounds(0, 10);
+        auto z = model.add_variable("z").bounds(0, 10);
+        auto w = model.add_variable("w").bounds(0, 10);
+        model.add_variable("u").bounds(0, 10);
+        auto v = model.add_variable("v").bounds(0, 10).fix(1);
+        model.add_objective(x + coek::pow(z, 2) + w + 3);
+        model.add_constraint(x + y * v >= 1);
+        model.add_constraint(z - v * w == 0);
+        model.add_constraint(coek::exp(y) <= 5);
+        model.add_constraint(v <= 2);
+
+        coek::Decomposition decomp(model);
+        REQUIRE(decomp.num_blocks() == 2);
+        REQUIRE(decomp.variables(0) == std::vector<size_t>{0, 1});
+        REQUIRE(decomp.constraints(0) == std::vector<size_t>{0, 2});
+        REQUIRE(decomp.variables(1) == std::vector<size_t>{2, 3});
+        REQUIRE(decomp.constraints(1) == std::vector<size_t>{1});
+
+        auto& b0 = decomp.block(0);
+        REQUIRE(b0.num_variables() == 2);
+        REQUIRE(b0.num_constraints() == 2);
+        REQUIRE(b0.get_variable(1).id() == y.id());
+        REQUIRE(b0.get_constraint(1).id() == model.get_constraint(2).id());
+        auto& b1 = decomp.block(1);
+        REQUIRE(b1.get_variable(0).id() == z.id());
+
+        // The objective terms are split between the blocks
+        x.value(1);
+        z.value(2);
+        w.value(4);
+        REQUIRE(b0.get_objective().value() == 4);
+        REQUIRE(b1.get_objective().value() == 8);
+        REQUIRE(b0.get_objective().value() + b1.get_objective().value()
+                == model.get_objective().value());
+
+        // The unused variable u and the fixed variable v are not in a block
+        REQUIRE(b0.num_variables() + b1.num_variables() == 4);
+
+        // The constraint v <= 2 is checked with the value of v
+        REQUIRE(decomp.fixed_constraints() == std::vector<size_t>{3});
+        REQUIRE(not decomp.infeasible());
+        v.value(3);
+        REQUIRE(decomp.infeasible());
+    }
+
+    SECTION("linked")
+    {
+        coek::Model model;
+        std::vector<coek::Variable> x;
+        for (size_t i = 0; i < 4; i++) x.push_back(model.add_variable().bounds(0, 1));
+        model.add_objective(x[0] + x[1] + x[2] + x[3]).sense(coek::Model::maximize);
+        model.add_constraint(x[0] + x[1] <= 1);
+        model.add_constraint(x[2] + x[3] <= 1);
+        model.add_objective(x[1] * x[2]);
+
+        REQUIRE_THROWS_WITH(coek::Decomposition(model),
+                            "Cannot decompose a model with 2 objectives");
+
+        model.repn->objectives.pop_back();
+        coek::Decomposition decomp(model);
+        REQUIRE(decomp.num_blocks() == 2);
+        REQUIRE(decomp.block(0).get_objective().sense() == coek::Model::maximize);
+
+        model.add_constraint(x[1] - x[3] == 0);
+        coek::Decomposition other(model);
+        REQUIRE(other.num_blocks() == 1);
+        REQUIRE(other.constraints(0) == std::vector<size_t>{0, 1, 2});
+    }
+
+    SECTION("solve")
+    {
+        coek::Model model;
+        std::vector<coek::Variable> x;
+        for (size_t i = 0; i < 4; i++) {
+            x.push_back(model.add_variable().bounds(-10, 10));
+            model.add_constraint(x[i] >= static_cast<double>(i));
+        }
+        model.add_objective(x[0] + x[1] + x[2] + x[3]);
+
+        coek::Decomposition decomp(model);
+        REQUIRE(decomp.num_blocks() == 4);
+
+        coek::Solver solver("test");
+        REQUIRE(solver.solve(decomp, 2) == 0);
+        REQUIRE(not solver.error_status());
+
+        coek::NLPSolver nlp_solver("ipopt");
+        if (nlp_solver.available()) {
+            nlp_solver.set_option("print_level", 0);
+            REQUIRE(nlp_solver.solve(decomp, "cppad", 2) == 0);
+            for (size_t i = 0; i < 4; i++) REQUIRE(x[i].value() == Approx(i));
+        }
+
+        // A violated constraint without free variables is reported
+        auto y = model.add_variable().fix(1);
+        model.add_constraint(y >= 2);
+        coek::Decomposition other(model);
+        REQUIRE(other.num_blocks() == 4);
+        REQUIRE(other.infeasible());
+        REQUIRE(solver.solve(other, 2) == -1);
+        REQUIRE(solver.error_status());
+        REQUIRE(solver.error_message()
+                == "The decomposed model has an infeasible constraint without free variables");
+        if (nlp_solver.available()) REQUIRE(nlp_solver.solve(other, "cppad", 2) == -1);
+    }
+
+    SECTION("errors")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x");
+        auto y = coek::variable("y");
+        model.add_objective(x);
+        model.add_constraint(x + y >= 3);
+        REQUIRE_THROWS_WITH(coek::Decomposition(model),
+                            "Cannot decompose a model with variable y that is not declared in "
+                            "the model");
+
+        coek::Model other;
+        coek::Decomposition decomp(other);
+        REQUIRE(decomp.num_blocks() == 0);
+        REQUIRE_THROWS_WITH(decomp.block(0),
+                            "Block index 0 is out of range for a decomposition with 0 blocks");
+    }
+}
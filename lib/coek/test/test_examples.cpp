@@ -1,4 +1,5 @@
 
+#include <cmath>
 #include <iostream>
 
 #include "catch2/catch.hpp"
@@ -47,6 +48,19 @@ TEST_CASE("ipopt_cppad", "[smoke]")
             check(m.get_variables(), rosenbr_soln);
         }
 
+        SECTION("multistart")
+        {
+            auto m = rosenbr();
+
+            coek::NLPModel nlp(m, "cppad");
+            auto results = solver.multistart(nlp, {{-1.2, 1}, {2, 2}, {0, 0}}, 2);
+
+            REQUIRE(results.found);
+            REQUIRE(results.starts.size() == 3);
+            for (auto& res : results.starts) REQUIRE(res.converged);
+            check(m.get_variables(), rosenbr_soln);
+        }
+
         SECTION("invquad_vector")
         {
             std::vector<coek::Parameter> p(5);
@@ -192,6 +206,11 @@ TEST_CASE("ipopt_cppad", "[smoke]")
         REQUIRE(solver.error_status());
         REQUIRE(solver.error_code() != 0);
         std::cerr << solver.error_message() << std::endl;
+
+        coek::NLPModel nlp;
+        REQUIRE_THROWS_WITH(solver.multistart(nlp, {{0}}),
+                            "Cannot perform multi-start solves because the Ipopt library is not "
+                            "available");
     }
 }
 
@@ -214,6 +233,48 @@ TEST_CASE("ipopt_asl", "[smoke]")
             check(m.get_variables(), rosenbr_soln);
         }
 
+        SECTION("multistart")
+        {
+            auto m = rosenbr();
+
+            coek::NLPModel nlp(m, "asl");
+            auto results = solver.multistart(nlp, {{-1.2, 1}, {2, 2}, {0, 0}}, 2);
+
+            REQUIRE(results.found);
+            REQUIRE(results.starts.size() == 3);
+            for (auto& res : results.starts) REQUIRE(res.converged);
+            check(m.get_variables(), rosenbr_soln);
+        }
+
+        SECTION("resolve_duals")
+        {
+            coek::Model m;
+            auto p = coek::parameter("p").value(0);
+            auto x = m.add_variable("x").bounds(-10, 10).value(0);
+            auto y = m.add_variable("y").bounds(-10, 10).value(0);
+            m.add_objective((x - p) * (x - p) + (y - p) * (y - p));
+            m.add_constraint(x + y >= 1);
+
+            coek::NLPModel nlp(m, "asl");
+            solver.solve(nlp);
+            std::vector<double> duals;
+            solver.get_duals(duals);
+            REQUIRE(duals.size() == 1);
+            REQUIRE(std::fabs(duals[0]) == Approx(1.0).margin(1e-6));
+
+            // Changing a parameter does not change the model structure, so the
+            // multipliers from the last solve are used to warm start the resolve.
+            // No iterations are performed, so the multipliers are unchanged.
+            p.value(0.1);
+            solver.set_option("warm_start_init_point", "yes");
+            solver.set_option("max_iter", 0);
+            solver.resolve();
+            std::vector<double> resolve_duals;
+            solver.get_duals(resolve_duals);
+            REQUIRE(resolve_duals.size() == 1);
+            REQUIRE(resolve_duals[0] == Approx(duals[0]).margin(1e-6));
+        }
+
         SECTION("invquad_vector")
         {
             std::vector<coek::Parameter> p(5);
@@ -0,0 +1,216 @@
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "catch2/catch.hpp"
+#include "coek/ast/base_terms.hpp"
+#include "coek/coek.hpp"
+
+const double inf = std::numeric_limits<double>::infinity();
+
+TEST_CASE("interval", "[smoke]")
+{
+    using coek::Interval;
+
+    SECTION("arithmetic")
+    {
+        Interval a(1, 2);
+        Interval b(-3, 4);
+        REQUIRE(-a == Interval(-2, -1));
+        REQUIRE(a + b == Interval(-2, 6));
+        REQUIRE(a - b == Interval(-3, 5));
+        REQUIRE(a * b == Interval(-6, 8));
+        REQUIRE(b / a == Interval(-3, 4));
+        REQUIRE(a / Interval(0, 2) == Interval(0.5, inf));
+        REQUIRE(a / b == Interval());
+        REQUIRE(Interval(0.0) * Interval() == Interval(0.0));
+        REQUIRE(intersect(a, b) == Interval(1, 2));
+        REQUIRE(intersect(a, Interval(3, 4)).empty());
+        REQUIRE(hull(a, Interval(3, 4)) == Interval(1, 4));
+        REQUIRE(Interval(0, inf).bounded() == false);
+
+        std::stringstream ostr;
+        ostr << a;
+        REQUIRE(ostr.str() == "[1, 2]");
+    }
+
+    SECTION("functions")
+    {
+        REQUIRE(abs(Interval(-3, 2)) == Interval(0, 3));
+        REQUIRE(ceil(Interval(0.5, 1.5)) == Interval(1, 2));
+        REQUIRE(floor(Interval(0.5, 1.5)) == Interval(0, 1));
+        REQUIRE(exp(Interval(0, 1)) == Interval(1, std::exp(1.0)));
+        REQUIRE(log(Interval(-1, 1)) == Interval(-inf, 0));
+        REQUIRE(log(Interval(-2, -1)).empty());
+        REQUIRE(sqrt(Interval(-4, 4)) == Interval(0, 2));
+        REQUIRE(sin(Interval(0, 4)) == Interval(std::sin(4.0), 1));
+        REQUIRE(cos(Interval(-1, 7)) == Interval(-1, 1));
+        REQUIRE(tan(Interval(1, 2)) == Interval());
+        REQUIRE(cosh(Interval(-1, 2)) == Interval(1, std::cosh(2.0)));
+        REQUIRE(asin(Interval(0, 2)) == Interval(0, std::asin(1.0)));
+        REQUIRE(acosh(Interval(0, 1)) == Interval(0.0));
+        REQUIRE(atanh(Interval(-2, 0)) == Interval(-inf, 0));
+    }
+
+    SECTION("pow")
+    {
+        REQUIRE(pow(Interval(-2, 3), Interval(2)) == Interval(0, 9));
+        REQUIRE(pow(Interval(-2, 3), Interval(3)) == Interval(-8, 27));
+        REQUIRE(pow(Interval(1, 2), Interval(-1)) == Interval(0.5, 1));
+        REQUIRE(pow(Interval(-1, 4), Interval(0.5)) == Interval(0, 2));
+        auto tmp = pow(Interval(2, 4), Interval(1, 2));
+        REQUIRE(tmp.lb == Approx(2));
+        REQUIRE(tmp.ub == Approx(16));
+    }
+
+    SECTION("expression")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(-1, 2);
+        auto y = model.add_variable("y").bounds(1, 3);
+        auto z = model.add_variable("z").lower(0);
+        auto p = coek::parameter("p").value(2);
+
+        REQUIRE((p * x + y).interval() == Interval(-1, 7));
+        REQUIRE((x * x).interval() == Interval(0, 4));
+        REQUIRE((x * y - 2).interval() == Interval(-5, 4));
+        REQUIRE((x / y).interval() == Interval(-1, 2));
+        REQUIRE(coek::exp(z).interval() == Interval(1, inf));
+        REQUIRE(coek::pow(y, 2).interval() == Interval(1, 9));
+        REQUIRE(coek::sqrt(x).interval() == Interval(0, std::sqrt(2.0)));
+
+        y.fix(2);
+        REQUIRE((x + y).interval() == Interval(1, 4));
+    }
+}
+
+TEST_CASE("fbbt", "[smoke]")
+{
+    SECTION("linear")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").lower(0);
+        auto y = model.add_variable("y").lower(1);
+        auto z = model.add_variable("z").bounds(0, 2).within(coek::Integers);
+        model.add_objective(x + y + z);
+        model.add_constraint(x + y <= 4);
+        model.add_constraint(2 * z - x >= 0.5);
+
+        coek::FBBT fbbt(model);
+        REQUIRE(fbbt.propagate());
+        REQUIRE(fbbt.bounds(x).ub == Approx(3));
+        REQUIRE(fbbt.bounds(y).ub == Approx(4));
+        REQUIRE(fbbt.bounds(z).lb == 1);
+        REQUIRE(x.upper() == COEK_INFINITY);
+
+        fbbt.apply();
+        REQUIRE(x.upper() == Approx(3));
+        REQUIRE(z.lower() == 1);
+        REQUIRE(z.upper() == 2);
+    }
+
+    SECTION("nonlinear")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x");
+        auto y = model.add_variable("y");
+        auto z = model.add_variable("z").bounds(-10, 10);
+        model.add_objective(x + y);
+        model.add_constraint(coek::exp(x) <= 1);
+        model.add_constraint(coek::log(y) >= 0);
+        model.add_constraint(x * x + coek::pow(z, 2) <= 4);
+        model.add_constraint(coek::sqrt(y) <= 3);
+
+        coek::FBBT fbbt(model);
+        REQUIRE(fbbt.propagate());
+        // x <= 0 and x^2 <= 4
+        REQUIRE(fbbt.bounds(x).lb == Approx(-2));
+        REQUIRE(fbbt.bounds(x).ub == Approx(0).margin(1e-6));
+        // 1 <= y <= 9
+        REQUIRE(fbbt.bounds(y).lb == Approx(1));
+        REQUIRE(fbbt.bounds(y).ub == Approx(9));
+        // z^2 <= 4
+        REQUIRE(fbbt.bounds(z).lb == Approx(-2));
+        REQUIRE(fbbt.bounds(z).ub == Approx(2));
+    }
+
+    SECTION("incremental")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10);
+        auto y = model.add_variable("y").bounds(0, 10);
+        auto z = model.add_variable("z").bounds(0, 10);
+        auto w = model.add_variable("w").bounds(0, 10);
+        model.add_objective(x + y + z + w);
+        model.add_constraint(x - y == 0);
+        model.add_constraint(z + w <= 10);
+
+        coek::FBBT fbbt(model);
+        REQUIRE(fbbt.propagate());
+        size_t propagations = fbbt.statistics().propagations;
+        REQUIRE(propagations == 2);
+
+        // Only the constraint that contains x is propagated
+        fbbt.set_bounds(x, 2, 5);
+        REQUIRE(fbbt.propagate());
+        REQUIRE(fbbt.statistics().propagations == propagations + 1);
+        REQUIRE(fbbt.bounds(y).lb == Approx(2));
+        REQUIRE(fbbt.bounds(y).ub == Approx(5));
+
+        // Bound changes in the model are read by update()
+        z.lower(4);
+        fbbt.update();
+        REQUIRE(fbbt.propagate());
+        REQUIRE(fbbt.statistics().propagations == propagations + 2);
+        REQUIRE(fbbt.bounds(w).ub == Approx(6));
+
+        // No constraints are queued
+        REQUIRE(fbbt.propagate());
+        REQUIRE(fbbt.statistics().propagations == propagations + 2);
+    }
+
+    SECTION("parameters")
+    {
+        coek::Model model;
+        auto p = coek::parameter("p").value(4);
+        auto x = model.add_variable("x").bounds(-10, 10);
+        model.add_objective(x);
+        model.add_constraint(p * x <= p);
+
+        coek::FBBT fbbt(model);
+        REQUIRE(fbbt.propagate());
+        REQUIRE(fbbt.bounds(x).ub == Approx(1));
+    }
+
+    SECTION("infeasible")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 1);
+        auto y = model.add_variable("y").bounds(0, 1);
+        model.add_objective(x + y);
+        model.add_constraint(x + y >= 3);
+
+        coek::FBBT fbbt(model);
+        REQUIRE(not fbbt.propagate());
+        REQUIRE(fbbt.infeasible());
+
+        coek::Model other;
+        auto z = other.add_variable("z").bounds(-2, -1);
+        other.add_objective(z);
+        other.add_constraint(coek::log(z) <= 0);
+        coek::FBBT other_fbbt(other);
+        REQUIRE(not other_fbbt.propagate());
+    }
+
+    SECTION("errors")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x");
+        auto y = coek::variable("y");
+        model.add_objective(x);
+        model.add_constraint(x + y >= 3);
+        REQUIRE_THROWS_WITH(coek::FBBT(model),
+                            "Cannot tighten bounds in a model with variable y that is not "
+                            "declared in the model");
+    }
+}
@@ -0,0 +1,39 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/util/id_index.hpp"
+
+TEST_CASE("id_index", "[smoke]")
+{
+    SECTION("empty")
+    {
+        coek::IdIndex index;
+        index.initialize({});
+        REQUIRE(index.find(0) == coek::IdIndex::npos);
+    }
+
+    SECTION("dense")
+    {
+        coek::IdIndex index;
+        index.initialize({12, 10, 11, 15, 10});
+        REQUIRE(index.find(10) == 1);
+        REQUIRE(index.find(11) == 2);
+        REQUIRE(index.find(12) == 0);
+        REQUIRE(index.find(15) == 3);
+        REQUIRE(index.find(9) == coek::IdIndex::npos);
+        REQUIRE(index.find(13) == coek::IdIndex::npos);
+        REQUIRE(index.find(16) == coek::IdIndex::npos);
+    }
+
+    SECTION("sparse")
+    {
+        coek::IdIndex index;
+        index.initialize({1000000, 5, 2000000, 5});
+        REQUIRE(index.find(5) == 1);
+        REQUIRE(index.find(1000000) == 0);
+        REQUIRE(index.find(2000000) == 2);
+        REQUIRE(index.find(0) == coek::IdIndex::npos);
+        REQUIRE(index.find(6) == coek::IdIndex::npos);
+        REQUIRE(index.find(3000000) == coek::IdIndex::npos);
+    }
+}
@@ -0,0 +1,201 @@
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/ast/base_terms.hpp"
+#include "coek/ast/constraint_terms.hpp"
+#include "coek/ast/value_terms.hpp"
+#include "coek/coek.hpp"
+#include "coek/model/model_repn.hpp"
+
+namespace {
+
+std::string written_file(coek::Model& model, const std::string& fname)
+{
+    model.write(fname);
+    std::ifstream ifstr(fname);
+    std::stringstream sstr;
+    sstr << ifstr.rdbuf();
+    ifstr.close();
+    std::remove(fname.c_str());
+    return sstr.str();
+}
+
+}  // namespace
+
+TEST_CASE("linear_constraint_block", "[smoke]")
+{
+    //
+    //   x + 2y      <= 4
+    //   -1 <= y - z <= 1
+    //   3x + z       = 5
+    //
+    std::vector<size_t> row_start = {0, 2, 4, 6};
+    std::vector<size_t> col_index = {0, 1, 1, 2, 2, 0};
+    std::vector<double> values = {1, 2, 1, -1, 1, 3};
+
+    SECTION("rows")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10).value(1);
+        auto y = model.add_variable("y").bounds(0, 10).value(2);
+        auto z = model.add_variable("z").bounds(0, 10).value(3);
+        model.add_objective(x + y + z);
+
+        coek::LinearConstraintBlock block({x, y, z}, row_start, col_index, values);
+        block.lower({-COEK_INFINITY, -1, 5}).upper({4, 1, COEK_INFINITY});
+        REQUIRE(block.size() == 3);
+        REQUIRE(block.num_nonzeros() == 6);
+        REQUIRE_THROWS_WITH(block.get_constraint(0), "A linear constraint block does not have "
+                                                     "constraints until it is added to a model");
+        model.add_constraint(block);
+        REQUIRE(model.num_constraints() == 3);
+
+        auto c0 = block.get_constraint(0);
+        REQUIRE(c0.id() == model.get_constraint(0).id());
+        REQUIRE(c0.is_inequality());
+        REQUIRE(not c0.has_lower());
+        REQUIRE(c0.upper().value() == 4);
+        REQUIRE(c0.body().value() == 5);
+        REQUIRE(block.get_constraint(1).lower().value() == -1);
+        REQUIRE(block.get_constraint(1).body().value() == -1);
+        REQUIRE(block.get_constraint(1).is_feasible());
+        REQUIRE(block.get_constraint(2).body().value() == 6);
+
+        std::stringstream sstr;
+        sstr << c0.body();
+        REQUIRE(sstr.str() == "x + 2*y");
+        REQUIRE(c0.body().to_list()
+                == std::list<std::string>{"[", "+", "[", "*", "1", "x", "]", "[", "*", "2", "y",
+                                          "]", "]"});
+
+        // The row is not stored with an expression for each term
+        REQUIRE(c0.repn->body->id() == coek::LinearRowTerm_id);
+
+        coek::QuadraticExpr repn;
+        repn.collect_terms(block.get_constraint(1));
+        REQUIRE(repn.linear_coefs == std::vector<double>{1, -1});
+        REQUIRE(repn.linear_vars[0]->index == y.id());
+        REQUIRE(repn.linear_vars[1]->index == z.id());
+
+        // Fixed variables are constants
+        z.fix(2);
+        repn.reset();
+        repn.collect_terms(block.get_constraint(1));
+        REQUIRE(repn.linear_coefs == std::vector<double>{1});
+        REQUIRE(repn.constval == -2);
+
+        coek::MutableNLPExpr nlp;
+        auto c2 = block.get_constraint(2);
+        nlp.collect_terms(c2);
+        REQUIRE(nlp.linear_vars.size() == 1);
+        REQUIRE(nlp.constval->eval() == 2);
+
+        auto diff = block.get_constraint(2).body().diff(x);
+        REQUIRE(diff.value() == 3);
+        auto e = coek::exp(block.get_constraint(0).body());
+        REQUIRE(e.diff(y).value() == Approx(2 * std::exp(5.0)));
+        REQUIRE(block.get_constraint(0).body().interval().ub == 30);
+    }
+
+    SECTION("writers")
+    {
+        // The files for a model with a block are the same as the files for a model with
+        // constraint expressions
+        auto create = [&](bool use_block, bool nonlinear) {
+            coek::Model model;
+            auto x = model.add_variable("x").bounds(0, 10);
+            auto y = model.add_variable("y").bounds(0, 10).within(coek::Integers);
+            auto z = model.add_variable("z").bounds(0, 10);
+            model.add_objective(x + y + z);
+            if (use_block) {
+                coek::LinearConstraintBlock block({x, y, z}, row_start, col_index, values);
+                block.lower({-COEK_INFINITY, -1, 5}).upper({4, 1, 5});
+                model.add_constraint(block);
+            }
+            else {
+                model.add_constraint(x + 2 * y <= 4);
+                model.add_constraint(coek::inequality(-1, y - z, 1));
+                model.add_constraint(coek::inequality(5, z + 3 * x, 5));
+            }
+            if (nonlinear) model.add_constraint(coek::exp(x) <= 3);
+            return model;
+        };
+
+        auto block_lp = create(true, false);
+        auto expr_lp = create(false, false);
+        REQUIRE(written_file(block_lp, "block.lp") == written_file(expr_lp, "block.lp"));
+
+        auto block_nl = create(true, true);
+        auto expr_nl = create(false, true);
+        REQUIRE(written_file(block_nl, "block.nl") == written_file(expr_nl, "block.nl"));
+    }
+
+    SECTION("parameters")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10);
+        auto y = model.add_variable("y").bounds(0, 10);
+        auto z = model.add_variable("z").bounds(0, 10);
+        model.add_objective(x + y + z);
+
+        auto rhs = coek::parameter("rhs", 3);
+        rhs(0).value(4);
+        rhs(1).value(1);
+        rhs(2).value(5);
+        coek::LinearConstraintBlock block({x, y, z}, row_start, col_index, values);
+        block.equal(rhs);
+        model.add(block);
+        REQUIRE(block.get_constraint(2).is_equality());
+        REQUIRE(block.get_constraint(2).lower().value() == 5);
+        rhs(2).value(7);
+        REQUIRE(block.get_constraint(2).lower().value() == 7);
+
+        auto& sf = model.to_standard_form();
+        REQUIRE(sf.row_values == std::vector<double>{1, 2, 1, -1, 3, 1});
+        REQUIRE(sf.row_lower == std::vector<double>{4, 1, 7});
+        REQUIRE(sf.row_upper == sf.row_lower);
+
+        REQUIRE_THROWS_WITH(block.upper({1, 2, 3}),
+                            "Cannot change the bounds of a linear constraint block after it is "
+                            "added to a model");
+
+        coek::Solver solver("test");
+        REQUIRE(solver.solve(model) == 0);
+    }
+
+    SECTION("errors")
+    {
+        auto x = coek::variable("x");
+        std::vector<coek::Variable> vars = {x};
+        REQUIRE_THROWS_WITH(coek::LinearConstraintBlock(vars, {}, {}, {}),
+                            "The row starts of a linear constraint block must begin with 0");
+        REQUIRE_THROWS_WITH(coek::LinearConstraintBlock(vars, {0, 2, 1}, {0}, {1}),
+                            "The row starts of a linear constraint block must be nondecreasing");
+        REQUIRE_THROWS_WITH(coek::LinearConstraintBlock(vars, {0, 2}, {0}, {1}),
+                            "A linear constraint block has 2 nonzeros, but 1 column indices and "
+                            "1 values");
+        REQUIRE_THROWS_WITH(coek::LinearConstraintBlock(vars, {0, 1}, {1}, {1}),
+                            "Column index 1 is out of range for a linear constraint block with 1 "
+                            "variables");
+
+        coek::LinearConstraintBlock block(vars, {0, 1, 1}, {0}, {1});
+        REQUIRE_THROWS_WITH(block.lower({1}),
+                            "Cannot set 1 bounds for a linear constraint block with 2 rows");
+        block.lower({1, -COEK_INFINITY});
+        coek::Model model;
+        REQUIRE_THROWS_WITH(model.add_constraint(block),
+                            "Row 1 of a linear constraint block does not have a bound");
+        REQUIRE(model.num_constraints() == 0);
+        block.upper({2, 3});
+        model.add_constraint(block);
+        REQUIRE(model.num_constraints() == 2);
+        REQUIRE(model.get_constraint(1).body().value() == 0);
+        REQUIRE_THROWS_WITH(block.get_constraint(2),
+                            "Row 2 is out of range for a linear constraint block with 2 rows");
+    }
+}
@@ -0,0 +1,115 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/util/parallel.hpp"
+
+TEST_CASE("parallel_for", "[smoke]")
+{
+    SECTION("all items")
+    {
+        // Catch2 assertions are not thread-safe, so the values are checked after
+        // parallel_for() returns
+        std::vector<int> count(100, 0);
+        std::vector<size_t> thread(100), index(100);
+        std::vector<unsigned char> parallel(100);
+        std::atomic<size_t> nitems{0};
+        coek::parallel_for(count.size(), 4, [&](size_t i, size_t t) {
+            thread[i] = t;
+            index[i] = coek::thread_index();
+            parallel[i] = coek::in_parallel() ? 1 : 0;
+            count[i]++;
+            nitems++;
+        });
+        REQUIRE(nitems == 100);
+        REQUIRE(count == std::vector<int>(100, 1));
+        for (size_t i = 0; i < 100; i++) {
+            REQUIRE(thread[i] < 4);
+            REQUIRE(index[i] == thread[i]);
+            REQUIRE(parallel[i] == 1);
+        }
+        REQUIRE(coek::thread_index() == 0);
+        REQUIRE(not coek::in_parallel());
+    }
+
+    SECTION("serial")
+    {
+        std::vector<size_t> order;
+        std::vector<size_t> thread;
+        coek::parallel_for(5, 1, [&](size_t i, size_t t) {
+            thread.push_back(t);
+            order.push_back(i);
+        });
+        REQUIRE(order == std::vector<size_t>{0, 1, 2, 3, 4});
+        REQUIRE(thread == std::vector<size_t>(5, 0));
+    }
+
+    SECTION("nested")
+    {
+        // A nested call is executed serially as thread 0, so callers can size
+        // per-thread data by their own number of threads
+        std::vector<size_t> outer(8), inner(8 * 3), index(8 * 3);
+        coek::parallel_for(8, 4, [&](size_t i, size_t t) {
+            outer[i] = t;
+            coek::parallel_for(3, 2, [&](size_t j, size_t u) {
+                inner[3 * i + j] = u;
+                index[3 * i + j] = coek::thread_index();
+            });
+            outer[i] = (coek::thread_index() == t) ? outer[i] : 99;
+        });
+        REQUIRE(inner == std::vector<size_t>(24, 0));
+        REQUIRE(index == std::vector<size_t>(24, 0));
+        for (auto t : outer) REQUIRE(t < 4);
+        REQUIRE(not coek::in_parallel());
+    }
+
+    SECTION("concurrent")
+    {
+        // The parallel state is local to each thread, so a call that finishes
+        // does not change the state of a concurrent call
+        std::atomic<bool> done{false};
+        std::atomic<bool> parallel{true};
+        std::thread other([&]() {
+            coek::parallel_for(2, 2, [&](size_t, size_t) {
+                while (not done.load()) std::this_thread::yield();
+                if (not coek::in_parallel()) parallel = false;
+            });
+        });
+        coek::parallel_for(4, 2, [&](size_t, size_t) {});
+        done = true;
+        other.join();
+        REQUIRE(parallel.load());
+        REQUIRE(not coek::in_parallel());
+    }
+
+    SECTION("pool")
+    {
+        // The worker threads are reused by later calls.  Each item waits until both
+        // items have started, so each thread executes one item.
+        std::vector<std::thread::id> ids(4);
+        for (size_t k = 0; k < 2; k++) {
+            std::atomic<size_t> started{0};
+            coek::parallel_for(2, 2, [&](size_t, size_t t) {
+                started++;
+                while (started.load() < 2) std::this_thread::yield();
+                ids[2 * k + t] = std::this_thread::get_id();
+            });
+        }
+        REQUIRE(ids[0] == std::this_thread::get_id());
+        REQUIRE(ids[1] != ids[0]);
+        REQUIRE(ids[2] == ids[0]);
+        REQUIRE(ids[3] == ids[1]);
+    }
+
+    SECTION("error")
+    {
+        REQUIRE_THROWS_WITH(coek::parallel_for(10, 3,
+                                               [&](size_t i, size_t) {
+                                                   if (i == 5) throw std::runtime_error("item 5");
+                                               }),
+                            "item 5");
+        REQUIRE(not coek::in_parallel());
+    }
+}
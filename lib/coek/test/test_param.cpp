@@ -845,3 +845,77 @@ TEST_CASE("ND_param_array_errors", "[smoke]")
     }
 }
 #endif
+
+#if __cpp_lib_variant
+TEST_CASE("param_array_shift", "[smoke]")
+{
+    SECTION("values")
+    {
+        auto p = coek::parameter("p", {2, 3});
+        for (size_t i = 0; i < 2; i++)
+            for (size_t t = 0; t < 3; t++) p(i, t).value(static_cast<double>(10 * i + t));
+        auto e = p(0, 0) + p(1, 2);
+
+        p.shift(1);
+        REQUIRE(p(0, 0).value() == 1);
+        REQUIRE(p(0, 1).value() == 2);
+        REQUIRE(p(0, 2).value() == 0);
+        REQUIRE(p(1, 0).value() == 11);
+        REQUIRE(p(1, 2).value() == 10);
+        // Expressions refer to the same parameters
+        REQUIRE(e.value() == 11);
+
+        p.shift(0, -1);
+        REQUIRE(p(0, 0).value() == 11);
+        REQUIRE(p(1, 0).value() == 1);
+        p.shift(1, 3);
+        REQUIRE(p(0, 0).value() == 11);
+    }
+
+    SECTION("expressions")
+    {
+        auto q = coek::parameter("q").value(1);
+        auto p = coek::parameter("p", 3).value(0);
+        p(2).value(q + 1);
+        p.shift(0, 2);
+        REQUIRE(p(0).value() == 2);
+        REQUIRE(p(1).value() == 0);
+        q.value(3);
+        REQUIRE(p(0).value() == 4);
+    }
+
+    SECTION("errors")
+    {
+        auto p = coek::parameter("p", {2, 3});
+        REQUIRE_THROWS_WITH(p.shift(2), "Cannot shift the values of p along index dimension 2 "
+                                        "because it has 2 index dimensions");
+    }
+}
+#endif
+
+#ifdef COEK_WITH_COMPACT_MODEL
+TEST_CASE("param_map_shift", "[smoke]")
+{
+    SECTION("values")
+    {
+        std::vector<int> v = {3, 1};
+        std::vector<int> w = {8, 2, 5};
+        auto V = coek::SetOf(v);
+        auto W = coek::SetOf(w);
+        auto p = coek::parameter("p", V * W);
+        for (int i : v)
+            for (int t : w) p(i, t).value(10 * i + t);
+
+        // The values are shifted in the order of the index values
+        p.shift(1);
+        REQUIRE(p(1, 2).value() == 15);
+        REQUIRE(p(1, 5).value() == 18);
+        REQUIRE(p(1, 8).value() == 12);
+        REQUIRE(p(3, 8).value() == 32);
+
+        p.shift(0, 1);
+        REQUIRE(p(1, 2).value() == 35);
+        REQUIRE(p(3, 2).value() == 15);
+    }
+}
+#endif
@@ -0,0 +1,252 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/ast/base_terms.hpp"
+#include "coek/coek.hpp"
+#include "coek/model/model_repn.hpp"
+
+TEST_CASE("presolve", "[smoke]")
+{
+    SECTION("fixed_variables")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(2, 2);
+        auto y = model.add_variable("y").bounds(0, 10);
+        auto z = model.add_variable("z").bounds(0, 10);
+        auto w = model.add_variable("w").bounds(0, 10).fix(4);
+        model.add_objective(x + y + z + w);
+        model.add_constraint(x + y + z >= 3);
+        model.add_constraint(x * x <= 5);
+        model.add_constraint(x * y + w * z <= 12);
+
+        coek::Presolve presolve(model);
+        REQUIRE(not presolve.infeasible());
+        auto& stats = presolve.statistics();
+        REQUIRE(stats.fixed_variables == 2);
+        REQUIRE(stats.empty_rows == 1);
+        REQUIRE(stats.num_variables == 4);
+        REQUIRE(stats.reduced_num_variables == 2);
+        REQUIRE(stats.reduced_num_constraints == 2);
+
+        auto& reduced = presolve.reduced_model();
+        REQUIRE(reduced.get_variable(0).id() == y.id());
+        REQUIRE(reduced.get_variable(1).id() == z.id());
+        // 2 + y + z >= 3
+        auto c0 = reduced.get_constraint(0);
+        REQUIRE(c0.lower().value() == 1);
+        REQUIRE(not c0.has_upper());
+        // 2*y + 4*z <= 12
+        auto c1 = reduced.get_constraint(1);
+        REQUIRE(c1.upper().value() == 12);
+        y.value(1);
+        z.value(1);
+        REQUIRE(c1.body().value() == 6);
+        // x + y + z + 4
+        y.value(0);
+        z.value(0);
+        REQUIRE(reduced.get_objective().expr().value() == 6);
+
+        x.value(0);
+        presolve.postsolve();
+        REQUIRE(x.value() == 2);
+        REQUIRE(w.value() == 4);
+    }
+
+    SECTION("singleton_rows")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10);
+        auto y = model.add_variable("y").bounds(0, 10).within(coek::Integers);
+        auto z = model.add_variable("z").bounds(0, 10);
+        model.add_objective(x + y + z);
+        model.add_constraint(2 * x <= 6);
+        model.add_constraint(-2 * y <= -2.5);
+        model.add_constraint(x + y + z <= 100);
+
+        coek::PresolveOptions options;
+        options.bound_tightening = false;
+        coek::Presolve presolve(model, options);
+        REQUIRE(presolve.statistics().singleton_rows == 2);
+        REQUIRE(presolve.statistics().tightened_bounds == 2);
+
+        auto& reduced = presolve.reduced_model();
+        REQUIRE(reduced.num_constraints() == 1);
+        REQUIRE(reduced.get_constraint(0).id() == model.get_constraint(2).id());
+        REQUIRE(x.upper() == 3);
+        REQUIRE(y.lower() == 2);
+
+        // Singleton rows receive the reduced cost of an active bound
+        x.value(3);
+        y.value(5);
+        reduced.set_suffix("rc", x, -4);
+        reduced.set_suffix("rc", y, 1);
+        auto c2 = model.get_constraint(2);
+        reduced.set_suffix("dual", c2, 0);
+        presolve.postsolve();
+
+        REQUIRE(x.upper() == 10);
+        REQUIRE(y.lower() == 0);
+        auto c0 = model.get_constraint(0);
+        auto c1 = model.get_constraint(1);
+        REQUIRE(model.get_suffix("dual", c0) == -2);
+        REQUIRE(model.get_suffix("dual", c1) == 0);
+        REQUIRE(model.get_suffix("dual", c2) == 0);
+
+        // The bounds are applied again when the reduced model is used
+        presolve.reduced_model();
+        REQUIRE(x.upper() == 3);
+        presolve.postsolve();
+    }
+
+    SECTION("duplicate_rows")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10);
+        auto y = model.add_variable("y").bounds(0, 10);
+        model.add_objective(x + y);
+        model.add_constraint(x + 2 * y >= 1);
+        model.add_constraint(-2 * x - 4 * y >= -6);
+        model.add_constraint(3 * x + 6 * y <= 12);
+        model.add_constraint(x - y <= 1);
+
+        coek::PresolveOptions options;
+        options.bound_tightening = false;
+        coek::Presolve presolve(model, options);
+        REQUIRE(presolve.statistics().duplicate_rows == 2);
+
+        // 1 <= x + 2*y <= 3
+        auto& reduced = presolve.reduced_model();
+        REQUIRE(reduced.num_constraints() == 2);
+        auto c = reduced.get_constraint(0);
+        REQUIRE(c.lower().value() == 1);
+        REQUIRE(c.upper().value() == 3);
+        REQUIRE(reduced.get_constraint(1).id() == model.get_constraint(3).id());
+
+        // The dual value is assigned to the row that defines the active bound
+        x.value(1);
+        y.value(1);
+        reduced.set_suffix("dual", c, 2);
+        presolve.postsolve();
+        std::vector<double> duals;
+        for (auto& con : model.repn->constraints) duals.push_back(model.get_suffix("dual", con));
+        REQUIRE(duals == std::vector<double>{0, -1, 0, 0});
+    }
+
+    SECTION("bound_tightening")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").lower(0);
+        auto y = model.add_variable("y").lower(1);
+        auto z = model.add_variable("z").bounds(0, 2).within(coek::Integers);
+        model.add_objective(x + y + z);
+        model.add_constraint(x + y <= 4);
+        model.add_constraint(2 * z - x >= 0.5);
+
+        coek::Presolve presolve(model);
+        REQUIRE(presolve.statistics().tightened_bounds == 3);
+        presolve.reduced_model();
+        REQUIRE(x.upper() == 3);
+        REQUIRE(y.upper() == 4);
+        REQUIRE(z.lower() == 1);
+        presolve.postsolve();
+        REQUIRE(x.upper() == COEK_INFINITY);
+        REQUIRE(z.lower() == 0);
+    }
+
+    SECTION("nonlinear")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(1, 1);
+        auto y = model.add_variable("y").bounds(1, 1);
+        auto z = model.add_variable("z").bounds(0, 4);
+        model.add_objective(coek::exp(x) + z);
+        model.add_constraint(coek::sin(z) <= 1);
+        model.add_constraint(y + z <= 5);
+
+        // Variables in nonlinear expressions are not removed
+        coek::Presolve presolve(model);
+        REQUIRE(presolve.statistics().fixed_variables == 1);
+        auto& reduced = presolve.reduced_model();
+        REQUIRE(reduced.num_variables() == 2);
+        REQUIRE(reduced.num_constraints() == 1);
+        REQUIRE(reduced.get_objective().id() == model.get_objective().id());
+        REQUIRE(reduced.get_constraint(0).id() == model.get_constraint(0).id());
+    }
+
+    SECTION("infeasible")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 1);
+        auto y = model.add_variable("y").bounds(0, 1);
+        model.add_objective(x + y);
+        model.add_constraint(x + y >= 3);
+
+        coek::Presolve presolve(model);
+        REQUIRE(presolve.infeasible());
+        REQUIRE(presolve.reduced_model().num_variables() == 0);
+
+        coek::Solver solver("test");
+        REQUIRE(solver.solve(presolve) != 0);
+        REQUIRE(solver.error_status());
+        REQUIRE(solver.error_message() == "Presolve found that the model is infeasible");
+
+        coek::Model other;
+        auto z = other.add_variable("z").bounds(2, 2);
+        other.add_objective(z);
+        other.add_constraint(z >= 3);
+        coek::Presolve other_presolve(other);
+        REQUIRE(other_presolve.infeasible());
+    }
+
+    SECTION("solve")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(2, 2);
+        auto y = model.add_variable("y").bounds(0, 10);
+        model.add_objective(x + y);
+        model.add_constraint(x + y >= 3);
+
+        coek::Presolve presolve(model);
+        coek::Solver solver("test");
+        REQUIRE(solver.solve(presolve) == 0);
+        REQUIRE(x.value() == 2);
+        REQUIRE(y.lower() == 0);
+    }
+
+    SECTION("write")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(2, 2);
+        auto y = model.add_variable("y").bounds(0, 10);
+        auto z = model.add_variable("z").bounds(0, 10);
+        model.add_objective(x + y + z);
+        model.add_constraint(x + y + z >= 3);
+        model.add_constraint(y - z == 0);
+
+        coek::Presolve presolve(model);
+        presolve.write("presolve.lp");
+        auto other = coek::read_problem_from_lp_file("presolve.lp");
+        std::remove("presolve.lp");
+        REQUIRE(other.num_variables() == 2);
+        REQUIRE(other.num_constraints() == 2);
+
+        std::stringstream ostr;
+        ostr << presolve.statistics();
+        REQUIRE(ostr.str().find("Fixed variables:  1") != std::string::npos);
+    }
+
+    SECTION("errors")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x");
+        auto y = coek::variable("y");
+        model.add_objective(x);
+        model.add_constraint(x + y >= 3);
+        REQUIRE_THROWS_WITH(coek::Presolve(model),
+                            "Cannot presolve a model with variable y that is not declared in the "
+                            "model");
+    }
+}
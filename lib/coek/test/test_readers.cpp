@@ -1,4 +1,7 @@
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 
 #include "catch2/catch.hpp"
 #include "coek/ast/base_terms.hpp"
@@ -1835,3 +1838,290 @@ TEST_CASE("jpof_reader_file", "[smoke]")
     }
 }
 #endif
+
+namespace {
+
+std::string file_contents(const std::string& fname)
+{
+    std::ifstream ifstr(fname, std::ifstream::binary);
+    std::stringstream sstr;
+    sstr << ifstr.rdbuf();
+    return sstr.str();
+}
+
+// Read an NL baseline and check that writing the model recreates the baselines
+bool nl_roundtrip(const std::string& name, const std::string& input)
+{
+    auto model = coek::read_problem_from_nl_file(currdir + "baselines/" + name + "." + input);
+    std::vector<std::string> suffixes = {"ostrnl"
+#ifdef WITH_FMTLIB
+                                         ,
+                                         "nl"
+#endif
+    };
+    for (const std::string& suffix : suffixes) {
+        std::string fname = name + "_roundtrip." + suffix;
+        model.write(fname);
+        bool same
+            = file_contents(fname) == file_contents(currdir + "baselines/" + name + "." + suffix);
+        std::remove(fname.c_str());
+        if (not same) return false;
+    }
+    return true;
+}
+
+// Read an LP baseline and check that writing the model recreates the baselines
+bool lp_roundtrip(const std::string& name, const std::string& input)
+{
+    auto model = coek::read_problem_from_lp_file(currdir + "baselines/" + name + "." + input);
+    std::vector<std::string> suffixes = {"ostrlp"
+#ifdef WITH_FMTLIB
+                                         ,
+                                         "lp"
+#endif
+    };
+    for (const std::string& suffix : suffixes) {
+        std::string fname = name + "_roundtrip." + suffix;
+        model.write(fname);
+        bool same
+            = file_contents(fname) == file_contents(currdir + "baselines/" + name + "." + suffix);
+        std::remove(fname.c_str());
+        if (not same) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("nl_reader_file", "[smoke]")
+{
+    SECTION("bad")
+    {
+        REQUIRE_THROWS_WITH(coek::read_problem_from_nl_file("bad.nl"), "Unknown file: bad.nl");
+    }
+
+    SECTION("error1")
+    {
+        std::string fname = currdir + "baselines/error1.nl";
+        REQUIRE_THROWS_WITH(coek::read_problem_from_nl_file(fname),
+                            "Error reading NL file " + fname + " (offset 0): Empty file");
+    }
+
+    SECTION("unsupported")
+    {
+        {
+            std::ofstream ofstr("unsupported.nl");
+            ofstr << file_contents(currdir + "baselines/small13.nl").substr(0, 510);
+            ofstr << "C0\no4\nv0\nn3\n";
+        }
+        REQUIRE_THROWS_WITH(coek::read_problem_from_nl_file("unsupported.nl"),
+                            "Error reading NL file unsupported.nl (offset 515): Unsupported "
+                            "operator: o4");
+        std::remove("unsupported.nl");
+    }
+
+    SECTION("small13")
+    {
+        auto model = coek::read_problem_from_nl_file(currdir + "baselines/small13.nl");
+        REQUIRE(model.num_variables() == 1);
+        REQUIRE(model.num_constraints() == 3);
+        REQUIRE(model.num_objectives() == 1);
+
+        auto x = model.get_variable(0);
+        REQUIRE(x.value() == 0.5);
+        REQUIRE(x.lower() == -COEK_INFINITY);
+        REQUIRE(x.upper() == COEK_INFINITY);
+
+        auto c = model.get_constraint(1);
+        REQUIRE(c.is_equality());
+        REQUIRE(c.body().value() == Approx(1.25 - 5));
+    }
+
+    SECTION("roundtrip")
+    {
+        for (const std::string name :
+             {"small1", "small2", "small3", "small4", "small5", "small6", "small7", "small8",
+              "small9", "small13", "small14", "subexpr1", "testing1", "testing2", "testing3",
+              "testing4", "testing5", "testing6"}) {
+            INFO("TEST: " << name);
+            REQUIRE(nl_roundtrip(name, "nl"));
+            REQUIRE(nl_roundtrip(name, "bnl"));
+        }
+    }
+
+#if defined(WITH_FMTLIB) and (defined(WITH_ZLIB) or defined(WITH_ZSTD))
+    SECTION("compressed")
+    {
+#    ifdef WITH_ZLIB
+        std::string fname = "testing1_roundtrip.nl.gz";
+#    else
+        std::string fname = "testing1_roundtrip.nl.zst";
+#    endif
+        auto model = coek::read_problem_from_nl_file(currdir + "baselines/testing1.nl");
+        model.write(fname);
+        auto other = coek::read_problem_from_nl_file(fname);
+        std::remove(fname.c_str());
+        other.write("testing1_roundtrip.nl");
+        bool same = file_contents("testing1_roundtrip.nl")
+                    == file_contents(currdir + "baselines/testing1.nl");
+        std::remove("testing1_roundtrip.nl");
+        REQUIRE(same);
+    }
+#endif
+}
+
+TEST_CASE("lp_reader_file", "[smoke]")
+{
+    auto read = [](const std::string& lp) {
+        {
+            std::ofstream ofstr("test.lp");
+            ofstr << lp;
+        }
+        try {
+            auto model = coek::read_problem_from_lp_file("test.lp");
+            std::remove("test.lp");
+            return model;
+        }
+        catch (std::exception&) {
+            std::remove("test.lp");
+            throw;
+        }
+    };
+
+    SECTION("bad")
+    {
+        REQUIRE_THROWS_WITH(coek::read_problem_from_lp_file("bad.lp"), "Unknown file: bad.lp");
+    }
+
+    SECTION("errors")
+    {
+        REQUIRE_THROWS_WITH(read("\\* comment *\\\n"),
+                            "Error reading LP file test.lp (line 2): Empty file");
+        REQUIRE_THROWS_WITH(read("minimize\n x + y\nsubject to\n c1: x + y\nend\n"),
+                            "Error reading LP file test.lp (line 5): Expected a constraint sense");
+        REQUIRE_THROWS_WITH(read("minimize\n x + y\nsubject to\n c1: x + y >= z\nend\n"),
+                            "Error reading LP file test.lp (line 4): Expected a constraint "
+                            "right-hand side");
+        REQUIRE_THROWS_WITH(read("minimize\n [ x ^ 3 ]\nend\n"),
+                            "Error reading LP file test.lp (line 2): Expected the exponent 2 in "
+                            "a quadratic term");
+        REQUIRE_THROWS_WITH(read("minimize\n x\nsos\n s1: S1:: x:1\nend\n"),
+                            "Error reading LP file test.lp (line 3): SOS constraints are not "
+                            "supported");
+        REQUIRE_THROWS_WITH(read("minimize\n x\n ] y\nend\n"),
+                            "Error reading LP file test.lp (line 3): Unexpected token ']'");
+        REQUIRE_THROWS_WITH(read("minimize\n x\nbounds\n x ? 3\nend\n"),
+                            "Error reading LP file test.lp (line 4): Expected a bound sense");
+    }
+
+    SECTION("cplex")
+    {
+        auto model = read(
+            "\\ A problem in the CPLEX LP format\n"
+            "Maximize\n"
+            " profit: 3x + 2 y - z + [ 4 x ^ 2 + 2 x * y ] / 2 + 5\n"
+            "Subject To\n"
+            " x + y + 1 <= 5\n"
+            " balance: x - y = 1 \\ trailing comment\n"
+            " -2 <= y - z <= 8\n"
+            " 3 >= z\n"
+            " quad: [ y ^ 2 ] >= 1\n"
+            "Bounds\n"
+            " x <= 10\n"
+            " -inf <= y <= +inf\n"
+            " z free\n"
+            " w = 2\n"
+            "Generals\n"
+            " x\n"
+            "Binaries\n"
+            " b\n"
+            "End\n");
+
+        REQUIRE(model.num_variables() == 5);
+        REQUIRE(model.num_objectives() == 1);
+        REQUIRE(model.num_constraints() == 5);
+
+        auto x = model.get_variable("x");
+        REQUIRE(x.lower() == 0);
+        REQUIRE(x.upper() == 10);
+        REQUIRE(x.is_integer());
+        auto y = model.get_variable("y");
+        REQUIRE(y.lower() == -COEK_INFINITY);
+        REQUIRE(y.upper() == COEK_INFINITY);
+        auto z = model.get_variable("z");
+        REQUIRE(z.lower() == -COEK_INFINITY);
+        auto w = model.get_variable("w");
+        REQUIRE(w.lower() == 2);
+        REQUIRE(w.upper() == 2);
+        auto b = model.get_variable("b");
+        REQUIRE(b.is_binary());
+        REQUIRE(b.upper() == 1);
+
+        auto obj = model.get_objective("profit");
+        REQUIRE(obj.sense() == coek::Model::maximize);
+        REQUIRE(obj.expr().to_list()
+                == std::list<std::string>{"[", "+", std::to_string(5.0),
+                                          "[", "*", "3", "x", "]",
+                                          "[", "*", "2", "y", "]",
+                                          "[", "*", "-1", "z", "]",
+                                          "[", "*", "[", "*", "2", "x", "]", "x", "]",
+                                          "[", "*", "[", "*", "1", "x", "]", "y", "]", "]"});
+
+        auto c0 = model.get_constraint(0);
+        REQUIRE(c0.is_inequality());
+        REQUIRE(c0.upper().value() == 4);
+        // Linear constraints are rows of a linear block, and their constants are moved to
+        // the bounds
+        REQUIRE(c0.body().repn->id() == coek::LinearRowTerm_id);
+        REQUIRE(c0.body().to_list()
+                == std::list<std::string>{"[", "+", "[", "*", "1", "x", "]", "[", "*", "1", "y",
+                                          "]", "]"});
+        auto quad = model.get_constraint("quad");
+        REQUIRE(quad.body().repn->id() != coek::LinearRowTerm_id);
+        auto balance = model.get_constraint("balance");
+        REQUIRE(balance.is_equality());
+        REQUIRE(balance.lower().value() == 1);
+        auto c2 = model.get_constraint(2);
+        REQUIRE(c2.lower().value() == -2);
+        REQUIRE(c2.upper().value() == 8);
+        auto c3 = model.get_constraint(3);
+        REQUIRE(not c3.lower().repn);
+        REQUIRE(c3.upper().value() == 3);
+        REQUIRE(quad.lower().value() == 1);
+        REQUIRE(not quad.upper().repn);
+    }
+
+    SECTION("roundtrip")
+    {
+        // Variables are created in the order they appear, so these baselines are
+        // chosen to list variables in index order
+        for (const std::string name :
+             {"small1", "small2", "small3", "testing1", "testing5"}) {
+            INFO("TEST: " << name);
+            REQUIRE(lp_roundtrip(name, "ostrlp"));
+#ifdef WITH_FMTLIB
+            REQUIRE(lp_roundtrip(name, "lp"));
+#endif
+        }
+    }
+
+#if defined(WITH_FMTLIB) and (defined(WITH_ZLIB) or defined(WITH_ZSTD))
+    SECTION("compressed")
+    {
+#    ifdef WITH_ZLIB
+        std::string fname = "testing1_roundtrip.lp.gz";
+#    else
+        std::string fname = "testing1_roundtrip.lp.zst";
+#    endif
+        auto model = coek::read_problem_from_lp_file(currdir + "baselines/testing1.lp");
+        model.write(fname);
+        auto other = coek::read_problem_from_lp_file(fname);
+        std::remove(fname.c_str());
+        other.write("testing1_roundtrip.lp");
+        bool same = file_contents("testing1_roundtrip.lp")
+                    == file_contents(currdir + "baselines/testing1.lp");
+        std::remove("testing1_roundtrip.lp");
+        REQUIRE(same);
+    }
+#endif
+}
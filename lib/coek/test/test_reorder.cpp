@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/coek.hpp"
+#include "coek/util/reorder.hpp"
+
+TEST_CASE("reorder", "[smoke]")
+{
+    SECTION("empty")
+    {
+        std::vector<size_t> row_order;
+        std::vector<size_t> col_order;
+        coek::rcm_ordering(0, 0, {0}, {}, row_order, col_order);
+        REQUIRE(row_order.size() == 0);
+        REQUIRE(col_order.size() == 0);
+    }
+
+    SECTION("path")
+    {
+        // The rows link the columns in the path 0-5-1-4-2-3
+        std::vector<size_t> start = {0, 2, 4, 6, 8, 10};
+        std::vector<size_t> index = {0, 5, 5, 1, 1, 4, 4, 2, 2, 3};
+        std::vector<size_t> row_order;
+        std::vector<size_t> col_order;
+        coek::rcm_ordering(5, 6, start, index, row_order, col_order);
+        REQUIRE(row_order == std::vector<size_t>{0, 1, 2, 3, 4});
+        REQUIRE(col_order == std::vector<size_t>{0, 5, 1, 4, 2, 3});
+    }
+
+    SECTION("components")
+    {
+        // Columns 1 and 3 are not used
+        std::vector<size_t> start = {0, 1, 3, 4};
+        std::vector<size_t> index = {4, 0, 2, 2};
+        std::vector<size_t> row_order;
+        std::vector<size_t> col_order;
+        coek::rcm_ordering(3, 5, start, index, row_order, col_order);
+        REQUIRE(row_order.size() == 3);
+        REQUIRE(col_order.size() == 5);
+        // Rows 1 and 2 are ordered next to each other
+        auto pos1 = std::find(row_order.begin(), row_order.end(), 1) - row_order.begin();
+        auto pos2 = std::find(row_order.begin(), row_order.end(), 2) - row_order.begin();
+        REQUIRE(std::abs(pos1 - pos2) == 1);
+    }
+
+    SECTION("model")
+    {
+        coek::Model model;
+        std::vector<coek::Variable> x;
+        for (size_t i = 0; i < 6; i++) x.push_back(model.add_variable().bounds(0, 1));
+        model.add_objective(x[0]);
+        model.add_constraint(x[1] + x[4] <= 1);
+        model.add_constraint(x[0] + x[5] <= 1);
+        model.add_constraint(x[2] + x[3] <= 1);
+        model.add_constraint(x[5] + x[1] <= 1);
+        model.add_constraint(x[4] + x[2] <= 1);
+        REQUIRE(model.ordering() == coek::Model::Ordering::creation);
+
+        std::map<size_t, size_t> varmap;
+        std::map<size_t, size_t> conmap;
+        model.write("reorder.nl", varmap, conmap);
+        for (size_t i = 0; i < 6; i++) REQUIRE(varmap[i] == x[i].id());
+        for (size_t i = 0; i < 5; i++) REQUIRE(conmap[i] == model.get_constraint(i).id());
+
+        model.ordering(coek::Model::Ordering::rcm);
+        varmap.clear();
+        conmap.clear();
+        model.write("reorder.nl", varmap, conmap);
+        std::vector<size_t> var_order = {3, 2, 4, 1, 5, 0};
+        std::vector<size_t> con_order = {2, 4, 0, 3, 1};
+        for (size_t i = 0; i < 6; i++) REQUIRE(varmap[i] == x[var_order[i]].id());
+        for (size_t i = 0; i < 5; i++)
+            REQUIRE(conmap[i] == model.get_constraint(con_order[i]).id());
+        std::remove("reorder.nl");
+    }
+}
@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/coek.hpp"
+
+namespace {
+
+//
+// Read the values of an "S" segment in a text NL file.  The values are indexed by
+// the NL index of each component.
+//
+std::map<size_t, double> read_suffix(const std::string& fname, const std::string& header)
+{
+    std::map<size_t, double> values;
+    std::ifstream ifstr(fname);
+    std::string line;
+    while (std::getline(ifstr, line)) {
+        if (line != header) continue;
+        std::istringstream istr(header.substr(3));
+        size_t n;
+        istr >> n;
+        for (size_t k = 0; k < n; k++) {
+            size_t i;
+            double value;
+            ifstr >> i >> value;
+            values[i] = value;
+        }
+        break;
+    }
+    return values;
+}
+
+}  // namespace
+
+TEST_CASE("scaling", "[smoke]")
+{
+    coek::Model model;
+    auto x = model.add_variable("x").bounds(-10, 10).value(1);
+    auto y = model.add_variable("y").bounds(-10, 10).value(1);
+    auto z = model.add_variable("z").bounds(-10, 10).value(1);
+    auto o = model.add_objective(1000 * x * x + y);
+    auto c1 = model.add_constraint(x + y <= 10);
+    model.add_constraint(500 * x - y >= 0);
+    model.add_constraint(0.001 * z <= 1);
+    model.set_suffix("scaling_factor", c1, 3.0);
+
+    SECTION("factors")
+    {
+        REQUIRE(coek::compute_scaling_factors(model) == 2);
+        REQUIRE(model.get_suffix("scaling_factor", o) == Approx(100.0 / 2000.0));
+        REQUIRE(model.get_suffix("scaling_factor", c1) == 3.0);
+        auto c2 = model.get_constraint(1);
+        REQUIRE(model.get_suffix("scaling_factor", c2) == Approx(0.2));
+        REQUIRE(model.variable_suffix_names().size() == 0);
+
+        // Existing factors are not changed
+        REQUIRE(coek::compute_scaling_factors(model) == 0);
+
+        coek::ScalingOptions options;
+        options.scale_variables = true;
+        REQUIRE(coek::compute_scaling_factors(model, options) == 1);
+        REQUIRE(model.get_suffix("scaling_factor", z) == Approx(0.001));
+    }
+
+    SECTION("min_value")
+    {
+        coek::ScalingOptions options;
+        options.max_gradient = 1e-6;
+        options.min_value = 1e-5;
+        coek::compute_scaling_factors(model, options);
+        REQUIRE(model.get_suffix("scaling_factor", o) == 1e-5);
+    }
+
+    SECTION("nl")
+    {
+        coek::ScalingOptions options;
+        options.scale_variables = true;
+        coek::compute_scaling_factors(model, options);
+        model.set_suffix("priority", 2.0);
+
+        model.write("scaling.ostrnl");
+        auto vvals = read_suffix("scaling.ostrnl", "S4 1 scaling_factor");
+        REQUIRE(vvals.size() == 1);
+        REQUIRE(vvals[2] == Approx(0.001));
+        auto cvals = read_suffix("scaling.ostrnl", "S5 2 scaling_factor");
+        REQUIRE(cvals.size() == 2);
+        REQUIRE(cvals[0] == 3.0);
+        REQUIRE(cvals[1] == Approx(0.2));
+        auto ovals = read_suffix("scaling.ostrnl", "S6 1 scaling_factor");
+        REQUIRE(ovals.size() == 1);
+        REQUIRE(ovals[0] == Approx(0.05));
+        auto mvals = read_suffix("scaling.ostrnl", "S7 1 priority");
+        REQUIRE(mvals[0] == 2.0);
+
+        // The NL reader skips the suffixes
+        std::vector<std::string> fnames = {"scaling.ostrnl", "scaling.bnl"
+#ifdef WITH_FMTLIB
+                                           ,
+                                           "scaling.fmtnl"
+#endif
+        };
+        for (const std::string& fname : fnames) {
+            if (fname != "scaling.ostrnl") model.write(fname);
+            if (fname == "scaling.fmtnl")
+                REQUIRE(read_suffix(fname, "S5 2 scaling_factor") == cvals);
+            auto tmp = coek::read_problem_from_nl_file(fname);
+            REQUIRE(tmp.num_variables() == 3);
+            REQUIRE(tmp.num_constraints() == 3);
+            std::remove(fname.c_str());
+        }
+    }
+
+    SECTION("ipopt")
+    {
+        coek::compute_scaling_factors(model);
+        coek::NLPSolver solver("ipopt");
+        if (solver.available()) {
+            coek::NLPModel nlp(model, "cppad");
+            solver.set_option("print_level", 0);
+            REQUIRE(solver.solve(nlp) == 0);
+            REQUIRE(y.value() == Approx(-10));
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "coek/coek.hpp"
+#include "coek/model/model_repn.hpp"
+
+TEST_CASE("standard_form", "[smoke]")
+{
+    SECTION("linear")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 10);
+        auto y = model.add_variable("y").bounds(-1, 1).within(coek::Integers);
+        auto z = model.add_variable("z").lower(2);
+        auto p = coek::parameter("p").value(3);
+        model.add_objective(2 * x - z + 1).sense(coek::Model::maximize);
+        model.add_constraint(x + 2 * y + 1 <= p);
+        model.add_constraint(3 * z + x + x == 4);
+        model.add_constraint(coek::inequality(-1, y - z, 1));
+
+        auto& sf = model.to_standard_form();
+        REQUIRE(sf.num_rows == 3);
+        REQUIRE(sf.num_cols == 3);
+        REQUIRE(sf.num_nonzeros() == 6);
+
+        REQUIRE(sf.row_start == std::vector<size_t>{0, 2, 4, 6});
+        REQUIRE(sf.col_index == std::vector<size_t>{0, 1, 0, 2, 1, 2});
+        REQUIRE(sf.row_values == std::vector<double>{1, 2, 2, 3, 1, -1});
+        REQUIRE(sf.col_start == std::vector<size_t>{0, 2, 4, 6});
+        REQUIRE(sf.row_index == std::vector<size_t>{0, 1, 0, 2, 1, 2});
+        REQUIRE(sf.col_values == std::vector<double>{1, 2, 2, 1, 3, -1});
+
+        REQUIRE(sf.row_lower == std::vector<double>{-COEK_INFINITY, 4, -1});
+        REQUIRE(sf.row_upper == std::vector<double>{2, 4, 1});
+        REQUIRE(sf.col_lower == std::vector<double>{0, -1, 2});
+        REQUIRE(sf.col_upper == std::vector<double>{10, 1, COEK_INFINITY});
+        REQUIRE(sf.integer == std::vector<unsigned char>{0, 1, 0});
+
+        REQUIRE(sf.c == std::vector<double>{2, 0, -1});
+        REQUIRE(sf.c0 == 1);
+        REQUIRE(sf.sense == coek::Model::maximize);
+        REQUIRE(sf.q_start == std::vector<size_t>{0, 0, 0, 0});
+        REQUIRE(sf.variable_ids == std::vector<unsigned int>{x.id(), y.id(), z.id()});
+        REQUIRE(sf.constraint_ids
+                == std::vector<unsigned int>{model.get_constraint(0).id(),
+                                             model.get_constraint(1).id(),
+                                             model.get_constraint(2).id()});
+    }
+
+    SECTION("quadratic")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x");
+        auto y = model.add_variable("y");
+        auto z = model.add_variable("z").fix(2);
+        model.add_objective(x * x + 3 * x * y + y * x + z * y + x);
+        model.add_constraint(x + y >= 0);
+
+        auto& sf = model.to_standard_form();
+        REQUIRE(sf.c == std::vector<double>{1, 2, 0});
+        REQUIRE(sf.q_start == std::vector<size_t>{0, 2, 3, 3});
+        REQUIRE(sf.q_index == std::vector<size_t>{0, 1, 0});
+        REQUIRE(sf.q_values == std::vector<double>{2, 4, 4});
+        REQUIRE(sf.col_lower[2] == 2);
+        REQUIRE(sf.col_upper[2] == 2);
+    }
+
+    SECTION("cache")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x").bounds(0, 1);
+        auto y = model.add_variable("y").bounds(0, 1);
+        auto p = coek::parameter("p").value(1);
+        auto q = coek::parameter("q").value(1);
+        model.add_objective(x + y);
+        model.add_constraint(q * x + y <= p);
+
+        auto* sf = &model.to_standard_form();
+        REQUIRE(sf->row_values == std::vector<double>{1, 1});
+
+        // Bounds are updated, but coefficients are cached
+        x.upper(5);
+        p.value(2);
+        q.value(3);
+        sf = &model.to_standard_form();
+        REQUIRE(sf->col_upper[0] == 5);
+        REQUIRE(sf->row_upper[0] == 2);
+        REQUIRE(sf->row_values == std::vector<double>{1, 1});
+        sf = &model.to_standard_form(true);
+        REQUIRE(sf->row_values == std::vector<double>{3, 1});
+
+        // Fixing a variable changes the standard form
+        y.fix(1);
+        sf = &model.to_standard_form();
+        REQUIRE(sf->num_nonzeros() == 1);
+        REQUIRE(sf->row_upper[0] == 1);
+        REQUIRE(sf->c0 == 1);
+
+        // Adding a constraint changes the standard form
+        model.add_constraint(x >= 0.5);
+        sf = &model.to_standard_form();
+        REQUIRE(sf->num_rows == 2);
+        REQUIRE(sf->col_start == std::vector<size_t>{0, 2, 2});
+    }
+
+    SECTION("parallel")
+    {
+        coek::Model model;
+        model.num_writer_threads(4);
+        size_t n = 1000;
+        std::vector<coek::Variable> x;
+        for (size_t i = 0; i < n; i++) x.push_back(model.add_variable().bounds(0, 1));
+        coek::Expression e;
+        for (size_t i = 0; i < n; i++) e += x[i];
+        model.add_objective(e);
+        for (size_t i = 0; i + 1 < n; i++)
+            model.add_constraint(x[i + 1] - x[i] >= static_cast<double>(i));
+
+        auto& sf = model.to_standard_form();
+        REQUIRE(sf.num_rows == n - 1);
+        REQUIRE(sf.num_nonzeros() == 2 * (n - 1));
+        for (size_t i = 0; i + 1 < n; i++) {
+            REQUIRE(sf.row_start[i] == 2 * i);
+            REQUIRE(sf.col_index[2 * i] == i);
+            REQUIRE(sf.row_values[2 * i] == -1);
+            REQUIRE(sf.row_lower[i] == static_cast<double>(i));
+        }
+        REQUIRE(sf.col_start[n] == 2 * (n - 1));
+    }
+
+    SECTION("errors")
+    {
+        coek::Model model;
+        auto x = model.add_variable("x");
+        auto y = coek::variable("y");
+        model.add_objective(x);
+        model.add_constraint(x + y >= 3);
+        REQUIRE_THROWS_WITH(model.to_standard_form(),
+                            "Cannot create a standard form for a model with variable y that is "
+                            "not declared in the model");
+        REQUIRE(model.repn->standard_form == nullptr);
+
+        coek::Model quad;
+        auto z = quad.add_variable("z");
+        quad.add_objective(z);
+        quad.add_constraint("c", z * z <= 1);
+        REQUIRE_THROWS_WITH(quad.to_standard_form(),
+                            "Cannot create a standard form for quadratic constraint c");
+
+        coek::Model multi;
+        auto w = multi.add_variable("w");
+        multi.add_objective(w);
+        multi.add_objective(w);
+        REQUIRE_THROWS_WITH(multi.to_standard_form(),
+                            "Cannot create a standard form for a model with 2 objectives");
+    }
+}
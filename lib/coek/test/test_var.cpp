@@ -1102,3 +1102,52 @@ TEST_CASE("ND_var_array_errors", "[smoke]")
     }
 }
 #endif
+
+#if __cpp_lib_variant
+TEST_CASE("var_array_shift", "[smoke]")
+{
+    SECTION("values")
+    {
+        coek::Model model;
+        auto x = coek::variable("x", 4).bounds(0, 10);
+        model.add_variable(x);
+        for (size_t t = 0; t < 4; t++) x(t).value(static_cast<double>(t));
+        x(0).fix(5);
+        auto c = model.add_constraint(x(0) + x(3) <= 10);
+
+        x.shift(0);
+        REQUIRE(x(0).value() == 1);
+        REQUIRE(x(2).value() == 3);
+        REQUIRE(x(3).value() == 5);
+        // The bounds and fixed status are not shifted
+        REQUIRE(x(0).fixed());
+        REQUIRE(not x(3).fixed());
+        REQUIRE(x(3).upper() == 10);
+        REQUIRE(c.body().value() == 6);
+        REQUIRE(model.num_variables() == 4);
+    }
+
+    SECTION("errors")
+    {
+        auto x = coek::variable("x", 4);
+        REQUIRE_THROWS_WITH(x.shift(1), "Cannot shift the values of x along index dimension 1 "
+                                        "because it has 1 index dimensions");
+    }
+}
+#endif
+
+#ifdef COEK_WITH_COMPACT_MODEL
+TEST_CASE("var_map_shift", "[smoke]")
+{
+    SECTION("values")
+    {
+        auto T = coek::RangeSet(1, 7, 2);
+        auto x = coek::variable("x", T);
+        for (int t : {1, 3, 5, 7}) x(t).value(t);
+        x.shift(0, -1);
+        REQUIRE(x(1).value() == 7);
+        REQUIRE(x(3).value() == 1);
+        REQUIRE(x(7).value() == 5);
+    }
+}
+#endif
@@ -4,12 +4,19 @@
 #include <cstdio>
 #include <fstream>
 #include <iterator>
+#include <map>
+#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
+#ifdef __linux__
+#    include <unistd.h>
+#endif
 
 #include "catch2/catch.hpp"
 #include "coek/ast/base_terms.hpp"
 #include "coek/coek.hpp"
+#include "coek/util/compressed_file.hpp"
 
 const std::string currdir = COEK_TEST_DIR;
 
@@ -330,6 +337,71 @@ void testing6(coek::Model& model)
     model.add(coek::objective(-q * x * x));
 }
 
+// Shared subexpressions are written as NL defined variables
+void subexpr1(coek::Model& model)
+{
+    auto x = model.add(coek::variable("x", 3).lower(0).upper(1).value(0.5));
+    auto q = coek::parameter("q").value(3);
+    auto e = coek::subexpression("e").value(2 * x(0) + x(1) * x(1) + 1);
+    auto f = coek::subexpression("f").value(sin(e) + q * x(2));
+    auto g = coek::subexpression("g").value(x(0) * x(2));
+    auto h = coek::subexpression("h").value(x(1) * x(2));
+
+    model.add(coek::objective(e + f));
+    model.add(f * x(0) == 1);
+    model.add(3 * f + g <= 2);
+    model.add(exp(g) + e + h >= 0);
+}
+
+// A subexpression that is shared by the second objective and a constraint
+void subexpr2(coek::Model& model)
+{
+    auto x = model.add(coek::variable("x", 3).lower(0).upper(1).value(0.5));
+    auto e = coek::subexpression("e").value(x(0) * x(1) + sin(x(2)));
+
+    model.add(coek::objective(x(0) + x(1)));
+    model.add(coek::objective(e + 2 * x(2)).sense(coek::Model::maximize));
+    model.add(e * x(0) <= 1);
+}
+
+// A model with enough constraints to be written with multiple threads
+void large1(coek::Model& model)
+{
+    size_t n = 5000;
+    auto x = model.add(coek::variable("x", n).lower(0).upper(1).value(0.5));
+    auto y = model.add_variable("y").fix(1.0 / 3);
+    auto q = coek::parameter("q").value(2.0 / 7);
+
+    model.add(coek::objective(x(0) * x(1)));
+    for (size_t i : coek::range(n - 1)) {
+        if (i % 3 == 0)
+            model.add(x(i) + y * x(i + 1) <= 1);
+        else if (i % 3 == 1)
+            model.add(q * x(i) * x(i + 1) + sin(x(i)) == 0);
+        else
+            model.add(coek::inequality(-q, x(i) - 3 * x(i + 1), coek::Expression(1)));
+    }
+}
+
+// A linear model with enough constraints to be written with multiple threads
+void large2(coek::Model& model)
+{
+    size_t n = 5000;
+    auto x = model.add(coek::variable("x", n).lower(0).upper(1).value(0.5));
+    auto z = model.add(coek::variable("z", n).within(coek::Integers).upper(10));
+    auto q = coek::parameter("q").value(2.0 / 7);
+
+    model.add_objective(x(0) * x(0) + x(n - 1) * z(0) - 3 * z(1));
+    for (size_t i = 0; i < n - 1; i++) {
+        if (i % 3 == 0)
+            model.add(x(i) + q * x(i + 1) <= 1);
+        else if (i % 3 == 1)
+            model.add(q * x(i) - z(i) + 1 == 0);
+        else
+            model.add(coek::inequality(-q, x(i) - 3 * z(i + 1), coek::Expression(1)));
+    }
+}
+
 #ifdef COEK_WITH_COMPACT_MODEL
 void compact1(coek::CompactModel& model)
 {
@@ -374,20 +446,20 @@ bool run_test(ModelType& model, const std::string& name, const std::string& suff
 
 TEST_CASE("model_writer", "[smoke]")
 {
-    std::vector<std::string> nonlinear = {"ostrnl"
+    std::vector<std::string> nonlinear = {"ostrnl", "bnl"
 #ifdef WITH_FMTLIB
                                           ,
                                           "nl", "fmtnl"
 #endif
     };
-    std::vector<std::string> linear = {"ostrlp",
-                                       "ostrnl"
+    std::vector<std::string> linear = {"ostrlp", "ostrnl", "bnl"
 #ifdef WITH_FMTLIB
                                        ,
                                        "lp",
                                        "nl",
                                        "fmtlp",
-                                       "fmtnl"
+                                       "fmtnl",
+                                       "mps"
 #endif
     };
     coek::Model model;
@@ -425,6 +497,24 @@ TEST_CASE("model_writer", "[smoke]")
         std::remove("error1.ostrlp");
     }
 
+    SECTION("file_errors")
+    {
+        small1(model);
+        for (const std::string& suffix : std::vector<std::string>{"ostrnl", "bnl"}) {
+            std::string fname = "no_such_dir/small1." + suffix;
+            REQUIRE_THROWS_WITH(model.write(fname), "Cannot open file: " + fname);
+        }
+#ifdef __linux__
+        // Writing to /dev/full fails as if the disk were full
+        for (const std::string& suffix : std::vector<std::string>{"ostrnl", "bnl"}) {
+            std::string fname = "full." + suffix;
+            REQUIRE(symlink("/dev/full", fname.c_str()) == 0);
+            REQUIRE_THROWS_WITH(model.write(fname), "Error writing NL file: " + fname);
+            std::remove(fname.c_str());
+        }
+#endif
+    }
+
 #if 0
     TODO - Revisit this test
 
@@ -615,6 +705,25 @@ TEST_CASE("model_writer", "[smoke]")
     }
 
     // TODO - Add separate NLP writer tests to confirm the variable mappings
+    SECTION("subexpr1")
+    {
+        subexpr1(model);
+        for (const std::string& suffix : nonlinear) REQUIRE(run_test(model, "subexpr1", suffix));
+    }
+
+    SECTION("subexpr2")
+    {
+        subexpr2(model);
+        for (const std::string& suffix : nonlinear) REQUIRE(run_test(model, "subexpr2", suffix));
+
+        // Writing defined variables does not change the indices of new variables
+        auto before = coek::variable();
+        model.write("subexpr2.ostrnl");
+        std::remove("subexpr2.ostrnl");
+        auto after = coek::variable();
+        REQUIRE(after.id() == before.id() + 1);
+    }
+
     SECTION("testing1-nlp")
     {
         testing1(model);
@@ -623,6 +732,335 @@ TEST_CASE("model_writer", "[smoke]")
     }
 }
 
+TEST_CASE("model_writer_threads", "[smoke]")
+{
+    std::vector<std::string> suffixes = {"ostrnl", "bnl"
+#ifdef WITH_FMTLIB
+                                         ,
+                                         "nl", "fmtnl"
+#endif
+    };
+    coek::Model model;
+    large1(model);
+    // Models are written serially unless more threads are requested
+    REQUIRE(model.num_writer_threads() == 1);
+
+    for (const std::string& suffix : suffixes) {
+        std::string serial = "large1_serial." + suffix;
+        std::string parallel = "large1_parallel." + suffix;
+        model.num_writer_threads(1);
+        model.write(serial);
+        model.num_writer_threads(4);
+        model.write(parallel);
+        REQUIRE(compare_files(serial, parallel));
+        std::remove(serial.c_str());
+        std::remove(parallel.c_str());
+    }
+}
+
+TEST_CASE("model_writer_threads_lp", "[smoke]")
+{
+    std::vector<std::string> suffixes = {"ostrlp"
+#ifdef WITH_FMTLIB
+                                         ,
+                                         "lp", "fmtlp", "mps"
+#endif
+    };
+    coek::Model model;
+    large2(model);
+
+    for (const std::string& suffix : suffixes) {
+        std::string serial = "large2_serial." + suffix;
+        std::string parallel = "large2_parallel." + suffix;
+        model.num_writer_threads(1);
+        model.write(serial);
+        model.num_writer_threads(4);
+        model.write(parallel);
+        REQUIRE(compare_files(serial, parallel));
+        std::remove(serial.c_str());
+        std::remove(parallel.c_str());
+    }
+}
+
+TEST_CASE("model_snapshot", "[smoke]")
+{
+    std::vector<std::string> nonlinear = {"ostrnl", "bnl"
+#ifdef WITH_FMTLIB
+                                          ,
+                                          "nl", "fmtnl"
+#endif
+    };
+    std::vector<std::string> linear = {"ostrlp", "ostrnl", "bnl"
+#ifdef WITH_FMTLIB
+                                       ,
+                                       "lp", "nl", "mps"
+#endif
+    };
+
+    SECTION("baselines")
+    {
+        std::vector<std::tuple<std::string, void (*)(coek::Model&), bool>> tests
+            = {{"small1", small1, true},      {"small2", small2, true},
+               {"small3", small3, true},      {"small4", small4, true},
+               {"small5", small5, false},     {"small6", small6, false},
+               {"small7", small7, false},     {"small8", small8, true},
+               {"small9", small9, false},     {"small13", small13, false},
+               {"small14", small14, false},   {"testing1", testing1, true},
+               {"testing2", testing2, false}, {"testing3", testing3, false},
+               {"testing4", testing4, false}, {"testing5", testing5, true},
+               {"testing6", testing6, false}, {"subexpr1", subexpr1, false}};
+
+        for (auto& [name, create, is_linear] : tests) {
+            INFO("TEST: " << name);
+            coek::Model original;
+            create(original);
+            original.save_snapshot(name + ".snapshot");
+            auto model = coek::Model::load_snapshot(name + ".snapshot");
+            std::remove((name + ".snapshot").c_str());
+            for (const std::string& suffix : (is_linear ? linear : nonlinear))
+                REQUIRE(run_test(model, name, suffix));
+        }
+    }
+
+    SECTION("components")
+    {
+        coek::Model original;
+        auto x = original.add_variable("x").lower(-1).upper(2).value(0.5);
+        auto y = original.add(coek::variable("y").within(coek::Integers).upper(4).value(2));
+        auto z = original.add(coek::variable("z").within(coek::Binary));
+        z.fix(1);
+        auto p = coek::parameter("p").value(3);
+        auto e = coek::subexpression().value(x * y);
+        auto obj = original.add_objective("o", e + p * coek::sin(x) + coek::pow(y, 2));
+        obj.sense(coek::Model::maximize);
+        auto c1 = original.add_constraint("c1", coek::inequality(-p, x + y, p, true));
+        auto c2 = original.add_constraint("c2", e - z == 1);
+        original.set_suffix("scale", x, 2.0);
+        original.set_suffix("scale", z, 3.0);
+        original.set_suffix("dual", c2, -1.5);
+        original.set_suffix("priority", obj, 1.0);
+        original.set_suffix("tol", 1e-6);
+        original.num_writer_threads(2);
+
+        original.save_snapshot("components.snapshot");
+        auto model = coek::Model::load_snapshot("components.snapshot");
+        std::remove("components.snapshot");
+
+        REQUIRE(model.num_variables() == 3);
+        REQUIRE(model.num_objectives() == 1);
+        REQUIRE(model.num_constraints() == 2);
+        REQUIRE(model.num_writer_threads() == 2);
+        REQUIRE(model.variable_names() == std::set<std::string>{"x", "y", "z"});
+        REQUIRE(model.constraint_names() == std::set<std::string>{"c1", "c2"});
+
+        auto X = model.get_variable("x");
+        REQUIRE(X.lower() == -1);
+        REQUIRE(X.upper() == 2);
+        REQUIRE(X.value() == 0.5);
+        REQUIRE(model.get_variable("y").is_integer());
+        REQUIRE(model.get_variable("y").upper() == 4);
+        auto Z = model.get_variable("z");
+        REQUIRE(Z.is_binary());
+        REQUIRE(Z.fixed());
+        REQUIRE(Z.value() == 1);
+
+        auto O = model.get_objective("o");
+        REQUIRE(O.sense() == coek::Model::maximize);
+        REQUIRE(O.expr().to_list() == obj.expr().to_list());
+        REQUIRE(O.expr().value() == Approx(1 + 3 * std::sin(0.5) + 4));
+        auto C1 = model.get_constraint("c1");
+        REQUIRE(C1.is_inequality());
+        REQUIRE(C1.to_list() == c1.to_list());
+        auto C2 = model.get_constraint("c2");
+        REQUIRE(C2.is_equality());
+        REQUIRE(C2.to_list() == c2.to_list());
+
+        REQUIRE(model.get_suffix("scale", X) == 2.0);
+        REQUIRE(model.get_suffix("scale", Z) == 3.0);
+        REQUIRE(model.get_suffix("dual", C2) == -1.5);
+        REQUIRE(model.get_suffix("priority", O) == 1.0);
+        REQUIRE(model.get_suffix("tol") == 1e-6);
+
+        // Updating the variable value changes both expressions that share it
+        X.value(1);
+        REQUIRE(O.expr().value() == Approx(2 + 3 * std::sin(1.0) + 4));
+        REQUIRE(C2.body().value() == Approx(2 - 1));
+    }
+
+    SECTION("errors")
+    {
+        REQUIRE_THROWS_WITH(coek::Model::load_snapshot("missing.snapshot"),
+                            "Unknown file: missing.snapshot");
+
+        {
+            std::ofstream ofstr("bad.snapshot");
+            ofstr << "COEKSNAX" << std::string(120, '.');
+        }
+        REQUIRE_THROWS_WITH(coek::Model::load_snapshot("bad.snapshot"),
+                            "Error loading model snapshot bad.snapshot: Not a model snapshot");
+        std::remove("bad.snapshot");
+
+        coek::Model model;
+        testing1(model);
+        model.save_snapshot("truncated.snapshot");
+        std::string data;
+        {
+            std::ifstream ifstr("truncated.snapshot", std::ifstream::binary);
+            std::stringstream sstr;
+            sstr << ifstr.rdbuf();
+            data = sstr.str();
+        }
+        {
+            std::ofstream ofstr("truncated.snapshot", std::ofstream::binary);
+            ofstr << data.substr(0, data.size() / 2);
+        }
+        REQUIRE_THROWS_WITH(coek::Model::load_snapshot("truncated.snapshot"),
+                            "Error loading model snapshot truncated.snapshot: Unexpected end of "
+                            "file");
+        std::remove("truncated.snapshot");
+
+        coek::Model abstract;
+        error4(abstract);
+        REQUIRE_THROWS_WITH(abstract.save_snapshot("error4.snapshot"),
+                            "Cannot save a snapshot of a model with term id 100");
+        std::remove("error4.snapshot");
+    }
+}
+
+#if defined(WITH_FMTLIB) and (defined(WITH_ZLIB) or defined(WITH_ZSTD))
+TEST_CASE("model_writer_compressed", "[smoke]")
+{
+    std::vector<std::string> compressions = {
+#    ifdef WITH_ZLIB
+        "gz",
+#    endif
+#    ifdef WITH_ZSTD
+        "zst",
+#    endif
+    };
+    auto read_file = [](const std::string& fname) {
+        coek::InputFile file(fname);
+        std::string data;
+        char buf[1000];
+        size_t n;
+        while ((n = file.read(buf, sizeof(buf))) > 0) data.append(buf, n);
+        return data;
+    };
+
+    coek::Model model;
+    testing1(model);
+
+    std::vector<std::string> suffixes = {"lp", "nl"};
+    for (const std::string& suffix : suffixes) {
+        // Uncompressed files are read without modification
+        std::string baseline = currdir + "/baselines/testing1." + suffix;
+        std::ifstream ifstr(baseline);
+        std::string expected(std::istreambuf_iterator<char>(ifstr), {});
+        REQUIRE(read_file(baseline) == expected);
+
+        for (auto& compression : compressions) {
+            std::string fname = "testing1." + suffix + "." + compression;
+            model.write(fname);
+            REQUIRE(read_file(fname) == expected);
+            std::remove(fname.c_str());
+        }
+    }
+
+    SECTION("large")
+    {
+        // Files that span many compressed blocks
+        coek::Model large;
+        large2(large);
+        large.write("large2.lp");
+        auto expected = read_file("large2.lp");
+        for (auto& compression : compressions) {
+            std::string fname = "large2.lp." + compression;
+            large.write(fname);
+            REQUIRE(read_file(fname) == expected);
+            std::remove(fname.c_str());
+        }
+        std::remove("large2.lp");
+    }
+
+    SECTION("error")
+    {
+        REQUIRE_THROWS_WITH(model.write("testing1.ostrlp.gz"),
+                            "Compressed output is not supported for: testing1.ostrlp.gz");
+    }
+}
+#endif
+
+#ifdef COEK_WITH_COMPACT_MODEL
+TEST_CASE("compact_model_writer_threads_lp", "[smoke]")
+{
+    std::vector<std::string> suffixes = {"ostrlp"
+#    ifdef WITH_FMTLIB
+                                         ,
+                                         "lp", "fmtlp", "mps"
+#    endif
+    };
+    size_t n = 5000;
+    auto I = coek::RangeSet(0, static_cast<int>(n) - 2);
+    auto i = coek::set_element("i");
+
+    coek::CompactModel model;
+    auto x = model.add(coek::variable("x", n).lower(0).upper(1).value(0.5));
+    auto z = model.add(coek::variable("z").within(coek::Integers).upper(10));
+    model.add_objective(x(0) * x(0) - 3 * z);
+    model.add_constraint(x(i) + i * x(i + 1) <= 1, coek::Forall(i).In(I));
+    model.add_constraint(x(0) - z == 0);
+
+    // Compact models are written in batches of constraints
+    for (const std::string& suffix : suffixes) {
+        std::string serial = "compact_serial." + suffix;
+        std::string parallel = "compact_parallel." + suffix;
+        std::string expanded = "compact_expanded." + suffix;
+        model.num_writer_threads(1);
+        model.write(serial);
+        model.num_writer_threads(4);
+        model.write(parallel);
+        model.expand().write(expanded);
+        REQUIRE(compare_files(serial, parallel));
+        REQUIRE(compare_files(serial, expanded));
+        std::remove(serial.c_str());
+        std::remove(parallel.c_str());
+        std::remove(expanded.c_str());
+    }
+}
+
+TEST_CASE("compact_model_writer_nl", "[smoke]")
+{
+    auto I = coek::RangeSet(0, 5);
+    auto J = coek::RangeSet(0, 4);
+    auto i = coek::set_element("i");
+
+    // NL files are written without expanding compact models
+    for (const std::string suffix : {"nl", "ostrnl"}) {
+        coek::CompactModel model;
+        auto x = model.add(coek::variable("x", I).lower(-1).upper(2).value(1));
+        auto y = model.add(coek::variable("y").lower(0));
+        auto z = model.add(coek::variable("z").within(coek::Integers));
+
+        model.add_objective(coek::Sum(coek::Forall(i).In(I), x(i)) + y * y + 3 * z);
+        model.add_objective(x(0) * y - z).sense(coek::Model::maximize);
+        model.add_constraint(x(i) + i * x(i + 1) <= 1, coek::Forall(i).In(J));
+        model.add_constraint(y * x(i) + sin(x(i)) == 1, coek::Forall(i).In(I));
+        model.add_constraint(coek::inequality(-1, x(0) - y + z, 3));
+
+        std::string compact = "compact_nl_compact." + suffix;
+        std::string expanded = "compact_nl_expanded.ostrnl";
+        std::map<size_t, size_t> varmap, conmap;
+        model.write(compact, varmap, conmap);
+        model.expand().write(expanded);
+        REQUIRE(compare_files(compact, expanded));
+        REQUIRE(varmap.size() == 8);
+        REQUIRE(conmap.size() == 12);
+        std::remove(compact.c_str());
+        std::remove(expanded.c_str());
+    }
+}
+#endif
+
 #if 0
 TEST_CASE( "compact_model_writer", "[smoke]" ) {
 {
@@ -0,0 +1,135 @@
+//
+// Measures the per-callback overhead of the NLPModel compute API, using the
+// same sequence of calls that the Ipopt interface makes in one iteration.
+//
+// The "vector" test copies through temporary std::vector buffers, and the
+// "pointer" test writes directly into caller buffers.
+//
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "models/coek_models.hpp"
+
+void print_help()
+{
+    std::cout << "coek_callbacks [-n <trials>] <ad> <model> [<data> ...]" << std::endl;
+    std::cout << std::endl << "TEST MODELS" << std::endl;
+    print_models(std::cout);
+    std::cout << std::endl;
+}
+
+double vector_callbacks(coek::NLPModel& nlp, std::vector<double>& x, size_t ntrials)
+{
+    size_t n = nlp.num_variables();
+    size_t m = nlp.num_constraints();
+    std::vector<double> grad(n), g(m), J(nlp.num_nonzeros_Jacobian()),
+        H(nlp.num_nonzeros_Hessian_Lagrangian()), lambda(m, 1.0);
+    std::vector<double> tmp_grad(n), tmp_g(m), tmp_j(J.size()), tmp_h(H.size()),
+        tmp_hw(nlp.num_objectives() + m);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < ntrials; t++) {
+        nlp.set_variable_view(x.data(), n);
+        double f = nlp.compute_f(0);
+        nlp.compute_df(f, tmp_grad, 0);
+        std::copy(tmp_grad.begin(), tmp_grad.end(), grad.begin());
+        nlp.compute_c(tmp_g);
+        std::copy(tmp_g.begin(), tmp_g.end(), g.begin());
+        nlp.compute_J(tmp_j);
+        std::copy(tmp_j.begin(), tmp_j.end(), J.begin());
+        std::fill(tmp_hw.data(), tmp_hw.data() + nlp.num_objectives(), 1.0);
+        std::copy(lambda.begin(), lambda.end(), tmp_hw.data() + nlp.num_objectives());
+        nlp.compute_H(tmp_hw, tmp_h);
+        std::copy(tmp_h.begin(), tmp_h.end(), H.begin());
+    }
+    std::chrono::duration<double> diff = std::chrono::high_resolution_clock::now() - start;
+    return diff.count() / static_cast<double>(ntrials);
+}
+
+double pointer_callbacks(coek::NLPModel& nlp, std::vector<double>& x, size_t ntrials)
+{
+    size_t n = nlp.num_variables();
+    size_t m = nlp.num_constraints();
+    std::vector<double> grad(n), g(m), J(nlp.num_nonzeros_Jacobian()),
+        H(nlp.num_nonzeros_Hessian_Lagrangian()), lambda(m, 1.0);
+    std::vector<double> fw(nlp.num_objectives(), 1.0);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < ntrials; t++) {
+        nlp.set_variable_view(x.data(), n);
+        double f = nlp.compute_f(0);
+        nlp.compute_df(f, grad.data(), 0);
+        nlp.compute_c(g.data());
+        nlp.compute_J(J.data());
+        nlp.compute_H(fw.data(), lambda.data(), H.data());
+    }
+    std::chrono::duration<double> diff = std::chrono::high_resolution_clock::now() - start;
+    return diff.count() / static_cast<double>(ntrials);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc <= 2) {
+        print_help();
+        return 1;
+    }
+
+    size_t ntrials = 10;
+    std::string ad_name;
+    std::string model_name;
+    std::vector<size_t> data;
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    // Loop over command-line args
+    size_t i = 0;
+    while (i < args.size()) {
+        if (args[i] == "-h" || args[i] == "--help") {
+            print_help();
+            return 0;
+        }
+        else if (args[i] == "-n") {
+            ntrials = std::stoul(args[i + 1]);
+            i += 2;
+        }
+        else {
+            ad_name = args[i++];
+            model_name = args[i++];
+            while (i < args.size()) data.push_back(std::stoul(args[i++]));
+        }
+    }
+
+    coek::Model model;
+    try {
+        create_instance(model, model_name, data);
+    }
+    catch (std::exception& e) {
+        std::cout << "ERROR - " << e.what() << std::endl;
+        return 1;
+    }
+
+    coek::NLPModel nlp;
+    try {
+        nlp.initialize(model, ad_name);
+    }
+    catch (std::exception& e) {
+        std::cout << "ERROR - " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<double> x(nlp.num_variables());
+    for (size_t j = 0; j < x.size(); j++) x[j] = nlp.get_variable(j).value();
+
+    // Warm up the AD data structures before timing
+    pointer_callbacks(nlp, x, 1);
+
+    std::cout << "Model: " << model_name << " Variables: " << nlp.num_variables()
+              << " Constraints: " << nlp.num_constraints() << " Trials: " << ntrials << std::endl;
+    std::cout << "vector:  " << vector_callbacks(nlp, x, ntrials) << " s/iteration" << std::endl;
+    std::cout << "pointer: " << pointer_callbacks(nlp, x, ntrials) << " s/iteration" << std::endl;
+
+    return 0;
+}
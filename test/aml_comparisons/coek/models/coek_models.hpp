@@ -23,6 +23,7 @@ void lqcp_map(coek::Model& model, size_t N);
 void knapsack_scalar(coek::Model& model, size_t N);
 void nqueens_scalar(coek::Model& model, size_t N);
 void pmedian_scalar(coek::Model& model, size_t N, size_t P);
+void srosenbr_scalar(coek::Model& model, size_t N);
 #if __cpp_lib_variant
 void knapsack_array(coek::Model& model, size_t N);
 void nqueens_array(coek::Model& model, size_t N);
@@ -53,7 +54,8 @@ inline void print_models(std::ostream& os)
 #if __cpp_lib_variant
         "  pmedian-array N P\n"
 #endif
-        "  pmedian-scalar N P\n";
+        "  pmedian-scalar N P\n"
+        "  srosenbr-scalar N\n";
 }
 
 inline void check_data(const std::string& name, const std::vector<size_t>& data, size_t num)
@@ -137,6 +139,10 @@ inline void create_instance(coek::Model& model, const std::string& name,
         check_data(name, data, 2);
         pmedian_scalar(model, data[0], data[1]);
     }
+    else if (name == "srosenbr-scalar") {
+        check_data(name, data, 1);
+        srosenbr_scalar(model, data[0]);
+    }
     else
         throw std::runtime_error("Unknown test model: " + name);
 }
@@ -0,0 +1,24 @@
+#include <coek/coek.hpp>
+#include <vector>
+
+// Source:  problem 21 in
+// J.J. More', B.S. Garbow and K.E. Hillstrom,
+// "Testing Unconstrained Optimization Software",
+// ACM Transactions on Mathematical Software, vol. 7(1), pp. 17-41, 1981.
+
+void srosenbr_scalar(coek::Model& model, size_t N)
+{
+    std::vector<coek::Variable> x(N);
+    for (size_t i = 0; i < N; i++) {
+        if (i % 2 == 0)
+            model.add(x[i].value(-1.2));
+        else
+            model.add(x[i].value(1));
+    }
+
+    coek::Expression obj;
+    for (size_t i = 0; i < N / 2; i++)
+        obj += 100 * pow(x[2 * i + 1] - pow(x[2 * i], 2), 2) + pow(x[2 * i] - 1, 2);
+
+    model.add_objective(obj);
+}
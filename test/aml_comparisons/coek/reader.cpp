@@ -0,0 +1,79 @@
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <coek/coek.hpp>
+
+void print_help()
+{
+    std::cout << "coek_reader [-t] <filename>" << std::endl;
+    std::cout << std::endl;
+    std::cout << "VALID FILENAME SUFFIXES\n"
+                 "  json   - JPOF file\n"
+                 "  lp     - LP file\n"
+                 "  nl     - NL file\n"
+                 "  snapshot - Binary model snapshot\n"
+                 "\n"
+                 "OPTIONS\n"
+                 "  -t     - Print the time used to read the file\n"
+                 "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        print_help();
+        return 1;
+    }
+
+    bool timing = false;
+    std::string filename;
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (auto& arg : args) {
+        if (arg == "-h" || arg == "--help") {
+            print_help();
+            return 0;
+        }
+        else if (arg == "-t")
+            timing = true;
+        else
+            filename = arg;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    coek::Model model;
+    try {
+        if (filename.size() > 5 && filename.substr(filename.size() - 5) == ".json") {
+            std::map<std::string, coek::Parameter> params;
+            model = coek::read_problem_from_jpof_file(filename, params);
+        }
+        else if (filename.size() > 3 && filename.substr(filename.size() - 3) == ".lp")
+            model = coek::read_problem_from_lp_file(filename);
+        else if (filename.size() > 3 && filename.substr(filename.size() - 3) == ".nl")
+            model = coek::read_problem_from_nl_file(filename);
+        else if (filename.size() > 9 && filename.substr(filename.size() - 9) == ".snapshot")
+            model = coek::Model::load_snapshot(filename);
+        else {
+            std::cout << "ERROR - Unknown file suffix: " << filename << std::endl;
+            return 1;
+        }
+    }
+    catch (std::exception& e) {
+        std::cout << "ERROR - " << e.what() << std::endl;
+        return 1;
+    }
+    auto read = std::chrono::steady_clock::now();
+
+    std::cout << "Variables: " << model.num_variables()
+              << " Constraints: " << model.num_constraints()
+              << " Objectives: " << model.num_objectives() << std::endl;
+    if (timing) {
+        std::chrono::duration<double> read_time = read - start;
+        std::cout << "Read: " << read_time.count() << " s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <coek/coek.hpp>
+
+void print_help()
+{
+    std::cout << "coek_scaling [-a <ad>] [--scale-variables] <filename> [<filename> ...]"
+              << std::endl;
+    std::cout << std::endl;
+    std::cout << "Solve NL files with ipopt, with and without the scaling factors computed by\n"
+                 "coek::compute_scaling_factors(), and report the iteration counts.\n"
+                 "\n"
+                 "OPTIONS\n"
+                 "  -a <ad>            - The AD library used by ipopt (default cppad)\n"
+                 "  --scale-variables  - Compute scaling factors for variables\n"
+                 "\n";
+}
+
+//
+// Solve from x0, and return the number of iterations (or -1 if ipopt fails)
+//
+int solve(coek::Model& model, const std::string& ad, const std::vector<double>& x0)
+{
+    coek::NLPModel nlp(model, ad);
+    coek::NLPSolver solver("ipopt");
+    solver.set_option("print_level", 0);
+    auto results = solver.multistart(nlp, {x0}, 1);
+    auto& res = results.starts[0];
+    return res.converged ? static_cast<int>(res.iterations) : -1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        print_help();
+        return 1;
+    }
+
+    std::string ad = "cppad";
+    coek::ScalingOptions options;
+    std::vector<std::string> filenames;
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "-h" || args[i] == "--help") {
+            print_help();
+            return 0;
+        }
+        else if ((args[i] == "-a") and (i + 1 < args.size()))
+            ad = args[++i];
+        else if (args[i] == "--scale-variables")
+            options.scale_variables = true;
+        else
+            filenames.push_back(args[i]);
+    }
+
+    coek::NLPSolver solver("ipopt");
+    if (not solver.available()) {
+        std::cout << "ERROR - solver 'ipopt' is not available" << std::endl;
+        std::cout << "MESSAGE - " << solver.error_message() << std::endl;
+        return 2;
+    }
+
+    std::cout << std::setw(30) << std::left << "Problem" << std::right << std::setw(10)
+              << "Unscaled" << std::setw(10) << "Scaled" << std::setw(10) << "Factors"
+              << std::endl;
+    size_t total_unscaled = 0;
+    size_t total_scaled = 0;
+    for (auto& filename : filenames) {
+        std::cout << std::setw(30) << std::left << filename << std::right << std::flush;
+        try {
+            auto model = coek::read_problem_from_nl_file(filename);
+
+            //
+            // Both solves start from the initial values in the NL file.  Variables
+            // without initial values start at the projection of zero onto their bounds.
+            //
+            std::vector<double> x0;
+            {
+                coek::NLPModel nlp(model, ad);
+                for (size_t i = 0; i < nlp.num_variables(); i++) {
+                    auto var = nlp.get_variable(i);
+                    double value = var.value();
+                    if (std::isnan(value))
+                        value = std::max(var.lower(), std::min(var.upper(), 0.0));
+                    var.value(value);
+                    x0.push_back(value);
+                }
+            }
+
+            int unscaled = solve(model, ad, x0);
+            model = coek::read_problem_from_nl_file(filename);
+            {
+                coek::NLPModel nlp(model, ad);
+                for (size_t i = 0; i < nlp.num_variables(); i++) nlp.get_variable(i).value(x0[i]);
+            }
+            size_t nfactors = coek::compute_scaling_factors(model, options);
+            int scaled = solve(model, ad, x0);
+
+            std::cout << std::setw(10) << unscaled << std::setw(10) << scaled << std::setw(10)
+                      << nfactors << std::endl;
+            if ((unscaled >= 0) and (scaled >= 0)) {
+                total_unscaled += static_cast<size_t>(unscaled);
+                total_scaled += static_cast<size_t>(scaled);
+            }
+        }
+        catch (std::exception& e) {
+            std::cout << "  ERROR - " << e.what() << std::endl;
+        }
+    }
+    std::cout << std::setw(30) << std::left << "Total (both converged)" << std::right
+              << std::setw(10) << total_unscaled << std::setw(10) << total_scaled << std::endl;
+
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -6,7 +7,7 @@
 
 void print_help()
 {
-    std::cout << "coek_writer [-d] <filename> <model> [<data> ...]" << std::endl;
+    std::cout << "coek_writer [-d] [-t] <filename> <model> [<data> ...]" << std::endl;
     std::cout << std::endl << "TEST MODELS" << std::endl;
     print_models(std::cout);
     std::cout << std::endl;
@@ -17,6 +18,9 @@ void print_help()
                  "  nl     - Canonical NL file, written with FMT library\n"
                  "  fmtnl  - Canonical NL file, written with FMT library\n"
                  "  ostrnl - Canonical NL file, written with C++ ostream\n"
+                 "  bnl    - Binary NL file\n"
+                 "  mps    - Free-format MPS file\n"
+                 "  snapshot - Binary model snapshot\n"
                  "\n";
 }
 
@@ -28,6 +32,7 @@ int main(int argc, char* argv[])
     }
 
     bool debug = false;
+    bool timing = false;
     std::string filename;
     std::string model_name;
     std::vector<size_t> data;
@@ -45,6 +50,10 @@ int main(int argc, char* argv[])
             debug = true;
             i++;
         }
+        else if (args[i] == "-t") {
+            timing = true;
+            i++;
+        }
         else {
             filename = args[i++];
             model_name = args[i++];
@@ -55,6 +64,7 @@ int main(int argc, char* argv[])
     if (debug)
         std::cout << "Filename: " << filename << " Model: " << model_name << " Data: " << data[0]
                   << std::endl;
+    auto start = std::chrono::steady_clock::now();
     coek::Model model;
     try {
         create_instance(model, model_name, data);
@@ -63,7 +73,19 @@ int main(int argc, char* argv[])
         std::cout << "ERROR - " << e.what() << std::endl;
         return 1;
     }
-    model.write(filename);
+    auto created = std::chrono::steady_clock::now();
+    if ((filename.size() > 9) and (filename.substr(filename.size() - 9) == ".snapshot"))
+        model.save_snapshot(filename);
+    else
+        model.write(filename);
+    auto written = std::chrono::steady_clock::now();
+
+    if (timing) {
+        std::chrono::duration<double> create_time = created - start;
+        std::chrono::duration<double> write_time = written - created;
+        std::cout << "Create: " << create_time.count() << " s  Write: " << write_time.count()
+                  << " s" << std::endl;
+    }
 
     return 0;
 }